@@ -0,0 +1,34 @@
+// array benchmark: per-element loops vs. the native bulk operations
+//
+//     time chuck --silent array-ops.ck
+
+// array size
+4096 => int N;
+// passes
+2000 => int PASSES;
+
+float a[N];
+float b[N];
+for( 0 => int i; i < N; i++ ) { i * .001 => a[i]; 1 - i * .0005 => b[i]; }
+
+// per element
+now => time start;
+0.0 => float acc;
+for( 0 => int p; p < PASSES; p++ )
+{
+    for( 0 => int i; i < N; i++ ) .999 *=> a[i];
+    0.0 => float dot;
+    for( 0 => int i; i < N; i++ ) a[i] * b[i] +=> dot;
+    dot +=> acc;
+}
+<<< "loops:", acc >>>;
+
+// bulk
+for( 0 => int i; i < N; i++ ) i * .001 => a[i];
+0.0 => acc;
+for( 0 => int p; p < PASSES; p++ )
+{
+    a.scale( .999 );
+    a.dot( b ) +=> acc;
+}
+<<< "bulk:", acc >>>;
@@ -0,0 +1,41 @@
+// event broadcast benchmark: 2000 shreds waiting on a clock event
+//
+// one clock shred broadcasts every beat; every waiter wakes, counts,
+// and waits again:
+//
+//     time chuck --silent event-broadcast.ck
+
+// number of waiters
+2000 => int N;
+// beats
+5000 => int BEATS;
+// beat length
+10::ms => dur T;
+
+// the clock
+Event beat;
+
+// wake count
+0 => int wakes;
+fun void waiter()
+{
+    while( true )
+    {
+        beat => now;
+        wakes++;
+    }
+}
+for( 0 => int i; i < N; i++ ) spork ~ waiter();
+
+// let them block
+me.yield();
+
+// tick
+for( 0 => int i; i < BEATS; i++ )
+{
+    beat.broadcast();
+    T => now;
+}
+
+// print
+<<< "wakes:", wakes, "expected:", N * BEATS >>>;
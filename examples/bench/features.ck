@@ -0,0 +1,35 @@
+// feature benchmark: eight extractors reading one FFT, hopping every
+// 256 samples for a minute of audio
+//
+//     time chuck --silent features.ck
+//
+// (the FFT's magnitude spectrum is made once per frame and shared)
+
+// the analysis chain
+Noise n => FFT fft => blackhole;
+fft =^ Centroid centroid => blackhole;
+fft =^ Flux flux => blackhole;
+fft =^ RMS rms => blackhole;
+fft =^ RollOff rolloff => blackhole;
+fft =^ MFCC mfcc => blackhole;
+fft =^ Chroma chroma => blackhole;
+fft =^ SFM sfm => blackhole;
+fft =^ Crest crest => blackhole;
+
+// the frame
+1024 => fft.size;
+Windowing.hann( 1024 ) => fft.window;
+
+// one minute
+now + 1::minute => time later;
+0 => int frames;
+while( now < later )
+{
+    // compute everything for this frame
+    centroid.upchuck(); flux.upchuck(); rms.upchuck(); rolloff.upchuck();
+    mfcc.upchuck(); chroma.upchuck(); sfm.upchuck(); crest.upchuck();
+    frames++;
+    256::samp => now;
+}
+
+<<< "frames:", frames, "mfcc:", mfcc.fvals().cap() >>>;
@@ -0,0 +1,39 @@
+// fft benchmark: forward and inverse transforms from 64 to 65536 points
+//
+//     time chuck --silent fft-sizes.ck
+//     time chuck --silent --fft:classic fft-sizes.ck
+//
+// (the classic fft rounds the sizes that aren't powers of two up)
+
+// points transformed per size
+4194304 => int WORK;
+
+FFT fft;
+IFFT ifft;
+
+// one size
+fun void run( int size )
+{
+    size => fft.size;
+    size => ifft.size;
+
+    float frame[size];
+    for( 0 => int i; i < size; i++ ) Std.rand2f( -1, 1 ) => frame[i];
+    complex spectrum[size/2];
+
+    WORK / size => int passes;
+    if( passes < 1 ) 1 => passes;
+    for( 0 => int p; p < passes; p++ )
+    {
+        fft.transform( frame );
+        fft.spectrum( spectrum );
+        ifft.transform( spectrum );
+    }
+    <<< "size:", fft.size(), "passes:", passes >>>;
+}
+
+// powers of two
+for( 64 => int n; n <= 65536; 2 *=> n ) run( n );
+// and some that aren't
+[ 100, 480, 1000, 1764, 4410, 44100 ] @=> int others[];
+for( 0 => int i; i < others.cap(); i++ ) run( others[i] );
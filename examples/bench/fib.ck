@@ -0,0 +1,16 @@
+// interpreter micro-benchmark: recursive function calls
+//
+// compare execution engines with:
+//
+//     time chuck --silent --engine:virtual fib.ck
+//     time chuck --silent --engine:threaded fib.ck
+
+// fibonacci
+fun int fib( int n )
+{
+    if( n < 2 ) return n;
+    return fib( n - 1 ) + fib( n - 2 );
+}
+
+// print
+<<< "fib(27):", fib( 27 ) >>>;
@@ -0,0 +1,22 @@
+// interpreter micro-benchmark: floating point loop
+//
+// compare execution engines with:
+//
+//     time chuck --silent --engine:virtual loop-float.ck
+//     time chuck --silent --engine:threaded loop-float.ck
+
+// iterations
+10000000 => int N;
+// state
+0.0 => float x;
+1.0 => float y;
+
+// loop
+for( 0 => int i; i < N; i++ )
+{
+    x * .999 + y * .001 => x;
+    -y => y;
+}
+
+// print
+<<< "x:", x >>>;
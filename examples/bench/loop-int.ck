@@ -0,0 +1,23 @@
+// interpreter micro-benchmark: integer arithmetic loop
+//
+// compare execution engines with:
+//
+//     time chuck --silent --engine:virtual loop-int.ck
+//     time chuck --silent --engine:threaded loop-int.ck
+//
+// and the peephole optimizer with --optimize1 or --optimize2
+
+// iterations
+20000000 => int N;
+// accumulator
+0 => int sum;
+
+// loop
+for( 0 => int i; i < N; i++ )
+{
+    i % 7 +=> sum;
+    i * 3 -=> sum;
+}
+
+// print
+<<< "sum:", sum >>>;
@@ -0,0 +1,46 @@
+// oscillator bank benchmark: 2000 sines
+//
+// compare computed sines, wavetable sines, and one OscBank with:
+//
+//     time chuck --silent osc-bank.ck
+//     time chuck --silent osc-bank.ck:1
+//     time chuck --silent osc-bank.ck:2
+//
+// (all oscillators in wavetable mode share one table)
+
+// number of oscillators
+2000 => int N;
+// how much to compute
+30::second => dur T;
+// 0: SinOsc, 1: SinOsc in wavetable mode, 2: OscBank
+0 => int mode;
+if( me.args() ) Std.atoi( me.arg(0) ) => mode;
+
+// the bank
+Gain g => dac;
+1.0 / N => g.gain;
+if( mode < 2 )
+{
+    SinOsc s[N];
+    for( 0 => int i; i < N; i++ )
+    {
+        s[i] => g;
+        Std.rand2f( 50, 5000 ) => s[i].freq;
+        mode => s[i].wavetable;
+    }
+    T => now;
+}
+else
+{
+    OscBank b => g;
+    float freqs[N];
+    float amps[N];
+    for( 0 => int i; i < N; i++ )
+    {
+        Std.rand2f( 50, 5000 ) => freqs[i];
+        1.0 => amps[i];
+    }
+    freqs => b.freqs;
+    amps => b.amps;
+    T => now;
+}
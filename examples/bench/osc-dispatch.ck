@@ -0,0 +1,61 @@
+// OSC dispatch benchmark: 500 listeners, 10k messages/second
+//
+// replays a controller-like stream (faders moving in runs, as a
+// control surface sends them) to itself over UDP, and counts what
+// the listeners receive:
+//
+//     chuck osc-dispatch.ck
+//
+// (watch the chuck process's cpu; the receiver thread does the work)
+
+// number of listeners
+500 => int N;
+// messages per second
+10000 => int RATE;
+// how long
+10::second => dur T;
+// port
+6449 => int port;
+
+// receiver
+OscRecv recv;
+port => recv.port;
+recv.listen();
+
+// count per listener
+int count[N];
+fun void listen( int which )
+{
+    recv.event( "/surface/fader/" + which + ", f" ) @=> OscEvent e;
+    while( true )
+    {
+        e => now;
+        while( e.nextMsg() ) { e.getFloat(); count[which]++; }
+    }
+}
+for( 0 => int i; i < N; i++ ) spork ~ listen( i );
+
+// sender
+OscSend xmit;
+xmit.setHost( "localhost", port );
+1::second / RATE => dur gap;
+0 => int sent;
+now + T => time later;
+while( now < later )
+{
+    // a run of moves on one fader
+    Std.rand2( 0, N-1 ) => int which;
+    repeat( Std.rand2( 1, 32 ) )
+    {
+        xmit.startMsg( "/surface/fader/" + which, "f" );
+        Std.rand2f( 0, 1 ) => xmit.addFloat;
+        sent++;
+        gap => now;
+    }
+}
+
+// let the last ones arrive
+100::ms => now;
+0 => int got;
+for( 0 => int i; i < N; i++ ) count[i] +=> got;
+<<< "sent:", sent, "received:", got >>>;
@@ -0,0 +1,35 @@
+// spork benchmark: many short-lived note shreds
+//
+// every few samples a new shred is sporked, plays one short note and
+// exits; compare stack sizing with
+//
+//     time chuck --silent spork-notes.ck
+//     time chuck --silent --stacks:full spork-notes.ck
+
+// notes
+200000 => int N;
+// gap between notes
+8::samp => dur T;
+
+// count
+0 => int done;
+fun void note( float freq )
+{
+    freq * 2 => float f;
+    f + 1 => f;
+    4::samp => now;
+    done++;
+}
+
+// spork
+for( 0 => int i; i < N; i++ )
+{
+    spork ~ note( 220 + (i % 12) * 20 );
+    T => now;
+}
+
+// let the last ones finish
+10::samp => now;
+
+// print
+<<< "notes:", done, "expected:", N >>>;
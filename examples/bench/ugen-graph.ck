@@ -0,0 +1,26 @@
+// ugen graph benchmark: 5000 unit generators
+//
+// compare recursive and flattened graph ticking with:
+//
+//     time chuck --silent --graph:recursive ugen-graph.ck
+//     time chuck --silent --graph:flat ugen-graph.ck
+//
+// (add --adaptive<N> to compare the block paths)
+
+// number of ugens
+5000 => int N;
+// how much to compute
+30::second => dur T;
+
+// the graph: a random tree feeding the dac, plus some fan-in
+Gain g[N];
+g[0] => dac;
+.0001 => g[0].gain;
+Noise n => g[1];
+for( 1 => int i; i < N; i++ )
+    g[i] => g[Std.rand2( 0, i-1 )];
+for( 0 => int i; i < N / 10; i++ )
+    g[Std.rand2( N/2, N-1 )] => g[Std.rand2( 1, N/2 )];
+
+// go
+T => now;
@@ -0,0 +1,72 @@
+// ugen graph rewiring: random connects and disconnects as the graph plays
+//
+// check every patch of the flattened schedule against a full rebuild:
+//
+//     chuck --silent --graph:check ugen-rewire.ck
+//
+// (at exit the VM says how many patches differed from a rebuild; any at
+// all is a bug), and compare the checksum printed with the recursive tick:
+//
+//     chuck --silent --graph:flat ugen-rewire.ck
+//     chuck --silent --graph:recursive ugen-rewire.ck
+
+// number of ugens (the first S are stereo)
+200 => int N;
+10 => int S;
+// number of rewirings, and of connections held at a time
+20000 => int R;
+400 => int MAX;
+
+// the same graph every run
+Std.srand( 1 );
+
+// stereo panners, then filters (the order they tick in shows in the sum)
+UGen @ u[N];
+for( 0 => int i; i < N; i++ )
+{
+    if( i < S ) { Pan2 p; p @=> u[i]; }
+    else { OnePole f; .9 => f.pole; f @=> u[i]; }
+}
+// fed by a few steps
+Step s[4];
+for( 0 => int i; i < 4; i++ ) ( i + 1 ) * .1 => s[i].next;
+
+// from: u, then s; to: u, then dac and blackhole
+fun UGen from( int i ) { if( i < N ) return u[i]; return s[i-N]; }
+fun UGen to( int i ) { if( i < N ) return u[i]; if( i == N ) return dac; return blackhole; }
+
+// connections made, and not yet undone
+int a[MAX];
+int b[MAX];
+0 => int E;
+0.0 => float sum;
+
+for( 0 => int r; r < R; r++ )
+{
+    // undo a connection
+    if( E == MAX || ( E > 0 && Std.rand2( 0, 1 ) ) )
+    {
+        Std.rand2( 0, E-1 ) => int e;
+        from( a[e] ) =< to( b[e] );
+        E--;
+        a[E] => a[e];
+        b[E] => b[e];
+    }
+    // or make one
+    else
+    {
+        Std.rand2( 0, N+3 ) => a[E];
+        Std.rand2( 0, N+1 ) => b[E];
+        if( a[E] != b[E] )
+        {
+            from( a[E] ) => to( b[E] );
+            E++;
+        }
+    }
+
+    // let it play, and sum what comes out
+    10::samp => now;
+    for( 0 => int i; i < N; i++ ) u[i].last() +=> sum;
+}
+
+<<< "connections left:", E, "checksum:", sum >>>;
@@ -0,0 +1,37 @@
+// spork many shreds - shreduler stress test
+//
+// sporks 10000 shreds that each wait a random number of samples,
+// then runs for a fixed amount of time with no audio processing.
+// to measure scheduling cost per sample, run:
+//
+//     time chuck --silent spork-many.ck
+//
+// and divide the user time by the number of samples printed at the end.
+
+// number of shreds
+10000 => int N;
+// how long to run
+10::second => dur T;
+// total wakeups
+0 => int wakes;
+
+// each shred wakes up at random intervals
+fun void voice()
+{
+    while( true )
+    {
+        Std.rand2( 1, 1000 )::samp => now;
+        wakes++;
+    }
+}
+
+// spork them
+for( 0 => int i; i < N; i++ )
+    spork ~ voice();
+
+// let time pass
+now => time start;
+T => now;
+
+// report
+<<< "shreds:", N, "samples:", (now - start) / samp, "wakeups:", wakes >>>;
@@ -0,0 +1,20 @@
+// advance time many more times than the reg stack is deep; with the
+// peephole optimizer on, 'dur => now' is a single fused instruction
+// that must leave the stack as it found it
+//
+//     chuck --silent --optimize time_advance_loop.ck
+//     chuck --silent --optimize2 time_advance_loop.ck
+
+// iterations (the reg stack holds a few thousand words)
+100000 => int N;
+
+// as a statement: the new time is discarded
+for( 0 => int i; i < N; i++ )
+    1::samp => now;
+
+// as an expression: the new time is used
+now => time start;
+for( 0 => int i; i < N; i++ )
+    ( 1::samp => now ) => time t;
+
+<<< "advanced", ( now - start ) / samp, "samples, twice" >>>;
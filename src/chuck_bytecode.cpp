@@ -0,0 +1,672 @@
+/*----------------------------------------------------------------------------
+    ChucK Concurrent, On-the-fly Audio Programming Language
+      Compiler and Virtual Machine
+
+    Copyright (c) 2004 Ge Wang and Perry R. Cook.  All rights reserved.
+      http://chuck.cs.princeton.edu/
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// file: chuck_bytecode.cpp
+// desc: threaded-code execution engine
+//-----------------------------------------------------------------------------
+#include "chuck_bytecode.h"
+#include "chuck_vm.h"
+#include "chuck_instr.h"
+#include "chuck_errmsg.h"
+
+#include <typeinfo>
+using namespace std;
+
+
+// use computed goto where the compiler has it
+#if defined(__GNUC__) && !defined(__CK_BYTECODE_SWITCH__)
+  #define __CK_BYTECODE_GOTO__
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// opcodes - must match the label table in bytecode_exec()
+//-----------------------------------------------------------------------------
+enum
+{
+    BC_VIRTUAL = 0,
+    BC_NOP,
+    BC_GOTO,
+    BC_REG_PUSH_IMM,
+    BC_REG_PUSH_IMM2,
+    BC_REG_POP_WORD,
+    BC_REG_POP_WORD2,
+    BC_REG_DUP_LAST,
+    BC_REG_PUSH_MEM,
+    BC_REG_PUSH_MEM_BASE,
+    BC_REG_PUSH_MEM2,
+    BC_REG_PUSH_MEM2_BASE,
+    BC_REG_PUSH_MEM_ADDR,
+    BC_REG_PUSH_MEM_ADDR_BASE,
+    BC_REG_PUSH_NOW,
+    BC_ASSIGN_PRIMITIVE,
+    BC_ASSIGN_PRIMITIVE2,
+    BC_ADD_INT,
+    BC_MINUS_INT,
+    BC_MINUS_INT_REVERSE,
+    BC_TIMES_INT,
+    BC_DIVIDE_INT,
+    BC_DIVIDE_INT_REVERSE,
+    BC_MOD_INT,
+    BC_MOD_INT_REVERSE,
+    BC_ADD_DOUBLE,
+    BC_MINUS_DOUBLE,
+    BC_MINUS_DOUBLE_REVERSE,
+    BC_TIMES_DOUBLE,
+    BC_DIVIDE_DOUBLE,
+    BC_DIVIDE_DOUBLE_REVERSE,
+    BC_ADD_INT_ASSIGN,
+    BC_MINUS_INT_ASSIGN,
+    BC_PREINC_INT,
+    BC_POSTINC_INT,
+    BC_PREDEC_INT,
+    BC_POSTDEC_INT,
+    BC_NOT_INT,
+    BC_NEGATE_INT,
+    BC_NEGATE_DOUBLE,
+    BC_CAST_INT2DOUBLE,
+    BC_CAST_DOUBLE2INT,
+    BC_LT_INT,
+    BC_GT_INT,
+    BC_LE_INT,
+    BC_GE_INT,
+    BC_EQ_INT,
+    BC_NEQ_INT,
+    BC_LT_DOUBLE,
+    BC_GT_DOUBLE,
+    BC_LE_DOUBLE,
+    BC_GE_DOUBLE,
+    BC_EQ_DOUBLE,
+    BC_NEQ_DOUBLE,
+    BC_BRANCH_LT_INT,
+    BC_BRANCH_GT_INT,
+    BC_BRANCH_LE_INT,
+    BC_BRANCH_GE_INT,
+    BC_BRANCH_EQ_INT,
+    BC_BRANCH_NEQ_INT,
+    BC_BRANCH_LT_DOUBLE,
+    BC_BRANCH_GT_DOUBLE,
+    BC_BRANCH_LE_DOUBLE,
+    BC_BRANCH_GE_DOUBLE,
+    BC_BRANCH_EQ_DOUBLE,
+    BC_BRANCH_NEQ_DOUBLE,
+    BC_REG_PUSH_MEM_ADD_IMM,
+    BC_REG_PUSH_MEM_ADD_IMM_BASE,
+    BC_ASSIGN_PRIMITIVE_MEM,
+    BC_ASSIGN_PRIMITIVE_MEM_BASE,
+    BC_ASSIGN_PRIMITIVE2_MEM,
+    BC_ASSIGN_PRIMITIVE2_MEM_BASE,
+    BC_ADD_INT_MEM_IMM,
+    BC_ADD_INT_MEM_IMM_BASE,
+    BC_NUM_OPS
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: Chuck_Bytecode()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_Bytecode::Chuck_Bytecode()
+{
+    ops = NULL;
+    num_ops = 0;
+    num_native = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~Chuck_Bytecode()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_Bytecode::~Chuck_Bytecode()
+{
+    SAFE_DELETE_ARRAY( ops );
+    num_ops = 0;
+}
+
+
+
+
+// instruction type test
+#define BC_IS( type ) ( typeid(*instr) == typeid(Chuck_Instr_##type) )
+//-----------------------------------------------------------------------------
+// name: lower()
+// desc: translate code->instr into ops
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_Bytecode::lower( Chuck_VM_Code * code )
+{
+    Chuck_Instr * instr = NULL;
+    Chuck_Bytecode_Op * op = NULL;
+
+    // clean up
+    SAFE_DELETE_ARRAY( ops );
+    num_ops = num_native = 0;
+
+    // allocate
+    ops = new Chuck_Bytecode_Op[code->num_instr];
+    if( !ops ) return FALSE;
+    num_ops = code->num_instr;
+
+    // loop over instructions
+    for( t_CKUINT i = 0; i < num_ops; i++ )
+    {
+        instr = code->instr[i];
+        op = &ops[i];
+        op->a = 0;
+        op->b = 0;
+
+        // operands
+        if( BC_IS( Goto ) )
+            op->a = ((Chuck_Instr_Branch_Op *)instr)->get();
+        else if( BC_IS( Reg_Push_Imm ) )
+            op->a = ((Chuck_Instr_Unary_Op *)instr)->get();
+        else if( BC_IS( Reg_Push_Imm2 ) )
+            op->f = ((Chuck_Instr_Unary_Op2 *)instr)->get();
+
+        // opcode
+        if( BC_IS( Nop ) ) op->op = BC_NOP;
+        else if( BC_IS( Goto ) ) op->op = BC_GOTO;
+        else if( BC_IS( Reg_Push_Imm ) ) op->op = BC_REG_PUSH_IMM;
+        else if( BC_IS( Reg_Push_Imm2 ) ) op->op = BC_REG_PUSH_IMM2;
+        else if( BC_IS( Reg_Pop_Word ) ) op->op = BC_REG_POP_WORD;
+        else if( BC_IS( Reg_Pop_Word2 ) ) op->op = BC_REG_POP_WORD2;
+        else if( BC_IS( Reg_Dup_Last ) ) op->op = BC_REG_DUP_LAST;
+        else if( BC_IS( Reg_Push_Mem ) )
+        {
+            Chuck_Instr_Reg_Push_Mem * p = (Chuck_Instr_Reg_Push_Mem *)instr;
+            op->op = p->use_base() ? BC_REG_PUSH_MEM_BASE : BC_REG_PUSH_MEM;
+            op->a = p->get();
+        }
+        else if( BC_IS( Reg_Push_Mem2 ) )
+        {
+            Chuck_Instr_Reg_Push_Mem2 * p = (Chuck_Instr_Reg_Push_Mem2 *)instr;
+            op->op = p->use_base() ? BC_REG_PUSH_MEM2_BASE : BC_REG_PUSH_MEM2;
+            op->a = p->get();
+        }
+        else if( BC_IS( Reg_Push_Mem_Addr ) )
+        {
+            Chuck_Instr_Reg_Push_Mem_Addr * p = (Chuck_Instr_Reg_Push_Mem_Addr *)instr;
+            op->op = p->use_base() ? BC_REG_PUSH_MEM_ADDR_BASE : BC_REG_PUSH_MEM_ADDR;
+            op->a = p->get();
+        }
+        else if( BC_IS( Reg_Push_Mem_Add_Imm ) )
+        {
+            Chuck_Instr_Reg_Push_Mem_Add_Imm * p = (Chuck_Instr_Reg_Push_Mem_Add_Imm *)instr;
+            op->op = p->use_base() ? BC_REG_PUSH_MEM_ADD_IMM_BASE : BC_REG_PUSH_MEM_ADD_IMM;
+            op->a = p->get();
+            op->b = (t_CKUINT)p->imm();
+        }
+        else if( BC_IS( Assign_Primitive_Mem ) )
+        {
+            Chuck_Instr_Assign_Primitive_Mem * p = (Chuck_Instr_Assign_Primitive_Mem *)instr;
+            op->op = p->use_base() ? BC_ASSIGN_PRIMITIVE_MEM_BASE : BC_ASSIGN_PRIMITIVE_MEM;
+            op->a = p->get();
+        }
+        else if( BC_IS( Assign_Primitive2_Mem ) )
+        {
+            Chuck_Instr_Assign_Primitive2_Mem * p = (Chuck_Instr_Assign_Primitive2_Mem *)instr;
+            op->op = p->use_base() ? BC_ASSIGN_PRIMITIVE2_MEM_BASE : BC_ASSIGN_PRIMITIVE2_MEM;
+            op->a = p->get();
+        }
+        else if( BC_IS( Add_int_Mem_Imm ) )
+        {
+            Chuck_Instr_Add_int_Mem_Imm * p = (Chuck_Instr_Add_int_Mem_Imm *)instr;
+            op->op = p->use_base() ? BC_ADD_INT_MEM_IMM_BASE : BC_ADD_INT_MEM_IMM;
+            op->a = p->get();
+            op->b = (t_CKUINT)p->imm();
+        }
+        else if( BC_IS( Reg_Push_Now ) ) op->op = BC_REG_PUSH_NOW;
+        else if( BC_IS( Assign_Primitive ) ) op->op = BC_ASSIGN_PRIMITIVE;
+        else if( BC_IS( Assign_Primitive2 ) ) op->op = BC_ASSIGN_PRIMITIVE2;
+        else if( BC_IS( Add_int ) ) op->op = BC_ADD_INT;
+        else if( BC_IS( Minus_int ) ) op->op = BC_MINUS_INT;
+        else if( BC_IS( Minus_int_Reverse ) ) op->op = BC_MINUS_INT_REVERSE;
+        else if( BC_IS( Times_int ) ) op->op = BC_TIMES_INT;
+        else if( BC_IS( Divide_int ) ) op->op = BC_DIVIDE_INT;
+        else if( BC_IS( Divide_int_Reverse ) ) op->op = BC_DIVIDE_INT_REVERSE;
+        else if( BC_IS( Mod_int ) ) op->op = BC_MOD_INT;
+        else if( BC_IS( Mod_int_Reverse ) ) op->op = BC_MOD_INT_REVERSE;
+        else if( BC_IS( Add_double ) ) op->op = BC_ADD_DOUBLE;
+        else if( BC_IS( Minus_double ) ) op->op = BC_MINUS_DOUBLE;
+        else if( BC_IS( Minus_double_Reverse ) ) op->op = BC_MINUS_DOUBLE_REVERSE;
+        else if( BC_IS( Times_double ) ) op->op = BC_TIMES_DOUBLE;
+        else if( BC_IS( Divide_double ) ) op->op = BC_DIVIDE_DOUBLE;
+        else if( BC_IS( Divide_double_Reverse ) ) op->op = BC_DIVIDE_DOUBLE_REVERSE;
+        else if( BC_IS( Add_int_Assign ) ) op->op = BC_ADD_INT_ASSIGN;
+        else if( BC_IS( Minus_int_Assign ) ) op->op = BC_MINUS_INT_ASSIGN;
+        else if( BC_IS( PreInc_int ) ) op->op = BC_PREINC_INT;
+        else if( BC_IS( PostInc_int ) ) op->op = BC_POSTINC_INT;
+        else if( BC_IS( PreDec_int ) ) op->op = BC_PREDEC_INT;
+        else if( BC_IS( PostDec_int ) ) op->op = BC_POSTDEC_INT;
+        else if( BC_IS( Not_int ) ) op->op = BC_NOT_INT;
+        else if( BC_IS( Negate_int ) ) op->op = BC_NEGATE_INT;
+        else if( BC_IS( Negate_double ) ) op->op = BC_NEGATE_DOUBLE;
+        else if( BC_IS( Cast_int2double ) ) op->op = BC_CAST_INT2DOUBLE;
+        else if( BC_IS( Cast_double2int ) ) op->op = BC_CAST_DOUBLE2INT;
+        else if( BC_IS( Lt_int ) ) op->op = BC_LT_INT;
+        else if( BC_IS( Gt_int ) ) op->op = BC_GT_INT;
+        else if( BC_IS( Le_int ) ) op->op = BC_LE_INT;
+        else if( BC_IS( Ge_int ) ) op->op = BC_GE_INT;
+        else if( BC_IS( Eq_int ) ) op->op = BC_EQ_INT;
+        else if( BC_IS( Neq_int ) ) op->op = BC_NEQ_INT;
+        else if( BC_IS( Lt_double ) ) op->op = BC_LT_DOUBLE;
+        else if( BC_IS( Gt_double ) ) op->op = BC_GT_DOUBLE;
+        else if( BC_IS( Le_double ) ) op->op = BC_LE_DOUBLE;
+        else if( BC_IS( Ge_double ) ) op->op = BC_GE_DOUBLE;
+        else if( BC_IS( Eq_double ) ) op->op = BC_EQ_DOUBLE;
+        else if( BC_IS( Neq_double ) ) op->op = BC_NEQ_DOUBLE;
+        else if( BC_IS( Branch_Lt_int ) ) op->op = BC_BRANCH_LT_INT;
+        else if( BC_IS( Branch_Gt_int ) ) op->op = BC_BRANCH_GT_INT;
+        else if( BC_IS( Branch_Le_int ) ) op->op = BC_BRANCH_LE_INT;
+        else if( BC_IS( Branch_Ge_int ) ) op->op = BC_BRANCH_GE_INT;
+        else if( BC_IS( Branch_Eq_int ) ) op->op = BC_BRANCH_EQ_INT;
+        else if( BC_IS( Branch_Neq_int ) ) op->op = BC_BRANCH_NEQ_INT;
+        else if( BC_IS( Branch_Lt_double ) ) op->op = BC_BRANCH_LT_DOUBLE;
+        else if( BC_IS( Branch_Gt_double ) ) op->op = BC_BRANCH_GT_DOUBLE;
+        else if( BC_IS( Branch_Le_double ) ) op->op = BC_BRANCH_LE_DOUBLE;
+        else if( BC_IS( Branch_Ge_double ) ) op->op = BC_BRANCH_GE_DOUBLE;
+        else if( BC_IS( Branch_Eq_double ) ) op->op = BC_BRANCH_EQ_DOUBLE;
+        else if( BC_IS( Branch_Neq_double ) ) op->op = BC_BRANCH_NEQ_DOUBLE;
+        else
+        {
+            // not ported: call through to the instruction
+            op->op = BC_VIRTUAL;
+            op->instr = instr;
+            continue;
+        }
+
+        // branch target
+        if( op->op >= BC_BRANCH_LT_INT && op->op <= BC_BRANCH_NEQ_DOUBLE )
+            op->a = ((Chuck_Instr_Branch_Op *)instr)->get();
+
+        // count
+        num_native++;
+    }
+
+    // log
+    EM_log( CK_LOG_FINER, "lowered '%s': %d of %d instructions native",
+            code->name.c_str(), num_native, num_ops );
+
+    return TRUE;
+}
+
+
+
+
+// register stack access
+#define BC_SP( type )           ((type *)reg_sp)
+#define BC_PUSH( type, val )    *(type *)reg_sp = (val); reg_sp += sizeof(type)
+#define BC_POP( type, n )       reg_sp -= (n) * sizeof(type)
+
+// binary op: pop two of 'type', push result of 'rtype'
+#define BC_BINARY( type, rtype, expr ) \
+    { BC_POP( type, 2 ); type * sp = BC_SP( type ); \
+      rtype r = (expr); BC_PUSH( rtype, r ); }
+// compare-and-branch: pop two of 'type', jump if true
+#define BC_BRANCH( type, cmp ) \
+    { BC_POP( type, 2 ); type * sp = BC_SP( type ); \
+      if( sp[0] cmp sp[1] ) { BC_JUMP( ip->a ); } } BC_NEXT()
+
+// dispatch
+#if defined(__CK_BYTECODE_GOTO__)
+  #define BC_CASE( x )          L_##x:
+  #define BC_DISPATCH()         goto *labels[ip->op]
+#else
+  #define BC_CASE( x )          case x:
+  #define BC_DISPATCH()         goto dispatch
+#endif
+
+// next op
+#define BC_NEXT()               ip++; CK_TRACK( shred->stat->cycles++ ); BC_DISPATCH()
+// jump - also where a tight loop gets a chance to be stopped
+#define BC_JUMP( target ) \
+    ip = ops + (target); CK_TRACK( shred->stat->cycles++ ); \
+    if( !*vm_running || shred->is_abort ) goto done; \
+    BC_DISPATCH()
+
+// (re)load code, lowering on first use
+#define BC_LOAD_CODE() \
+    code = shred->code; \
+    if( !code->bytecode ) \
+    { code->bytecode = new Chuck_Bytecode; code->bytecode->lower( code ); } \
+    ops = code->bytecode->ops
+//-----------------------------------------------------------------------------
+// name: bytecode_exec()
+// desc: run shred from shred->pc until it yields, ends, or is aborted; on
+//       return shred->pc/next_pc are set as Chuck_VM_Shred::run() would set
+//       them, so shreds can move between engines
+//-----------------------------------------------------------------------------
+void bytecode_exec( Chuck_VM * vm, Chuck_VM_Shred * shred )
+{
+    Chuck_VM_Code * code = NULL;
+    Chuck_Bytecode_Op * ops = NULL;
+    Chuck_Bytecode_Op * ip = NULL;
+    t_CKBOOL * vm_running = &vm->m_running;
+    // cached stack pointers (only virtual ops move mem->sp)
+    t_CKBYTE * reg_sp = NULL;
+    t_CKBYTE * mem_sp = NULL;
+    t_CKBYTE * base = shred->base_ref->stack;
+
+#if defined(__CK_BYTECODE_GOTO__)
+    // label table, in opcode order
+    static void * labels[BC_NUM_OPS] = {
+        &&L_BC_VIRTUAL, &&L_BC_NOP, &&L_BC_GOTO,
+        &&L_BC_REG_PUSH_IMM, &&L_BC_REG_PUSH_IMM2,
+        &&L_BC_REG_POP_WORD, &&L_BC_REG_POP_WORD2, &&L_BC_REG_DUP_LAST,
+        &&L_BC_REG_PUSH_MEM, &&L_BC_REG_PUSH_MEM_BASE,
+        &&L_BC_REG_PUSH_MEM2, &&L_BC_REG_PUSH_MEM2_BASE,
+        &&L_BC_REG_PUSH_MEM_ADDR, &&L_BC_REG_PUSH_MEM_ADDR_BASE,
+        &&L_BC_REG_PUSH_NOW,
+        &&L_BC_ASSIGN_PRIMITIVE, &&L_BC_ASSIGN_PRIMITIVE2,
+        &&L_BC_ADD_INT, &&L_BC_MINUS_INT, &&L_BC_MINUS_INT_REVERSE,
+        &&L_BC_TIMES_INT, &&L_BC_DIVIDE_INT, &&L_BC_DIVIDE_INT_REVERSE,
+        &&L_BC_MOD_INT, &&L_BC_MOD_INT_REVERSE,
+        &&L_BC_ADD_DOUBLE, &&L_BC_MINUS_DOUBLE, &&L_BC_MINUS_DOUBLE_REVERSE,
+        &&L_BC_TIMES_DOUBLE, &&L_BC_DIVIDE_DOUBLE, &&L_BC_DIVIDE_DOUBLE_REVERSE,
+        &&L_BC_ADD_INT_ASSIGN, &&L_BC_MINUS_INT_ASSIGN,
+        &&L_BC_PREINC_INT, &&L_BC_POSTINC_INT, &&L_BC_PREDEC_INT, &&L_BC_POSTDEC_INT,
+        &&L_BC_NOT_INT, &&L_BC_NEGATE_INT, &&L_BC_NEGATE_DOUBLE,
+        &&L_BC_CAST_INT2DOUBLE, &&L_BC_CAST_DOUBLE2INT,
+        &&L_BC_LT_INT, &&L_BC_GT_INT, &&L_BC_LE_INT,
+        &&L_BC_GE_INT, &&L_BC_EQ_INT, &&L_BC_NEQ_INT,
+        &&L_BC_LT_DOUBLE, &&L_BC_GT_DOUBLE, &&L_BC_LE_DOUBLE,
+        &&L_BC_GE_DOUBLE, &&L_BC_EQ_DOUBLE, &&L_BC_NEQ_DOUBLE,
+        &&L_BC_BRANCH_LT_INT, &&L_BC_BRANCH_GT_INT, &&L_BC_BRANCH_LE_INT,
+        &&L_BC_BRANCH_GE_INT, &&L_BC_BRANCH_EQ_INT, &&L_BC_BRANCH_NEQ_INT,
+        &&L_BC_BRANCH_LT_DOUBLE, &&L_BC_BRANCH_GT_DOUBLE, &&L_BC_BRANCH_LE_DOUBLE,
+        &&L_BC_BRANCH_GE_DOUBLE, &&L_BC_BRANCH_EQ_DOUBLE, &&L_BC_BRANCH_NEQ_DOUBLE,
+        &&L_BC_REG_PUSH_MEM_ADD_IMM, &&L_BC_REG_PUSH_MEM_ADD_IMM_BASE,
+        &&L_BC_ASSIGN_PRIMITIVE_MEM, &&L_BC_ASSIGN_PRIMITIVE_MEM_BASE,
+        &&L_BC_ASSIGN_PRIMITIVE2_MEM, &&L_BC_ASSIGN_PRIMITIVE2_MEM_BASE,
+        &&L_BC_ADD_INT_MEM_IMM, &&L_BC_ADD_INT_MEM_IMM_BASE
+    };
+#endif
+
+    // get the code
+    BC_LOAD_CODE();
+    // get the stacks
+    reg_sp = shred->reg->sp;
+    mem_sp = shred->mem->sp;
+    // start
+    ip = ops + shred->pc;
+    shred->is_running = TRUE;
+
+    // go!
+#if defined(__CK_BYTECODE_GOTO__)
+    BC_DISPATCH();
+#else
+dispatch:
+    switch( ip->op )
+    {
+#endif
+
+    BC_CASE( BC_VIRTUAL )
+        // hand the state back to the shred
+        shred->reg->sp = reg_sp;
+        shred->pc = ip - ops;
+        shred->next_pc = shred->pc + 1;
+        // execute the instruction
+        ip->instr->execute( vm, shred );
+        CK_TRACK( shred->stat->cycles++ );
+        // function call/return may have switched code
+        if( shred->code != code ) { BC_LOAD_CODE(); }
+        // pick up the state
+        reg_sp = shred->reg->sp;
+        mem_sp = shred->mem->sp;
+        ip = ops + shred->next_pc;
+        // yield, end, abort
+        if( !shred->is_running || !*vm_running || shred->is_abort )
+            goto done;
+        BC_DISPATCH();
+
+    BC_CASE( BC_NOP )
+        BC_NEXT();
+
+    BC_CASE( BC_GOTO )
+        BC_JUMP( ip->a );
+
+    BC_CASE( BC_REG_PUSH_IMM )
+        BC_PUSH( t_CKUINT, ip->a );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_IMM2 )
+        BC_PUSH( t_CKFLOAT, ip->f );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_POP_WORD )
+        BC_POP( t_CKUINT, 1 );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_POP_WORD2 )
+        BC_POP( t_CKFLOAT, 1 );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_DUP_LAST )
+        { t_CKUINT v = *(BC_SP( t_CKUINT ) - 1); BC_PUSH( t_CKUINT, v ); }
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_MEM )
+        BC_PUSH( t_CKUINT, *(t_CKUINT *)(mem_sp + ip->a) );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_MEM_BASE )
+        BC_PUSH( t_CKUINT, *(t_CKUINT *)(base + ip->a) );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_MEM2 )
+        BC_PUSH( t_CKFLOAT, *(t_CKFLOAT *)(mem_sp + ip->a) );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_MEM2_BASE )
+        BC_PUSH( t_CKFLOAT, *(t_CKFLOAT *)(base + ip->a) );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_MEM_ADDR )
+        BC_PUSH( t_CKUINT, (t_CKUINT)(mem_sp + ip->a) );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_MEM_ADDR_BASE )
+        BC_PUSH( t_CKUINT, (t_CKUINT)(base + ip->a) );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_NOW )
+        BC_PUSH( t_CKTIME, shred->now );
+        BC_NEXT();
+
+    BC_CASE( BC_ASSIGN_PRIMITIVE )
+        {
+            // value, then address
+            BC_POP( t_CKUINT, 2 );
+            t_CKUINT * sp = BC_SP( t_CKUINT );
+            *((t_CKUINT *)(*(sp+1))) = *sp;
+            BC_PUSH( t_CKUINT, *sp );
+        }
+        BC_NEXT();
+
+    BC_CASE( BC_ASSIGN_PRIMITIVE2 )
+        {
+            // same word layout as Chuck_Instr_Assign_Primitive2
+            BC_POP( t_CKUINT, 3 );
+            t_CKUINT * sp = BC_SP( t_CKUINT );
+            *((t_CKFLOAT *)(*(sp+2))) = *(t_CKFLOAT *)sp;
+            BC_PUSH( t_CKFLOAT, *(t_CKFLOAT *)sp );
+        }
+        BC_NEXT();
+
+    BC_CASE( BC_ADD_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] + sp[1] ); BC_NEXT();
+    BC_CASE( BC_MINUS_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] - sp[1] ); BC_NEXT();
+    BC_CASE( BC_MINUS_INT_REVERSE ) BC_BINARY( t_CKINT, t_CKINT, sp[1] - sp[0] ); BC_NEXT();
+    BC_CASE( BC_TIMES_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] * sp[1] ); BC_NEXT();
+    BC_CASE( BC_DIVIDE_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] / sp[1] ); BC_NEXT();
+    BC_CASE( BC_DIVIDE_INT_REVERSE ) BC_BINARY( t_CKINT, t_CKINT, sp[1] / sp[0] ); BC_NEXT();
+    BC_CASE( BC_MOD_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] % sp[1] ); BC_NEXT();
+    BC_CASE( BC_MOD_INT_REVERSE ) BC_BINARY( t_CKINT, t_CKINT, sp[1] % sp[0] ); BC_NEXT();
+
+    BC_CASE( BC_ADD_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKFLOAT, sp[0] + sp[1] ); BC_NEXT();
+    BC_CASE( BC_MINUS_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKFLOAT, sp[0] - sp[1] ); BC_NEXT();
+    BC_CASE( BC_MINUS_DOUBLE_REVERSE ) BC_BINARY( t_CKFLOAT, t_CKFLOAT, sp[1] - sp[0] ); BC_NEXT();
+    BC_CASE( BC_TIMES_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKFLOAT, sp[0] * sp[1] ); BC_NEXT();
+    BC_CASE( BC_DIVIDE_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKFLOAT, sp[0] / sp[1] ); BC_NEXT();
+    BC_CASE( BC_DIVIDE_DOUBLE_REVERSE ) BC_BINARY( t_CKFLOAT, t_CKFLOAT, sp[1] / sp[0] ); BC_NEXT();
+
+    BC_CASE( BC_ADD_INT_ASSIGN )
+        {
+            // value, then address
+            BC_POP( t_CKINT, 2 );
+            t_CKINT * sp = BC_SP( t_CKINT );
+            t_CKINT r = **(t_CKINT **)(sp+1) += sp[0];
+            BC_PUSH( t_CKINT, r );
+        }
+        BC_NEXT();
+
+    BC_CASE( BC_MINUS_INT_ASSIGN )
+        {
+            BC_POP( t_CKINT, 2 );
+            t_CKINT * sp = BC_SP( t_CKINT );
+            t_CKINT r = **(t_CKINT **)(sp+1) -= sp[0];
+            BC_PUSH( t_CKINT, r );
+        }
+        BC_NEXT();
+
+    BC_CASE( BC_PREINC_INT )
+        { BC_POP( t_CKINT *, 1 ); t_CKINT * p = *BC_SP( t_CKINT * ); BC_PUSH( t_CKINT, ++(*p) ); }
+        BC_NEXT();
+
+    BC_CASE( BC_POSTINC_INT )
+        { BC_POP( t_CKINT *, 1 ); t_CKINT * p = *BC_SP( t_CKINT * ); BC_PUSH( t_CKINT, (*p)++ ); }
+        BC_NEXT();
+
+    BC_CASE( BC_PREDEC_INT )
+        { BC_POP( t_CKINT *, 1 ); t_CKINT * p = *BC_SP( t_CKINT * ); BC_PUSH( t_CKINT, --(*p) ); }
+        BC_NEXT();
+
+    BC_CASE( BC_POSTDEC_INT )
+        { BC_POP( t_CKINT *, 1 ); t_CKINT * p = *BC_SP( t_CKINT * ); BC_PUSH( t_CKINT, (*p)-- ); }
+        BC_NEXT();
+
+    BC_CASE( BC_NOT_INT )
+        { t_CKINT * sp = BC_SP( t_CKINT ) - 1; *sp = !(*sp); }
+        BC_NEXT();
+
+    BC_CASE( BC_NEGATE_INT )
+        { t_CKINT * sp = BC_SP( t_CKINT ) - 1; *sp = -(*sp); }
+        BC_NEXT();
+
+    BC_CASE( BC_NEGATE_DOUBLE )
+        { t_CKFLOAT * sp = BC_SP( t_CKFLOAT ) - 1; *sp = -(*sp); }
+        BC_NEXT();
+
+    BC_CASE( BC_CAST_INT2DOUBLE )
+        { BC_POP( t_CKINT, 1 ); t_CKINT v = *BC_SP( t_CKINT ); BC_PUSH( t_CKFLOAT, (t_CKFLOAT)v ); }
+        BC_NEXT();
+
+    BC_CASE( BC_CAST_DOUBLE2INT )
+        { BC_POP( t_CKFLOAT, 1 ); t_CKFLOAT v = *BC_SP( t_CKFLOAT ); BC_PUSH( t_CKINT, (t_CKINT)v ); }
+        BC_NEXT();
+
+    BC_CASE( BC_LT_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] < sp[1] ); BC_NEXT();
+    BC_CASE( BC_GT_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] > sp[1] ); BC_NEXT();
+    BC_CASE( BC_LE_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] <= sp[1] ); BC_NEXT();
+    BC_CASE( BC_GE_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] >= sp[1] ); BC_NEXT();
+    BC_CASE( BC_EQ_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] == sp[1] ); BC_NEXT();
+    BC_CASE( BC_NEQ_INT ) BC_BINARY( t_CKINT, t_CKINT, sp[0] != sp[1] ); BC_NEXT();
+
+    BC_CASE( BC_LT_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKUINT, sp[0] < sp[1] ); BC_NEXT();
+    BC_CASE( BC_GT_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKUINT, sp[0] > sp[1] ); BC_NEXT();
+    BC_CASE( BC_LE_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKUINT, sp[0] <= sp[1] ); BC_NEXT();
+    BC_CASE( BC_GE_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKUINT, sp[0] >= sp[1] ); BC_NEXT();
+    BC_CASE( BC_EQ_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKUINT, sp[0] == sp[1] ); BC_NEXT();
+    BC_CASE( BC_NEQ_DOUBLE ) BC_BINARY( t_CKFLOAT, t_CKUINT, sp[0] != sp[1] ); BC_NEXT();
+
+    BC_CASE( BC_BRANCH_LT_INT ) BC_BRANCH( t_CKINT, < );
+    BC_CASE( BC_BRANCH_GT_INT ) BC_BRANCH( t_CKINT, > );
+    BC_CASE( BC_BRANCH_LE_INT ) BC_BRANCH( t_CKINT, <= );
+    BC_CASE( BC_BRANCH_GE_INT ) BC_BRANCH( t_CKINT, >= );
+    BC_CASE( BC_BRANCH_EQ_INT ) BC_BRANCH( t_CKINT, == );
+    BC_CASE( BC_BRANCH_NEQ_INT ) BC_BRANCH( t_CKINT, != );
+    BC_CASE( BC_BRANCH_LT_DOUBLE ) BC_BRANCH( t_CKFLOAT, < );
+    BC_CASE( BC_BRANCH_GT_DOUBLE ) BC_BRANCH( t_CKFLOAT, > );
+    BC_CASE( BC_BRANCH_LE_DOUBLE ) BC_BRANCH( t_CKFLOAT, <= );
+    BC_CASE( BC_BRANCH_GE_DOUBLE ) BC_BRANCH( t_CKFLOAT, >= );
+    BC_CASE( BC_BRANCH_EQ_DOUBLE ) BC_BRANCH( t_CKFLOAT, == );
+    BC_CASE( BC_BRANCH_NEQ_DOUBLE ) BC_BRANCH( t_CKFLOAT, != );
+
+    // superinstructions
+    BC_CASE( BC_REG_PUSH_MEM_ADD_IMM )
+        BC_PUSH( t_CKINT, *(t_CKINT *)(mem_sp + ip->a) + (t_CKINT)ip->b );
+        BC_NEXT();
+
+    BC_CASE( BC_REG_PUSH_MEM_ADD_IMM_BASE )
+        BC_PUSH( t_CKINT, *(t_CKINT *)(base + ip->a) + (t_CKINT)ip->b );
+        BC_NEXT();
+
+    BC_CASE( BC_ASSIGN_PRIMITIVE_MEM )
+        BC_POP( t_CKUINT, 1 );
+        *(t_CKUINT *)(mem_sp + ip->a) = *BC_SP( t_CKUINT );
+        BC_NEXT();
+
+    BC_CASE( BC_ASSIGN_PRIMITIVE_MEM_BASE )
+        BC_POP( t_CKUINT, 1 );
+        *(t_CKUINT *)(base + ip->a) = *BC_SP( t_CKUINT );
+        BC_NEXT();
+
+    BC_CASE( BC_ASSIGN_PRIMITIVE2_MEM )
+        BC_POP( t_CKFLOAT, 1 );
+        *(t_CKFLOAT *)(mem_sp + ip->a) = *BC_SP( t_CKFLOAT );
+        BC_NEXT();
+
+    BC_CASE( BC_ASSIGN_PRIMITIVE2_MEM_BASE )
+        BC_POP( t_CKFLOAT, 1 );
+        *(t_CKFLOAT *)(base + ip->a) = *BC_SP( t_CKFLOAT );
+        BC_NEXT();
+
+    BC_CASE( BC_ADD_INT_MEM_IMM )
+        *(t_CKINT *)(mem_sp + ip->a) += (t_CKINT)ip->b;
+        BC_NEXT();
+
+    BC_CASE( BC_ADD_INT_MEM_IMM_BASE )
+        *(t_CKINT *)(base + ip->a) += (t_CKINT)ip->b;
+        BC_NEXT();
+
+#if !defined(__CK_BYTECODE_GOTO__)
+    default:
+        EM_error3( "[chuck](VM): internal error: bad bytecode op '%d'", ip->op );
+        shred->is_done = TRUE;
+        goto done;
+    }
+#endif
+
+done:
+    // hand the state back to the shred
+    shred->reg->sp = reg_sp;
+    shred->pc = ip - ops;
+    shred->next_pc = shred->pc + 1;
+}
@@ -0,0 +1,106 @@
+/*----------------------------------------------------------------------------
+    ChucK Concurrent, On-the-fly Audio Programming Language
+      Compiler and Virtual Machine
+
+    Copyright (c) 2004 Ge Wang and Perry R. Cook.  All rights reserved.
+      http://chuck.cs.princeton.edu/
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// file: chuck_bytecode.h
+// desc: threaded-code execution engine - Chuck_VM_Code is lowered into a
+//       contiguous array of (opcode, operands), executed by a computed-goto
+//       (or switch) loop; instructions not yet ported fall back to
+//       Chuck_Instr::execute()
+//-----------------------------------------------------------------------------
+#ifndef __CHUCK_BYTECODE_H__
+#define __CHUCK_BYTECODE_H__
+
+#include "chuck_def.h"
+
+
+// forward references
+struct Chuck_Instr;
+struct Chuck_VM;
+struct Chuck_VM_Code;
+struct Chuck_VM_Shred;
+
+
+// vm execution engines
+#define CK_VM_ENGINE_VIRTUAL        0
+#define CK_VM_ENGINE_THREADED       1
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Bytecode_Op
+// desc: one lowered instruction; op i corresponds to Chuck_VM_Code::instr[i],
+//       so jump targets and return addresses carry over unchanged
+//-----------------------------------------------------------------------------
+struct Chuck_Bytecode_Op
+{
+    // opcode
+    t_CKUINT op;
+    // operand (immediate, offset, or jump target)
+    t_CKUINT a;
+    // second operand
+    union
+    {
+        t_CKUINT b;
+        t_CKFLOAT f;
+        Chuck_Instr * instr;
+    };
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Bytecode
+// desc: lowered form of a Chuck_VM_Code
+//-----------------------------------------------------------------------------
+struct Chuck_Bytecode
+{
+public:
+    Chuck_Bytecode();
+    ~Chuck_Bytecode();
+
+public:
+    t_CKBOOL lower( Chuck_VM_Code * code );
+
+public:
+    // array of ops, parallel to code->instr
+    Chuck_Bytecode_Op * ops;
+    // size of the array
+    t_CKUINT num_ops;
+    // how many were ported (the rest use the virtual fallback)
+    t_CKUINT num_native;
+};
+
+
+
+
+// run shred on the threaded engine, until it yields, ends, or is aborted
+void bytecode_exec( Chuck_VM * vm, Chuck_VM_Shred * shred );
+
+
+
+
+#endif
@@ -46,6 +46,8 @@
 #include "ulib_std.h"
 #include "ulib_opsc.h"
 
+#include <string.h>
+
 using namespace std;
 
 
@@ -67,6 +69,9 @@ Chuck_Compiler::Chuck_Compiler()
     env = NULL;
     emitter = NULL;
     code = NULL;
+    m_env_version = 0;
+    m_cache_hits = m_cache_misses = m_cache_skips = 0;
+    memset( m_cache_stats, 0, sizeof(m_cache_stats) );
 }
 
 
@@ -150,6 +155,13 @@ void Chuck_Compiler::shutdown()
     m_auto_depend = FALSE;
     m_recent.clear();
 
+    // release cached code
+    std::map<string, Chuck_Code_Cache_Entry>::iterator iter;
+    for( iter = m_cache.begin(); iter != m_cache.end(); iter++ )
+        SAFE_RELEASE( (*iter).second.code );
+    m_cache.clear();
+    cache_publish();
+
     // pop indent
     EM_poplog();
 }
@@ -184,8 +196,14 @@ t_CKBOOL Chuck_Compiler::go( const string & filename, FILE * fd, const char * st
     // check to see if resolve dependencies automatically
     if( !m_auto_depend )
     {
+        Chuck_Code_Cache_Entry key;
+        // unchanged since last time?
+        if( cache_find( filename, fd, str_src, key ) )
+            return TRUE;
+
         // normal
         ret = this->do_normal( filename, fd, str_src );
+        if( ret ) cache_store( filename, key );
         return ret;
     }
     else // auto
@@ -216,6 +234,8 @@ t_CKBOOL Chuck_Compiler::go( const string & filename, FILE * fd, const char * st
             EM_error2( 0, "internal error: context->code() NULL!" );
             goto cleanup;
         }
+        // name it after its source
+        code->name = filename;
 
 cleanup:
 
@@ -407,6 +427,9 @@ t_CKBOOL Chuck_Compiler::do_normal( const string & filename, FILE * fd, const ch
     if( !(code = emit_engine_emit_prog( emitter, g_program, te_do_all )) )
     { ret = FALSE; goto cleanup; }
 
+    // name it after its source (it may be cached, so no one renames it)
+    code->name = filename;
+
 cleanup:
 
     // commit
@@ -464,6 +487,169 @@ t_CKBOOL Chuck_Compiler::add_recent_path( const string & path,
 
 
 
+//-----------------------------------------------------------------------------
+// name: source_hash()
+// desc: FNV-1a hash of a source (file by name, open fd, or string); fd is
+//       left where it was
+//-----------------------------------------------------------------------------
+static t_CKBOOL source_hash( const string & filename, FILE * fd, const char * str_src,
+                             t_CKUINT & hash, t_CKUINT & length )
+{
+    t_CKUINT h = (t_CKUINT)2166136261UL;
+    t_CKUINT prime = sizeof(t_CKUINT) > 4 ? (t_CKUINT)1099511628211ULL : 16777619UL;
+    unsigned char buf[4096];
+    t_CKUINT n;
+
+    length = 0;
+    if( str_src )
+    {
+        for( const unsigned char * p = (const unsigned char *)str_src; *p; p++ )
+        { h = ( h ^ *p ) * prime; length++; }
+        hash = h;
+        return TRUE;
+    }
+
+    // open as the parser does
+    t_CKBOOL own = FALSE;
+    long pos = 0;
+    if( fd ) pos = ftell( fd );
+    else
+    {
+        char fname[1024];
+        if( filename.length() + 4 >= sizeof(fname) ) return FALSE;
+        strcpy( fname, filename.c_str() );
+        if( !(fd = open_cat_ck( fname )) ) return FALSE;
+        own = TRUE;
+    }
+
+    while( (n = fread( buf, 1, sizeof(buf), fd )) > 0 )
+    {
+        for( t_CKUINT i = 0; i < n; i++ ) h = ( h ^ buf[i] ) * prime;
+        length += n;
+    }
+
+    if( own ) fclose( fd );
+    else fseek( fd, pos, SEEK_SET );
+
+    hash = h;
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cache_find()
+// desc: if path was compiled from the same source against the same public
+//       classes, make its code the output; key is filled in either way
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_Compiler::cache_find( const string & path, FILE * fd,
+                                     const char * str_src,
+                                     Chuck_Code_Cache_Entry & key )
+{
+    key.code = NULL;
+    key.version = m_env_version;
+    if( !source_hash( path, fd, str_src, key.hash, key.length ) )
+    {
+        // can't read it; the parser will say why
+        key.length = (t_CKUINT)-1;
+        return FALSE;
+    }
+
+    std::map<string, Chuck_Code_Cache_Entry>::iterator iter = m_cache.find( path );
+    if( iter == m_cache.end() ) return FALSE;
+    Chuck_Code_Cache_Entry & entry = (*iter).second;
+    if( entry.hash != key.hash || entry.length != key.length ||
+        entry.version != key.version )
+        return FALSE;
+
+    // hit
+    code = entry.code;
+    m_cache_hits++;
+    cache_publish();
+    EM_log( CK_LOG_FINE, "code cache: reusing '%s'", mini(path.c_str()) );
+
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cache_store()
+// desc: remember the code just emitted for path; files that define classes
+//       are compiled every time, since each compile makes new types (and
+//       public classes change what other files check against)
+//-----------------------------------------------------------------------------
+void Chuck_Compiler::cache_store( const string & path,
+                                  const Chuck_Code_Cache_Entry & key )
+{
+    t_CKBOOL has_class = FALSE;
+    for( a_Program prog = g_program; prog; prog = prog->next )
+    {
+        if( prog->section->s_type != ae_section_class ) continue;
+        has_class = TRUE;
+        // a new public class: everything cached was checked without it
+        if( prog->section->class_def->decl == ae_key_public )
+            m_env_version++;
+    }
+
+    if( has_class || key.length == (t_CKUINT)-1 || !code )
+    {
+        m_cache_skips++;
+        cache_publish();
+        return;
+    }
+
+    Chuck_Code_Cache_Entry & entry = m_cache[path];
+    SAFE_RELEASE( entry.code );
+    entry = key;
+    entry.code = code;
+    entry.code->add_ref();
+    m_cache_misses++;
+    cache_publish();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cache_publish()
+// desc: copy the statistics (holding the compile lock) for cache_status()
+//-----------------------------------------------------------------------------
+void Chuck_Compiler::cache_publish( )
+{
+    m_cache_stats_lock.acquire();
+    m_cache_stats[0] = m_cache.size();
+    m_cache_stats[1] = m_cache_hits;
+    m_cache_stats[2] = m_cache_misses;
+    m_cache_stats[3] = m_cache_skips;
+    m_cache_stats_lock.release();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cache_status()
+// desc: print code cache statistics
+//-----------------------------------------------------------------------------
+void Chuck_Compiler::cache_status( )
+{
+    t_CKUINT stats[4];
+
+    // the copy, not the cache: a compile may be running
+    m_cache_stats_lock.acquire();
+    memcpy( stats, m_cache_stats, sizeof(stats) );
+    m_cache_stats_lock.release();
+
+    fprintf( stdout, "[chuck](compiler): code cache: %ld files, %ld hits, %ld misses, %ld not cacheable\n",
+             (long)stats[0], (long)stats[1], (long)stats[2], (long)stats[3] );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: output()
 // desc: get the code generated by the last do()
@@ -39,6 +39,26 @@
 #include "chuck_type.h"
 #include "chuck_emit.h"
 #include "chuck_vm.h"
+#include "util_thread.h"
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Code_Cache_Entry
+// desc: compiled code for a file, valid while the source and the public
+//       classes it was checked against are unchanged
+//-----------------------------------------------------------------------------
+struct Chuck_Code_Cache_Entry
+{
+    // source hash and length
+    t_CKUINT hash;
+    t_CKUINT length;
+    // public class version at compile time
+    t_CKUINT version;
+    // the code (named after the path, and never changed once cached)
+    Chuck_VM_Code * code;
+};
 
 
 
@@ -62,6 +82,18 @@ public: // data
     // recent map
     std::map<std::string, Chuck_Context *> m_recent;
 
+    // compiled code, by path
+    std::map<std::string, Chuck_Code_Cache_Entry> m_cache;
+    // bumped whenever a public class is added
+    t_CKUINT m_env_version;
+    // cache statistics
+    t_CKUINT m_cache_hits;
+    t_CKUINT m_cache_misses;
+    t_CKUINT m_cache_skips;
+    // copy of the statistics, for printing while a compile runs
+    t_CKUINT m_cache_stats[4];
+    XMutex m_cache_stats_lock;
+
 public: // to all
     // contructor
     Chuck_Compiler();
@@ -81,6 +113,8 @@ public: // to all
     t_CKBOOL resolve( const std::string & type );
     // get the code generated from the last go()
     Chuck_VM_Code * output( );
+    // print code cache statistics (any thread, without the compile lock)
+    void cache_status( );
 
 protected: // internal
     // do entire file
@@ -97,6 +131,12 @@ protected: // internal
     Chuck_Context * find_recent_type( const std::string & type );
     // add to recent
     t_CKBOOL add_recent_path( const std::string & path, Chuck_Context * context );
+    // look up / store in the code cache
+    t_CKBOOL cache_find( const std::string & path, FILE * fd, const char * str_src,
+                         Chuck_Code_Cache_Entry & key );
+    void cache_store( const std::string & path, const Chuck_Code_Cache_Entry & key );
+    // copy the statistics for cache_status()
+    void cache_publish( );
 };
 
 
@@ -348,6 +348,36 @@ void CK_DLL_CALL ck_add_ugen_func( Chuck_DL_Query * query, f_tick ugen_tick, f_p
 
 
 
+//-----------------------------------------------------------------------------
+// name: ck_add_ugen_funcf()
+// desc: (ugen only) add block tick function
+//-----------------------------------------------------------------------------
+void CK_DLL_CALL ck_add_ugen_funcf( Chuck_DL_Query * query, f_tickf ugen_tickf )
+{
+    // make sure there is class
+    if( !query->curr_class )
+    {
+        // error
+        EM_error2( 0, "class import: add_ugen_funcf invoked without begin_class..." );
+        return;
+    }
+    
+    // make sure tickf not defined already
+    if( query->curr_class->ugen_tickf && ugen_tickf )
+    {
+        // error
+        EM_error2( 0, "class import: ugen_tickf already defined..." );
+        return;
+    }
+    
+    // set
+    if( ugen_tickf ) query->curr_class->ugen_tickf = ugen_tickf;
+    query->curr_func = NULL;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: ck_add_ugen_ctrl()
 // desc: (ugen only) add ctrl parameters
@@ -675,6 +705,7 @@ Chuck_DL_Query::Chuck_DL_Query( )
     add_svar = ck_add_svar;
     add_arg = ck_add_arg;
     add_ugen_func = ck_add_ugen_func;
+    add_ugen_funcf = ck_add_ugen_funcf;
     add_ugen_ctrl = ck_add_ugen_ctrl;
     end_class = ck_end_class;
     dll_name = "[noname]";
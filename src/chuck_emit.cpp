@@ -37,6 +37,8 @@
 #include "chuck_errmsg.h"
 #include "chuck_instr.h"
 
+#include <typeinfo>
+
 using namespace std;
 
 
@@ -226,7 +228,7 @@ Chuck_VM_Code * emit_engine_emit_prog( Chuck_Emitter * emit, a_Program prog,
         // make sure
         assert( emit->context->nspc->pre_ctor == NULL );
         // converted to virtual machine code
-        emit->context->nspc->pre_ctor = emit_to_code( emit->code, NULL, emit->dump );
+        emit->context->nspc->pre_ctor = emit_to_code( emit->code, NULL, emit->dump, emit->optimize );
         // add reference
         emit->context->nspc->pre_ctor->add_ref();
     }
@@ -251,8 +253,14 @@ Chuck_VM_Code * emit_engine_emit_prog( Chuck_Emitter * emit, a_Program prog,
 //-----------------------------------------------------------------------------
 Chuck_VM_Code * emit_to_code( Chuck_Code * in,
                               Chuck_VM_Code * out,
-                              t_CKBOOL dump )
+                              t_CKBOOL dump,
+                              t_CKUINT optimize )
 {
+    // instructions before optimization
+    t_CKUINT before = in->code.size();
+    // peephole
+    if( optimize ) emit_engine_optimize( in, optimize );
+
     // log
     EM_log( CK_LOG_FINER, "emitting code: %d VM instructions...",
             in->code.size() );
@@ -270,6 +278,13 @@ Chuck_VM_Code * emit_to_code( Chuck_Code * in,
     code->need_this = in->need_this;
     // set name
     code->name = in->name;
+    // stack bounds: no instruction pushes more than 16 bytes of operands
+    code->frame_depth = in->frame->max_offset;
+    code->reg_depth = before * 16;
+    code->native_depth = in->native_depth;
+    code->callees = in->callees;
+    code->callee_codes = in->callee_codes;
+    code->unbounded = in->unbounded;
 
     // copy
     for( t_CKUINT i = 0; i < code->num_instr; i++ )
@@ -280,6 +295,10 @@ Chuck_VM_Code * emit_to_code( Chuck_Code * in,
     {
         // name of what we are dumping
         EM_error2( 0, "dumping %s:", in->name.c_str() );
+        // what the optimizer did
+        if( optimize )
+            EM_error2( 0, "(optimize level %d: %d -> %d instructions)",
+                       optimize, before, code->num_instr );
 
         // uh
         EM_error2( 0, "-------" );
@@ -295,6 +314,229 @@ Chuck_VM_Code * emit_to_code( Chuck_Code * in,
 
 
 
+// instruction type test
+#define is_( k, type ) ( (k) < n && typeid(*code[k]) == typeid(Chuck_Instr_##type) )
+// nothing jumps into the middle of a sequence
+#define free_( k ) ( (k) < n && !target[k] )
+// pops exactly one word
+#define pop1_( k ) ( is_( k, Reg_Pop_Word ) || ( is_( k, Reg_Pop_Word3 ) && \
+    ((Chuck_Instr_Reg_Pop_Word3 *)code[k])->get() == 1 ) )
+//-----------------------------------------------------------------------------
+// name: emit_engine_fuse()
+// desc: match one superinstruction at code[i]; returns it and sets len,
+//       or NULL; branches carry their unmapped targets
+//-----------------------------------------------------------------------------
+static Chuck_Instr * emit_engine_fuse( std::vector<Chuck_Instr *> & code,
+                                       std::vector<t_CKBOOL> & target,
+                                       t_CKUINT i, t_CKUINT level,
+                                       t_CKUINT & len )
+{
+    t_CKUINT n = code.size();
+    Chuck_Instr_Reg_Push_Mem_Addr * addr = NULL;
+
+    // now + dur => now (Reg_Push_Now, Add_double, Time_Advance [, Reg_Pop_Word2])
+    if( is_( i, Reg_Push_Now ) && is_( i+1, Add_double ) && free_( i+1 ) &&
+        is_( i+2, Time_Advance ) && free_( i+2 ) )
+    {
+        // result discarded?
+        t_CKBOOL pop = is_( i+3, Reg_Pop_Word2 ) && free_( i+3 );
+        len = pop ? 4 : 3;
+        return new Chuck_Instr_Time_Advance_Dur( !pop );
+    }
+
+    // store (Reg_Push_Mem_Addr, Assign_Primitive[2], Reg_Pop_Word[2])
+    if( is_( i, Reg_Push_Mem_Addr ) && free_( i+1 ) && free_( i+2 ) )
+    {
+        addr = (Chuck_Instr_Reg_Push_Mem_Addr *)code[i];
+        len = 3;
+        if( is_( i+1, Assign_Primitive ) && pop1_( i+2 ) )
+            return new Chuck_Instr_Assign_Primitive_Mem( addr->get(), addr->use_base() );
+        if( is_( i+1, Assign_Primitive2 ) && is_( i+2, Reg_Pop_Word2 ) )
+            return new Chuck_Instr_Assign_Primitive2_Mem( addr->get(), addr->use_base() );
+        // increment (Reg_Push_Mem_Addr, ++/--, Reg_Pop_Word)
+        if( pop1_( i+2 ) && ( is_( i+1, PreInc_int ) || is_( i+1, PostInc_int ) ) )
+            return new Chuck_Instr_Add_int_Mem_Imm( addr->get(), addr->use_base(), 1 );
+        if( pop1_( i+2 ) && ( is_( i+1, PreDec_int ) || is_( i+1, PostDec_int ) ) )
+            return new Chuck_Instr_Add_int_Mem_Imm( addr->get(), addr->use_base(), -1 );
+    }
+
+    // k +=> x (Reg_Push_Imm, Reg_Push_Mem_Addr, +=>/-=>, Reg_Pop_Word)
+    if( is_( i, Reg_Push_Imm ) && is_( i+1, Reg_Push_Mem_Addr ) && free_( i+1 ) &&
+        free_( i+2 ) && pop1_( i+3 ) && free_( i+3 ) )
+    {
+        t_CKINT k = (t_CKINT)((Chuck_Instr_Reg_Push_Imm *)code[i])->get();
+        addr = (Chuck_Instr_Reg_Push_Mem_Addr *)code[i+1];
+        len = 4;
+        if( is_( i+2, Add_int_Assign ) )
+            return new Chuck_Instr_Add_int_Mem_Imm( addr->get(), addr->use_base(), k );
+        if( is_( i+2, Minus_int_Assign ) )
+            return new Chuck_Instr_Add_int_Mem_Imm( addr->get(), addr->use_base(), -k );
+    }
+
+    // compare and branch (compare, Reg_Push_Imm 0, Branch_Eq/Neq_int)
+    if( is_( i+1, Reg_Push_Imm ) && free_( i+1 ) && free_( i+2 ) &&
+        ((Chuck_Instr_Reg_Push_Imm *)code[i+1])->get() == 0 &&
+        ( is_( i+2, Branch_Eq_int ) || is_( i+2, Branch_Neq_int ) ) )
+    {
+        t_CKUINT jmp = ((Chuck_Instr_Branch_Op *)code[i+2])->get();
+        // branch when the comparison is false
+        t_CKBOOL inv = is_( i+2, Branch_Eq_int );
+        len = 3;
+        if( is_( i, Lt_int ) ) return inv ? (Chuck_Instr *)new Chuck_Instr_Branch_Ge_int( jmp )
+                                          : (Chuck_Instr *)new Chuck_Instr_Branch_Lt_int( jmp );
+        if( is_( i, Gt_int ) ) return inv ? (Chuck_Instr *)new Chuck_Instr_Branch_Le_int( jmp )
+                                          : (Chuck_Instr *)new Chuck_Instr_Branch_Gt_int( jmp );
+        if( is_( i, Le_int ) ) return inv ? (Chuck_Instr *)new Chuck_Instr_Branch_Gt_int( jmp )
+                                          : (Chuck_Instr *)new Chuck_Instr_Branch_Le_int( jmp );
+        if( is_( i, Ge_int ) ) return inv ? (Chuck_Instr *)new Chuck_Instr_Branch_Lt_int( jmp )
+                                          : (Chuck_Instr *)new Chuck_Instr_Branch_Ge_int( jmp );
+        if( is_( i, Eq_int ) ) return inv ? (Chuck_Instr *)new Chuck_Instr_Branch_Neq_int( jmp )
+                                          : (Chuck_Instr *)new Chuck_Instr_Branch_Eq_int( jmp );
+        if( is_( i, Neq_int ) ) return inv ? (Chuck_Instr *)new Chuck_Instr_Branch_Eq_int( jmp )
+                                           : (Chuck_Instr *)new Chuck_Instr_Branch_Neq_int( jmp );
+        // float compares only fuse without inverting (NaN)
+        if( !inv )
+        {
+            if( is_( i, Lt_double ) ) return new Chuck_Instr_Branch_Lt_double( jmp );
+            if( is_( i, Gt_double ) ) return new Chuck_Instr_Branch_Gt_double( jmp );
+            if( is_( i, Le_double ) ) return new Chuck_Instr_Branch_Le_double( jmp );
+            if( is_( i, Ge_double ) ) return new Chuck_Instr_Branch_Ge_double( jmp );
+            if( is_( i, Eq_double ) ) return new Chuck_Instr_Branch_Eq_double( jmp );
+            if( is_( i, Neq_double ) ) return new Chuck_Instr_Branch_Neq_double( jmp );
+        }
+    }
+
+    // constant cast (Reg_Push_Imm, Cast_int2double)
+    if( is_( i, Reg_Push_Imm ) && is_( i+1, Cast_int2double ) && free_( i+1 ) )
+    {
+        t_CKINT k = (t_CKINT)((Chuck_Instr_Reg_Push_Imm *)code[i])->get();
+        len = 2;
+        return new Chuck_Instr_Reg_Push_Imm2( (t_CKFLOAT)k );
+    }
+
+    // level 2: load-op (Reg_Push_Mem, Reg_Push_Imm, Add_int/Minus_int)
+    if( level >= 2 && is_( i, Reg_Push_Mem ) && is_( i+1, Reg_Push_Imm ) &&
+        free_( i+1 ) && free_( i+2 ) )
+    {
+        Chuck_Instr_Reg_Push_Mem * mem = (Chuck_Instr_Reg_Push_Mem *)code[i];
+        t_CKINT k = (t_CKINT)((Chuck_Instr_Reg_Push_Imm *)code[i+1])->get();
+        len = 3;
+        if( is_( i+2, Add_int ) )
+            return new Chuck_Instr_Reg_Push_Mem_Add_Imm( mem->get(), mem->use_base(), k );
+        if( is_( i+2, Minus_int ) )
+            return new Chuck_Instr_Reg_Push_Mem_Add_Imm( mem->get(), mem->use_base(), -k );
+    }
+
+    len = 0;
+    return NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: emit_engine_jump()
+// desc: get jump target of instruction, if it has one
+//-----------------------------------------------------------------------------
+static t_CKBOOL emit_engine_jump( Chuck_Instr * instr, t_CKUINT & jmp )
+{
+    // branches and goto
+    Chuck_Instr_Branch_Op * branch = dynamic_cast<Chuck_Instr_Branch_Op *>( instr );
+    if( branch ) { jmp = branch->get(); return TRUE; }
+
+    // array pre-constructor loop
+    if( typeid(*instr) == typeid(Chuck_Instr_Pre_Ctor_Array_Top) ||
+        typeid(*instr) == typeid(Chuck_Instr_Pre_Ctor_Array_Bottom) )
+    { jmp = ((Chuck_Instr_Unary_Op *)instr)->get(); return TRUE; }
+
+    return FALSE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: emit_engine_set_jump()
+// desc: set jump target of instruction found by emit_engine_jump()
+//-----------------------------------------------------------------------------
+static void emit_engine_set_jump( Chuck_Instr * instr, t_CKUINT jmp )
+{
+    Chuck_Instr_Branch_Op * branch = dynamic_cast<Chuck_Instr_Branch_Op *>( instr );
+    if( branch ) branch->set( jmp );
+    else ((Chuck_Instr_Unary_Op *)instr)->set( jmp );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: emit_engine_optimize()
+// desc: peephole pass over emitted code - replaces common sequences with
+//       superinstructions and remaps jump targets
+//-----------------------------------------------------------------------------
+t_CKUINT emit_engine_optimize( Chuck_Code * in, t_CKUINT level )
+{
+    std::vector<Chuck_Instr *> & code = in->code;
+    t_CKUINT n = code.size();
+    t_CKUINT i, k, len, jmp;
+
+    // nothing to do
+    if( !level || !n ) return 0;
+
+    // mark jump targets
+    std::vector<t_CKBOOL> target( n + 1, FALSE );
+    for( i = 0; i < n; i++ )
+    {
+        if( emit_engine_jump( code[i], jmp ) && jmp <= n )
+            target[jmp] = TRUE;
+    }
+
+    // fuse
+    std::vector<Chuck_Instr *> out;
+    std::vector<t_CKUINT> remap( n + 1, 0 );
+    out.reserve( n );
+    for( i = 0; i < n; )
+    {
+        remap[i] = out.size();
+        Chuck_Instr * fused = emit_engine_fuse( code, target, i, level, len );
+        if( fused )
+        {
+            // replace the sequence
+            for( k = i; k < i + len; k++ )
+            {
+                remap[k] = out.size();
+                delete code[k];
+            }
+            out.push_back( fused );
+            i += len;
+        }
+        else
+            out.push_back( code[i++] );
+    }
+    remap[n] = out.size();
+
+    // remap jump targets
+    for( i = 0; i < out.size(); i++ )
+    {
+        if( emit_engine_jump( out[i], jmp ) && jmp <= n )
+            emit_engine_set_jump( out[i], remap[jmp] );
+    }
+
+    // log
+    EM_log( CK_LOG_FINE, "optimized '%s': %d -> %d instructions",
+            in->name.c_str(), n, out.size() );
+
+    // done
+    code.swap( out );
+    return n - code.size();
+}
+#undef is_
+#undef free_
+#undef pop1_
+
+
+
+
 //-----------------------------------------------------------------------------
 // name:
 // desc: ...
@@ -1429,6 +1671,9 @@ t_CKBOOL emit_engine_emit_op( Chuck_Emitter * emit, ae_Operator op, a_Exp lhs, a
     te_Type right = t_right->xid;
     // op
     Chuck_Instr * instr = NULL;
+    // a string made by another + is a temporary, and can be appended to
+    t_CKBOOL in_place = lhs->s_type == ae_exp_binary &&
+        lhs->binary.op == ae_op_plus && isa( lhs->type, &t_string );
 
     // emit op
     switch( op )
@@ -1445,16 +1690,16 @@ t_CKBOOL emit_engine_emit_op( Chuck_Emitter * emit, ae_Operator op, a_Exp lhs, a
         else if( isa( t_left, &t_string ) && isa( t_right, &t_string ) )
         {
             // concatenate
-            emit->append( instr = new Chuck_Instr_Add_string );
+            emit->append( instr = new Chuck_Instr_Add_string( in_place ) );
         }
         // left: string
         else if( isa( t_left, &t_string ) )
         {
             // + int
             if( isa( t_right, &t_int ) )
-                emit->append( instr = new Chuck_Instr_Add_string_int );
+                emit->append( instr = new Chuck_Instr_Add_string_int( in_place ) );
             else if( isa( t_right, &t_float ) )
-                emit->append( instr = new Chuck_Instr_Add_string_float );
+                emit->append( instr = new Chuck_Instr_Add_string_float( in_place ) );
             else
             {
                 EM_error2( lhs->linepos,
@@ -3063,10 +3308,19 @@ t_CKBOOL emit_engine_emit_exp_func_call( Chuck_Emitter * emit,
                        size );
             return FALSE;
         }
+
+        // for stack bounds: natives only use their arguments
+        if( !func->code ) emit->code->unbounded = TRUE;
+        else if( func->code->stack_depth > emit->code->native_depth )
+            emit->code->native_depth = func->code->stack_depth;
     }
     else
     {
         emit->append( new Chuck_Instr_Func_Call );
+
+        // for stack bounds: virtual calls can't be followed
+        if( is_member ) emit->code->unbounded = TRUE;
+        else emit->code->callees.push_back( func );
     }
 
     return TRUE;
@@ -3430,6 +3684,8 @@ t_CKBOOL emit_engine_pre_constructor( Chuck_Emitter * emit, Chuck_Type * type )
         // append instruction
         emit->append( new Chuck_Instr_Pre_Constructor( type->info->pre_ctor,
             emit->code->frame->curr_offset ) );
+        // for stack bounds
+        emit->code->callee_codes.push_back( type->info->pre_ctor );
     }
 
     return TRUE;
@@ -3856,7 +4112,7 @@ t_CKBOOL emit_engine_emit_func_def( Chuck_Emitter * emit, a_Func_Def func_def )
     emit->append( new Chuck_Instr_Func_Return );
 
     // vm code
-    func->code = emit_to_code( emit->code, NULL, emit->dump );
+    func->code = emit_to_code( emit->code, NULL, emit->dump, emit->optimize );
     // add reference
     func->code->add_ref();
     
@@ -3961,7 +4217,7 @@ t_CKBOOL emit_engine_emit_class_def( Chuck_Emitter * emit, a_Class_Def class_def
         // emit return statement
         emit->append( new Chuck_Instr_Func_Return );
         // vm code
-        type->info->pre_ctor = emit_to_code( emit->code, type->info->pre_ctor, emit->dump );
+        type->info->pre_ctor = emit_to_code( emit->code, type->info->pre_ctor, emit->dump, emit->optimize );
         // add reference
         type->info->pre_ctor->add_ref();
         // allocate static
@@ -4063,7 +4319,7 @@ t_CKBOOL emit_engine_emit_spork( Chuck_Emitter * emit, a_Exp_Func_Call exp )
     op->set( emit->code->stack_depth );
 
     // emit it
-    Chuck_VM_Code * code = emit_to_code( emit->code, NULL, emit->dump );
+    Chuck_VM_Code * code = emit_to_code( emit->code, NULL, emit->dump, emit->optimize );
     // remember it
     exp->ck_vm_code = code;
     // add reference
@@ -4085,6 +4341,11 @@ t_CKBOOL emit_engine_emit_spork( Chuck_Emitter * emit, a_Exp_Func_Call exp )
     // if( emit->code->need_this )
     //     size += 4;
 
+    // stack bounds: the spork copies args, this, and func onto the new reg
+    // stack, and the op above pushes a word on mem
+    code->reg_depth += size + 2 * sizeof(t_CKUINT);
+    code->frame_depth += sizeof(t_CKUINT);
+
     // emit instruction that will put the code on the stack
     emit->append( new Chuck_Instr_Reg_Push_Imm( (t_CKUINT)code ) );
     // emit spork instruction - this will copy, func, args, this
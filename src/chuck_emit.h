@@ -72,6 +72,12 @@ public:
     std::vector<Chuck_Instr_Goto *> stack_break;
     // return stack
     std::vector<Chuck_Instr_Goto *> stack_return;
+
+    // for stack bounds (see Chuck_VM_Code::stack_bounds())
+    std::vector<Chuck_Func *> callees;
+    std::vector<Chuck_VM_Code *> callee_codes;
+    t_CKUINT native_depth;
+    t_CKBOOL unbounded;
     
     // constructor
     Chuck_Code( )
@@ -79,6 +85,8 @@ public:
         stack_depth = 0;
         need_this = FALSE;
         frame = new Chuck_Frame;
+        native_depth = 0;
+        unbounded = FALSE;
     }
 
     // destructor
@@ -115,11 +123,13 @@ struct Chuck_Emitter : public Chuck_VM_Object
 
     // dump
     t_CKBOOL dump;
+    // optimization level
+    t_CKUINT optimize;
 
     // constructor
     Chuck_Emitter()
     { env = NULL; vm = NULL; code = NULL; context = NULL; 
-      nspc = NULL; func = NULL; dump = FALSE; }
+      nspc = NULL; func = NULL; dump = FALSE; optimize = 0; }
 
     // destructor
     ~Chuck_Emitter()
@@ -159,7 +169,10 @@ Chuck_VM_Code * emit_engine_emit_prog( Chuck_Emitter * emit,
 // helper function to emit code
 Chuck_VM_Code * emit_to_code( Chuck_Code * in,
                               Chuck_VM_Code * out = NULL,
-                              t_CKBOOL dump = FALSE );
+                              t_CKBOOL dump = FALSE,
+                              t_CKUINT optimize = 0 );
+// peephole pass: fuse instruction sequences, returns number removed
+t_CKUINT emit_engine_optimize( Chuck_Code * in, t_CKUINT level );
 
 // NOT USED: ...
 t_CKBOOL emit_engine_addr_map( Chuck_Emitter * emit, Chuck_VM_Shred * shred );
@@ -142,6 +142,8 @@ void EM_error( int pos, const char * message, ... )
     strcat( g_lasterror, " " );
     va_start(ap, message);
     vfprintf(stderr, message, ap);
+    va_end(ap);
+    va_start(ap, message);
     vsprintf( g_buffer, message, ap );
     va_end(ap);
     fprintf(stderr, "\n");
@@ -170,6 +172,8 @@ void EM_error2( int line, const char * message, ... )
 
     va_start( ap, message );
     vfprintf( stderr, message, ap );
+    va_end( ap );
+    va_start( ap, message );
     vsprintf( g_buffer, message, ap );
     va_end( ap );
 
@@ -199,6 +203,8 @@ void EM_error2b( int line, const char * message, ... )
 
     va_start( ap, message );
     vfprintf( stderr, message, ap );
+    va_end( ap );
+    va_start( ap, message );
     vsprintf( g_buffer, message, ap );
     va_end( ap );
 
@@ -218,6 +224,8 @@ void EM_error3( const char * message, ... )
 
     va_start( ap, message );
     vfprintf( stderr, message, ap );
+    va_end( ap );
+    va_start( ap, message );
     vsprintf( g_buffer, message, ap );
     va_end( ap );
 
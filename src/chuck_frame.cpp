@@ -46,6 +46,7 @@ Chuck_Frame::Chuck_Frame()
     name = "";
     // ofset
     curr_offset = 0;
+    max_offset = 0;
     // don't know
     num_access = 0;
 }
@@ -70,6 +71,8 @@ Chuck_Local * Chuck_Frame::alloc_local( t_CKUINT size, const string & name,
     local->is_ref = is_ref;
     // the next offset
     this->curr_offset += local->size;
+    if( this->curr_offset > this->max_offset )
+        this->max_offset = this->curr_offset;
     // name
     local->name = name;
     // push the local
@@ -73,6 +73,8 @@ struct Chuck_Frame
     std::string name;
     // the offset
     t_CKUINT curr_offset;
+    // the highest offset reached
+    t_CKUINT max_offset;
     // not sure
     t_CKUINT num_access;
     // offset stack
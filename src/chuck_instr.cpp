@@ -1071,11 +1071,18 @@ void Chuck_Instr_Add_string::execute( Chuck_VM * vm, Chuck_VM_Shred * shred )
     // make sure no null
     if( !rhs || !lhs ) goto null_pointer;
 
-    // make new string
-    result = (Chuck_String *)instantiate_and_initialize_object( &t_string, shred );
+    // append to the left temporary, or make new string
+    if( m_in_place )
+        result = lhs;
+    else
+    {
+        result = (Chuck_String *)instantiate_and_initialize_object( &t_string, shred );
+        result->str.reserve( lhs->str.size() + rhs->str.size() );
+        result->str.append( lhs->str );
+    }
 
     // concat
-    result->str = lhs->str + rhs->str;
+    result->str.append( rhs->str );
 
     // push the reference value to reg stack
     push_( reg_sp, (t_CKUINT)(result) );
@@ -1163,11 +1170,17 @@ void Chuck_Instr_Add_string_int::execute( Chuck_VM * vm, Chuck_VM_Shred * shred
     // make sure no null
     if( !lhs ) goto null_pointer;
 
-    // make new string
-    result = (Chuck_String *)instantiate_and_initialize_object( &t_string, shred );
+    // append to the left temporary, or make new string
+    if( m_in_place )
+        result = lhs;
+    else
+    {
+        result = (Chuck_String *)instantiate_and_initialize_object( &t_string, shred );
+        result->str = lhs->str;
+    }
 
     // concat
-    result->str = lhs->str + ::itoa(rhs);
+    result->str += ::itoa(rhs);
 
     // push the reference value to reg stack
     push_( reg_sp, (t_CKUINT)(result) );
@@ -1211,11 +1224,17 @@ void Chuck_Instr_Add_string_float::execute( Chuck_VM * vm, Chuck_VM_Shred * shre
     // make sure no null
     if( !lhs ) goto null_pointer;
 
-    // make new string
-    result = (Chuck_String *)instantiate_and_initialize_object( &t_string, shred );
+    // append to the left temporary, or make new string
+    if( m_in_place )
+        result = lhs;
+    else
+    {
+        result = (Chuck_String *)instantiate_and_initialize_object( &t_string, shred );
+        result->str = lhs->str;
+    }
 
     // concat
-    result->str = lhs->str + ::ftoa(rhs, 4);
+    result->str += ::ftoa(rhs, 4);
 
     // push the reference value to reg stack
     push_( reg_sp, (t_CKUINT)(result) );
@@ -2677,11 +2696,8 @@ t_CKBOOL initialize_object( Chuck_Object * object, Chuck_Type * type )
     assert( type != NULL );
     assert( type->info != NULL );
 
-    // allocate virtual table
-    object->vtable = new Chuck_VTable;
-    if( !object->vtable ) goto out_of_memory;
-    // copy the object's virtual table
-    object->vtable->funcs = type->info->obj_v_table.funcs;
+    // share the type's virtual table (the type outlives the object)
+    object->vtable = &type->info->obj_v_table;
     // set the type reference
     // TODO: reference count
     object->type_ref = type;
@@ -2692,8 +2708,9 @@ t_CKBOOL initialize_object( Chuck_Object * object, Chuck_Type * type )
     if( object->size )
     {
         // check to ensure enough memory
-        object->data = new t_CKBYTE[object->size];
+        object->data = (t_CKBYTE *)Chuck_VM_Pool::alloc( object->size );
         if( !object->data ) goto out_of_memory;
+        object->m_pooled = TRUE;
         // zero it out
         memset( object->data, 0, object->size );
     }
@@ -2705,6 +2722,7 @@ t_CKBOOL initialize_object( Chuck_Object * object, Chuck_Type * type )
         // ugen
         Chuck_UGen * ugen = (Chuck_UGen *)object;
         if( type->ugen_info->tick ) ugen->tick = type->ugen_info->tick;
+        if( type->ugen_info->tickf ) ugen->tickf = type->ugen_info->tickf;
         if( type->ugen_info->pmsg ) ugen->pmsg = type->ugen_info->pmsg;
         // TODO: another hack!
         if( type->ugen_info->tock ) ((Chuck_UAna *)ugen)->tock = type->ugen_info->tock;
@@ -2738,8 +2756,8 @@ out_of_memory:
         "[chuck](VM): OutOfMemory: while instantiating object '%s'\n",
         type->c_name() );
 
-    // delete
-    if( object ) SAFE_DELETE( object->vtable );
+    // not ours
+    if( object ) object->vtable = NULL;
 
     // return FALSE
     return FALSE;
@@ -3214,8 +3232,9 @@ void Chuck_Instr_Func_Call::execute( Chuck_VM * vm, Chuck_VM_Shred * shred )
             *mem_sp2++ = *reg_sp2++;
     }
 
-    // detect overflow/underflow
-    if( overflow_( shred->mem ) ) goto error_overflow;
+    // detect overflow/underflow (the reg stack too: bounded stacks are sized
+    // for the deepest call chain, and a call is where that can be exceeded)
+    if( overflow_( shred->mem ) || overflow_( shred->reg ) ) goto error_overflow;
 
     return;
 
@@ -3280,7 +3299,7 @@ void Chuck_Instr_Func_Call_Member::execute( Chuck_VM * vm, Chuck_VM_Shred * shre
     }
 
     // detect overflow/underflow
-    if( overflow_( shred->mem ) ) goto error_overflow;
+    if( overflow_( shred->mem ) || overflow_( shred->reg ) ) goto error_overflow;
 
     // check the type
     if( func->native_func_type == Chuck_VM_Code::NATIVE_CTOR )
@@ -3387,7 +3406,7 @@ void Chuck_Instr_Func_Call_Static::execute( Chuck_VM * vm, Chuck_VM_Shred * shre
     }
 
     // detect overflow/underflow
-    if( overflow_( shred->mem ) ) goto error_overflow;
+    if( overflow_( shred->mem ) || overflow_( shred->reg ) ) goto error_overflow;
 
     // call the function
     f( mem_sp, &retval, shred );
@@ -5625,3 +5644,111 @@ const char * Chuck_Instr_Gack::params() const
     sprintf( buffer, "( many types )" );
     return buffer;
 }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: execute()
+// desc: push int from mem stack plus immediate
+//-----------------------------------------------------------------------------
+void Chuck_Instr_Reg_Push_Mem_Add_Imm::execute( Chuck_VM * vm, Chuck_VM_Shred * shred )
+{
+    t_CKBYTE *& mem_sp = (t_CKBYTE *&)(base?shred->base_ref->stack:shred->mem->sp);
+    t_CKINT *& reg_sp = (t_CKINT *&)shred->reg->sp;
+
+    // push mem stack content plus immediate into reg stack
+    push_( reg_sp, *((t_CKINT *)(mem_sp + m_val)) + m_imm );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: execute()
+// desc: pop int from reg stack into mem stack
+//-----------------------------------------------------------------------------
+void Chuck_Instr_Assign_Primitive_Mem::execute( Chuck_VM * vm, Chuck_VM_Shred * shred )
+{
+    t_CKBYTE *& mem_sp = (t_CKBYTE *&)(base?shred->base_ref->stack:shred->mem->sp);
+    t_CKUINT *& reg_sp = (t_CKUINT *&)shred->reg->sp;
+
+    // pop word from reg stack
+    pop_( reg_sp, 1 );
+    // copy popped value into mem stack
+    *((t_CKUINT *)(mem_sp + m_val)) = *reg_sp;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: execute()
+// desc: pop t_CKFLOAT from reg stack into mem stack
+//-----------------------------------------------------------------------------
+void Chuck_Instr_Assign_Primitive2_Mem::execute( Chuck_VM * vm, Chuck_VM_Shred * shred )
+{
+    t_CKBYTE *& mem_sp = (t_CKBYTE *&)(base?shred->base_ref->stack:shred->mem->sp);
+    t_CKFLOAT *& reg_sp = (t_CKFLOAT *&)shred->reg->sp;
+
+    // pop word from reg stack
+    pop_( reg_sp, 1 );
+    // copy popped value into mem stack
+    *((t_CKFLOAT *)(mem_sp + m_val)) = *reg_sp;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: execute()
+// desc: add immediate to int in mem stack
+//-----------------------------------------------------------------------------
+void Chuck_Instr_Add_int_Mem_Imm::execute( Chuck_VM * vm, Chuck_VM_Shred * shred )
+{
+    t_CKBYTE *& mem_sp = (t_CKBYTE *&)(base?shred->base_ref->stack:shred->mem->sp);
+
+    // add in place
+    *((t_CKINT *)(mem_sp + m_val)) += m_imm;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: execute()
+// desc: advance time by dur
+//-----------------------------------------------------------------------------
+void Chuck_Instr_Time_Advance_Dur::execute( Chuck_VM * vm, Chuck_VM_Shred * shred )
+{
+    t_CKTIME *& sp = (t_CKTIME *&)shred->reg->sp;
+
+    // pop dur from reg stack
+    pop_( sp, 1 );
+    // when
+    t_CKTIME when = shred->now + *sp;
+
+    if( when < shred->now )
+    {
+        // we have a problem
+        fprintf( stderr, 
+            "[chuck](VM): DestTimeNegativeException: '%.6f' in shred[id=%lu:%s], PC=[%lu]\n",
+            when, shred->xid, shred->name.c_str(), shred->pc );
+        // do something!
+        shred->is_running = FALSE;
+        shred->is_done = TRUE;
+
+        return;
+    }
+
+    // shredule the shred
+    vm->shreduler()->shredule( shred, when );
+    // suspend
+    shred->is_running = FALSE;
+
+    // track time advance
+    CK_TRACK( Chuck_Stats::instance()->advance_time( shred, when ) );
+
+    // leave the time
+    if( m_push ) { push_( sp, when ); }
+}
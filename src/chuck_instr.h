@@ -76,6 +76,7 @@ struct Chuck_Instr_Branch_Op : public Chuck_Instr
 {
 public:
     inline void set( t_CKUINT jmp ) { m_jmp = jmp; }
+    inline t_CKUINT get() { return m_jmp; }
 
 public:
     virtual const char * params() const
@@ -822,12 +823,22 @@ public:
 
 //-----------------------------------------------------------------------------
 // name: struct Chuck_Instr_Add_string
-// desc: ...
+// desc: ...; in place when the left string is the result of another +,
+//       a temporary nothing else can see
 //-----------------------------------------------------------------------------
 struct Chuck_Instr_Add_string : public Chuck_Instr_Binary_Op
 {
+public:
+    Chuck_Instr_Add_string( t_CKBOOL in_place = FALSE )
+    { m_in_place = in_place; }
+
 public:
     virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { return m_in_place ? "in-place" : ""; }
+
+protected:
+    t_CKBOOL m_in_place;
 };
 
 
@@ -848,12 +859,22 @@ public:
 
 //-----------------------------------------------------------------------------
 // name: struct Chuck_Instr_Add_string_int
-// desc: ...
+// desc: ...; in place when the left string is the result of another +,
+//       a temporary nothing else can see
 //-----------------------------------------------------------------------------
 struct Chuck_Instr_Add_string_int : public Chuck_Instr_Binary_Op
 {
+public:
+    Chuck_Instr_Add_string_int( t_CKBOOL in_place = FALSE )
+    { m_in_place = in_place; }
+
 public:
     virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { return m_in_place ? "in-place" : ""; }
+
+protected:
+    t_CKBOOL m_in_place;
 };
 
 
@@ -861,12 +882,22 @@ public:
 
 //-----------------------------------------------------------------------------
 // name: struct Chuck_Instr_Add_string_float
-// desc: ...
+// desc: ...; in place when the left string is the result of another +,
+//       a temporary nothing else can see
 //-----------------------------------------------------------------------------
 struct Chuck_Instr_Add_string_float : public Chuck_Instr_Binary_Op
 {
+public:
+    Chuck_Instr_Add_string_float( t_CKBOOL in_place = FALSE )
+    { m_in_place = in_place; }
+
 public:
     virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { return m_in_place ? "in-place" : ""; }
+
+protected:
+    t_CKBOOL m_in_place;
 };
 
 
@@ -1738,6 +1769,7 @@ public:
     { static char buffer[256];
       sprintf( buffer, "src=%ld, base=%ld", m_val, base );
       return buffer; }
+    inline t_CKBOOL use_base() { return base; }
 
 protected:
     // use global stack base
@@ -1763,6 +1795,7 @@ public:
     { static char buffer[256];
       sprintf( buffer, "src=%ld, base=%ld", m_val, base );
       return buffer; }
+    inline t_CKBOOL use_base() { return base; }
 
 protected:
     // use global stack base
@@ -1788,6 +1821,7 @@ public:
     { static char buffer[256];
       sprintf( buffer, "src=%ld, base=%ld", m_val, base );
       return buffer; }
+    inline t_CKBOOL use_base() { return base; }
 
 protected:
     // use global stack base
@@ -1813,6 +1847,7 @@ public:
     { static char buffer[256];
       sprintf( buffer, "src=%ld, base=%ld", m_val, base );
       return buffer; }
+    inline t_CKBOOL use_base() { return base; }
 
 protected:
     // use global stack base
@@ -3159,6 +3194,155 @@ protected:
 
 
 
+//-----------------------------------------------------------------------------
+// superinstructions - not emitted directly; the optimizer (see
+// emit_engine_optimize()) substitutes them for common instruction sequences
+//-----------------------------------------------------------------------------
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Instr_Reg_Push_Mem_Add_Imm
+// desc: push int from mem stack plus immediate to reg stack
+//       (Reg_Push_Mem, Reg_Push_Imm, Add_int/Minus_int)
+//-----------------------------------------------------------------------------
+struct Chuck_Instr_Reg_Push_Mem_Add_Imm : public Chuck_Instr_Unary_Op
+{
+public:
+    Chuck_Instr_Reg_Push_Mem_Add_Imm( t_CKUINT src, t_CKBOOL use_base, t_CKINT imm )
+    { this->set( src ); base = use_base; m_imm = imm; }
+
+public:
+    virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { static char buffer[256];
+      sprintf( buffer, "src=%ld, base=%ld, imm=%ld", m_val, base, m_imm );
+      return buffer; }
+    inline t_CKBOOL use_base() { return base; }
+    inline t_CKINT imm() { return m_imm; }
+
+protected:
+    // use global stack base
+    t_CKBOOL base;
+    // immediate
+    t_CKINT m_imm;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Instr_Assign_Primitive_Mem
+// desc: pop int from reg stack into mem stack
+//       (Reg_Push_Mem_Addr, Assign_Primitive, Reg_Pop_Word)
+//-----------------------------------------------------------------------------
+struct Chuck_Instr_Assign_Primitive_Mem : public Chuck_Instr_Unary_Op
+{
+public:
+    Chuck_Instr_Assign_Primitive_Mem( t_CKUINT dest, t_CKBOOL use_base )
+    { this->set( dest ); base = use_base; }
+
+public:
+    virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { static char buffer[256];
+      sprintf( buffer, "dest=%ld, base=%ld", m_val, base );
+      return buffer; }
+    inline t_CKBOOL use_base() { return base; }
+
+protected:
+    // use global stack base
+    t_CKBOOL base;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Instr_Assign_Primitive2_Mem
+// desc: pop t_CKFLOAT from reg stack into mem stack
+//       (Reg_Push_Mem_Addr, Assign_Primitive2, Reg_Pop_Word2)
+//-----------------------------------------------------------------------------
+struct Chuck_Instr_Assign_Primitive2_Mem : public Chuck_Instr_Unary_Op
+{
+public:
+    Chuck_Instr_Assign_Primitive2_Mem( t_CKUINT dest, t_CKBOOL use_base )
+    { this->set( dest ); base = use_base; }
+
+public:
+    virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { static char buffer[256];
+      sprintf( buffer, "dest=%ld, base=%ld", m_val, base );
+      return buffer; }
+    inline t_CKBOOL use_base() { return base; }
+
+protected:
+    // use global stack base
+    t_CKBOOL base;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Instr_Add_int_Mem_Imm
+// desc: add immediate to int in mem stack, nothing on reg stack
+//       (Reg_Push_Mem_Addr, ++/--, Reg_Pop_Word and
+//        Reg_Push_Imm, Reg_Push_Mem_Addr, +=>/-=>, Reg_Pop_Word)
+//-----------------------------------------------------------------------------
+struct Chuck_Instr_Add_int_Mem_Imm : public Chuck_Instr_Unary_Op
+{
+public:
+    Chuck_Instr_Add_int_Mem_Imm( t_CKUINT dest, t_CKBOOL use_base, t_CKINT imm )
+    { this->set( dest ); base = use_base; m_imm = imm; }
+
+public:
+    virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { static char buffer[256];
+      sprintf( buffer, "dest=%ld, base=%ld, imm=%ld", m_val, base, m_imm );
+      return buffer; }
+    inline t_CKBOOL use_base() { return base; }
+    inline t_CKINT imm() { return m_imm; }
+
+protected:
+    // use global stack base
+    t_CKBOOL base;
+    // immediate
+    t_CKINT m_imm;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Instr_Time_Advance_Dur
+// desc: advance time by dur on reg stack
+//       (Reg_Push_Now, Add_double, Time_Advance [, Reg_Pop_Word2])
+//-----------------------------------------------------------------------------
+struct Chuck_Instr_Time_Advance_Dur : public Chuck_Instr
+{
+public:
+    Chuck_Instr_Time_Advance_Dur( t_CKBOOL push_result )
+    { m_push = push_result; }
+
+public:
+    virtual void execute( Chuck_VM * vm, Chuck_VM_Shred * shred );
+    virtual const char * params() const
+    { static char buffer[256];
+      sprintf( buffer, "push=%ld", m_push );
+      return buffer; }
+
+protected:
+    // leave the new time on the reg stack
+    t_CKBOOL m_push;
+};
+
+
+
+
 // runtime functions
 Chuck_Object * instantiate_and_initialize_object( Chuck_Type * type, Chuck_VM_Shred * shred );
 // initialize object using Type
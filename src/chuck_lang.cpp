@@ -49,10 +49,13 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 using namespace std;
 
 // dac tick
 CK_DLL_TICK(__ugen_tick) { *out = in; return TRUE; }
+// dac block tick
+CK_DLL_TICKF(__ugen_tickf) { if( out != in ) memcpy( out, in, nframes * sizeof(SAMPLE) ); return TRUE; }
 // object string offset
 static t_CKUINT Object_offset_string = 0;
 
@@ -115,6 +118,7 @@ t_CKBOOL init_class_ugen( Chuck_Env * env, Chuck_Type * type )
     type->ugen_info = new Chuck_UGen_Info;
     type->ugen_info->add_ref();
     type->ugen_info->tick = __ugen_tick;
+    type->ugen_info->tickf = __ugen_tickf;
     type->ugen_info->num_ins = 1;
     type->ugen_info->num_outs = 1;
 
@@ -877,6 +881,75 @@ t_CKBOOL init_class_array( Chuck_Env * env, Chuck_Type * type )
     func->add_arg( "string", "key" );
     if( !type_engine_import_mfun( env, func ) ) goto error;
 
+    // bulk operations (int and float arrays; run natively over the whole
+    // array instead of element by element)
+    // add fill()
+    func = make_new_mfun( "void", "fill", array_fill );
+    func->add_arg( "float", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "void", "fill", array_fill_range );
+    func->add_arg( "float", "value" );
+    func->add_arg( "int", "start" );
+    func->add_arg( "int", "end" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add copy(), for float[] and int[] sources
+    for( t_CKUINT i = 0; i < 2; i++ )
+    {
+        const char * src = i ? "int[]" : "float[]";
+        func = make_new_mfun( "int", "copy", array_copy );
+        func->add_arg( src, "src" );
+        if( !type_engine_import_mfun( env, func ) ) goto error;
+        func = make_new_mfun( "int", "copy", array_copy_range );
+        func->add_arg( src, "src" );
+        func->add_arg( "int", "start" );
+        func->add_arg( "int", "end" );
+        if( !type_engine_import_mfun( env, func ) ) goto error;
+        // add add(), mul(), dot() with an array
+        func = make_new_mfun( "void", "add", array_add_array );
+        func->add_arg( src, "rhs" );
+        if( !type_engine_import_mfun( env, func ) ) goto error;
+        func = make_new_mfun( "void", "mul", array_mul_array );
+        func->add_arg( src, "rhs" );
+        if( !type_engine_import_mfun( env, func ) ) goto error;
+        func = make_new_mfun( "float", "dot", array_dot );
+        func->add_arg( src, "rhs" );
+        if( !type_engine_import_mfun( env, func ) ) goto error;
+    }
+
+    // add add(), mul(), scale() with a scalar
+    func = make_new_mfun( "void", "add", array_add_scalar );
+    func->add_arg( "float", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "void", "mul", array_mul_scalar );
+    func->add_arg( "float", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "void", "scale", array_mul_scalar );
+    func->add_arg( "float", "gain" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add sum(), min(), max()
+    func = make_new_mfun( "float", "sum", array_sum );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "float", "min", array_min );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "float", "max", array_max );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add sort()
+    func = make_new_mfun( "void", "sort", array_sort );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add search()
+    func = make_new_mfun( "int", "search", array_search );
+    func->add_arg( "float", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add interp()
+    func = make_new_mfun( "float", "interp", array_interp );
+    func->add_arg( "float", "index" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
     type_engine_import_class_end( env );
 
     return TRUE;
@@ -1928,12 +2001,18 @@ Chuck_UAnaBlobProxy::Chuck_UAnaBlobProxy( Chuck_Object * blob )
     assert( m_blob != NULL );
     // add reference
     m_blob->add_ref();
+    // no spectrum yet
+    m_mag = m_power = NULL;
+    m_spec_size = m_spec_cap = 0;
+    m_mag_when = m_power_when = -1;
 }
 
 Chuck_UAnaBlobProxy::~Chuck_UAnaBlobProxy()
 {
     // release
     SAFE_RELEASE( m_blob );
+    SAFE_DELETE_ARRAY( m_mag );
+    SAFE_DELETE_ARRAY( m_power );
 }
 
 t_CKTIME & Chuck_UAnaBlobProxy::when()
@@ -1958,6 +2037,53 @@ Chuck_Array16 & Chuck_UAnaBlobProxy::cvals()
     return *arr16;
 }
 
+SAMPLE * Chuck_UAnaBlobProxy::set_mag( t_CKUINT n, t_CKTIME frame )
+{
+    // grow
+    if( n > m_spec_cap )
+    {
+        SAFE_DELETE_ARRAY( m_mag );
+        SAFE_DELETE_ARRAY( m_power );
+        m_mag = new SAMPLE[n];
+        m_power = new SAMPLE[n];
+        m_spec_cap = n;
+    }
+    m_spec_size = n;
+    // stamp; power follows on demand
+    m_mag_when = frame;
+    m_power_when = -1;
+
+    return m_mag;
+}
+
+const SAMPLE * Chuck_UAnaBlobProxy::mag( t_CKUINT & n )
+{
+    Chuck_Array8 & f = fvals();
+    n = f.size();
+    // not made for this frame (or not by a producer): copy fvals
+    if( m_mag_when != when() || m_spec_size != n )
+    {
+        SAMPLE * m = set_mag( n, when() );
+        for( t_CKUINT i = 0; i < n; i++ )
+            m[i] = (SAMPLE)f.m_vector[i];
+    }
+
+    return m_mag;
+}
+
+const SAMPLE * Chuck_UAnaBlobProxy::power( t_CKUINT & n )
+{
+    const SAMPLE * m = mag( n );
+    if( m_power_when != m_mag_when )
+    {
+        for( t_CKUINT i = 0; i < n; i++ )
+            m_power[i] = m[i] * m[i];
+        m_power_when = m_mag_when;
+    }
+
+    return m_power;
+}
+
 // get proxy
 Chuck_UAnaBlobProxy * getBlobProxy( const Chuck_UAna * uana )
 {
@@ -2644,6 +2770,325 @@ CK_DLL_MFUN( array_pop_back )
 }
 
 
+
+
+//-----------------------------------------------------------------------------
+// array bulk operations
+//
+// these work on int and float arrays (the vector part, not the map); the
+// loops are over contiguous t_CKINT / t_CKFLOAT memory, so the compiler can
+// vectorize them.  object and complex arrays print an error and do nothing.
+//-----------------------------------------------------------------------------
+struct Array_View
+{
+    t_CKINT * i;
+    t_CKFLOAT * f;
+    t_CKUINT n;
+};
+
+// get the int or float storage of an array
+static t_CKBOOL array_view( Chuck_Array * array, Array_View & v, const char * op )
+{
+    v.i = NULL; v.f = NULL; v.n = 0;
+    if( !array )
+    {
+        fprintf( stderr, "[chuck](via array): null array in %s()\n", op );
+        return FALSE;
+    }
+    if( array->data_type_size() == CHUCK_ARRAY4_DATASIZE &&
+        !((Chuck_Array4 *)array)->m_is_obj )
+    {
+        std::vector<t_CKUINT> & vec = ((Chuck_Array4 *)array)->m_vector;
+        v.n = vec.size();
+        v.i = v.n ? (t_CKINT *)&vec[0] : NULL;
+        return TRUE;
+    }
+    if( array->data_type_size() == CHUCK_ARRAY8_DATASIZE )
+    {
+        std::vector<t_CKFLOAT> & vec = ((Chuck_Array8 *)array)->m_vector;
+        v.n = vec.size();
+        v.f = v.n ? &vec[0] : NULL;
+        return TRUE;
+    }
+    fprintf( stderr, "[chuck](via array): %s() needs an int or float array\n", op );
+    return FALSE;
+}
+
+// clamp [start,end) to [0,n)
+static void array_range( t_CKINT & start, t_CKINT & end, t_CKUINT n )
+{
+    if( start < 0 ) start = 0;
+    if( end > (t_CKINT)n ) end = n;
+    if( end < start ) end = start;
+}
+
+template <typename T>
+static void arr_fill( T * x, t_CKUINT n, T v )
+{ for( t_CKUINT i = 0; i < n; i++ ) x[i] = v; }
+
+template <typename T, typename U>
+static void arr_copy( T * x, const U * y, t_CKUINT n )
+{ for( t_CKUINT i = 0; i < n; i++ ) x[i] = (T)y[i]; }
+
+template <typename T>
+static void arr_add_scalar( T * x, t_CKUINT n, t_CKFLOAT v )
+{ for( t_CKUINT i = 0; i < n; i++ ) x[i] = (T)(x[i] + v); }
+
+template <typename T>
+static void arr_mul_scalar( T * x, t_CKUINT n, t_CKFLOAT v )
+{ for( t_CKUINT i = 0; i < n; i++ ) x[i] = (T)(x[i] * v); }
+
+template <typename T, typename U>
+static void arr_add_array( T * x, const U * y, t_CKUINT n )
+{ for( t_CKUINT i = 0; i < n; i++ ) x[i] = (T)(x[i] + y[i]); }
+
+template <typename T, typename U>
+static void arr_mul_array( T * x, const U * y, t_CKUINT n )
+{ for( t_CKUINT i = 0; i < n; i++ ) x[i] = (T)(x[i] * y[i]); }
+
+// four partial sums, so the adds don't serialize
+template <typename T, typename U>
+static t_CKFLOAT arr_dot( const T * x, const U * y, t_CKUINT n )
+{
+    t_CKFLOAT s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    t_CKUINT i = 0;
+    for( ; i + 4 <= n; i += 4 )
+    {
+        s0 += (t_CKFLOAT)x[i] * y[i];
+        s1 += (t_CKFLOAT)x[i+1] * y[i+1];
+        s2 += (t_CKFLOAT)x[i+2] * y[i+2];
+        s3 += (t_CKFLOAT)x[i+3] * y[i+3];
+    }
+    for( ; i < n; i++ ) s0 += (t_CKFLOAT)x[i] * y[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+template <typename T>
+static t_CKFLOAT arr_sum( const T * x, t_CKUINT n )
+{
+    t_CKFLOAT s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    t_CKUINT i = 0;
+    for( ; i + 4 <= n; i += 4 )
+    { s0 += x[i]; s1 += x[i+1]; s2 += x[i+2]; s3 += x[i+3]; }
+    for( ; i < n; i++ ) s0 += x[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+template <typename T>
+static T arr_min( const T * x, t_CKUINT n )
+{
+    T m = x[0];
+    for( t_CKUINT i = 1; i < n; i++ ) if( x[i] < m ) m = x[i];
+    return m;
+}
+
+template <typename T>
+static T arr_max( const T * x, t_CKUINT n )
+{
+    T m = x[0];
+    for( t_CKUINT i = 1; i < n; i++ ) if( x[i] > m ) m = x[i];
+    return m;
+}
+
+// linear interpolation at a fractional index, clamped to the ends
+template <typename T>
+static t_CKFLOAT arr_interp( const T * x, t_CKUINT n, t_CKFLOAT index )
+{
+    if( !( index > 0 ) ) return x[0];
+    if( index >= n - 1 ) return x[n-1];
+    t_CKUINT i = (t_CKUINT)index;
+    t_CKFLOAT frac = index - i;
+    return x[i] + frac * ( (t_CKFLOAT)x[i+1] - x[i] );
+}
+
+// run a two-array op for each combination of int and float storage
+#define ARRAY_BINARY( x, y, n, op ) \
+    if( x.f && y.f ) op( x.f, y.f, n ); \
+    else if( x.f ) op( x.f, y.i, n ); \
+    else if( y.f ) op( x.i, y.f, n ); \
+    else op( x.i, y.i, n )
+
+// array.fill( value )
+CK_DLL_MFUN( array_fill )
+{
+    t_CKFLOAT v = GET_NEXT_FLOAT( ARGS );
+    Array_View x;
+    if( !array_view( (Chuck_Array *)SELF, x, "fill" ) ) return;
+    if( x.f ) arr_fill( x.f, x.n, v );
+    else arr_fill( x.i, x.n, (t_CKINT)v );
+}
+
+// array.fill( value, start, end )
+CK_DLL_MFUN( array_fill_range )
+{
+    t_CKFLOAT v = GET_NEXT_FLOAT( ARGS );
+    t_CKINT start = GET_NEXT_INT( ARGS );
+    t_CKINT end = GET_NEXT_INT( ARGS );
+    Array_View x;
+    if( !array_view( (Chuck_Array *)SELF, x, "fill" ) ) return;
+    array_range( start, end, x.n );
+    if( x.f ) arr_fill( x.f + start, end - start, v );
+    else arr_fill( x.i + start, end - start, (t_CKINT)v );
+}
+
+// copy src[start,end) into array, resizing it
+static t_CKINT array_copy_from( Chuck_Array * array, Chuck_Array * src,
+                                t_CKINT start, t_CKINT end )
+{
+    Array_View x, y;
+    if( !array_view( array, x, "copy" ) || !array_view( src, y, "copy" ) )
+        return array ? array->size() : 0;
+    array_range( start, end, y.n );
+    t_CKUINT n = end - start;
+
+    // slice of itself: move down, then shrink
+    if( array == src )
+    {
+        if( x.f ) memmove( x.f, x.f + start, n * sizeof(t_CKFLOAT) );
+        else memmove( x.i, x.i + start, n * sizeof(t_CKINT) );
+        return array->set_size( n );
+    }
+
+    // resize, then copy
+    array->set_size( n );
+    array_view( array, x, "copy" );
+    if( y.i ) y.i += start;
+    if( y.f ) y.f += start;
+    ARRAY_BINARY( x, y, n, arr_copy );
+    return n;
+}
+
+// array.copy( src )
+CK_DLL_MFUN( array_copy )
+{
+    Chuck_Array * src = (Chuck_Array *)GET_NEXT_OBJECT( ARGS );
+    RETURN->v_int = array_copy_from( (Chuck_Array *)SELF, src, 0,
+                                     src ? src->size() : 0 );
+}
+
+// array.copy( src, start, end )
+CK_DLL_MFUN( array_copy_range )
+{
+    Chuck_Array * src = (Chuck_Array *)GET_NEXT_OBJECT( ARGS );
+    t_CKINT start = GET_NEXT_INT( ARGS );
+    t_CKINT end = GET_NEXT_INT( ARGS );
+    RETURN->v_int = array_copy_from( (Chuck_Array *)SELF, src, start, end );
+}
+
+// array.add( value )
+CK_DLL_MFUN( array_add_scalar )
+{
+    t_CKFLOAT v = GET_NEXT_FLOAT( ARGS );
+    Array_View x;
+    if( !array_view( (Chuck_Array *)SELF, x, "add" ) ) return;
+    if( x.f ) arr_add_scalar( x.f, x.n, v );
+    else arr_add_scalar( x.i, x.n, v );
+}
+
+// array.mul( value ), array.scale( gain )
+CK_DLL_MFUN( array_mul_scalar )
+{
+    t_CKFLOAT v = GET_NEXT_FLOAT( ARGS );
+    Array_View x;
+    if( !array_view( (Chuck_Array *)SELF, x, "mul" ) ) return;
+    if( x.f ) arr_mul_scalar( x.f, x.n, v );
+    else arr_mul_scalar( x.i, x.n, v );
+}
+
+// array.add( rhs ), over the shorter of the two
+CK_DLL_MFUN( array_add_array )
+{
+    Array_View x, y;
+    if( !array_view( (Chuck_Array *)SELF, x, "add" ) ||
+        !array_view( (Chuck_Array *)GET_NEXT_OBJECT( ARGS ), y, "add" ) ) return;
+    ARRAY_BINARY( x, y, ck_min( x.n, y.n ), arr_add_array );
+}
+
+// array.mul( rhs ), over the shorter of the two
+CK_DLL_MFUN( array_mul_array )
+{
+    Array_View x, y;
+    if( !array_view( (Chuck_Array *)SELF, x, "mul" ) ||
+        !array_view( (Chuck_Array *)GET_NEXT_OBJECT( ARGS ), y, "mul" ) ) return;
+    ARRAY_BINARY( x, y, ck_min( x.n, y.n ), arr_mul_array );
+}
+
+// array.dot( rhs ), over the shorter of the two
+CK_DLL_MFUN( array_dot )
+{
+    Array_View x, y;
+    RETURN->v_float = 0;
+    if( !array_view( (Chuck_Array *)SELF, x, "dot" ) ||
+        !array_view( (Chuck_Array *)GET_NEXT_OBJECT( ARGS ), y, "dot" ) ) return;
+    t_CKUINT n = ck_min( x.n, y.n );
+    if( x.f && y.f ) RETURN->v_float = arr_dot( x.f, y.f, n );
+    else if( x.f ) RETURN->v_float = arr_dot( x.f, y.i, n );
+    else if( y.f ) RETURN->v_float = arr_dot( x.i, y.f, n );
+    else RETURN->v_float = arr_dot( x.i, y.i, n );
+}
+
+// array.sum()
+CK_DLL_MFUN( array_sum )
+{
+    Array_View x;
+    RETURN->v_float = 0;
+    if( !array_view( (Chuck_Array *)SELF, x, "sum" ) ) return;
+    RETURN->v_float = x.f ? arr_sum( x.f, x.n ) : arr_sum( x.i, x.n );
+}
+
+// array.min(), 0 if empty
+CK_DLL_MFUN( array_min )
+{
+    Array_View x;
+    RETURN->v_float = 0;
+    if( !array_view( (Chuck_Array *)SELF, x, "min" ) || !x.n ) return;
+    RETURN->v_float = x.f ? arr_min( x.f, x.n ) : (t_CKFLOAT)arr_min( x.i, x.n );
+}
+
+// array.max(), 0 if empty
+CK_DLL_MFUN( array_max )
+{
+    Array_View x;
+    RETURN->v_float = 0;
+    if( !array_view( (Chuck_Array *)SELF, x, "max" ) || !x.n ) return;
+    RETURN->v_float = x.f ? arr_max( x.f, x.n ) : (t_CKFLOAT)arr_max( x.i, x.n );
+}
+
+// array.sort(), ascending
+CK_DLL_MFUN( array_sort )
+{
+    Array_View x;
+    if( !array_view( (Chuck_Array *)SELF, x, "sort" ) ) return;
+    if( x.f ) std::sort( x.f, x.f + x.n );
+    else std::sort( x.i, x.i + x.n );
+}
+
+// compare an int element against a float value
+static bool arr_int_less( t_CKINT a, t_CKFLOAT b ) { return a < b; }
+
+// array.search( value ): on a sorted array, the index of the first element
+// not less than value (size() if there is none)
+CK_DLL_MFUN( array_search )
+{
+    t_CKFLOAT v = GET_NEXT_FLOAT( ARGS );
+    Array_View x;
+    RETURN->v_int = 0;
+    if( !array_view( (Chuck_Array *)SELF, x, "search" ) ) return;
+    if( x.f ) RETURN->v_int = std::lower_bound( x.f, x.f + x.n, v ) - x.f;
+    else RETURN->v_int = std::lower_bound( x.i, x.i + x.n, v, arr_int_less ) - x.i;
+}
+
+// array.interp( index ): linear interpolation between elements
+CK_DLL_MFUN( array_interp )
+{
+    t_CKFLOAT index = GET_NEXT_FLOAT( ARGS );
+    Array_View x;
+    RETURN->v_float = 0;
+    if( !array_view( (Chuck_Array *)SELF, x, "interp" ) || !x.n ) return;
+    RETURN->v_float = x.f ? arr_interp( x.f, x.n, index ) : arr_interp( x.i, x.n, index );
+}
+
+
 #ifndef __DISABLE_MIDI__
 
 //-----------------------------------------------------------------------------
@@ -136,11 +136,28 @@ public:
     Chuck_Array8 & fvals();
     Chuck_Array16 & cvals();
 
+public:
+    // fvals as contiguous SAMPLEs (downstream of FFT, the magnitude
+    // spectrum) and their squares; made once per frame, on first use, and
+    // shared by every UAna reading this blob
+    const SAMPLE * mag( t_CKUINT & n );
+    const SAMPLE * power( t_CKUINT & n );
+    // for producers: n magnitudes to fill in for the frame being tocked
+    // (fvals still has to be written)
+    SAMPLE * set_mag( t_CKUINT n, t_CKTIME frame );
+
 public:
     Chuck_Object * realblob() { return m_blob; }
 
 protected:
     Chuck_Object * m_blob;
+    // spectrum cache
+    SAMPLE * m_mag;
+    SAMPLE * m_power;
+    t_CKUINT m_spec_size;
+    t_CKUINT m_spec_cap;
+    t_CKTIME m_mag_when;
+    t_CKTIME m_power_when;
 };
 
 // get proxy
@@ -180,6 +197,21 @@ CK_DLL_MFUN( array_find );
 CK_DLL_MFUN( array_erase );
 CK_DLL_MFUN( array_clear );
 CK_DLL_MFUN( array_reset );
+CK_DLL_MFUN( array_fill );
+CK_DLL_MFUN( array_fill_range );
+CK_DLL_MFUN( array_copy );
+CK_DLL_MFUN( array_copy_range );
+CK_DLL_MFUN( array_add_scalar );
+CK_DLL_MFUN( array_mul_scalar );
+CK_DLL_MFUN( array_add_array );
+CK_DLL_MFUN( array_mul_array );
+CK_DLL_MFUN( array_dot );
+CK_DLL_MFUN( array_sum );
+CK_DLL_MFUN( array_min );
+CK_DLL_MFUN( array_max );
+CK_DLL_MFUN( array_sort );
+CK_DLL_MFUN( array_search );
+CK_DLL_MFUN( array_interp );
 
 
 //-----------------------------------------------------------------------------
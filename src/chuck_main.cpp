@@ -47,10 +47,12 @@
 #include "chuck_shell.h"
 #include "chuck_console.h"
 #include "chuck_globals.h"
+#include "ugen_xxx.h"
 
 #include "util_math.h"
 #include "util_string.h"
 #include "util_thread.h"
+#include "util_fft.h"
 #include "util_network.h"
 #include "hidio_sdl.h"
 
@@ -78,6 +80,8 @@
 CHUCK_THREAD g_tid_otf = 0;
 // thread id for shell
 CHUCK_THREAD g_tid_shell = 0;
+// set by signal_int()
+static volatile sig_atomic_t g_sigint = 0;
 
 // default destination host name
 char g_host[256] = "127.0.0.1";
@@ -87,51 +91,21 @@ char g_host[256] = "127.0.0.1";
 
 //-----------------------------------------------------------------------------
 // name: signal_int()
-// desc: ...
+// desc: stop the vm, and let main() clean up when it returns from run();
+//       it may land on any thread, so it doesn't wait on anything here
 //-----------------------------------------------------------------------------
 extern "C" void signal_int( int sig_num )
 {
-    fprintf( stderr, "[chuck]: cleaning up...\n" );
-
-    if( g_vm )
-    {
-        // get vm
-        Chuck_VM * vm = g_vm;
-        Chuck_Compiler * compiler = g_compiler;
-        // flag the global one
-        g_vm = NULL;
-        g_compiler = NULL;
-        // if not NULL
-        if( vm )
-        {
-            // stop
-            vm->stop();
-            // detach
-            all_detach();
-        }
+    // again, or nothing running to stop: don't wait for the clean up
+    if( g_sigint || !g_vm || !g_vm->m_running )
+        exit( 2 );
 
-        // things don't work so good on windows...
-#if !defined(__PLATFORM_WIN32__) || defined(__WINDOWS_PTHREAD__)
-        // pthread_kill( g_tid_otf, 2 );
-        if( g_tid_otf ) pthread_cancel( g_tid_otf );
-        if( g_tid_whatever ) pthread_cancel( g_tid_whatever );
-        // if( g_tid_otf ) usleep( 50000 );
-#else
-        // close handle
-        if( g_tid_otf ) CloseHandle( g_tid_otf );
-#endif
-        // will this work for windows?
-        SAFE_DELETE( vm );
-        SAFE_DELETE( compiler );
-
-        // ck_close( g_sock );
-    }
+    g_sigint = 1;
+    fprintf( stderr, "[chuck]: cleaning up...\n" );
 
-#if !defined(__PLATFORM_WIN32__) || defined(__WINDOWS_PTHREAD__)
-    // pthread_join( g_tid_otf, NULL );
-#endif
-    
-    exit(2);
+    // stop (main() wakes from vm->run())
+    g_vm->m_running = FALSE;
+    Digitalio::m_end = TRUE;
 }
 
 
@@ -207,6 +181,33 @@ static t_CKBOOL get_count( const char * arg, t_CKUINT * out )
 
 
 
+//-----------------------------------------------------------------------------
+// name: get_duration()
+// desc: parse <N>[samp|ms|s|min] (default seconds) into samples
+//-----------------------------------------------------------------------------
+static t_CKBOOL get_duration( const char * arg, t_CKUINT srate, t_CKINT * out )
+{
+    char * end = NULL;
+    t_CKFLOAT value = strtod( arg, &end );
+    string unit = end ? end : "";
+
+    // no number
+    if( end == arg || value < 0 ) return FALSE;
+
+    if( unit == "samp" ) { }
+    else if( unit == "ms" ) value *= srate / 1000.0;
+    else if( unit == "" || unit == "s" || unit == "second" ) value *= srate;
+    else if( unit == "min" || unit == "minute" ) value *= srate * 60.0;
+    else return FALSE;
+
+    *out = (t_CKINT)( value + .5 );
+
+    return TRUE;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: version()
 // desc: ...
@@ -251,7 +252,13 @@ static void usage()
     fprintf( stderr, "               srate<N>|bufsize<N>|bufnum<N>|dac<N>|adc<N>|\n" );
     fprintf( stderr, "               remote<hostname>|port<N>|verbose<N>|probe|\n" );
     fprintf( stderr, "               channels<N>|out<N>|in<N>|shell|empty|level<N>|\n" );
-    fprintf( stderr, "               blocking|callback|deprecate:{stop|warn|ignore}\n" );
+    fprintf( stderr, "               blocking|callback|deprecate:{stop|warn|ignore}|\n" );
+    fprintf( stderr, "               engine:{virtual|threaded}|optimize<N>|\n" );
+    fprintf( stderr, "               graph:{flat|recursive|check}|render-threads=<N>|\n" );
+    fprintf( stderr, "               reclaim:{immediate|deferred|<N>}|\n" );
+    fprintf( stderr, "               stacks:{bounded|full}|fft:{planned|classic}|\n" );
+    fprintf( stderr, "               render=<file.wav>|duration=<N>[samp|ms|s|min]|\n" );
+    fprintf( stderr, "               sample-cache=<dir>\n" );
     fprintf( stderr, "   [commands] = add|remove|replace|remove.all|status|time|kill\n" );
     fprintf( stderr, "   [+-=^] = shortcuts for add, remove, replace, status\n" );
     version();
@@ -297,6 +304,15 @@ static void usage()
     t_CKINT  adaptive_size = 0;
     t_CKINT  log_level = CK_LOG_CORE;
     t_CKINT  deprecate_level = 1; // warn
+    t_CKUINT engine = CK_VM_ENGINE_VIRTUAL;
+    t_CKUINT optimize = 0;
+    t_CKBOOL flat_graph = TRUE;
+    t_CKINT  render_threads = 1;
+    t_CKINT  reclaim_batch = 0;
+    t_CKBOOL bounded_stacks = TRUE;
+    string   render_file = "";
+    string   render_duration = "";
+    t_CKINT  render_samps = -1;
 
     string   filename = "";
     vector<string> args;
@@ -422,6 +438,98 @@ static void usage()
                     exit( 1 );
                 }
             }
+            else if( !strncmp(argv[i], "--optimize", 10) )
+                optimize = argv[i][10] ? atoi( argv[i]+10 ) : 1;
+            else if( !strncmp(argv[i], "--engine", 8) )
+            {
+                // get the rest
+                string arg = argv[i]+8;
+                if( arg == ":virtual" ) engine = CK_VM_ENGINE_VIRTUAL;
+                else if( arg == ":threaded" ) engine = CK_VM_ENGINE_THREADED;
+                else
+                {
+                    // error
+                    fprintf( stderr, "[chuck]: invalid arguments for '--engine'...\n" );
+                    fprintf( stderr, "[chuck]: ... (looking for :virtual or :threaded)\n" );
+                    exit( 1 );
+                }
+            }
+            else if( !strncmp(argv[i], "--graph", 7) )
+            {
+                // get the rest
+                string arg = argv[i]+7;
+                if( arg == ":flat" ) flat_graph = TRUE;
+                else if( arg == ":recursive" ) flat_graph = FALSE;
+                else if( arg == ":check" ) flat_graph = Chuck_UGen::our_schedule_check = TRUE;
+                else
+                {
+                    // error
+                    fprintf( stderr, "[chuck]: invalid arguments for '--graph'...\n" );
+                    fprintf( stderr, "[chuck]: ... (looking for :flat, :recursive, or :check)\n" );
+                    exit( 1 );
+                }
+            }
+            else if( !strncmp(argv[i], "--render-threads=", 17) )
+                render_threads = atoi( argv[i]+17 ) > 0 ? atoi( argv[i]+17 ) : 1;
+            else if( !strncmp(argv[i], "--render=", 9) )
+            {
+                render_file = argv[i]+9;
+                if( render_file == "" )
+                {
+                    // error
+                    fprintf( stderr, "[chuck]: invalid arguments for '--render'...\n" );
+                    fprintf( stderr, "[chuck]: ... (looking for =<file.wav>)\n" );
+                    exit( 1 );
+                }
+            }
+            else if( !strncmp(argv[i], "--duration=", 11) )
+                render_duration = argv[i]+11;
+            else if( !strncmp(argv[i], "--sample-cache=", 15) )
+                sndbuf_cache_set_dir( argv[i]+15 );
+            else if( !strncmp(argv[i], "--reclaim", 9) )
+            {
+                // get the rest
+                string arg = argv[i]+9;
+                if( arg == ":immediate" ) reclaim_batch = 0;
+                else if( arg == ":deferred" ) reclaim_batch = 32;
+                else if( arg.length() > 1 && arg[0] == ':' && atoi( arg.c_str()+1 ) > 0 )
+                    reclaim_batch = atoi( arg.c_str()+1 );
+                else
+                {
+                    // error
+                    fprintf( stderr, "[chuck]: invalid arguments for '--reclaim'...\n" );
+                    fprintf( stderr, "[chuck]: ... (looking for :immediate, :deferred, or :<N>)\n" );
+                    exit( 1 );
+                }
+            }
+            else if( !strncmp(argv[i], "--stacks", 8) )
+            {
+                // get the rest
+                string arg = argv[i]+8;
+                if( arg == ":bounded" ) bounded_stacks = TRUE;
+                else if( arg == ":full" ) bounded_stacks = FALSE;
+                else
+                {
+                    // error
+                    fprintf( stderr, "[chuck]: invalid arguments for '--stacks'...\n" );
+                    fprintf( stderr, "[chuck]: ... (looking for :bounded or :full)\n" );
+                    exit( 1 );
+                }
+            }
+            else if( !strncmp(argv[i], "--fft", 5) )
+            {
+                // get the rest
+                string arg = argv[i]+5;
+                if( arg == ":planned" ) fft_set_planned( TRUE );
+                else if( arg == ":classic" ) fft_set_planned( FALSE );
+                else
+                {
+                    // error
+                    fprintf( stderr, "[chuck]: invalid arguments for '--fft'...\n" );
+                    fprintf( stderr, "[chuck]: ... (looking for :planned or :classic)\n" );
+                    exit( 1 );
+                }
+            }
             else if( !strcmp( argv[i], "--probe" ) )
                 probe = TRUE;
             else if( !strcmp( argv[i], "--poop" ) )
@@ -486,6 +594,23 @@ static void usage()
         exit( 0 );
     }
     
+    // offline render: no audio device, full speed, big blocks
+    if( render_file != "" )
+    {
+        enable_audio = FALSE;
+        if( adaptive_size == 0 ) adaptive_size = -1;
+        // length
+        if( render_duration != "" && !get_duration( render_duration.c_str(), srate, &render_samps ) )
+        {
+            // error
+            fprintf( stderr, "[chuck]: invalid arguments for '--duration'...\n" );
+            fprintf( stderr, "[chuck]: ... (looking for =<N>[samp|ms|s|min])\n" );
+            exit( 1 );
+        }
+    }
+    else if( render_duration != "" )
+        fprintf( stderr, "[chuck]: '--duration' needs '--render', ignoring...\n" );
+
     // check buffer size
     buffer_size = ensurepow2( buffer_size );
     // check mode and blocking
@@ -499,6 +624,8 @@ static void usage()
     g_do_watchdog = do_watchdog;
     // set adaptive size
     if( adaptive_size < 0 ) adaptive_size = buffer_size;
+    // render threads work on blocks
+    if( render_threads > 1 && adaptive_size == 0 ) adaptive_size = buffer_size;
 
     if ( !files && vm_halt && !enable_shell )
     {
@@ -538,6 +665,30 @@ static void usage()
         fprintf( stderr, "[chuck]: %s\n", vm->last_error() );
         exit( 1 );
     }
+    // set execution engine
+    vm->m_engine = engine;
+    EM_log( CK_LOG_SYSTEM, "execution engine: %s",
+            engine == CK_VM_ENGINE_THREADED ? "threaded" : "virtual" );
+    // set ugen graph traversal
+    vm->shreduler()->m_flat_graph = flat_graph;
+    EM_log( CK_LOG_SYSTEM, "ugen graph: %s", flat_graph ? "flat" : "recursive" );
+    // set render threads
+    if( render_threads > 1 && !flat_graph )
+        fprintf( stderr, "[chuck]: '--render-threads' needs '--graph:flat', ignoring...\n" );
+    else if( render_threads > 1 && vm->shreduler()->set_render_threads( render_threads ) )
+        EM_log( CK_LOG_SYSTEM, "render threads: %d (block size %d)", render_threads, adaptive_size );
+    // set render target
+    if( render_file != "" && !vm->set_render( render_file, render_samps ) )
+    {
+        fprintf( stderr, "[chuck]: %s\n", vm->last_error() );
+        exit( 1 );
+    }
+    // set object reclamation
+    vm->set_reclaim( reclaim_batch );
+    if( reclaim_batch )
+        EM_log( CK_LOG_SYSTEM, "object reclaim: deferred (%d per pass)", reclaim_batch );
+    // sporked shred stacks
+    vm->m_bounded_stacks = bounded_stacks;
 
     // allocate the compiler
     compiler = g_compiler = new Chuck_Compiler;
@@ -549,6 +700,8 @@ static void usage()
     }
     // enable dump
     compiler->emitter->dump = dump;
+    // set optimization level
+    compiler->emitter->optimize = optimize;
     // set auto depend
     compiler->set_auto_depend( auto_depend );
 
@@ -628,8 +781,6 @@ static void usage()
 
         // get the code
         code = compiler->output();
-        // name it
-        code->name += string(argv[i]);
 
         // log
         EM_log( CK_LOG_FINE, "sporking %d %s...", count,
@@ -640,6 +791,8 @@ static void usage()
         {
             // spork
             shred = vm->spork( code, NULL );
+            // name it (not the code, which the compiler may be caching)
+            shred->name = argv[i];
             // add args
             shred->args = args;
         }
@@ -710,12 +863,23 @@ static void usage()
 #endif
     }
 
+    // compile Machine.add/replace off the audio thread (offline render
+    // keeps them synchronous, so output doesn't depend on compile time)
+    if( render_file == "" )
+        otf_compile_start( vm, compiler );
+
     // run the vm
     vm->run();
 
+    // stop compiling (waits for a compile in progress)
+    otf_compile_stop();
+
     // detach
     all_detach();
 
+    // interrupted: the otf listener may still be using the vm
+    if( g_sigint ) exit( 2 );
+
     // free vm
     vm = NULL; SAFE_DELETE( g_vm );
     // free the compiler
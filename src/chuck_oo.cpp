@@ -43,6 +43,9 @@
 #include <sstream>
 #include <iomanip>
 #include <typeinfo>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
 using namespace std;
 
 #if defined(__PLATFORM_WIN32__)
@@ -83,6 +86,9 @@ void Chuck_VM_Object::init_ref()
     m_locked = FALSE;
     // set v ref
     m_v_ref = NULL;
+    // not queued
+    m_free_next = NULL;
+    m_free_stamp = 0;
     // add to vm allocator
     // Chuck_VM_Alloc::instance()->add_object( this );
 }
@@ -96,11 +102,9 @@ void Chuck_VM_Object::init_ref()
 //-----------------------------------------------------------------------------
 void Chuck_VM_Object::add_ref()
 {
-    // increment reference count
-    m_ref_count++;
-
-    // if going from 0 to 1
-    if( m_ref_count == 1 )
+    // increment reference count (atomically: types and code are shared by
+    // running shreds and the compiler thread), and if going from 0 to 1
+    if( ck_atomic_add( &m_ref_count, 1 ) == 1 )
     {
         // add to vm allocator
         Chuck_VM_Alloc::instance()->add_object( this );
@@ -118,11 +122,8 @@ void Chuck_VM_Object::release()
 {
     // make sure there is at least one reference
     assert( m_ref_count > 0 );
-    // decrement
-    m_ref_count--;
-    
-    // if no more references
-    if( m_ref_count == 0 )
+    // decrement, and if no more references
+    if( ck_atomic_add( &m_ref_count, (t_CKUINT)-1 ) == 0 )
     {
         // this is not good
         if( our_locks_in_effect && m_locked )
@@ -245,6 +246,18 @@ void Chuck_VM_Alloc::free_object( Chuck_VM_Object * obj )
 
     // remove it from map
 
+    // queue it
+    if( m_deferred )
+    {
+        obj->m_free_stamp = m_now;
+        // push onto the incoming stack
+        do { obj->m_free_next = m_incoming; }
+        while( !ck_cas_ptr( (void * volatile *)&m_incoming, obj->m_free_next, obj ) );
+        // count
+        ck_atomic_add( &m_num_queued, 1 );
+        return;
+    }
+
     // delete it
     delete obj;
 }
@@ -252,12 +265,96 @@ void Chuck_VM_Alloc::free_object( Chuck_VM_Object * obj )
 
 
 
+//-----------------------------------------------------------------------------
+// name: reclaim()
+// desc: destroy up to max queued objects; releases made by the destructors
+//       queue more objects, so a deep graph is freed over several calls
+//-----------------------------------------------------------------------------
+t_CKUINT Chuck_VM_Alloc::reclaim( t_CKUINT max, t_CKUINT now )
+{
+    t_CKUINT count = 0;
+    Chuck_VM_Object * obj = NULL;
+
+    // date the queue
+    m_now = now;
+
+    // nothing to do
+    if( !m_pending && !m_incoming ) return 0;
+
+    // track depth
+    if( depth() > m_max_depth ) m_max_depth = depth();
+
+    while( count < max )
+    {
+        // refill from the incoming stack, reversing it to queue order
+        if( !m_pending )
+        {
+            Chuck_VM_Object * list = NULL;
+            do { list = m_incoming; }
+            while( list && !ck_cas_ptr( (void * volatile *)&m_incoming, list, NULL ) );
+            if( !list ) break;
+            while( list )
+            {
+                obj = list;
+                list = list->m_free_next;
+                obj->m_free_next = m_pending;
+                m_pending = obj;
+            }
+        }
+
+        // pop
+        obj = m_pending;
+        m_pending = obj->m_free_next;
+        // count
+        t_CKUINT latency = now - obj->m_free_stamp;
+        m_latency_total += latency;
+        if( latency > m_latency_max ) m_latency_max = latency;
+        m_num_reclaimed++;
+        count++;
+        // delete it
+        delete obj;
+    }
+
+    return count;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: log_stats()
+// desc: log the reclaim counters
+//-----------------------------------------------------------------------------
+void Chuck_VM_Alloc::log_stats( t_CKINT level )
+{
+    if( !m_num_queued ) return;
+
+    EM_log( level, "deferred reclaim: %lu queued, %lu reclaimed, max depth %lu",
+        (t_CKUINT)m_num_queued, m_num_reclaimed, m_max_depth );
+    EM_log( level, "deferred reclaim latency: %.1f avg, %lu max (samples)",
+        m_num_reclaimed ? (t_CKFLOAT)m_latency_total / m_num_reclaimed : 0.0,
+        m_latency_max );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: Chuck_VM_Alloc()
 // desc: constructor
 //-----------------------------------------------------------------------------
 Chuck_VM_Alloc::Chuck_VM_Alloc()
-{ }
+{
+    m_deferred = FALSE;
+    m_incoming = NULL;
+    m_pending = NULL;
+    m_now = 0;
+    m_num_queued = 0;
+    m_num_reclaimed = 0;
+    m_max_depth = 0;
+    m_latency_total = 0;
+    m_latency_max = 0;
+}
 
 
 
@@ -272,6 +369,259 @@ Chuck_VM_Alloc::~Chuck_VM_Alloc()
 
 
 
+// size classes: 16 byte steps to 256, 64 to 512, 128 to 1024
+#define CK_POOL_NUM_CLASSES 24
+// minimum slab size
+#define CK_POOL_SLAB_SIZE 16384
+// blocks are at least this aligned
+#define CK_POOL_ALIGN 16
+
+const t_CKUINT Chuck_VM_Pool::MAX_BLOCK = 1024;
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_VM_Pool_Class
+// desc: one size class - free list of blocks carved from slabs
+//-----------------------------------------------------------------------------
+struct Chuck_VM_Pool_Class
+{
+    // next free block (first word of each free block links the next)
+    void * free_list;
+    // slabs owned by this class, linked through their first word
+    void * slabs;
+    // counters
+    Chuck_VM_Pool_Stats stats;
+    // lock (objects are made from the vm and compiler threads)
+    XMutex mutex;
+};
+
+// the classes, plus one more for the fallback (made on first use and never
+// freed, so objects released during static destruction are still safe)
+static Chuck_VM_Pool_Class * g_pool_classes = NULL;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pool_classes()
+// desc: first use is from the main thread, before the vm is started
+//-----------------------------------------------------------------------------
+static inline Chuck_VM_Pool_Class * pool_classes()
+{
+    if( !g_pool_classes )
+    {
+        g_pool_classes = new Chuck_VM_Pool_Class[CK_POOL_NUM_CLASSES + 1];
+        for( t_CKUINT i = 0; i <= CK_POOL_NUM_CLASSES; i++ )
+        {
+            g_pool_classes[i].free_list = NULL;
+            g_pool_classes[i].slabs = NULL;
+            memset( &g_pool_classes[i].stats, 0, sizeof(Chuck_VM_Pool_Stats) );
+        }
+    }
+
+    return g_pool_classes;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pool_class_index()
+// desc: size class for a block of size bytes
+//-----------------------------------------------------------------------------
+static inline t_CKUINT pool_class_index( t_CKUINT size )
+{
+    if( size <= 16 ) return 0;
+    if( size <= 256 ) return ( size + 15 ) / 16 - 1;
+    if( size <= 512 ) return 16 + ( size - 257 ) / 64;
+    return 20 + ( size - 513 ) / 128;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pool_class_size()
+// desc: block size of a size class
+//-----------------------------------------------------------------------------
+static inline t_CKUINT pool_class_size( t_CKUINT index )
+{
+    if( index < 16 ) return ( index + 1 ) * 16;
+    if( index < 20 ) return 256 + ( index - 15 ) * 64;
+    return 512 + ( index - 19 ) * 128;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: alloc()
+// desc: allocate size bytes (uninitialized)
+//-----------------------------------------------------------------------------
+void * Chuck_VM_Pool::alloc( t_CKUINT size )
+{
+    // too big for the pool
+    if( size > MAX_BLOCK )
+    {
+        Chuck_VM_Pool_Class & f = pool_classes()[CK_POOL_NUM_CLASSES];
+        void * ptr = malloc( size );
+        f.mutex.acquire();
+        f.stats.allocs++;
+        f.stats.bytes += size;
+        f.mutex.release();
+        return ptr;
+    }
+
+    Chuck_VM_Pool_Class & c = pool_classes()[pool_class_index( size )];
+    void * ptr = NULL;
+
+    c.mutex.acquire();
+    // out of blocks
+    if( !c.free_list )
+    {
+        t_CKUINT block = pool_class_size( pool_class_index( size ) );
+        // at least 16 blocks per slab; the header keeps blocks aligned
+        t_CKUINT count = CK_POOL_SLAB_SIZE / block;
+        if( count < 16 ) count = 16;
+        t_CKBYTE * slab = (t_CKBYTE *)malloc( CK_POOL_ALIGN + count * block );
+        if( !slab ) { c.mutex.release(); return NULL; }
+        // link the slab
+        *(void **)slab = c.slabs;
+        c.slabs = slab;
+        // carve it, back to front so blocks come out in address order
+        for( t_CKUINT i = count; i > 0; i-- )
+        {
+            void * b = slab + CK_POOL_ALIGN + ( i - 1 ) * block;
+            *(void **)b = c.free_list;
+            c.free_list = b;
+        }
+        // count
+        c.stats.slabs++;
+        c.stats.bytes += CK_POOL_ALIGN + count * block;
+    }
+    // pop
+    ptr = c.free_list;
+    c.free_list = *(void **)ptr;
+    c.stats.allocs++;
+    c.mutex.release();
+
+    return ptr;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: free()
+// desc: return a block from alloc(); size must match
+//-----------------------------------------------------------------------------
+void Chuck_VM_Pool::free( void * ptr, t_CKUINT size )
+{
+    if( !ptr ) return;
+
+    // from the system
+    if( size > MAX_BLOCK )
+    {
+        Chuck_VM_Pool_Class & f = pool_classes()[CK_POOL_NUM_CLASSES];
+        ::free( ptr );
+        f.mutex.acquire();
+        f.stats.frees++;
+        f.stats.bytes -= size;
+        f.mutex.release();
+        return;
+    }
+
+    Chuck_VM_Pool_Class & c = pool_classes()[pool_class_index( size )];
+
+    // push
+    c.mutex.acquire();
+    *(void **)ptr = c.free_list;
+    c.free_list = ptr;
+    c.stats.frees++;
+    c.mutex.release();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: get_stats()
+// desc: snapshot of the counters
+//-----------------------------------------------------------------------------
+void Chuck_VM_Pool::get_stats( std::vector<Chuck_VM_Pool_Stats> & out )
+{
+    Chuck_VM_Pool_Class * classes = pool_classes();
+
+    out.clear();
+    for( t_CKUINT i = 0; i <= CK_POOL_NUM_CLASSES; i++ )
+    {
+        classes[i].mutex.acquire();
+        out.push_back( classes[i].stats );
+        classes[i].mutex.release();
+        // the last one is the fallback
+        out.back().block_size = i < CK_POOL_NUM_CLASSES ? pool_class_size( i ) : 0;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: log_stats()
+// desc: log the classes in use and the fallback
+//-----------------------------------------------------------------------------
+void Chuck_VM_Pool::log_stats( t_CKINT level )
+{
+    if( !DO_LOG( level ) ) return;
+
+    std::vector<Chuck_VM_Pool_Stats> stats;
+    get_stats( stats );
+
+    EM_log( level, "vm object pool:" );
+    EM_pushlog();
+    for( t_CKUINT i = 0; i < stats.size(); i++ )
+    {
+        Chuck_VM_Pool_Stats & s = stats[i];
+        if( !s.allocs ) continue;
+        if( s.block_size )
+            EM_log( level, "%4lu bytes: %lu allocs, %lu frees, %lu slab(s), %lu bytes",
+                s.block_size, s.allocs, s.frees, s.slabs, s.bytes );
+        else
+            EM_log( level, "  system: %lu allocs, %lu frees, %lu bytes live",
+                s.allocs, s.frees, s.bytes );
+    }
+    EM_poplog();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: operator new()
+// desc: allocate objects from the pool
+//-----------------------------------------------------------------------------
+void * Chuck_Object::operator new( size_t size )
+{
+    void * ptr = Chuck_VM_Pool::alloc( size );
+    if( !ptr ) throw std::bad_alloc();
+    return ptr;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: operator delete()
+// desc: size is that of the most derived type (destructors are virtual)
+//-----------------------------------------------------------------------------
+void Chuck_Object::operator delete( void * ptr, size_t size )
+{
+    Chuck_VM_Pool::free( ptr, size );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: Chuck_Object()
 // desc: constructor
@@ -300,10 +650,15 @@ Chuck_Object::Chuck_Object()
 //-----------------------------------------------------------------------------
 Chuck_Object::~Chuck_Object()
 {
-    // free
-    if( vtable ) { delete vtable; vtable = NULL; }
+    // free (the virtual table is shared with the type)
+    vtable = NULL;
     if( type_ref ) { type_ref->release(); type_ref = NULL; }
-    if( data ) { delete [] data; size = 0; data = NULL; }
+    if( data )
+    {
+        if( m_pooled ) Chuck_VM_Pool::free( data, size );
+        else delete [] data;
+        size = 0; data = NULL;
+    }
 }
 
 
@@ -1291,6 +1646,19 @@ void Chuck_Array16::zero( t_CKUINT start, t_CKUINT end )
 // static
 t_CKUINT Chuck_Event::our_can_wait = 0;
 
+//-----------------------------------------------------------------------------
+// name: Chuck_Event()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_Event::Chuck_Event()
+{
+    m_queue_head = NULL;
+    m_queue_tail = NULL;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: signal()
 // desc: signal a event/condition variable, shreduling the next waiting shred
@@ -1299,21 +1667,17 @@ t_CKUINT Chuck_Event::our_can_wait = 0;
 void Chuck_Event::signal()
 {
     m_queue_lock.acquire();
-    if( !m_queue.empty() )
+    Chuck_VM_Shred * shred = m_queue_head;
+    if( shred )
     {
-        Chuck_VM_Shred * shred = m_queue.front();
-        m_queue.pop();
-        m_queue_lock.release();
-        Chuck_VM_Shreduler * shreduler = shred->vm_ref->shreduler();
-        shred->event = NULL;
-        shreduler->remove_blocked( shred );
-        shreduler->shredule( shred );
-        // push the current time
-        t_CKTIME *& sp = (t_CKTIME *&)shred->reg->sp;
-        push_( sp, shreduler->now_system );
+        m_queue_head = shred->event_next;
+        if( m_queue_head ) m_queue_head->event_prev = NULL;
+        else m_queue_tail = NULL;
+        shred->event_next = NULL;
     }
-    else
-        m_queue_lock.release();
+    m_queue_lock.release();
+
+    if( shred ) shred->vm_ref->shreduler()->wake( shred );
 }
 
 
@@ -1325,23 +1689,23 @@ void Chuck_Event::signal()
 //-----------------------------------------------------------------------------
 t_CKBOOL Chuck_Event::remove( Chuck_VM_Shred * shred )
 {
-    queue<Chuck_VM_Shred *> temp;
-    t_CKBOOL removed = FALSE;
     m_queue_lock.acquire();
-    while( !m_queue.empty() )
+    if( shred->event != this )
     {
-        if( m_queue.front() != shred )
-            temp.push( m_queue.front() );
-        else {
-            shred->event = NULL;
-            removed = TRUE;
-        }
-        m_queue.pop();
+        m_queue_lock.release();
+        return FALSE;
     }
 
-    m_queue = temp;
+    // unlink
+    if( shred->event_prev ) shred->event_prev->event_next = shred->event_next;
+    else m_queue_head = shred->event_next;
+    if( shred->event_next ) shred->event_next->event_prev = shred->event_prev;
+    else m_queue_tail = shred->event_prev;
+    shred->event_prev = shred->event_next = NULL;
+    shred->event = NULL;
+
     m_queue_lock.release();
-    return removed;
+    return TRUE;
 }
 
 
@@ -1356,11 +1720,11 @@ void Chuck_Event::queue_broadcast()
 {
     // TODO: handle multiple VM
     m_queue_lock.acquire();
-    if( !m_queue.empty() )
+    if( m_queue_head )
     {
-        Chuck_VM_Shred * shred = m_queue.front();
+        Chuck_VM * vm = m_queue_head->vm_ref;
         m_queue_lock.release();
-        shred->vm_ref->queue_event( this, 1 );
+        vm->queue_event( this, 1 );
     }
     else
         m_queue_lock.release();
@@ -1372,18 +1736,17 @@ void Chuck_Event::queue_broadcast()
 
 //-----------------------------------------------------------------------------
 // name: broadcast()
-// desc: broadcast a event/condition variable, shreduling all waiting shreds
+// desc: broadcast a event/condition variable, shreduling all waiting shreds;
+//       the whole wait list is taken at once, and shreduled as a batch
 //-----------------------------------------------------------------------------
 void Chuck_Event::broadcast()
 {
     m_queue_lock.acquire();
-    while( !m_queue.empty() )
-    {
-        m_queue_lock.release();
-        this->signal();
-        m_queue_lock.acquire();
-    }
+    Chuck_VM_Shred * list = m_queue_head;
+    m_queue_head = m_queue_tail = NULL;
     m_queue_lock.release();
+
+    if( list ) list->vm_ref->shreduler()->wake( list );
 }
 
 
@@ -1412,13 +1775,16 @@ void Chuck_Event::wait( Chuck_VM_Shred * shred, Chuck_VM * vm )
         shred->is_running = FALSE;
 
         // add to waiting list
+        assert( shred->event == NULL );
         m_queue_lock.acquire();
-        m_queue.push( shred );
-        m_queue_lock.release();
-
+        shred->event_prev = m_queue_tail;
+        shred->event_next = NULL;
+        if( m_queue_tail ) m_queue_tail->event_next = shred;
+        else m_queue_head = shred;
+        m_queue_tail = shred;
         // add event to shred
-        assert( shred->event == NULL );
         shred->event = this;
+        m_queue_lock.release();
 
         // add shred to shreduler
         vm->shreduler()->add_blocked( shred );
@@ -86,13 +86,17 @@ public:
     static t_CKBOOL our_locks_in_effect;
 
 public:
-    t_CKUINT m_ref_count; // reference count
-    t_CKBOOL m_pooled; // if true, this allocates from a pool
+    t_CKUINT m_ref_count; // reference count (changed atomically)
+    t_CKBOOL m_pooled; // if true, the data segment is from Chuck_VM_Pool
     t_CKBOOL m_locked; // if true, this should never be deleted
 
 public:
     // where
     std::vector<Chuck_VM_Object *> * m_v_ref;
+    // next in the reclaim queue (see Chuck_VM_Alloc)
+    Chuck_VM_Object * m_free_next;
+    // sample count when queued
+    t_CKUINT m_free_stamp;
     
 private:
     void init_ref();
@@ -114,6 +118,30 @@ public:
     void add_object( Chuck_VM_Object * obj );
     void free_object( Chuck_VM_Object * obj );
 
+public:
+    // deferred reclamation: when on, free_object() only queues the object
+    // (lock-free, from any thread) and reclaim() destroys it later
+    void set_deferred( t_CKBOOL deferred ) { m_deferred = deferred; }
+    t_CKBOOL deferred() const { return m_deferred; }
+    // destroy up to max queued objects, in queue order (vm thread only);
+    // now is in samples and dates the queue; returns number destroyed
+    t_CKUINT reclaim( t_CKUINT max, t_CKUINT now );
+    // objects queued and not yet destroyed
+    t_CKUINT depth() const { return m_num_queued - m_num_reclaimed; }
+    // log the counters
+    void log_stats( t_CKINT level );
+
+public: // counters
+    // total queued
+    volatile t_CKUINT m_num_queued;
+    // total destroyed by reclaim()
+    t_CKUINT m_num_reclaimed;
+    // largest depth seen by reclaim()
+    t_CKUINT m_max_depth;
+    // samples between queue and destroy, summed and max
+    t_CKUINT m_latency_total;
+    t_CKUINT m_latency_max;
+
 protected:
     static Chuck_VM_Alloc * our_instance;
 
@@ -123,6 +151,60 @@ protected:
 
 protected: // data
     std::map<Chuck_VM_Object *, void *> m_objects;
+    // deferred mode
+    t_CKBOOL m_deferred;
+    // stack pushed by free_object() (newest first)
+    Chuck_VM_Object * volatile m_incoming;
+    // queue drained by reclaim() (oldest first)
+    Chuck_VM_Object * m_pending;
+    // last now passed to reclaim()
+    t_CKUINT m_now;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_VM_Pool_Stats
+// desc: allocation counters for one size class of the vm object pool
+//-----------------------------------------------------------------------------
+struct Chuck_VM_Pool_Stats
+{
+    // block size in bytes (0 for the system allocator fallback)
+    t_CKUINT block_size;
+    // number of allocations
+    t_CKUINT allocs;
+    // number of frees
+    t_CKUINT frees;
+    // number of slabs carved (0 for the fallback)
+    t_CKUINT slabs;
+    // bytes held in slabs, or currently live for the fallback
+    t_CKUINT bytes;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_VM_Pool
+// desc: size-class slab allocator for vm objects and their data segments;
+//       freed blocks go back on their class's free list and slabs are never
+//       returned, so steady-state allocation does not reach the system
+//       allocator; requests above the largest class fall through to malloc
+//-----------------------------------------------------------------------------
+struct Chuck_VM_Pool
+{
+public:
+    static void * alloc( t_CKUINT size );
+    static void free( void * ptr, t_CKUINT size );
+
+public:
+    // largest pooled block, in bytes
+    static const t_CKUINT MAX_BLOCK;
+    // fill with one entry per size class, followed by the fallback
+    static void get_stats( std::vector<Chuck_VM_Pool_Stats> & out );
+    // log a summary
+    static void log_stats( t_CKINT level );
 };
 
 
@@ -151,6 +233,11 @@ public:
     Chuck_Object();
     virtual ~Chuck_Object();
 
+public:
+    // objects come from Chuck_VM_Pool
+    static void * operator new( size_t size );
+    static void operator delete( void * ptr, size_t size );
+
 public:
     // virtual table
     Chuck_VTable * vtable;
@@ -323,6 +410,9 @@ public:
 //-----------------------------------------------------------------------------
 struct Chuck_Event : Chuck_Object
 {
+public:
+    Chuck_Event();
+
 public:
     void signal();
     void broadcast();
@@ -333,7 +423,9 @@ public: // internal
     void queue_broadcast();
     static t_CKUINT our_can_wait;
 
-    std::queue<Chuck_VM_Shred *> m_queue;
+    // waiting shreds, first to last (linked through their event_next)
+    Chuck_VM_Shred * m_queue_head;
+    Chuck_VM_Shred * m_queue_tail;
     XMutex m_queue_lock;
 };
 
@@ -34,8 +34,10 @@
 #include "chuck_compile.h"
 #include "chuck_errmsg.h"
 #include "chuck_globals.h"
+#include "chuck_instr.h"
 #include "util_thread.h"
 #include "util_string.h"
+#include "util_buffers.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -45,6 +47,9 @@
 
 #ifndef __PLATFORM_WIN32__
 #include <unistd.h>
+#include <sys/time.h>
+#else
+#include <windows.h>
 #endif
 
 using namespace std;
@@ -54,6 +59,12 @@ using namespace std;
 // log level
 t_CKUINT g_otf_log = CK_LOG_INFO;
 
+// one compile at a time: the parser and the type environment are shared
+// by the compiler thread, the otf listener, and synchronous compiles; only
+// a compile changes the environment, so each one sees it as the last left
+// it (the compiler's m_env_version), while the VM runs on
+static XMutex g_compile_lock;
+
 
 
 
@@ -133,6 +144,56 @@ error:
 
 
 
+//-----------------------------------------------------------------------------
+// name: otf_clock()
+// desc: wall clock, in seconds
+//-----------------------------------------------------------------------------
+static t_CKFLOAT otf_clock()
+{
+#if defined(__PLATFORM_WIN32__)
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &freq );
+    return (t_CKFLOAT)count.QuadPart / (t_CKFLOAT)freq.QuadPart;
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: otf_compile()
+// desc: parse, type-check, and emit a file (fd may be NULL), holding the
+//       compile lock; logs how long it waited and took
+//-----------------------------------------------------------------------------
+static Chuck_VM_Code * otf_compile( Chuck_Compiler * compiler,
+                                    const char * filename, FILE * fd )
+{
+    Chuck_VM_Code * code = NULL;
+    t_CKFLOAT start = otf_clock();
+
+    g_compile_lock.acquire();
+    t_CKFLOAT locked = otf_clock();
+    t_CKUINT version = compiler->m_env_version;
+    // get the code (named by the compiler, and maybe shared with the cache)
+    if( compiler->go( filename, fd ) )
+        code = compiler->output();
+    g_compile_lock.release();
+
+    EM_log( CK_LOG_INFO, "(via otf): compiled '%s' against public classes v%lu in %.2f ms (waited %.2f ms)%s",
+            mini(filename), version, (otf_clock() - locked) * 1000.0,
+            (locked - start) * 1000.0, code ? "" : ", failed" );
+
+    return code;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: otf_process_msg()
 // desc: ...
@@ -183,17 +244,13 @@ t_CKUINT otf_process_msg( Chuck_VM * vm, Chuck_Compiler * compiler,
         }
 
         // parse, type-check, and emit
-        if( !compiler->go( msg->buffer, fd ) )
+        code = otf_compile( compiler, msg->buffer, fd );
+        if( !code )
         {
             SAFE_DELETE(cmd);
             goto cleanup;
         }
 
-        // get the code
-        code = compiler->output();
-        // name it
-        code->name += string(msg->buffer);
-
         // set the flags for the command
         cmd->type = msg->type;
         cmd->code = code;
@@ -233,6 +290,10 @@ t_CKUINT otf_process_msg( Chuck_VM * vm, Chuck_Compiler * compiler,
         ret = 1;
     }
 
+    // the compiler's part of the status (doesn't wait for a compile)
+    if( msg->type == MSG_STATUS && compiler )
+        compiler->cache_status();
+
 cleanup:
     // close file handle
     if( fd ) fclose( fd );
@@ -243,6 +304,207 @@ cleanup:
 
 
 
+//-----------------------------------------------------------------------------
+// name: struct Otf_Compile_Job
+// desc: an add/replace waiting for the compiler thread
+//-----------------------------------------------------------------------------
+struct Otf_Compile_Job
+{
+    Net_Msg msg;
+    Chuck_VM_Shred * shred;
+    Chuck_Event * event;
+};
+
+// compiler thread state
+static Chuck_VM * g_compile_vm = NULL;
+static Chuck_Compiler * g_compile_compiler = NULL;
+static XThread * g_compile_thread = NULL;
+static XSemaphore * g_compile_wake = NULL;
+static XSemaphore * g_compile_exit = NULL;
+static CBufferSimple * g_compile_jobs = NULL;
+static volatile t_CKBOOL g_compile_quit = FALSE;
+// queue length
+#define OTF_COMPILE_JOBS 256
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: otf_compile_job()
+// desc: compile one job, and queue the result (or the failure) for the VM
+//-----------------------------------------------------------------------------
+static void otf_compile_job( Otf_Compile_Job * job )
+{
+    Chuck_Msg * cmd = new Chuck_Msg;
+    string filename;
+    vector<string> args;
+
+    cmd->type = job->msg.type;
+    cmd->param = job->msg.param;
+    cmd->caller = job->shred;
+    cmd->caller_event = job->event;
+
+    // parse out command line arguments
+    if( !extract_args( job->msg.buffer, filename, args ) )
+    {
+        // error
+        fprintf( stderr, "[chuck]: malformed filename with argument list...\n" );
+        fprintf( stderr, "    -->  '%s'", job->msg.buffer );
+    }
+    else
+    {
+        if( args.size() > 0 ) cmd->set( args );
+        // compile (NULL code tells the VM it failed)
+        cmd->code = otf_compile( g_compile_compiler, filename.c_str(), NULL );
+    }
+
+    // hand to the VM
+    while( !g_compile_vm->queue_msg( cmd, 1 ) )
+    {
+        // stopping: the VM is done with the shred
+        if( g_compile_quit )
+        {
+            SAFE_RELEASE( cmd->caller_event );
+            SAFE_RELEASE( cmd->caller );
+            SAFE_DELETE( cmd );
+            break;
+        }
+        usleep( 1000 );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: otf_compile_cb()
+// desc: compiler thread
+//-----------------------------------------------------------------------------
+static THREAD_RETURN THREAD_TYPE otf_compile_cb( void * data )
+{
+    Otf_Compile_Job * job = NULL;
+
+    while( !g_compile_quit )
+    {
+        g_compile_wake->wait();
+        while( !g_compile_quit && g_compile_jobs->get( &job, 1 ) )
+        {
+            otf_compile_job( job );
+            SAFE_DELETE( job );
+        }
+    }
+
+    g_compile_exit->post();
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: otf_compile_start()
+// desc: start the compiler thread
+//-----------------------------------------------------------------------------
+t_CKBOOL otf_compile_start( Chuck_VM * vm, Chuck_Compiler * compiler )
+{
+    if( g_compile_thread ) return TRUE;
+
+    g_compile_vm = vm;
+    g_compile_compiler = compiler;
+    g_compile_quit = FALSE;
+    g_compile_wake = new XSemaphore( 0, 1 );
+    g_compile_exit = new XSemaphore;
+    g_compile_jobs = new CBufferSimple;
+    g_compile_jobs->initialize( OTF_COMPILE_JOBS, sizeof(Otf_Compile_Job *) );
+    g_compile_thread = new XThread;
+    if( !g_compile_thread->start( otf_compile_cb, NULL ) )
+    {
+        EM_log( CK_LOG_SYSTEM, "cannot start compiler thread; compiling synchronously" );
+        g_compile_thread->clear();
+        SAFE_DELETE( g_compile_thread );
+        SAFE_DELETE( g_compile_jobs );
+        SAFE_DELETE( g_compile_exit );
+        SAFE_DELETE( g_compile_wake );
+        return FALSE;
+    }
+
+    EM_log( CK_LOG_SYSTEM, "compiler thread: ON" );
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: otf_compile_stop()
+// desc: stop the compiler thread, after the compile in progress; jobs
+//       still queued are dropped
+//-----------------------------------------------------------------------------
+void otf_compile_stop( )
+{
+    if( !g_compile_thread ) return;
+
+    g_compile_quit = TRUE;
+    g_compile_wake->post();
+    g_compile_exit->wait();
+    // exited on its own
+    g_compile_thread->clear();
+    SAFE_DELETE( g_compile_thread );
+
+    // the VM is done with shreds by now
+    Otf_Compile_Job * job = NULL;
+    while( g_compile_jobs->get( &job, 1 ) )
+    {
+        SAFE_RELEASE( job->event );
+        SAFE_RELEASE( job->shred );
+        SAFE_DELETE( job );
+    }
+
+    SAFE_DELETE( g_compile_jobs );
+    SAFE_DELETE( g_compile_exit );
+    SAFE_DELETE( g_compile_wake );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: otf_compile_async()
+// desc: (VM thread) queue an add/replace for the compiler thread, and
+//       make the shred wait on an event for the result
+//-----------------------------------------------------------------------------
+t_CKBOOL otf_compile_async( Net_Msg * msg, Chuck_VM_Shred * shred )
+{
+    if( !g_compile_thread || !shred ) return FALSE;
+    if( msg->type != MSG_ADD && msg->type != MSG_REPLACE ) return FALSE;
+
+    Chuck_Event * event = (Chuck_Event *)instantiate_and_initialize_object( &t_event, shred );
+    if( !event ) return FALSE;
+    // held until the VM resumes the shred
+    event->add_ref();
+    shred->add_ref();
+
+    Otf_Compile_Job * job = new Otf_Compile_Job;
+    job->msg = *msg;
+    job->shred = shred;
+    job->event = event;
+    if( !g_compile_jobs->put( &job, 1 ) )
+    {
+        SAFE_DELETE( job );
+        event->release();
+        shred->release();
+        return FALSE;
+    }
+
+    // wait (the result is handled on this thread, so not before this)
+    event->wait( shred, shred->vm_ref );
+    g_compile_wake->post();
+    return TRUE;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: otf_send_file()
 // desc: ...
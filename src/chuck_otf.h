@@ -47,6 +47,7 @@
 // forward
 struct Chuck_VM;
 struct Chuck_Compiler;
+struct Chuck_VM_Shred;
 
 
 //-----------------------------------------------------------------------------
@@ -77,6 +78,13 @@ void otf_ntoh( Net_Msg * msg );
 // process incoming message
 t_CKUINT otf_process_msg( Chuck_VM * vm, Chuck_Compiler * compiler, 
                           Net_Msg * msg, t_CKBOOL immediate, void * data );
+// start/stop the compiler thread (for Machine.add/replace)
+t_CKBOOL otf_compile_start( Chuck_VM * vm, Chuck_Compiler * compiler );
+void otf_compile_stop( );
+// compile an add/replace on the compiler thread; the shred (in a native
+// call returning int) waits, and gets the result when the VM takes the
+// code; FALSE if the compiler thread is not running
+t_CKBOOL otf_compile_async( Net_Msg * msg, Chuck_VM_Shred * shred );
 
 // send command
 int otf_send_cmd( int argc, const char ** argv, t_CKINT & i, const char * host, int port, int * is_otf = NULL );
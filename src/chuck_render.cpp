@@ -0,0 +1,277 @@
+/*----------------------------------------------------------------------------
+    ChucK Concurrent, On-the-fly Audio Programming Language
+      Compiler and Virtual Machine
+
+    Copyright (c) 2004 Ge Wang and Perry R. Cook.  All rights reserved.
+      http://chuck.cs.princeton.edu/
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// file: chuck_render.cpp
+// desc: offline rendering of the dac to a sound file
+//-----------------------------------------------------------------------------
+#include "chuck_render.h"
+#include "chuck_errmsg.h"
+
+#include <string.h>
+
+#if defined(__CK_SNDFILE_NATIVE__)
+#include <sndfile.h>
+#else
+#include "util_sndfile.h"
+#endif
+
+#if defined(__PLATFORM_WIN32__)
+  #include <windows.h>
+#else
+  #include <sys/time.h>
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: render_clock()
+// desc: wall clock, in seconds
+//-----------------------------------------------------------------------------
+static t_CKFLOAT render_clock()
+{
+#if defined(__PLATFORM_WIN32__)
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &freq );
+    return (t_CKFLOAT)count.QuadPart / (t_CKFLOAT)freq.QuadPart;
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: Chuck_Render()
+// desc: constructor
+//-----------------------------------------------------------------------------
+Chuck_Render::Chuck_Render()
+    : m_free( CK_RENDER_NUM_BLOCKS - 1 )
+{
+    m_file = NULL;
+    m_srate = 0;
+    m_num_channels = 0;
+    memset( m_blocks, 0, sizeof(m_blocks) );
+    memset( m_counts, 0, sizeof(m_counts) );
+    m_fill = 0;
+    m_count = 0;
+    m_frames = 0;
+    m_writer_ok = FALSE;
+    m_errors = 0;
+    m_start = 0;
+    m_elapsed = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~Chuck_Render()
+// desc: destructor
+//-----------------------------------------------------------------------------
+Chuck_Render::~Chuck_Render()
+{
+    this->close();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: open()
+// desc: open a 16-bit WAV file and start the writer thread
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_Render::open( const std::string & filename, t_CKUINT srate,
+                             t_CKUINT num_channels )
+{
+    SF_INFO info;
+
+    // already open
+    if( m_file ) return FALSE;
+
+    // open the file
+    memset( &info, 0, sizeof(info) );
+    info.samplerate = (int)srate;
+    info.channels = (int)num_channels;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+    SNDFILE * file = sf_open( filename.c_str(), SFM_WRITE, &info );
+    if( !file )
+    {
+        EM_error2( 0, "render: cannot open '%s': %s", filename.c_str(),
+                   sf_strerror( NULL ) );
+        return FALSE;
+    }
+    // clip rather than wrap
+    sf_command( file, SFC_SET_CLIPPING, NULL, SF_TRUE );
+
+    m_file = file;
+    m_filename = filename;
+    m_srate = srate;
+    m_num_channels = num_channels;
+    // allocate blocks
+    for( t_CKUINT i = 0; i < CK_RENDER_NUM_BLOCKS; i++ )
+    {
+        m_blocks[i] = new SAMPLE[CK_RENDER_BLOCK_FRAMES * num_channels];
+        m_counts[i] = 0;
+    }
+    m_fill = 0;
+    m_count = 0;
+    m_frames = 0;
+    m_errors = 0;
+
+    // start the writer
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    m_writer_ok = pthread_create( &m_writer, NULL, writer_cb, this ) == 0;
+#elif defined(__PLATFORM_WIN32__)
+    unsigned thread_id;
+    m_writer = _beginthreadex( NULL, 0, writer_cb, this, 0, &thread_id );
+    m_writer_ok = m_writer != 0;
+#endif
+    if( !m_writer_ok )
+    {
+        EM_error2( 0, "render: cannot start writer thread" );
+        this->close();
+        return FALSE;
+    }
+
+    // log
+    EM_log( CK_LOG_SYSTEM, "rendering to '%s' (%lu channels, %lu Hz)...",
+            filename.c_str(), num_channels, srate );
+
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: flush()
+// desc: hand the current block to the writer, take the next free one
+//-----------------------------------------------------------------------------
+void Chuck_Render::flush()
+{
+    m_counts[m_fill] = m_count;
+    m_frames += m_count;
+    m_count = 0;
+    m_full.post();
+
+    // wait for the oldest block to be written
+    m_free.wait();
+    m_fill = ( m_fill + 1 ) % CK_RENDER_NUM_BLOCKS;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: close()
+// desc: write what is left, stop the writer, and close the file
+//-----------------------------------------------------------------------------
+void Chuck_Render::close()
+{
+    if( !m_file ) return;
+
+    if( m_writer_ok )
+    {
+        // last partial block
+        if( m_count ) this->flush();
+        // an empty block tells the writer to stop
+        m_counts[m_fill] = 0;
+        m_full.post();
+        // join it
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+        pthread_join( m_writer, NULL );
+#elif defined(__PLATFORM_WIN32__)
+        WaitForSingleObject( (HANDLE)m_writer, INFINITE );
+        CloseHandle( (HANDLE)m_writer );
+#endif
+        m_writer_ok = FALSE;
+    }
+
+    // stop the clock
+    if( m_start > 0 ) m_elapsed = render_clock() - m_start;
+
+    sf_close( (SNDFILE *)m_file );
+    m_file = NULL;
+
+    // report
+    if( m_errors )
+        EM_error2( 0, "render: %lu write error(s) on '%s'", m_errors, m_filename.c_str() );
+
+    // free blocks
+    for( t_CKUINT i = 0; i < CK_RENDER_NUM_BLOCKS; i++ )
+        SAFE_DELETE_ARRAY( m_blocks[i] );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: start_clock()
+// desc: ...
+//-----------------------------------------------------------------------------
+void Chuck_Render::start_clock()
+{
+    m_start = render_clock();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: writer_cb()
+// desc: writer thread - appends full blocks in order
+//-----------------------------------------------------------------------------
+THREAD_RETURN THREAD_TYPE Chuck_Render::writer_cb( void * data )
+{
+    Chuck_Render * render = (Chuck_Render *)data;
+    SNDFILE * file = (SNDFILE *)render->m_file;
+    t_CKUINT w = 0, n;
+
+    while( true )
+    {
+        // wait for a block
+        render->m_full.wait();
+        n = render->m_counts[w];
+        // done
+        if( !n ) break;
+        // write it
+#if defined(CK_S_DOUBLE)
+        if( sf_writef_double( file, render->m_blocks[w], n ) != (sf_count_t)n )
+#else
+        if( sf_writef_float( file, render->m_blocks[w], n ) != (sf_count_t)n )
+#endif
+            render->m_errors++;
+        // give it back
+        w = ( w + 1 ) % CK_RENDER_NUM_BLOCKS;
+        render->m_free.post();
+    }
+
+    return 0;
+}
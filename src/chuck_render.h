@@ -0,0 +1,112 @@
+/*----------------------------------------------------------------------------
+    ChucK Concurrent, On-the-fly Audio Programming Language
+      Compiler and Virtual Machine
+
+    Copyright (c) 2004 Ge Wang and Perry R. Cook.  All rights reserved.
+      http://chuck.cs.princeton.edu/
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// file: chuck_render.h
+// desc: offline rendering of the dac to a sound file
+//-----------------------------------------------------------------------------
+#ifndef __CHUCK_RENDER_H__
+#define __CHUCK_RENDER_H__
+
+#include "chuck_def.h"
+#include "util_thread.h"
+#include <string>
+
+
+// frames per block handed to the writer
+#define CK_RENDER_BLOCK_FRAMES 8192
+// blocks in flight
+#define CK_RENDER_NUM_BLOCKS 8
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_Render
+// desc: collects dac frames into blocks, which a writer thread appends to
+//       a WAV file; the vm only waits if the disk falls NUM_BLOCKS behind
+//-----------------------------------------------------------------------------
+struct Chuck_Render
+{
+public:
+    Chuck_Render();
+    ~Chuck_Render();
+
+public:
+    // open the file and start the writer
+    t_CKBOOL open( const std::string & filename, t_CKUINT srate,
+                   t_CKUINT num_channels );
+    // flush, stop the writer, and close the file
+    void close();
+    // append one frame of num_channels samples
+    inline void tick( const SAMPLE * frame )
+    {
+        SAMPLE * p = m_blocks[m_fill] + m_count * m_num_channels;
+        for( t_CKUINT i = 0; i < m_num_channels; i++ ) p[i] = frame[i];
+        if( ++m_count == CK_RENDER_BLOCK_FRAMES ) this->flush();
+    }
+
+public:
+    // start the clock, and report speed on close
+    void start_clock();
+    // frames appended
+    t_CKUINT frames() const { return m_frames + m_count; }
+    const std::string & filename() const { return m_filename; }
+    // wall clock seconds from start_clock() to close()
+    t_CKFLOAT elapsed() const { return m_elapsed; }
+
+protected:
+    // hand the current block to the writer, take the next free one
+    void flush();
+    static THREAD_RETURN THREAD_TYPE writer_cb( void * data );
+
+protected:
+    std::string m_filename;
+    void * m_file;
+    t_CKUINT m_srate;
+    t_CKUINT m_num_channels;
+    // blocks, and the number of frames in each
+    SAMPLE * m_blocks[CK_RENDER_NUM_BLOCKS];
+    t_CKUINT m_counts[CK_RENDER_NUM_BLOCKS];
+    // block being filled, and frames in it
+    t_CKUINT m_fill;
+    t_CKUINT m_count;
+    // frames in blocks already handed off
+    t_CKUINT m_frames;
+    // writer handoff
+    XSemaphore m_full;
+    XSemaphore m_free;
+    THREAD_HANDLE m_writer;
+    t_CKBOOL m_writer_ok;
+    // write errors seen by the writer
+    t_CKUINT m_errors;
+    // wall clock at start_clock(), and time to close()
+    t_CKFLOAT m_start;
+    t_CKFLOAT m_elapsed;
+};
+
+
+
+
+#endif
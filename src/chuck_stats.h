@@ -41,6 +41,7 @@
 #if defined(__CHUCK_STAT_TRACK__)
 
 #include "util_thread.h"
+#include "chuck_oo.h"
 
 #include <string>
 #include <map>
@@ -177,6 +178,11 @@ public:
                      std::map<Shred_Stat *, Shred_Stat *> & d );
     static t_CKBOOL activations_yes;
 
+public:
+    // vm object pool counters (see Chuck_VM_Pool)
+    void get_alloc_stats( std::vector<Chuck_VM_Pool_Stats> & out )
+    { Chuck_VM_Pool::get_stats( out ); }
+
 protected:
     Chuck_Stats();
     ~Chuck_Stats();
@@ -4774,10 +4774,13 @@ Chuck_Type * type_engine_import_ugen_begin( Chuck_Env * env, const char * name,
     info = new Chuck_UGen_Info;
     info->add_ref();
     info->tick = type->parent->ugen_info->tick;
+    info->tickf = type->parent->ugen_info->tickf;
     info->pmsg = type->parent->ugen_info->pmsg;
     info->num_ins = type->parent->ugen_info->num_ins;
     info->num_outs = type->parent->ugen_info->num_outs;
-    if( tick ) info->tick = tick;
+    info->serial = type->parent->ugen_info->serial;
+    // a new tick invalidates the parent's block tick
+    if( tick ) { info->tick = tick; info->tickf = NULL; }
     if( pmsg ) info->pmsg = pmsg;
     if( num_ins != 0xffffffff ) info->num_ins = num_ins;
     if( num_outs != 0xffffffff ) info->num_outs = num_outs;
@@ -4790,6 +4793,54 @@ Chuck_Type * type_engine_import_ugen_begin( Chuck_Env * env, const char * name,
 
 
 
+//-----------------------------------------------------------------------------
+// name: type_engine_import_ugen_tickf()
+// desc: set the block tick for the ugen being imported; it must produce the
+//       same output as calling tick once per frame
+//-----------------------------------------------------------------------------
+t_CKBOOL type_engine_import_ugen_tickf( Chuck_Env * env, f_tickf tickf )
+{
+    // make sure there is a ugen class
+    if( !env->class_def || !env->class_def->ugen_info )
+    {
+        // error
+        EM_error2( 0, "import error: import_ugen_tickf invoked without ugen_begin..." );
+        return FALSE;
+    }
+
+    // set
+    env->class_def->ugen_info->tickf = tickf;
+
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: type_engine_import_ugen_serial()
+// desc: mark the ugen being imported as touching state shared between
+//       instances, so parallel rendering keeps it in order
+//-----------------------------------------------------------------------------
+t_CKBOOL type_engine_import_ugen_serial( Chuck_Env * env )
+{
+    // make sure there is a ugen class
+    if( !env->class_def || !env->class_def->ugen_info )
+    {
+        // error
+        EM_error2( 0, "import error: import_ugen_serial invoked without ugen_begin..." );
+        return FALSE;
+    }
+
+    // set
+    env->class_def->ugen_info->serial = TRUE;
+
+    return TRUE;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: type_engine_import_uana_begin()
 // desc: ...
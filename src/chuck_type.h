@@ -455,12 +455,17 @@ struct Chuck_UGen_Info : public Chuck_VM_Object
 {
     // tick function pointer
     f_tick tick;
+    // block tick function pointer (optional)
+    f_tickf tickf;
     // pmsg function pointer
     f_pmsg pmsg;
     // number of incoming channels
     t_CKUINT num_ins;
     // number of outgoing channels
     t_CKUINT num_outs;
+    // tick uses state shared between instances (e.g. rand()), so ticks
+    // of all such ugens must stay in order
+    t_CKBOOL serial;
     
     // for uana, NULL for ugen
     f_tock tock;
@@ -471,7 +476,7 @@ struct Chuck_UGen_Info : public Chuck_VM_Object
 
     // constructor
     Chuck_UGen_Info()
-    { tick = NULL; pmsg = NULL; num_ins = num_outs = 1; 
+    { tick = NULL; tickf = NULL; pmsg = NULL; num_ins = num_outs = 1; serial = FALSE;
       tock = NULL; num_ins_ana = num_outs_ana = 1; }
 };
 
@@ -752,6 +757,8 @@ Chuck_Type * type_engine_import_uana_begin( Chuck_Env * env, const char * name,
                                             f_tick tick, f_tock tock, f_pmsg pmsg,
                                             t_CKUINT num_ins = 0xffffffff, t_CKUINT num_outs = 0xffffffff,
                                             t_CKUINT num_ins_ana = 0xffffffff, t_CKUINT num_outs_ana = 0xffffffff );
+t_CKBOOL type_engine_import_ugen_tickf( Chuck_Env * env, f_tickf tickf );
+t_CKBOOL type_engine_import_ugen_serial( Chuck_Env * env );
 t_CKBOOL type_engine_import_mfun( Chuck_Env * env, Chuck_DL_Func * mfun );
 t_CKBOOL type_engine_import_sfun( Chuck_Env * env, Chuck_DL_Func * sfun );
 t_CKUINT type_engine_import_mvar( Chuck_Env * env, const char * type, 
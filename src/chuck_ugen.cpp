@@ -34,10 +34,87 @@
 #include "chuck_ugen.h"
 #include "chuck_vm.h"
 #include "chuck_lang.h"
+#include "chuck_type.h"
 #include "chuck_errmsg.h"
+#include "util_simd.h"
 using namespace std;
 
 
+// graph version, see Chuck_UGen_Schedule
+t_CKUINT Chuck_UGen::our_graph_version = 1;
+Chuck_UGen_Schedule * Chuck_UGen::our_schedule = NULL;
+t_CKBOOL Chuck_UGen::our_schedule_check = FALSE;
+// schedule build counter, to mark visited ugens
+static t_CKUINT g_sched_pass = 0;
+// removals held back while a multi-channel remove() is half done
+static t_CKUINT g_graph_holding = 0;
+static std::vector< std::pair<Chuck_UGen *, Chuck_UGen *> > g_graph_held;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: graph_changed()
+// desc: connection src -> dst was added or removed (dst NULL: src is going
+//       away); every schedule is out of date, except the live one if it was
+//       up to date and can patch itself
+//-----------------------------------------------------------------------------
+static void graph_changed( Chuck_UGen * src, Chuck_UGen * dst, t_CKBOOL added )
+{
+    Chuck_UGen_Schedule * live = Chuck_UGen::our_schedule;
+    t_CKBOOL patch = live && live->m_version == Chuck_UGen::our_graph_version;
+    t_CKBOOL ok = FALSE;
+
+    // later (keeping src), when the other channels have let go too
+    if( g_graph_holding && dst && !added )
+    {
+        src->add_ref();
+        g_graph_held.push_back( std::pair<Chuck_UGen *, Chuck_UGen *>( src, dst ) );
+        return;
+    }
+
+    Chuck_UGen::our_graph_version++;
+    if( !patch ) return;
+
+    if( !dst ) ok = !live->has( src );
+    else if( added ) ok = live->added( src, dst );
+    else ok = live->removed( src, dst );
+
+    if( !ok ) return;
+    live->m_version = Chuck_UGen::our_graph_version;
+
+    // debugging the patches
+    if( Chuck_UGen::our_schedule_check && !live->check() )
+        EM_error2( 0, "internal error: ugen schedule patched for a %s differs from a rebuild",
+                   !dst ? "deleted ugen" : added ? "connection" : "disconnection" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: graph_hold() / graph_release()
+// desc: hold back removals from the schedule, until every channel is
+//       disconnected (a source read by one channel is still read by the
+//       others, which would make the schedule rebuild)
+//-----------------------------------------------------------------------------
+static void graph_hold()
+{
+    g_graph_holding++;
+}
+static void graph_release()
+{
+    if( --g_graph_holding ) return;
+
+    for( t_CKUINT i = 0; i < g_graph_held.size(); i++ )
+    {
+        graph_changed( g_graph_held[i].first, g_graph_held[i].second, FALSE );
+        g_graph_held[i].first->release();
+    }
+    g_graph_held.clear();
+}
+
+
 
 
 //-----------------------------------------------------------------------------
@@ -175,6 +252,7 @@ Chuck_UGen::~Chuck_UGen()
 void Chuck_UGen::init()
 {
     tick = NULL;
+    tickf = NULL;
     pmsg = NULL;
     m_multi_chan = NULL;
     m_multi_chan_size = 0;
@@ -209,6 +287,10 @@ void Chuck_UGen::init()
     
     // what a hack
     m_is_uana = FALSE;
+
+    m_sched_pass = 0;
+    m_sched_index = 0;
+    m_sched_first = 0;
 }
 
 
@@ -228,6 +310,8 @@ void Chuck_UGen::done()
     // disconnect
     this->disconnect( TRUE );
     m_valid = FALSE;
+    // in case a schedule still holds this
+    graph_changed( this, NULL, FALSE );
 
     fa_done( m_src_list, m_src_cap );
     fa_done( m_dest_list, m_dest_cap );
@@ -350,6 +434,8 @@ t_CKBOOL Chuck_UGen::add( Chuck_UGen * src, t_CKBOOL isUpChuck )
         m_num_src++;
         src->add_ref();
         src->add_by( this, isUpChuck );
+        // graph changed
+        graph_changed( src, this, TRUE );
         
         // upchuck
         if( isUpChuck )
@@ -453,7 +539,8 @@ t_CKBOOL Chuck_UGen::remove( Chuck_UGen * src )
                 --j;
             }
 
-        // remove
+        // remove (every connection from src)
+        t_CKUINT removed = 0;
         for( t_CKUINT i = 0; i < m_num_src; i++ )
             if( m_src_list[i] == src )
             {
@@ -463,10 +550,14 @@ t_CKBOOL Chuck_UGen::remove( Chuck_UGen * src )
 
                 m_src_list[--m_num_src] = NULL;
                 src->remove_by( this );
-                src->release();
+                removed++;
                 --i;
             }
-        
+
+        // graph changed, once all of them are gone (while src is sure to
+        // be there)
+        if( removed ) graph_changed( src, this, FALSE );
+        while( removed-- ) src->release();
     }
     /* else if( outs >= 2 && ins == 1 )
     {
@@ -487,15 +578,19 @@ t_CKBOOL Chuck_UGen::remove( Chuck_UGen * src )
     } */
     else if( outs == 1 && ins >= 2 )
     {
+        graph_hold();
         for( i = 0; i < ins; i++ )
-            if( !m_multi_chan[i]->remove( src ) ) return FALSE;
-        ret = TRUE;
+            if( !m_multi_chan[i]->remove( src ) ) break;
+        graph_release();
+        ret = ( i == ins );
     }
     else if( outs >= 2 && ins >= 2 )
     {
+        graph_hold();
         for( i = 0; i < ins; i++ )
-            if( !m_multi_chan[i]->remove( src->m_multi_chan[i%outs] ) ) return FALSE;
-        ret = TRUE;
+            if( !m_multi_chan[i]->remove( src->m_multi_chan[i%outs] ) ) break;
+        graph_release();
+        ret = ( i == ins );
     }
 
     return ret;
@@ -559,11 +654,14 @@ void Chuck_UGen::remove_all( )
             // TODO: figure out why this is necessary!
 
             // get rid of it, but don't release
+            Chuck_UGen * src = m_src_list[0];
             for( t_CKUINT j = 1; j < m_num_src; j++ )
                 m_src_list[j-1] = m_src_list[j];
 
             // null the last element
             m_src_list[--m_num_src] = NULL;
+            // graph changed
+            graph_changed( src, this, FALSE );
         }
     }
 }
@@ -584,11 +682,14 @@ t_CKBOOL Chuck_UGen::disconnect( t_CKBOOL recursive )
         if( !m_dest_list[0]->remove( this ) )
         {
             // get rid of it, but don't release
+            Chuck_UGen * dest = m_dest_list[0];
             for( t_CKUINT j = 1; j < m_num_dest; j++ )
                 m_dest_list[j-1] = m_dest_list[j];
 
             // null the last element
             m_dest_list[--m_num_dest] = NULL;
+            // graph changed
+            graph_changed( this, dest, FALSE );
         }
     }
 
@@ -634,13 +735,49 @@ t_CKBOOL Chuck_UGen::is_connected_from( Chuck_UGen * src )
 
 //-----------------------------------------------------------------------------
 // name: tick()
-// dsec: ...
+// dsec: recursive tick - ticks what this depends on, then computes
 //-----------------------------------------------------------------------------
 t_CKBOOL Chuck_UGen::system_tick( t_CKTIME now )
 {
     if( m_time >= now )
         return m_valid;
 
+    t_CKUINT i; Chuck_UGen * ugen;
+
+    // inc time (also breaks cycles)
+    m_time = now;
+
+    // tick the src list
+    for( i = 0; i < m_num_src; i++ )
+    {
+        ugen = m_src_list[i];
+        if( ugen->m_time < now ) ugen->system_tick( now );
+    }
+
+    // tick multiple channels
+    for( i = 0; i < m_multi_chan_size; i++ )
+    {
+        ugen = m_multi_chan[i];
+        if( ugen->m_time < now ) ugen->system_tick( now );
+    }
+
+    // if owner
+    if( owner != NULL && owner->m_time < now )
+        owner->system_tick( now );
+
+    return this->compute( now );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: compute()
+// dsec: compute one sample, assuming everything this depends on has been
+//       ticked for now
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_UGen::compute( t_CKTIME now )
+{
     t_CKUINT i; Chuck_UGen * ugen; SAMPLE multi;
 
     // inc time
@@ -649,15 +786,12 @@ t_CKBOOL Chuck_UGen::system_tick( t_CKTIME now )
     m_sum = 0.0f;
     if( m_num_src )
     {
-        ugen = m_src_list[0];
-        if( ugen->m_time < now ) ugen->system_tick( now );
-        m_sum = ugen->m_current;
+        m_sum = m_src_list[0]->m_current;
 
-        // tick the src list
+        // sum the src list
         for( i = 1; i < m_num_src; i++ )
         {
             ugen = m_src_list[i];
-            if( ugen->m_time < now ) ugen->system_tick( now );
             if( ugen->m_valid )
             {
                 if( m_op <= 1 )
@@ -676,16 +810,14 @@ t_CKBOOL Chuck_UGen::system_tick( t_CKTIME now )
         }
     }
 
-    // tick multiple channels
+    // multiple channels
     multi = 0.0f;
     if( m_multi_chan_size )
     {
         for( i = 0; i < m_multi_chan_size; i++ )
         {
-            ugen = m_multi_chan[i];
-            if( ugen->m_time < now ) ugen->system_tick( now );
             // multiple channels are added
-            multi += ugen->m_current;
+            multi += m_multi_chan[i]->m_current;
         }
     
         // scale multi
@@ -693,10 +825,6 @@ t_CKBOOL Chuck_UGen::system_tick( t_CKTIME now )
         m_sum += multi;
     }
 
-    // if owner
-    if( owner != NULL && owner->m_time < now )
-        owner->system_tick( now );
-
     if( m_op > 0 )  // UGEN_OP_TICK
     {
         // tick the ugen
@@ -729,13 +857,49 @@ t_CKBOOL Chuck_UGen::system_tick( t_CKTIME now )
 
 //-----------------------------------------------------------------------------
 // name: tick_v()
-// dsec: ...
+// dsec: recursive block tick
 //-----------------------------------------------------------------------------
 t_CKBOOL Chuck_UGen::system_tick_v( t_CKTIME now, t_CKUINT numFrames )
 {
     if( m_time >= now )
         return m_valid;
     
+    t_CKUINT i; Chuck_UGen * ugen;
+    
+    // inc time (also breaks cycles)
+    m_time = now;
+
+    // tick the src list
+    for( i = 0; i < m_num_src; i++ )
+    {
+        ugen = m_src_list[i];
+        if( ugen->m_time < now ) ugen->system_tick_v( now, numFrames );
+    }
+
+    // tick multiple channels
+    for( i = 0; i < m_multi_chan_size; i++ )
+    {
+        ugen = m_multi_chan[i];
+        if( ugen->m_time < now ) ugen->system_tick_v( now, numFrames );
+    }
+    
+    // if owner
+    if( owner != NULL && owner->m_time < now )
+        owner->system_tick_v( now, numFrames );
+
+    return this->compute_v( now, numFrames );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: compute_v()
+// dsec: compute one block, assuming everything this depends on has been
+//       ticked for now
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_UGen::compute_v( t_CKTIME now, t_CKUINT numFrames )
+{
     t_CKUINT i, j; Chuck_UGen * ugen; SAMPLE factor;
     
     // inc time
@@ -743,33 +907,20 @@ t_CKBOOL Chuck_UGen::system_tick_v( t_CKTIME now, t_CKUINT numFrames )
 
     if( m_num_src )
     {
-        ugen = m_src_list[0];
-        if( ugen->m_time < now ) ugen->system_tick_v( now, numFrames );
-        memcpy( m_sum_v, ugen->m_current_v, numFrames * sizeof(SAMPLE) );
+        memcpy( m_sum_v, m_src_list[0]->m_current_v, numFrames * sizeof(SAMPLE) );
         
-        // tick the src list
+        // sum the src list
         for( i = 1; i < m_num_src; i++ )
         {
             ugen = m_src_list[i];
-            if( ugen->m_time < now ) ugen->system_tick_v( now, numFrames );
             if( ugen->m_valid )
             {
-                if( m_op <= 1 )
-                    for( j = 0; j < numFrames; j++ )
-                        m_sum_v[j] += ugen->m_current_v[j];
-                else // special ops
+                switch( m_op )
                 {
-                    switch( m_op )
-                    {
-                        case 2: for( j = 0; j < numFrames; j++ )
-                            m_sum_v[j] -= ugen->m_current_v[j]; break;
-                        case 3: for( j = 0; j < numFrames; j++ )
-                            m_sum_v[j] *= ugen->m_current_v[j]; break;
-                        case 4: for( j = 0; j < numFrames; j++ )
-                            m_sum_v[j] /= ugen->m_current_v[j]; break;
-                        default: for( j = 0; j < numFrames; j++ )
-                            m_sum_v[j] += ugen->m_current_v[j]; break;
-                    }
+                    case 2: vec_sub( m_sum_v, ugen->m_current_v, numFrames ); break;
+                    case 3: vec_mul( m_sum_v, ugen->m_current_v, numFrames ); break;
+                    case 4: vec_div( m_sum_v, ugen->m_current_v, numFrames ); break;
+                    default: vec_add( m_sum_v, ugen->m_current_v, numFrames ); break;
                 }
             }
         }
@@ -779,42 +930,33 @@ t_CKBOOL Chuck_UGen::system_tick_v( t_CKTIME now, t_CKUINT numFrames )
         memset( m_sum_v, 0, numFrames * sizeof(SAMPLE) );
     }
 
-    // tick multiple channels
+    // multiple channels
     if( m_multi_chan_size )
     {
         // initialize
         factor = 1.0f / m_multi_chan_size;
         // iterate
         for( i = 0; i < m_multi_chan_size; i++ )
-        {
-            ugen = m_multi_chan[i];
-            if( ugen->m_time < now ) ugen->system_tick_v( now, numFrames );
-            for( j = 0; j < numFrames; j++ )
-                m_sum_v[j] += ugen->m_current_v[j] * factor;
-        }
+            vec_madd( m_sum_v, m_multi_chan[i]->m_current_v, factor, numFrames );
     }
     
-    // if owner
-    if( owner != NULL && owner->m_time < now )
-        owner->system_tick_v( now, numFrames );
-    
     if( m_op > 0 )  // UGEN_OP_TICK
     {
-        // tick the ugen
-        if( tick ) 
+        // tick the ugen, whole block if it can, else one frame at a time
+        if( tickf )
+            m_valid = tickf( this, m_sum_v, m_current_v, numFrames, NULL );
+        else if( tick )
             for( j = 0; j < numFrames; j++ )
                 m_valid = tick( this, m_sum_v[j], &(m_current_v[j]), NULL );
         if( !m_valid )
-            for( j = 0; j < numFrames; j++ )
-                m_current_v[j] = 0.0f;
+            memset( m_current_v, 0, numFrames * sizeof(SAMPLE) );
         else
-            for( j = 0; j < numFrames; j++ )
-            {
-                // apply gain and pan
-                m_current_v[j] *= m_gain * m_pan;
-                // dedenormal
-                CK_DDN( m_current_v[j] );
-            }
+        {
+            // apply gain and pan
+            vec_scale( m_current_v, m_gain * m_pan, numFrames );
+            // dedenormal
+            vec_ddn( m_current_v, numFrames );
+        }
         // save as last
         m_last = m_current_v[numFrames-1];
         return m_valid;
@@ -842,6 +984,529 @@ t_CKBOOL Chuck_UGen::system_tick_v( t_CKTIME now, t_CKUINT numFrames )
 
 
 
+//-----------------------------------------------------------------------------
+// name: Chuck_UGen_Schedule()
+// desc: constructor
+//-----------------------------------------------------------------------------
+Chuck_UGen_Schedule::Chuck_UGen_Schedule()
+{
+    m_leaf = NULL;
+    m_version = 0;
+    m_pass = 0;
+    m_num_checked = 0;
+    m_num_differed = 0;
+    m_pool = NULL;
+    m_now = 0;
+    m_num_frames = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~Chuck_UGen_Schedule()
+// desc: destructor
+//-----------------------------------------------------------------------------
+Chuck_UGen_Schedule::~Chuck_UGen_Schedule()
+{
+    if( Chuck_UGen::our_schedule == this )
+        Chuck_UGen::our_schedule = NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set_roots()
+// desc: ...
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::set_roots( Chuck_UGen ** roots, t_CKUINT num_roots )
+{
+    m_roots.clear();
+    for( t_CKUINT i = 0; i < num_roots; i++ )
+        if( roots[i] ) m_roots.push_back( roots[i] );
+
+    // rebuild on next tick
+    m_version = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set_leaf()
+// desc: leaf is not scheduled, nor anything only reachable through it (adc,
+//       when it is filled in from the audio input)
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::set_leaf( Chuck_UGen * leaf )
+{
+    if( m_leaf == leaf ) return;
+    m_leaf = leaf;
+
+    // rebuild on next tick
+    m_version = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: build()
+// desc: depth-first, post-order walk of the edges system_tick() follows
+//       (sources, channels, owner), without recursion; a ugen reached
+//       again while on the stack closes a cycle, and is read with its
+//       previous output, as in the recursive tick
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::build()
+{
+    std::vector< std::pair<Chuck_UGen *, t_CKUINT> > stack;
+    Chuck_UGen * ugen, * next;
+    t_CKUINT i, k;
+
+    // new pass
+    m_pass = ++g_sched_pass;
+    m_order.clear();
+
+    // this pass takes the marks the live schedule patches with
+    if( Chuck_UGen::our_schedule && Chuck_UGen::our_schedule != this )
+        Chuck_UGen::our_schedule->invalidate();
+
+    // don't go through the leaf
+    if( m_leaf ) m_leaf->m_sched_pass = g_sched_pass;
+
+    for( i = 0; i < m_roots.size(); i++ )
+    {
+        if( m_roots[i]->m_sched_pass == g_sched_pass ) continue;
+        m_roots[i]->m_sched_pass = g_sched_pass;
+        m_roots[i]->m_sched_first = m_order.size();
+        stack.push_back( std::pair<Chuck_UGen *, t_CKUINT>( m_roots[i], 0 ) );
+
+        while( stack.size() )
+        {
+            ugen = stack.back().first;
+            k = stack.back().second++;
+
+            // next edge, in system_tick() order
+            if( k < ugen->m_num_src )
+                next = ugen->m_src_list[k];
+            else if( (k -= ugen->m_num_src) < ugen->m_multi_chan_size )
+                next = ugen->m_multi_chan[k];
+            else if( k == ugen->m_multi_chan_size && ugen->owner )
+                next = ugen->owner;
+            else
+            {
+                // all dependencies placed
+                ugen->m_sched_index = m_order.size();
+                m_order.push_back( ugen );
+                stack.pop_back();
+                continue;
+            }
+
+            // visit
+            if( next->m_sched_pass != g_sched_pass )
+            {
+                next->m_sched_pass = g_sched_pass;
+                next->m_sched_first = m_order.size();
+                stack.push_back( std::pair<Chuck_UGen *, t_CKUINT>( next, 0 ) );
+            }
+        }
+    }
+
+    m_version = Chuck_UGen::our_graph_version;
+    EM_log( CK_LOG_FINE, "ugen schedule rebuilt: %d ugens", m_order.size() );
+
+    // split for the pool
+    if( m_pool ) this->partition();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: check()
+// desc: rebuild, and compare with the order (and where each ugen's
+//       dependencies start) from before; FALSE if they differ
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_UGen_Schedule::check()
+{
+    std::vector<Chuck_UGen *> order( m_order );
+    std::vector<t_CKUINT> first;
+    t_CKBOOL same = TRUE;
+    t_CKUINT i;
+
+    for( i = 0; i < order.size(); i++ )
+        first.push_back( order[i]->m_sched_first );
+
+    this->build();
+
+    same = order == m_order;
+    for( i = 0; same && i < order.size(); i++ )
+        same = order[i]->m_sched_first == first[i];
+
+    m_num_checked++;
+    if( !same ) m_num_differed++;
+    return same;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: has()
+// desc: ...
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_UGen_Schedule::has( Chuck_UGen * ugen )
+{
+    return ugen && ugen->m_sched_pass == m_pass &&
+           ugen->m_sched_index < m_order.size() &&
+           m_order[ugen->m_sched_index] == ugen;
+}
+
+
+
+
+// a is scheduled, and d was placed on the way to it (a was on build()'s
+// stack when d was reached)
+static t_CKBOOL sched_encloses( Chuck_UGen * a, Chuck_UGen * d )
+{
+    return a->m_sched_first <= d->m_sched_index &&
+           d->m_sched_index < a->m_sched_index;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: added()
+// desc: build() would reach src through dst's new (last) source edge, and
+//       place what it finds there right before dst; that is done here,
+//       visiting only the ugens src newly reaches, as long as build() would
+//       see the rest of the graph as it did last time
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_UGen_Schedule::added( Chuck_UGen * src, Chuck_UGen * dst )
+{
+    std::vector< std::pair<Chuck_UGen *, t_CKUINT> > stack;
+    std::vector<Chuck_UGen *> placed;
+    Chuck_UGen * ugen, * next;
+    t_CKUINT at, i, k, n;
+
+    // not reached through dst
+    if( !has( dst ) || src == m_leaf ) return TRUE;
+    // groups would need redoing
+    if( m_pool ) return FALSE;
+    // build() follows dst's channels and owner after the new edge; they
+    // have to have been visited before dst, or nothing can be said
+    if( dst->m_multi_chan_size ) return FALSE;
+    if( dst->owner && dst->owner != m_leaf && !( has( dst->owner ) &&
+        ( dst->owner->m_sched_index < dst->m_sched_first ||
+          sched_encloses( dst->owner, dst ) ) ) )
+        return FALSE;
+
+    at = dst->m_sched_index;
+
+    // already visited by then: before dst, or on the way to it (a cycle,
+    // read with its previous output either way)
+    if( has( src ) )
+        return src->m_sched_index < at || sched_encloses( src, dst );
+
+    // walk what src newly reaches, as build() does
+    src->m_sched_pass = m_pass;
+    src->m_sched_first = at;
+    stack.push_back( std::pair<Chuck_UGen *, t_CKUINT>( src, 0 ) );
+    while( stack.size() )
+    {
+        ugen = stack.back().first;
+        k = stack.back().second++;
+
+        // next edge, in system_tick() order
+        if( k < ugen->m_num_src )
+            next = ugen->m_src_list[k];
+        else if( (k -= ugen->m_num_src) < ugen->m_multi_chan_size )
+            next = ugen->m_multi_chan[k];
+        else if( k == ugen->m_multi_chan_size && ugen->owner )
+            next = ugen->owner;
+        else
+        {
+            // all dependencies placed
+            ugen->m_sched_index = at + placed.size();
+            placed.push_back( ugen );
+            stack.pop_back();
+            continue;
+        }
+
+        if( next == m_leaf ) continue;
+        // new, or scheduled: it has to have been visited before dst too
+        if( next->m_sched_pass == m_pass )
+        {
+            if( has( next ) && !( next->m_sched_index < at ||
+                sched_encloses( next, dst ) ) )
+                return FALSE;
+            continue;
+        }
+
+        next->m_sched_pass = m_pass;
+        next->m_sched_first = at + placed.size();
+        stack.push_back( std::pair<Chuck_UGen *, t_CKUINT>( next, 0 ) );
+    }
+
+    // insert, and move what follows
+    n = placed.size();
+    m_order.insert( m_order.begin() + at, placed.begin(), placed.end() );
+    for( i = at + n; i < m_order.size(); i++ )
+    {
+        ugen = m_order[i];
+        ugen->m_sched_index += n;
+        if( ugen->m_sched_first > at ) ugen->m_sched_first += n;
+    }
+
+    EM_log( CK_LOG_FINER, "ugen schedule: %d ugens added", n );
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: removed()
+// desc: if dst's edge was how build() first reached src, what was placed on
+//       the way to src goes, unless something else still reads from it
+//       (then, or for a root, FALSE)
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_UGen_Schedule::removed( Chuck_UGen * src, Chuck_UGen * dst )
+{
+    Chuck_UGen * ugen, * reader;
+    t_CKUINT first, last, i, k, n;
+
+    // not reached through dst
+    if( !has( dst ) || !has( src ) ) return TRUE;
+    // groups would need redoing
+    if( m_pool ) return FALSE;
+    // reached before dst, or on the way to it
+    if( src->m_sched_index < dst->m_sched_first || sched_encloses( src, dst ) )
+        return TRUE;
+    // otherwise it was placed on the way to dst
+    if( src->m_sched_index > dst->m_sched_index ) return FALSE;
+
+    first = src->m_sched_first;
+    last = src->m_sched_index;
+    for( i = 0; i < m_roots.size(); i++ )
+        if( has( m_roots[i] ) && m_roots[i]->m_sched_index >= first &&
+            m_roots[i]->m_sched_index <= last )
+            return FALSE;
+
+    // anything read from outside (by a source edge, as a channel, or as
+    // an owner)
+    for( i = first; i <= last; i++ )
+    {
+        ugen = m_order[i];
+        for( k = 0; k < ugen->m_num_dest + ugen->m_multi_chan_size + 1; k++ )
+        {
+            if( k < ugen->m_num_dest ) reader = ugen->m_dest_list[k];
+            else if( k < ugen->m_num_dest + ugen->m_multi_chan_size )
+                reader = ugen->m_multi_chan[k - ugen->m_num_dest];
+            else reader = ugen->owner;
+
+            if( has( reader ) && ( reader->m_sched_index < first ||
+                reader->m_sched_index > last ) )
+                return FALSE;
+        }
+    }
+
+    // take them out, and move what follows
+    n = last - first + 1;
+    for( i = first; i <= last; i++ )
+        m_order[i]->m_sched_pass = 0;
+    m_order.erase( m_order.begin() + first, m_order.begin() + last + 1 );
+    for( i = first; i < m_order.size(); i++ )
+    {
+        ugen = m_order[i];
+        ugen->m_sched_index -= n;
+        if( ugen->m_sched_first > last ) ugen->m_sched_first -= n;
+    }
+
+    EM_log( CK_LOG_FINER, "ugen schedule: %d ugens removed", n );
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set_pool()
+// desc: ...
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::set_pool( XWorkPool * pool )
+{
+    m_pool = pool;
+    m_tasks.clear();
+    m_rest.clear();
+
+    // rebuild on next tick
+    m_version = 0;
+}
+
+
+
+
+// union-find over schedule indices
+static t_CKUINT sched_find( std::vector<t_CKUINT> & up, t_CKUINT i )
+{
+    while( up[i] != i ) i = up[i] = up[up[i]];
+    return i;
+}
+static void sched_union( std::vector<t_CKUINT> & up, t_CKUINT a, t_CKUINT b )
+{
+    a = sched_find( up, a ); b = sched_find( up, b );
+    // lower index wins, so groups keep the order they first appear in
+    if( a < b ) up[b] = a; else if( b < a ) up[a] = b;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: partition()
+// desc: group the schedule into connected pieces that can be ticked
+//       independently: the roots and their channels, and anything that
+//       reads them, go to m_rest (ticked last, in order); ugens marked
+//       serial are all put in one group, so their shared state is touched
+//       in the same order as single-threaded
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::partition()
+{
+    t_CKUINT n = m_order.size(), i, k, r;
+    // two extra sets: the rest, and serial ugens
+    t_CKUINT REST = n, SERIAL = n + 1;
+    std::vector<t_CKUINT> up( n + 2 );
+    std::vector<t_CKBOOL> root( n, FALSE );
+    std::vector<long> task( n + 2, -1 );
+    Chuck_UGen * ugen, * next;
+
+    m_tasks.clear();
+    m_rest.clear();
+
+    for( i = 0; i < n + 2; i++ ) up[i] = i;
+
+    // the roots and their channels
+    for( i = 0; i < m_roots.size(); i++ )
+    {
+        ugen = m_roots[i];
+        root[ugen->m_sched_index] = TRUE;
+        for( k = 0; k < ugen->m_multi_chan_size; k++ )
+            root[ugen->m_multi_chan[k]->m_sched_index] = TRUE;
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+        ugen = m_order[i];
+        if( root[i] ) { sched_union( up, i, REST ); continue; }
+
+        // shared state
+        if( ugen->type_ref && ugen->type_ref->ugen_info &&
+            ugen->type_ref->ugen_info->serial )
+            sched_union( up, i, SERIAL );
+
+        // join with everything it reads
+        for( k = 0; k < ugen->m_num_src + ugen->m_multi_chan_size + 1; k++ )
+        {
+            if( k < ugen->m_num_src ) next = ugen->m_src_list[k];
+            else if( k < ugen->m_num_src + ugen->m_multi_chan_size )
+                next = ugen->m_multi_chan[k - ugen->m_num_src];
+            else next = ugen->owner;
+
+            // the leaf is computed before the schedule
+            if( !next || next == m_leaf ) continue;
+            // reading a root: has to wait for it
+            sched_union( up, i, root[next->m_sched_index] ? REST : next->m_sched_index );
+        }
+    }
+
+    // collect, in schedule order
+    for( i = 0; i < n; i++ )
+    {
+        r = sched_find( up, i );
+        if( r == sched_find( up, REST ) ) { m_rest.push_back( m_order[i] ); continue; }
+        if( task[r] < 0 )
+        {
+            task[r] = m_tasks.size();
+            m_tasks.push_back( std::vector<Chuck_UGen *>() );
+        }
+        m_tasks[task[r]].push_back( m_order[i] );
+    }
+
+    EM_log( CK_LOG_FINE, "ugen schedule: %d parallel groups, %d ugens after",
+            m_tasks.size(), m_rest.size() );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: tick_task()
+// desc: pool callback, ticks one group
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::tick_task( void * data, t_CKUINT task )
+{
+    Chuck_UGen_Schedule * sched = (Chuck_UGen_Schedule *)data;
+    std::vector<Chuck_UGen *> & group = sched->m_tasks[task];
+    t_CKTIME now = sched->m_now;
+
+    for( t_CKUINT i = 0; i < group.size(); i++ )
+        if( group[i]->m_time < now ) group[i]->compute_v( now, sched->m_num_frames );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: tick()
+// desc: tick every scheduled ugen once, for now
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::tick( t_CKTIME now )
+{
+    if( m_version != Chuck_UGen::our_graph_version )
+        this->build();
+
+    Chuck_UGen ** order = m_order.size() ? &m_order[0] : NULL;
+    t_CKUINT size = m_order.size();
+    for( t_CKUINT i = 0; i < size; i++ )
+        if( order[i]->m_time < now ) order[i]->compute( now );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: tick_v()
+// desc: block version of tick()
+//-----------------------------------------------------------------------------
+void Chuck_UGen_Schedule::tick_v( t_CKTIME now, t_CKUINT numFrames )
+{
+    if( m_version != Chuck_UGen::our_graph_version )
+        this->build();
+
+    // in parallel
+    if( m_pool && m_tasks.size() > 1 )
+    {
+        m_now = now;
+        m_num_frames = numFrames;
+        m_pool->run( tick_task, this, m_tasks.size() );
+
+        // then the rest
+        for( t_CKUINT i = 0; i < m_rest.size(); i++ )
+            if( m_rest[i]->m_time < now ) m_rest[i]->compute_v( now, numFrames );
+        return;
+    }
+
+    Chuck_UGen ** order = m_order.size() ? &m_order[0] : NULL;
+    t_CKUINT size = m_order.size();
+    for( t_CKUINT i = 0; i < size; i++ )
+        if( order[i]->m_time < now ) order[i]->compute_v( now, numFrames );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: Chuck_UAna()
 // desc: constructor
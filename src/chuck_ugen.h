@@ -39,11 +39,13 @@
 #include "chuck_def.h"
 #include "chuck_oo.h"
 #include "chuck_dl.h"
+#include "util_thread.h"
 
 
 // forward reference
 struct Chuck_VM_Shred;
 struct Chuck_UAnaBlobProxy;
+struct Chuck_UGen_Schedule;
 
 
 // op mode
@@ -73,6 +75,8 @@ public: // src
     t_CKUINT disconnect( t_CKBOOL recursive );
     t_CKUINT system_tick( t_CKTIME now );
     t_CKUINT system_tick_v( t_CKTIME now, t_CKUINT numFrames );
+    t_CKBOOL compute( t_CKTIME now );
+    t_CKBOOL compute_v( t_CKTIME now, t_CKUINT numFrames );
     t_CKBOOL alloc_v( t_CKUINT size );
 
 protected:
@@ -82,6 +86,8 @@ protected:
 public:
     // tick function
     f_tick tick;
+    // block tick function (NULL: tick is called once per frame)
+    f_tickf tickf;
     // msg function
     f_pmsg pmsg;
     // channels (if more than one is required)
@@ -131,6 +137,84 @@ public: // data
     
     // what a hack!
     t_CKBOOL m_is_uana;
+
+    // last schedule build that visited this ugen, where it is, and where
+    // what was placed on the way to it starts
+    t_CKUINT m_sched_pass;
+    t_CKUINT m_sched_index;
+    t_CKUINT m_sched_first;
+
+public:
+    // bumped on every connection change, invalidates schedules
+    static t_CKUINT our_graph_version;
+    // the schedule patched on connection changes, rather than rebuilt
+    static Chuck_UGen_Schedule * our_schedule;
+    // check every patch against a build() (--graph:check)
+    static t_CKBOOL our_schedule_check;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_UGen_Schedule
+// desc: the ugens reachable from a set of roots, flattened in the order the
+//       recursive system_tick() would reach them (sources first); ticked as
+//       a linear array, rebuilt when the graph version changes (the live
+//       schedule patches itself instead, where it can)
+//-----------------------------------------------------------------------------
+struct Chuck_UGen_Schedule
+{
+public:
+    Chuck_UGen_Schedule();
+    ~Chuck_UGen_Schedule();
+
+public:
+    // roots are ticked in order, leaves are assumed computed elsewhere
+    void set_roots( Chuck_UGen ** roots, t_CKUINT num_roots );
+    void set_leaf( Chuck_UGen * leaf );
+    void invalidate() { m_version = 0; }
+    void build();
+    void tick( t_CKTIME now );
+    void tick_v( t_CKTIME now, t_CKUINT numFrames );
+
+public:
+    // is ugen scheduled
+    t_CKBOOL has( Chuck_UGen * ugen );
+    // patch for a connection src -> dst just added/removed, to what build()
+    // would make; FALSE if that takes a build()
+    t_CKBOOL added( Chuck_UGen * src, Chuck_UGen * dst );
+    t_CKBOOL removed( Chuck_UGen * src, Chuck_UGen * dst );
+    // build(), and tell if that changed anything (a patch went wrong)
+    t_CKBOOL check();
+
+public:
+    // render blocks on a pool (NULL for single-threaded)
+    void set_pool( XWorkPool * pool );
+
+protected:
+    void partition();
+    static void tick_task( void * data, t_CKUINT task );
+
+public:
+    std::vector<Chuck_UGen *> m_roots;
+    Chuck_UGen * m_leaf;
+    std::vector<Chuck_UGen *> m_order;
+    t_CKUINT m_version;
+    // build() that marked the scheduled ugens
+    t_CKUINT m_pass;
+    // patches check()ed, and those that differed from a build()
+    t_CKUINT m_num_checked;
+    t_CKUINT m_num_differed;
+
+    // parallel rendering: independent groups of ugens, each in schedule
+    // order, then the rest (dac, blackhole, and whatever reads them)
+    XWorkPool * m_pool;
+    std::vector< std::vector<Chuck_UGen *> > m_tasks;
+    std::vector<Chuck_UGen *> m_rest;
+    // block being ticked
+    t_CKTIME m_now;
+    t_CKUINT m_num_frames;
 };
 
 
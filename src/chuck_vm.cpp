@@ -33,12 +33,14 @@
 #include "chuck_vm.h"
 #include "chuck_instr.h"
 #include "chuck_bbq.h"
+#include "chuck_render.h"
 #include "chuck_errmsg.h"
 #include "chuck_dl.h"
 #include "chuck_type.h"
 #include "chuck_globals.h"
 #include "chuck_lang.h"
 #include "ugen_xxx.h"
+#include "ugen_stk.h"
 
 #include <algorithm>
 using namespace std;
@@ -124,11 +126,18 @@ Chuck_VM::Chuck_VM()
     m_msg_buffer = NULL;
     m_reply_buffer = NULL;
     m_event_buffer = NULL;
+    m_callback_buffer = NULL;
     m_shred_id = 0;
     m_halt = TRUE;
     m_audio = FALSE;
     m_block = TRUE;
+    m_reclaim_batch = 0;
+    m_bounded_stacks = TRUE;
+    m_render = NULL;
+    m_render_samps = -1;
+    m_record = NULL;
     m_running = FALSE;
+    m_engine = CK_VM_ENGINE_VIRTUAL;
 
     m_audio_started = FALSE;
     m_dac = NULL;
@@ -282,15 +291,19 @@ t_CKBOOL Chuck_VM::initialize( t_CKBOOL enable_audio, t_CKBOOL halt, t_CKUINT sr
     // log
     EM_log( CK_LOG_SYSTEM, "allocating messaging buffers..." );
     // allocate msg buffer
+    // (messages come from the otf and shell threads, events from midi, hid,
+    //  osc, and keyboard threads; replies only from the vm)
     m_msg_buffer = new CBufferSimple;
-    m_msg_buffer->initialize( 1024, sizeof(Chuck_Msg *) );
+    m_msg_buffer->initialize( 1024, sizeof(Chuck_Msg *), TRUE );
     //m_msg_buffer->join(); // this should return 0
     m_reply_buffer = new CBufferSimple;
     m_reply_buffer->initialize( 1024, sizeof(Chuck_Msg *) );
     //m_reply_buffer->join(); // this should return 0 too
     m_event_buffer = new CBufferSimple;
-    m_event_buffer->initialize( 1024, sizeof(Chuck_Event *) );
+    m_event_buffer->initialize( 1024, sizeof(Chuck_Event *), TRUE );
     //m_event_buffer->join(); // this should also return 0
+    m_callback_buffer = new CBufferSimple;
+    m_callback_buffer->initialize( 1024, sizeof(Chuck_VM_Callback), TRUE );
 
     // log
     EM_log( CK_LOG_SYSTEM, "real-time audio: %s", enable_audio ? "YES" : "NO" );
@@ -393,6 +406,12 @@ t_CKBOOL Chuck_VM::initialize_synthesis( )
     m_shreduler->m_bunghole = m_bunghole;
     m_shreduler->m_num_dac_channels = m_num_dac_channels;
     m_shreduler->m_num_adc_channels = m_num_adc_channels;
+    // ugen schedule: dac, then blackhole; adc is filled in from the input
+    Chuck_UGen * roots[2] = { m_dac, m_bunghole };
+    m_shreduler->m_ugen_schedule.set_roots( roots, 2 );
+    if( m_audio ) m_shreduler->m_ugen_schedule.set_leaf( m_adc );
+    // patched as shreds connect and disconnect
+    Chuck_UGen::our_schedule = &m_shreduler->m_ugen_schedule;
 
     // log
     EM_log( CK_LOG_SYSTEM, "initializing '%s' audio...", m_audio ? "real-time" : "fake-time" );
@@ -454,6 +473,13 @@ t_CKBOOL Chuck_VM::shutdown()
         usleep( 50000 );
     }
 
+    // finish deferred reclaim; from here on objects are freed immediately
+    if( m_reclaim_batch )
+    {
+        EM_log( CK_LOG_SYSTEM, "reclaiming deferred objects..." );
+        this->set_reclaim( 0 );
+    }
+
     // shutdown audio
     if( m_audio )
     {
@@ -465,6 +491,17 @@ t_CKBOOL Chuck_VM::shutdown()
         m_bbq->shutdown();
         m_audio = FALSE;
     }
+    // close render file
+    if( m_render ) this->finish_render();
+    // --graph:check
+    if( Chuck_UGen::our_schedule_check )
+        fprintf( stderr, "[chuck]: ugen schedule: %lu patch(es) checked, %lu differed from a rebuild\n",
+                 m_shreduler->m_ugen_schedule.m_num_checked,
+                 m_shreduler->m_ugen_schedule.m_num_differed );
+    // close dac recording, and wait for it to be written
+    if( m_record ) this->set_record( "" );
+    WvOut::finishClosing();
+
     // log
     EM_log( CK_LOG_SYSTEM, "freeing bbq subsystem..." );
     // clean up
@@ -483,6 +520,9 @@ t_CKBOOL Chuck_VM::shutdown()
     SAFE_DELETE( m_reply_buffer );
     // free the event buffer
     SAFE_DELETE( m_event_buffer );
+    // callbacks not yet due are dropped
+    drop_callbacks();
+    SAFE_DELETE( m_callback_buffer );
 
     // log
     EM_log( CK_LOG_SEVERE, "clearing shreds..." );
@@ -512,6 +552,10 @@ t_CKBOOL Chuck_VM::shutdown()
     SAFE_RELEASE( m_adc );
     SAFE_RELEASE( m_bunghole );
 
+    // allocation summary
+    Chuck_VM_Pool::log_stats( CK_LOG_SYSTEM );
+    sndbuf_cache_log( CK_LOG_SYSTEM );
+
     m_init = FALSE;
 
     // pop indent
@@ -593,7 +637,12 @@ t_CKBOOL Chuck_VM::run( )
     EM_poplog();
 
     // run
-    if( m_block ) this->run( -1 );
+    if( m_block )
+    {
+        if( m_render ) m_render->start_clock();
+        this->run( m_render ? m_render_samps : -1 );
+        if( m_render ) this->finish_render();
+    }
     else
     {
         // compute shreds before first sample
@@ -637,6 +686,9 @@ t_CKBOOL Chuck_VM::compute()
     Chuck_Event * event = NULL;
     t_CKBOOL iterate = TRUE;
 
+    // callbacks that have come due
+    if( m_callback_buffer ) run_callbacks();
+
     // iteration until no more shreds/events/messages
     while( iterate )
     {
@@ -682,6 +734,11 @@ t_CKBOOL Chuck_VM::compute()
         if( m_num_dumped_shreds > 0 )
             release_dump();
     }
+
+    // destroy a bounded batch of released objects
+    if( m_reclaim_batch )
+        Chuck_VM_Alloc::instance()->reclaim( m_reclaim_batch,
+            (t_CKUINT)m_shreduler->now_system );
     
     return TRUE;
 }
@@ -689,14 +746,135 @@ t_CKBOOL Chuck_VM::compute()
 
 
 
+//-----------------------------------------------------------------------------
+// name: set_render()
+// desc: send the dac to a sound file instead of the audio device; the file
+//       is open until finish_render(), after num_samps or when the vm halts
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM::set_render( const std::string & filename, t_CKINT num_samps )
+{
+    // after initialize(), before run()
+    if( !m_init || m_running || m_render )
+    {
+        m_last_error = "render target must be set once, before running the VM";
+        return FALSE;
+    }
+
+    m_render = new Chuck_Render;
+    if( !m_render->open( filename, Digitalio::sampling_rate(), m_num_dac_channels ) )
+    {
+        m_last_error = "cannot open render file '" + filename + "'";
+        SAFE_DELETE( m_render );
+        return FALSE;
+    }
+
+    m_render_samps = num_samps;
+    m_shreduler->m_render = m_render;
+
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: finish_render()
+// desc: close the render file and report the speed
+//-----------------------------------------------------------------------------
+void Chuck_VM::finish_render()
+{
+    if( !m_render ) return;
+
+    // detach
+    m_shreduler->m_render = NULL;
+    // close (waits for the writer)
+    m_render->close();
+
+    // report
+    t_CKFLOAT secs = (t_CKFLOAT)m_render->frames() / Digitalio::sampling_rate();
+    t_CKFLOAT elapsed = m_render->elapsed();
+    fprintf( stderr, "[chuck]: rendered %.3f second(s) to '%s' in %.3f second(s)",
+             secs, m_render->filename().c_str(), elapsed );
+    if( elapsed > 0 ) fprintf( stderr, " (%.1fx realtime)", secs / elapsed );
+    fprintf( stderr, "\n" );
+
+    SAFE_DELETE( m_render );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set_record()
+// desc: write the dac, all channels, to a WAV file as it plays; the file is
+//       written by the WvOut writer thread, "" closes it (also on that
+//       thread, so the rest of the file isn't written here)
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM::set_record( const std::string & filename )
+{
+    // close the current file, if any
+    if( m_record )
+    {
+        m_shreduler->m_record = NULL;
+        m_record->closeLater();
+        m_record = NULL;
+        m_record_name.str = "";
+    }
+
+    if( filename == "" ) return TRUE;
+
+    WvOut * w = new WvOut;
+    try {
+        w->openFile( filename.c_str(), m_num_dac_channels,
+                     WvOut::WVOUT_WAV, Stk::STK_SINT16 );
+    } catch( StkError & ) {
+        m_last_error = "cannot open record file '" + filename + "'";
+        SAFE_DELETE( w );
+        return FALSE;
+    }
+
+    m_record = w;
+    m_record_name.str = filename;
+    m_shreduler->m_record = m_record;
+
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: set_reclaim()
+// desc: batch > 0 defers object destruction to compute(), batch at a time;
+//       0 frees everything queued and goes back to immediate
+//-----------------------------------------------------------------------------
+void Chuck_VM::set_reclaim( t_CKUINT batch )
+{
+    Chuck_VM_Alloc * alloc = Chuck_VM_Alloc::instance();
+
+    m_reclaim_batch = batch;
+    alloc->set_deferred( batch > 0 );
+
+    // drain
+    if( !batch )
+    {
+        t_CKUINT now = m_shreduler ? (t_CKUINT)m_shreduler->now_system : 0;
+        while( alloc->reclaim( 1024, now ) ) { }
+        alloc->log_stats( CK_LOG_SYSTEM );
+    }
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: run()
 // desc: ...
 //-----------------------------------------------------------------------------
 t_CKBOOL Chuck_VM::run( t_CKINT num_samps )
 {
-    // loop it
-    while( num_samps )
+    // loop it (until done, or stop())
+    while( num_samps && m_running )
     {
         // compute shreds
         if( !compute() ) goto vm_stop;
@@ -789,8 +967,69 @@ void Chuck_VM::gc( )
 t_CKBOOL Chuck_VM::queue_msg( Chuck_Msg * msg, int count )
 {
     assert( count == 1 );
-    m_msg_buffer->put( &msg, count );
-    return TRUE;
+    return m_msg_buffer->put( &msg, count ) == (UINT__)count;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: queue_callback()
+// desc: have compute() call func( data ) at sample time 'when' (or at the next
+//       compute() if 'when' has passed); safe from any thread
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM::queue_callback( t_CKTIME when, void (* func)( void * ), void * data,
+                                   void (* drop)( void * ) )
+{
+    if( !m_callback_buffer ) return FALSE;
+
+    Chuck_VM_Callback cb;
+    cb.when = when;
+    cb.func = func;
+    cb.data = data;
+    cb.drop = drop;
+    return m_callback_buffer->put( &cb, 1 ) == 1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run_callbacks()
+// desc: take queued callbacks, and call those due by now in time order
+//-----------------------------------------------------------------------------
+void Chuck_VM::run_callbacks()
+{
+    Chuck_VM_Callback cb;
+    while( m_callback_buffer->get( &cb, 1 ) )
+        m_callbacks.insert( std::pair<const t_CKTIME, Chuck_VM_Callback>( cb.when, cb ) );
+
+    while( !m_callbacks.empty() && m_callbacks.begin()->first <= m_shreduler->now_system )
+    {
+        cb = m_callbacks.begin()->second;
+        m_callbacks.erase( m_callbacks.begin() );
+        cb.func( cb.data );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: drop_callbacks()
+// desc: discard every queued callback, letting each free its data
+//-----------------------------------------------------------------------------
+void Chuck_VM::drop_callbacks()
+{
+    Chuck_VM_Callback cb;
+    if( m_callback_buffer )
+        while( m_callback_buffer->get( &cb, 1 ) )
+            m_callbacks.insert( std::pair<const t_CKTIME, Chuck_VM_Callback>( cb.when, cb ) );
+
+    std::multimap<t_CKTIME, Chuck_VM_Callback>::iterator it;
+    for( it = m_callbacks.begin(); it != m_callbacks.end(); it++ )
+        if( it->second.drop ) it->second.drop( it->second.data );
+    m_callbacks.clear();
 }
 
 
@@ -803,8 +1042,7 @@ t_CKBOOL Chuck_VM::queue_msg( Chuck_Msg * msg, int count )
 t_CKBOOL Chuck_VM::queue_event( Chuck_Event * event, int count )
 {
     assert( count == 1 );
-    m_event_buffer->put( &event, count );
-    return TRUE;
+    return m_event_buffer->put( &event, count ) == (UINT__)count;
 }
 
 
@@ -832,6 +1070,14 @@ t_CKUINT Chuck_VM::process_msg( Chuck_Msg * msg )
 {
     t_CKUINT retval = 0xfffffff0;
 
+    // asynchronous compile that failed
+    if( ( msg->type == MSG_REPLACE || msg->type == MSG_ADD ) &&
+        !msg->code && !msg->shred )
+    {
+        retval = 0;
+        goto done;
+    }
+
     if( msg->type == MSG_REPLACE )
     {
         Chuck_VM_Shred * out = m_shreduler->lookup( msg->param );
@@ -1017,6 +1263,10 @@ t_CKUINT Chuck_VM::process_msg( Chuck_Msg * msg )
 
 done:
 
+    // hand the result to a waiting shred
+    if( msg->caller )
+        resume_caller( msg, retval );
+
     if( msg->reply )
     {
         msg->replyA = retval;
@@ -1031,6 +1281,39 @@ done:
 
 
 
+//-----------------------------------------------------------------------------
+// name: resume_caller()
+// desc: wake the shred that asked for msg (it waits on msg->caller_event
+//       right after a native call that returned int), with retval as the
+//       call's result
+//-----------------------------------------------------------------------------
+void Chuck_VM::resume_caller( Chuck_Msg * msg, t_CKUINT retval )
+{
+    Chuck_VM_Shred * shred = msg->caller;
+    Chuck_Event * event = msg->caller_event;
+
+    // still waiting (it may have been removed meanwhile)
+    if( shred->event == event )
+    {
+        t_CKBYTE *& sp = shred->reg->sp;
+        // drop the placeholder result
+        sp -= sizeof(t_CKINT);
+        // wake, which pushes now; replace that with the result
+        event->signal();
+        sp -= sizeof(t_CKTIME);
+        *(t_CKINT *)sp = (t_CKINT)retval;
+        sp += sizeof(t_CKINT);
+    }
+
+    SAFE_RELEASE( event );
+    SAFE_RELEASE( shred );
+    msg->caller = NULL;
+    msg->caller_event = NULL;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: next_id()
 // desc: ...
@@ -1099,8 +1382,12 @@ Chuck_VM_Shred * Chuck_VM::spork( Chuck_VM_Code * code, Chuck_VM_Shred * parent
 {
     // allocate a new shred
     Chuck_VM_Shred * shred = new Chuck_VM_Shred;
-    // initialize the shred (default stack size)
-    shred->initialize( code );
+    // initialize the shred: sporked code with known bounds gets stacks
+    // sized for it, everything else the default
+    t_CKUINT mem_size = CVM_MEM_STACK_SIZE, reg_size = CVM_REG_STACK_SIZE;
+    if( parent && m_bounded_stacks )
+        stack_size_for( code, mem_size, reg_size );
+    shred->initialize( code, mem_size, reg_size );
     // set the name
     shred->name = code->name;
     // set the parent
@@ -1289,6 +1576,7 @@ void Chuck_VM::release_dump( )
 Chuck_VM_Stack::Chuck_VM_Stack()
 {
     stack = sp = sp_max = NULL;
+    m_size = 0;
     prev = next = NULL;
     m_is_init = FALSE;
 }
@@ -1320,6 +1608,14 @@ Chuck_VM_Code::Chuck_VM_Code()
     need_this = FALSE;
     native_func = 0;
     native_func_type = NATIVE_UNKNOWN;
+    bytecode = NULL;
+    frame_depth = 0;
+    reg_depth = 0;
+    native_depth = 0;
+    unbounded = FALSE;
+    m_bound_state = BOUND_NONE;
+    m_bound_mem = 0;
+    m_bound_reg = 0;
 }
 
 
@@ -1342,16 +1638,149 @@ Chuck_VM_Code::~Chuck_VM_Code()
         SAFE_DELETE_ARRAY( instr );
     }
 
+    // free lowered form
+    SAFE_DELETE( bytecode );
+
     num_instr = 0;
 }
 
 
 
 
+// 4-byte words, rounded up, as the call instructions count them
+#define VM_WORDS( bytes ) ( ((bytes) >> 2) + ((bytes) & 0x3 ? 1 : 0) )
+//-----------------------------------------------------------------------------
+// name: stack_bounds()
+// desc: depth-first over the call graph; a call back into code still being
+//       visited is recursion, and makes the whole chain unknown
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM_Code::stack_bounds( t_CKUINT & mem, t_CKUINT & reg )
+{
+    // memo
+    if( m_bound_state == BOUND_DONE )
+    { mem = m_bound_mem; reg = m_bound_reg; return TRUE; }
+    if( m_bound_state != BOUND_NONE || unbounded )
+        return FALSE;
+
+    // native code only reads its arguments
+    if( native_func )
+    {
+        mem = VM_WORDS( stack_depth ) * sizeof(t_CKUINT);
+        reg = 0;
+        m_bound_state = BOUND_DONE;
+        m_bound_mem = mem; m_bound_reg = reg;
+        return TRUE;
+    }
+
+    m_bound_state = BOUND_VISITING;
+
+    // deepest callee (native arguments land past our locals, like a call)
+    t_CKUINT c_mem = VM_WORDS( native_depth ) * sizeof(t_CKUINT);
+    t_CKUINT c_reg = 0, m = 0, r = 0;
+    t_CKUINT i, n = callees.size() + callee_codes.size();
+    for( i = 0; i < n; i++ )
+    {
+        Chuck_VM_Code * code = i < callees.size() ? callees[i]->code
+                               : callee_codes[i - callees.size()];
+        if( !code || !code->stack_bounds( m, r ) )
+        {
+            m_bound_state = BOUND_UNKNOWN;
+            return FALSE;
+        }
+        if( m > c_mem ) c_mem = m;
+        if( r > c_reg ) c_reg = r;
+    }
+
+    // a call skips the caller's args and locals, then pushes 4 words
+    mem = ( VM_WORDS( stack_depth ) + 2 * VM_WORDS( frame_depth ) + 4 )
+          * sizeof(t_CKUINT) + c_mem;
+    reg = reg_depth + c_reg;
+
+    m_bound_state = BOUND_DONE;
+    m_bound_mem = mem; m_bound_reg = reg;
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stack_size_for()
+// desc: stack sizes for a shred running code; the defaults unless the bounds
+//       are known, then the bound plus headroom, rounded to a power of two
+//-----------------------------------------------------------------------------
+void Chuck_VM::stack_size_for( Chuck_VM_Code * code, t_CKUINT & mem_size,
+                               t_CKUINT & reg_size )
+{
+    t_CKUINT mem, reg;
+    if( !code->stack_bounds( mem, reg ) )
+        return;
+
+    // headroom (the stack keeps 1/16 as overflow padding)
+    mem += mem / 4 + 256;
+    reg += reg / 4 + 256;
+    t_CKUINT size;
+    for( size = 256; size < mem && size < mem_size; size <<= 1 );
+    mem_size = size;
+    for( size = 256; size < reg && size < reg_size; size <<= 1 );
+    reg_size = size;
+}
+
+
+
+
 // offset in bytes at the beginning of a stack for initializing data
 #define VM_STACK_OFFSET  16
 // 1/factor of stack is left blank, to give room to detect overflow
 #define VM_STACK_PADDING_FACTOR 16
+// pooled stack sizes are powers of two from 2^MIN to 2^MAX
+#define VM_STACK_POOL_MIN 8
+#define VM_STACK_POOL_MAX 16
+// bytes kept free per size class
+#define VM_STACK_POOL_KEEP ( 0x1 << 21 )
+//-----------------------------------------------------------------------------
+// name: struct Chuck_VM_Stack_Pool
+// desc: free lists of stack buffers by power-of-two size, threaded through
+//       the buffers themselves; like Chuck_VM_Pool, only the VM thread
+//       allocates and frees shreds, so there is no lock
+//-----------------------------------------------------------------------------
+struct Chuck_VM_Stack_Pool
+{
+    static t_CKBYTE * free_list[VM_STACK_POOL_MAX + 1];
+    static t_CKUINT count[VM_STACK_POOL_MAX + 1];
+
+    // size class of a request, 0 if not pooled
+    static t_CKUINT which( t_CKUINT size )
+    {
+        for( t_CKUINT i = VM_STACK_POOL_MIN; i <= VM_STACK_POOL_MAX; i++ )
+            if( size == ((t_CKUINT)1 << i) ) return i;
+        return 0;
+    }
+
+    static t_CKBYTE * alloc( t_CKUINT c )
+    {
+        t_CKBYTE * buf = free_list[c];
+        if( !buf ) return NULL;
+        free_list[c] = *(t_CKBYTE **)buf;
+        count[c]--;
+        return buf;
+    }
+
+    static t_CKBOOL free( t_CKUINT c, t_CKBYTE * buf )
+    {
+        if( count[c] >= (VM_STACK_POOL_KEEP >> c) ) return FALSE;
+        *(t_CKBYTE **)buf = free_list[c];
+        free_list[c] = buf;
+        count[c]++;
+        return TRUE;
+    }
+};
+t_CKBYTE * Chuck_VM_Stack_Pool::free_list[VM_STACK_POOL_MAX + 1];
+t_CKUINT Chuck_VM_Stack_Pool::count[VM_STACK_POOL_MAX + 1];
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: initialize()
 // desc: ...
@@ -1361,10 +1790,14 @@ t_CKBOOL Chuck_VM_Stack::initialize( t_CKUINT size )
     if( m_is_init )
         return FALSE;
 
+    // remember for shutdown
+    m_size = size;
     // make room for header
     size += VM_STACK_OFFSET;
-    // allocate stack
-    stack = new t_CKBYTE[size];
+    // reuse a stack of this size, or allocate one
+    t_CKUINT c = Chuck_VM_Stack_Pool::which( m_size );
+    stack = c ? Chuck_VM_Stack_Pool::alloc( c ) : NULL;
+    if( !stack ) stack = new t_CKBYTE[size];
     if( !stack ) goto out_of_memory;
 
     // zero
@@ -1402,9 +1835,11 @@ t_CKBOOL Chuck_VM_Stack::shutdown()
     if( !m_is_init )
         return FALSE;
 
-    // free the stack
+    // free the stack (back to the pool when there is room)
     stack -= VM_STACK_OFFSET;
-    SAFE_DELETE_ARRAY( stack );
+    t_CKUINT c = Chuck_VM_Stack_Pool::which( m_size );
+    if( c && Chuck_VM_Stack_Pool::free( c, stack ) ) stack = NULL;
+    else SAFE_DELETE_ARRAY( stack );
     sp = sp_max = NULL;
 
     // set the flag to false
@@ -1433,7 +1868,10 @@ Chuck_VM_Shred::Chuck_VM_Shred()
     base_ref = NULL;
     vm_ref = NULL;
     event = NULL;
+    event_prev = event_next = NULL;
     xid = 0;
+    heap_index = -1;
+    heap_seq = 0;
 
     // set
     CK_TRACK( stat = NULL );
@@ -1570,23 +2008,35 @@ t_CKBOOL Chuck_VM_Shred::run( Chuck_VM * vm )
 {
     // get the code
     instr = code->instr;
-    is_running = TRUE;
-    t_CKBOOL * vm_running = &vm->m_running;
 
-    // go!
-    while( is_running && *vm_running && !is_abort )
+    // threaded engine
+    if( vm->m_engine == CK_VM_ENGINE_THREADED )
+    {
+        // go!
+        bytecode_exec( vm, this );
+        // function calls may have switched code
+        instr = code->instr;
+    }
+    else
     {
-        // execute the instruction
-        instr[pc]->execute( vm, this );
+        is_running = TRUE;
+        t_CKBOOL * vm_running = &vm->m_running;
+
+        // go!
+        while( is_running && *vm_running && !is_abort )
+        {
+            // execute the instruction
+            instr[pc]->execute( vm, this );
 
-        // set to next_pc;
-        pc = next_pc;
-        next_pc++;
+            // set to next_pc;
+            pc = next_pc;
+            next_pc++;
 
-        // track number of cycles
-        CK_TRACK( this->stat->cycles++ );
+            // track number of cycles
+            CK_TRACK( this->stat->cycles++ );
+        }
     }
-    
+
     // check abort
     if( is_abort )
     {
@@ -1603,6 +2053,228 @@ t_CKBOOL Chuck_VM_Shred::run( Chuck_VM * vm )
 
 
 
+//-----------------------------------------------------------------------------
+// name: Chuck_VM_Shred_Queue()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_VM_Shred_Queue::Chuck_VM_Shred_Queue()
+{
+    m_seq = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~Chuck_VM_Shred_Queue()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_VM_Shred_Queue::~Chuck_VM_Shred_Queue()
+{
+    // shreds are not owned by the queue
+    for( t_CKUINT i = 0; i < m_heap.size(); i++ )
+        m_heap[i]->heap_index = -1;
+    m_heap.clear();
+}
+
+
+
+
+// wake first; for equal wake time, first shreduled
+#define SHRED_QUEUE_BEFORE( a, b ) \
+    ( (a)->wake_time < (b)->wake_time || \
+      ( (a)->wake_time == (b)->wake_time && (a)->heap_seq < (b)->heap_seq ) )
+//-----------------------------------------------------------------------------
+// name: place()
+// desc: put shred at heap position i
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shred_Queue::place( t_CKUINT i, Chuck_VM_Shred * shred )
+{
+    m_heap[i] = shred;
+    shred->heap_index = (t_CKINT)i;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sift_up()
+// desc: ...
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shred_Queue::sift_up( t_CKUINT i )
+{
+    Chuck_VM_Shred * shred = m_heap[i];
+    t_CKUINT parent;
+
+    while( i > 0 )
+    {
+        parent = (i - 1) >> 1;
+        if( !SHRED_QUEUE_BEFORE( shred, m_heap[parent] ) )
+            break;
+        place( i, m_heap[parent] );
+        i = parent;
+    }
+
+    place( i, shred );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sift_down()
+// desc: ...
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shred_Queue::sift_down( t_CKUINT i )
+{
+    Chuck_VM_Shred * shred = m_heap[i];
+    t_CKUINT size = m_heap.size();
+    t_CKUINT child;
+
+    while( (child = (i << 1) + 1) < size )
+    {
+        // pick the earlier of the two children
+        if( child + 1 < size && SHRED_QUEUE_BEFORE( m_heap[child+1], m_heap[child] ) )
+            child++;
+        if( !SHRED_QUEUE_BEFORE( m_heap[child], shred ) )
+            break;
+        place( i, m_heap[child] );
+        i = child;
+    }
+
+    place( i, shred );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: push()
+// desc: insert shred, ordered by its wake_time
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shred_Queue::push( Chuck_VM_Shred * shred )
+{
+    // stamp
+    shred->heap_seq = m_seq++;
+    // append and restore order
+    m_heap.push_back( shred );
+    sift_up( m_heap.size() - 1 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: push()
+// desc: insert n shreds at once; a batch bigger than the heap is heapified
+//       along with it, rather than sifted in one at a time
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shred_Queue::push( Chuck_VM_Shred ** shreds, t_CKUINT n )
+{
+    t_CKUINT size = m_heap.size();
+    t_CKUINT i;
+
+    for( i = 0; i < n; i++ )
+    {
+        shreds[i]->heap_seq = m_seq++;
+        m_heap.push_back( shreds[i] );
+    }
+
+    if( n > size )
+    {
+        for( i = size; i < m_heap.size(); i++ )
+            m_heap[i]->heap_index = (t_CKINT)i;
+        for( i = m_heap.size() / 2; i-- > 0; )
+            sift_down( i );
+    }
+    else
+    {
+        for( i = size; i < m_heap.size(); i++ )
+            sift_up( i );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pop()
+// desc: remove and return the earliest shred
+//-----------------------------------------------------------------------------
+Chuck_VM_Shred * Chuck_VM_Shred_Queue::pop( )
+{
+    if( m_heap.empty() ) return NULL;
+
+    Chuck_VM_Shred * shred = m_heap[0];
+    this->remove( shred );
+
+    return shred;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: contains()
+// desc: ...
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM_Shred_Queue::contains( Chuck_VM_Shred * shred ) const
+{
+    return shred->heap_index >= 0 && (t_CKUINT)shred->heap_index < m_heap.size()
+           && m_heap[shred->heap_index] == shred;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: remove()
+// desc: remove shred from anywhere in the queue
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM_Shred_Queue::remove( Chuck_VM_Shred * shred )
+{
+    if( !contains( shred ) ) return FALSE;
+
+    t_CKUINT i = (t_CKUINT)shred->heap_index;
+    Chuck_VM_Shred * last = m_heap.back();
+    m_heap.pop_back();
+    shred->heap_index = -1;
+
+    // move the last one into the hole
+    if( last != shred )
+    {
+        place( i, last );
+        if( i > 0 && SHRED_QUEUE_BEFORE( last, m_heap[(i - 1) >> 1] ) )
+            sift_up( i );
+        else
+            sift_down( i );
+    }
+
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: replace()
+// desc: put 'in' in place of 'out', with the same wake time and order
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM_Shred_Queue::replace( Chuck_VM_Shred * out, Chuck_VM_Shred * in )
+{
+    if( !contains( out ) || in->heap_index >= 0 ) return FALSE;
+
+    in->wake_time = out->wake_time;
+    in->heap_seq = out->heap_seq;
+    place( (t_CKUINT)out->heap_index, in );
+    out->heap_index = -1;
+
+    return TRUE;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: Chuck_VM_Shreduler()
 // desc: ...
@@ -1612,13 +2284,16 @@ Chuck_VM_Shreduler::Chuck_VM_Shreduler()
     now_system = 0;
     rt_audio = FALSE;
     bbq = NULL;
-    shred_list = NULL;
     m_current_shred = NULL;
     m_dac = NULL;
     m_adc = NULL;
     m_bunghole = NULL;
     m_num_dac_channels = 0;
     m_num_adc_channels = 0;
+    m_flat_graph = TRUE;
+    m_render_pool = NULL;
+    m_render = NULL;
+    m_record = NULL;
     
     set_adaptive( 0 );
 }
@@ -1656,6 +2331,10 @@ t_CKBOOL Chuck_VM_Shreduler::initialize()
 //-----------------------------------------------------------------------------
 t_CKBOOL Chuck_VM_Shreduler::shutdown()
 {
+    // stop rendering threads
+    m_ugen_schedule.set_pool( NULL );
+    SAFE_DELETE( m_render_pool );
+
     return TRUE;
 }
 
@@ -1676,14 +2355,45 @@ void Chuck_VM_Shreduler::set_adaptive( t_CKUINT max_block_size )
 
 
 
+//-----------------------------------------------------------------------------
+// name: set_render_threads()
+// desc: tick independent parts of the ugen graph on num_threads threads
+//       (including the vm thread); applies to block processing
+//-----------------------------------------------------------------------------
+t_CKBOOL Chuck_VM_Shreduler::set_render_threads( t_CKUINT num_threads )
+{
+    // clean up
+    m_ugen_schedule.set_pool( NULL );
+    SAFE_DELETE( m_render_pool );
+
+    // single threaded
+    if( num_threads <= 1 ) return TRUE;
+
+    // the vm thread is one of them
+    m_render_pool = new XWorkPool;
+    if( !m_render_pool->start( num_threads - 1 ) )
+    {
+        EM_error3( "[chuck](VM): could not start %d render threads", num_threads - 1 );
+        SAFE_DELETE( m_render_pool );
+        return FALSE;
+    }
+
+    m_ugen_schedule.set_pool( m_render_pool );
+    return TRUE;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: add_blocked()
 // desc: add shred to the shreduler's blocked list
 //-----------------------------------------------------------------------------
 t_CKBOOL Chuck_VM_Shreduler::add_blocked( Chuck_VM_Shred * shred )
 {
-    // add shred to map, using pointer
-    blocked[shred] = shred;
+    // (shred->event marks it blocked)
+    // index by id
+    shred_index[shred->xid] = shred;
     
     return TRUE;
 }
@@ -1697,10 +2407,8 @@ t_CKBOOL Chuck_VM_Shreduler::add_blocked( Chuck_VM_Shred * shred )
 //-----------------------------------------------------------------------------
 t_CKBOOL Chuck_VM_Shreduler::remove_blocked( Chuck_VM_Shred * shred )
 {
-    // remove from hash
-    std::map<Chuck_VM_Shred *, Chuck_VM_Shred *>::iterator iter;
-    iter = blocked.find( shred );
-    blocked.erase( iter );
+    // remove from index
+    unindex( shred );
 
     // remove from event
     if( shred->event != NULL ) shred->event->remove( shred );
@@ -1711,6 +2419,47 @@ t_CKBOOL Chuck_VM_Shreduler::remove_blocked( Chuck_VM_Shred * shred )
 
 
 
+//-----------------------------------------------------------------------------
+// name: wake()
+// desc: shredule at now a list of shreds (linked by event_next) taken off an
+//       event's wait list, as one batch; each is already indexed by id, and
+//       gets now pushed as the result of its wait
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shreduler::wake( Chuck_VM_Shred * list )
+{
+    Chuck_VM_Shred * shred, * next;
+
+    m_wake.clear();
+    for( shred = list; shred != NULL; shred = next )
+    {
+        next = shred->event_next;
+        shred->event_prev = shred->event_next = NULL;
+        shred->event = NULL;
+
+        // sanity check
+        if( shred->heap_index >= 0 )
+        {
+            EM_error3( "[chuck](VM): internal sanity check failed in wake()" );
+            EM_error3( "[chuck](VM): (shred shreduled while shreduled)" );
+            continue;
+        }
+
+        shred->wake_time = this->now_system;
+        // push the current time
+        t_CKTIME *& sp = (t_CKTIME *&)shred->reg->sp;
+        push_( sp, this->now_system );
+        m_wake.push_back( shred );
+    }
+
+    if( m_wake.empty() ) return;
+
+    shred_queue.push( &m_wake[0], m_wake.size() );
+    m_samps_until_next = 0;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: shredule()
 // desc: ...
@@ -1731,7 +2480,7 @@ t_CKBOOL Chuck_VM_Shreduler::shredule( Chuck_VM_Shred * shred,
                                        t_CKTIME wake_time )
 {
     // sanity check
-    if( shred->prev || shred->next )
+    if( shred->heap_index >= 0 )
     {
         // something is really wrong here - no shred can be 
         // shreduled more than once
@@ -1753,42 +2502,12 @@ t_CKBOOL Chuck_VM_Shreduler::shredule( Chuck_VM_Shred * shred,
 
     shred->wake_time = wake_time;
 
-    // list empty
-    if( !shred_list )
-        shred_list = shred;
-    else
-    {
-        // pointers to the shred queue
-        Chuck_VM_Shred * curr = shred_list;
-        Chuck_VM_Shred * prev = NULL;
+    // insert in wake time order
+    shred_queue.push( shred );
+    // index by id
+    shred_index[shred->xid] = shred;
 
-        while( curr )
-        {
-            // found the place to insert
-            if( curr->wake_time > wake_time )
-                break;
-
-            prev = curr;
-            curr = curr->next;
-        }
-
-        if( !prev )
-        {
-            shred->next = shred_list;
-            if( shred_list ) shred_list->prev = shred;
-            shred_list = shred;
-        }
-        else
-        {
-            // insert the shred in sorted order
-            shred->next = prev->next;
-            shred->prev = prev;
-            if( prev->next ) prev->next->prev = shred;
-            prev->next = shred;
-        }
-    }
-
-    t_CKTIME diff = shred_list->wake_time - this->now_system;
+    t_CKTIME diff = shred_queue.top()->wake_time - this->now_system;
     if( diff < 0 ) diff = 0;
     // if( diff < m_samps_until_next )
     m_samps_until_next = diff;
@@ -1860,11 +2579,14 @@ void Chuck_VM_Shreduler::advance_v( t_CKINT & numLeft )
         m_adc->m_time = this->now_system;
     }
 
-    // dac
-    m_dac->system_tick_v( this->now_system, numFrames );
-
-    // suck samples
-    m_bunghole->system_tick_v( this->now_system, numFrames );
+    // dac, suck samples
+    if( m_flat_graph )
+        m_ugen_schedule.tick_v( this->now_system, numFrames );
+    else
+    {
+        m_dac->system_tick_v( this->now_system, numFrames );
+        m_bunghole->system_tick_v( this->now_system, numFrames );
+    }
 
     // adaptive block
     for( i = 0; i < numFrames; i++ )
@@ -1873,7 +2595,9 @@ void Chuck_VM_Shreduler::advance_v( t_CKINT & numLeft )
             frame[j] = m_dac->m_multi_chan[j]->m_current_v[i];
         
         // tick
-        audio->digi_out()->tick_out( frame, m_num_dac_channels );
+        if( m_record ) record( frame );
+        if( m_render ) m_render->tick( frame );
+        else audio->digi_out()->tick_out( frame, m_num_dac_channels );
     }
 }
 
@@ -1906,18 +2630,23 @@ void Chuck_VM_Shreduler::advance2( )
         m_adc->m_time = this->now_system;
     }
 
-    // dac
-    m_dac->system_tick( this->now_system );
+    // dac, suck samples
+    if( m_flat_graph )
+        m_ugen_schedule.tick( this->now_system );
+    else
+    {
+        m_dac->system_tick( this->now_system );
+        m_bunghole->system_tick( this->now_system );
+    }
     l = m_dac->m_multi_chan[0]->m_current;
     r = m_dac->m_multi_chan[1]->m_current;
     // remove: 1.2.1.2
     // l *= .5f; r *= .5f;
 
-    // suck samples
-    m_bunghole->system_tick( this->now_system );
-
     // tick
-    audio->digi_out()->tick_out( l, r );
+    if( m_record ) { SAMPLE frame[2] = { l, r }; record( frame ); }
+    if( m_render ) { SAMPLE frame[2] = { l, r }; m_render->tick( frame ); }
+    else audio->digi_out()->tick_out( l, r );
 }
 
 
@@ -1955,16 +2684,33 @@ void Chuck_VM_Shreduler::advance( )
         m_adc->m_time = this->now_system;
     }
 
-    // dac
-    m_dac->system_tick( this->now_system );
+    // dac, suck samples
+    if( m_flat_graph )
+        m_ugen_schedule.tick( this->now_system );
+    else
+    {
+        m_dac->system_tick( this->now_system );
+        m_bunghole->system_tick( this->now_system );
+    }
     for( i = 0; i < m_num_dac_channels; i++ )
         frame[i] = m_dac->m_multi_chan[i]->m_current; // * .5f;
 
-    // suck samples
-    m_bunghole->system_tick( this->now_system );
-
     // tick
-    audio->digi_out()->tick_out( frame, m_num_dac_channels );
+    if( m_record ) record( frame );
+    if( m_render ) m_render->tick( frame );
+    else audio->digi_out()->tick_out( frame, m_num_dac_channels );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: record()
+// desc: copy one dac frame to the recording
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shreduler::record( const SAMPLE * frame )
+{
+    m_record->tickSamples( frame );
 }
 
 
@@ -1976,9 +2722,9 @@ void Chuck_VM_Shreduler::advance( )
 //-----------------------------------------------------------------------------
 Chuck_VM_Shred * Chuck_VM_Shreduler::get( )
 {
-    Chuck_VM_Shred * shred = shred_list;
+    Chuck_VM_Shred * shred = shred_queue.top();
 
-    // list empty
+    // queue empty
     if( !shred )
     {
         m_samps_until_next = -1;
@@ -1991,14 +2737,12 @@ Chuck_VM_Shred * Chuck_VM_Shreduler::get( )
         // if( shred->wake_time < this->now_system )
         //    assert( false );
 
-        shred_list = shred->next;
-        shred->next = NULL;
-        shred->prev = NULL;
+        shred_queue.pop();
+        unindex( shred );
         
-        if( shred_list )
+        if( shred_queue.top() )
         {
-            shred_list->prev = NULL;
-            m_samps_until_next = shred_list->wake_time - this->now_system;
+            m_samps_until_next = shred_queue.top()->wake_time - this->now_system;
             if( m_samps_until_next < 0 ) m_samps_until_next = 0;
         }
 
@@ -2017,23 +2761,10 @@ Chuck_VM_Shred * Chuck_VM_Shreduler::get( )
 //-----------------------------------------------------------------------------
 t_CKUINT Chuck_VM_Shreduler::highest( )
 {
-    Chuck_VM_Shred * shred = shred_list;
-    t_CKUINT n = 0;
-
-    while( shred )
-    {
-        if( shred->xid > n ) n = shred->xid;
-        shred = shred->next;
-    }
+    // the index is ordered by id
+    if( shred_index.empty() ) return 0;
 
-    std::map<Chuck_VM_Shred *, Chuck_VM_Shred *>::iterator iter;    
-    for( iter = blocked.begin(); iter != blocked.end(); iter++ )
-    {
-        shred = (*iter).second;
-        if( shred->xid > n ) n = shred->xid;
-    }
-
-    return n;
+    return (*shred_index.rbegin()).first;
 }
 
 
@@ -2051,20 +2782,14 @@ t_CKBOOL Chuck_VM_Shreduler::replace( Chuck_VM_Shred * out, Chuck_VM_Shred * in
     if( !out || !in )
         return FALSE;
 
-    if( !out->prev )
-        shred_list = in;
-    else
-        out->prev->next = in;
-    
-    if( out->next )
-        out->next->prev = in;
-    
-    in->next = out->next;
-    in->prev = out->prev;
-    
-    out->next = out->prev = NULL;
+    // take over the slot in the queue
+    if( !shred_queue.replace( out, in ) )
+        return FALSE;
+
+    // update index
+    unindex( out );
+    shred_index[in->xid] = in;
 
-    in->wake_time = out->wake_time;
     in->start = in->wake_time;
     
     return TRUE;
@@ -2088,18 +2813,11 @@ t_CKBOOL Chuck_VM_Shreduler::remove( Chuck_VM_Shred * out )
     }
 
     // sanity check
-    if( !out->prev && !out->next && out != shred_list )
+    if( !shred_queue.remove( out ) )
         return FALSE;
-    
-    if( !out->prev )
-        shred_list = out->next;
-    else
-        out->prev->next = out->next;
-    
-    if( out->next )
-        out->next->prev = out->prev;
-    
-    out->next = out->prev = NULL;
+
+    // remove from index
+    unindex( out );
 
     return TRUE;
 }
@@ -2108,34 +2826,35 @@ t_CKBOOL Chuck_VM_Shreduler::remove( Chuck_VM_Shred * out )
 
 
 //-----------------------------------------------------------------------------
-// name: get()
+// name: unindex()
+// desc: remove shred from the id index, if the entry is for this shred
+//-----------------------------------------------------------------------------
+void Chuck_VM_Shreduler::unindex( Chuck_VM_Shred * shred )
+{
+    std::map<t_CKUINT, Chuck_VM_Shred *>::iterator iter;
+    iter = shred_index.find( shred->xid );
+    if( iter != shred_index.end() && (*iter).second == shred )
+        shred_index.erase( iter );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lookup()
 // desc: ...
 //-----------------------------------------------------------------------------
 Chuck_VM_Shred * Chuck_VM_Shreduler::lookup( t_CKUINT xid )
 {
-    Chuck_VM_Shred * shred = shred_list;
-
     // current shred?
     if( m_current_shred != NULL && m_current_shred->xid == xid )
         return m_current_shred;
 
-    // look for in shreduled list
-    while( shred )
-    {
-        if( shred->xid == xid )
-            return shred;
-
-        shred = shred->next;
-    }
-
-    // blocked?
-    std::map<Chuck_VM_Shred *, Chuck_VM_Shred *>::iterator iter;
-    for( iter = blocked.begin(); iter != blocked.end(); iter++ )
-    {
-        shred = (*iter).second;
-        if( shred->xid == xid )
-            return shred;
-    }
+    // shreduled or blocked?
+    std::map<t_CKUINT, Chuck_VM_Shred *>::iterator iter;
+    iter = shred_index.find( xid );
+    if( iter != shred_index.end() )
+        return (*iter).second;
     
     return NULL;
 }
@@ -2162,7 +2881,7 @@ struct SortByID
 //-----------------------------------------------------------------------------
 void Chuck_VM_Shreduler::status( Chuck_VM_Status * status )
 {
-    Chuck_VM_Shred * shred = shred_list;
+    Chuck_VM_Shred * shred = NULL;
     Chuck_VM_Shred * temp = NULL;
 
     t_CKUINT srate = Digitalio::sampling_rate();
@@ -2181,24 +2900,16 @@ void Chuck_VM_Shreduler::status( Chuck_VM_Status * status )
     status->t_minute = m;
     status->t_hour = h;
     
-    // get list of shreds
+    // get list of shreds (shreduled and blocked)
     vector<Chuck_VM_Shred *> list;
-    while( shred )
-    {
-        list.push_back( shred );
-        shred = shred->next;
-    }
-
-    // get blocked
-    std::map<Chuck_VM_Shred *, Chuck_VM_Shred *>::iterator iter;    
-    for( iter = blocked.begin(); iter != blocked.end(); iter++ )
-    {
-        shred = (*iter).second;
-        list.push_back( shred );
-    }
-
-    // get current shred
-    if( temp = m_current_shred )
+    std::map<t_CKUINT, Chuck_VM_Shred *>::iterator iter;
+    for( iter = shred_index.begin(); iter != shred_index.end(); iter++ )
+        list.push_back( (*iter).second );
+
+    // get current shred (if not already in the index)
+    if( ( temp = m_current_shred ) && 
+        ( ( iter = shred_index.find( temp->xid ) ) == shred_index.end() ||
+          (*iter).second != temp ) )
         list.push_back( temp );
 
     // sort the list
@@ -35,6 +35,7 @@
 
 #include "chuck_oo.h"
 #include "chuck_ugen.h"
+#include "chuck_bytecode.h"
 
 // tracking
 #ifdef __CHUCK_STAT_TRACK__
@@ -65,6 +66,24 @@ struct Chuck_Msg;
 class BBQ;
 class CBufferSimple;
 class Digitalio;
+struct Chuck_Render;
+class WvOut;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_VM_Callback
+// desc: a function for the vm to call on its own thread at a sample time
+//-----------------------------------------------------------------------------
+struct Chuck_VM_Callback
+{
+    t_CKTIME when;
+    void (* func)( void * data );
+    void * data;
+    // frees data if the callback never runs (may be NULL)
+    void (* drop)( void * data );
+};
 
 
 
@@ -93,6 +112,8 @@ public: // machine
     t_CKBYTE * stack;
     t_CKBYTE * sp;
     t_CKBYTE * sp_max;
+    // requested size (selects the pool class)
+    t_CKUINT m_size;
 
 public: // linked list
     Chuck_VM_Stack * prev;
@@ -131,7 +152,35 @@ public:
     t_CKUINT native_func;
     // is ctor?
     t_CKUINT native_func_type;
+    // lowered form for the threaded engine (created on first run)
+    Chuck_Bytecode * bytecode;
+
+public: // stack bounds, as recorded by the emitter
+    // deepest local frame, in bytes
+    t_CKUINT frame_depth;
+    // upper bound on operand (reg) stack use, in bytes
+    t_CKUINT reg_depth;
+    // deepest argument list passed to a native function, in bytes
+    t_CKUINT native_depth;
+    // user functions called (code is resolved lazily; may be emitted later)
+    std::vector<Chuck_Func *> callees;
+    // other code called (pre-constructors)
+    std::vector<Chuck_VM_Code *> callee_codes;
+    // calls something that can't be known statically (virtual member)
+    t_CKBOOL unbounded;
+
+    // worst-case mem and reg stack use of a shred running this code;
+    // FALSE if unknown (recursion, virtual calls)
+    t_CKBOOL stack_bounds( t_CKUINT & mem, t_CKUINT & reg );
 
+protected:
+    // memo for stack_bounds()
+    enum { BOUND_NONE, BOUND_VISITING, BOUND_DONE, BOUND_UNKNOWN };
+    t_CKUINT m_bound_state;
+    t_CKUINT m_bound_mem;
+    t_CKUINT m_bound_reg;
+
+public:
     // native func types
     enum { NATIVE_UNKNOWN, NATIVE_CTOR, NATIVE_DTOR, NATIVE_MFUN, NATIVE_SFUN };
 };
@@ -198,6 +247,8 @@ public:
     t_CKBOOL is_abort;
     t_CKBOOL is_dumped;
     Chuck_Event * event;  // event shred is waiting on
+    Chuck_VM_Shred * event_prev; // neighbors in its wait list
+    Chuck_VM_Shred * event_next;
     std::map<Chuck_UGen *, Chuck_UGen *> m_ugen_map;
 
 public: // id
@@ -209,6 +260,12 @@ public:
     Chuck_VM_Shred * prev;
     Chuck_VM_Shred * next;
 
+public: // shreduler queue
+    // position in the shreduler heap (-1 if not shreduled)
+    t_CKINT heap_index;
+    // insertion order, breaks ties between equal wake times
+    t_CKUINT heap_seq;
+
     // tracking
     CK_TRACK( Shred_Stat * stat );
 };
@@ -268,6 +325,42 @@ public:
 
 
 
+//-----------------------------------------------------------------------------
+// name: struct Chuck_VM_Shred_Queue
+// desc: shreds waiting on time, ordered by wake time (binary min-heap);
+//       shreds with equal wake time are dequeued in the order shreduled
+//-----------------------------------------------------------------------------
+struct Chuck_VM_Shred_Queue
+{
+public:
+    Chuck_VM_Shred_Queue();
+    ~Chuck_VM_Shred_Queue();
+
+public:
+    void push( Chuck_VM_Shred * shred );
+    void push( Chuck_VM_Shred ** shreds, t_CKUINT n );
+    Chuck_VM_Shred * pop( );
+    Chuck_VM_Shred * top( ) const
+    { return m_heap.size() ? m_heap[0] : NULL; }
+    t_CKBOOL remove( Chuck_VM_Shred * shred );
+    t_CKBOOL replace( Chuck_VM_Shred * out, Chuck_VM_Shred * in );
+    t_CKBOOL contains( Chuck_VM_Shred * shred ) const;
+    t_CKUINT size( ) const { return m_heap.size(); }
+    Chuck_VM_Shred * at( t_CKUINT i ) const { return m_heap[i]; }
+
+protected:
+    void place( t_CKUINT i, Chuck_VM_Shred * shred );
+    void sift_up( t_CKUINT i );
+    void sift_down( t_CKUINT i );
+
+protected:
+    std::vector<Chuck_VM_Shred *> m_heap;
+    t_CKUINT m_seq;
+};
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: struct Chuck_VM_Shreduler
 // desc: ...
@@ -293,6 +386,8 @@ public: // shreduling
     void advance2( );
     void advance_v( t_CKINT & num_left );
     void set_adaptive( t_CKUINT max_block_size );
+    t_CKBOOL set_render_threads( t_CKUINT num_threads );
+    void record( const SAMPLE * frame );
 
 public: // high-level shred interface
     t_CKBOOL remove( Chuck_VM_Shred * shred );
@@ -305,6 +400,10 @@ public: // high-level shred interface
 public: // for event related shred queue
     t_CKBOOL add_blocked( Chuck_VM_Shred * shred );
     t_CKBOOL remove_blocked( Chuck_VM_Shred * shred );
+    void wake( Chuck_VM_Shred * list );
+
+protected:
+    void unindex( Chuck_VM_Shred * shred );
 
 //-----------------------------------------------------------------------------
 // data
@@ -316,9 +415,12 @@ public:
     BBQ * bbq;
 
     // shreds to be shreduled
-    Chuck_VM_Shred * shred_list;
-    // shreds waiting on events
-    std::map<Chuck_VM_Shred *, Chuck_VM_Shred *> blocked;
+    Chuck_VM_Shred_Queue shred_queue;
+    // shreds known to the shreduler (shreduled or blocked), by id
+    std::map<t_CKUINT, Chuck_VM_Shred *> shred_index;
+    // (shreds waiting on events are those with shred->event set)
+    // shreds being woken together, reused
+    std::vector<Chuck_VM_Shred *> m_wake;
     // current shred
     Chuck_VM_Shred * m_current_shred; // TODO: ref count?
 
@@ -328,6 +430,15 @@ public:
     Chuck_UGen * m_bunghole;
     t_CKUINT m_num_dac_channels;
     t_CKUINT m_num_adc_channels;
+    // flattened ugen graph (dac, blackhole), if m_flat_graph
+    Chuck_UGen_Schedule m_ugen_schedule;
+    t_CKBOOL m_flat_graph;
+    // render threads for the flattened graph (block processing only)
+    XWorkPool * m_render_pool;
+    // offline render target, replaces the dac output if set
+    Chuck_Render * m_render;
+    // copy of the dac output, if recording
+    WvOut * m_record;
     
     // status cache
     Chuck_VM_Status m_status;
@@ -394,6 +505,10 @@ public: // garbage collection
 public: // msg
     t_CKBOOL queue_msg( Chuck_Msg * msg, int num_msg );
     t_CKBOOL queue_event( Chuck_Event * event, int num_msg );
+    // call func( data ) from compute() once now reaches 'when' (any thread);
+    // drop( data ) instead if the vm shuts down first
+    t_CKBOOL queue_callback( t_CKTIME when, void (* func)( void * ), void * data,
+                             void (* drop)( void * ) = NULL );
     t_CKUINT process_msg( Chuck_Msg * msg );
     Chuck_Msg * get_reply( );
 
@@ -403,6 +518,16 @@ public: // static/dynamic function table
     t_CKBOOL has_init() { return m_init; }
     t_CKBOOL is_running() { return m_running; }
     
+public: // object reclamation
+    void set_reclaim( t_CKUINT batch );
+
+public: // offline render, instead of real-time audio
+    t_CKBOOL set_render( const std::string & filename, t_CKINT num_samps );
+
+public: // record the dac to a file, alongside the audio output ("" to stop)
+    t_CKBOOL set_record( const std::string & filename );
+    Chuck_String * record_name() { return &m_record_name; }
+
 public: // get error
     const char * last_error() const
     { return m_last_error.c_str(); }
@@ -421,13 +546,23 @@ public:
     t_CKBOOL m_halt;
     t_CKBOOL m_audio;
     t_CKBOOL m_block;
+    // objects destroyed per compute() when reclaim is deferred (0: immediate)
+    t_CKUINT m_reclaim_batch;
+    // size sporked shreds' stacks from the emitter's bounds, when known
+    t_CKBOOL m_bounded_stacks;
 
 protected:
     Chuck_VM_Shred * spork( Chuck_VM_Shred * shred );
+    void stack_size_for( Chuck_VM_Code * code, t_CKUINT & mem_size,
+                         t_CKUINT & reg_size );
+    void resume_caller( Chuck_Msg * msg, t_CKUINT retval );
     t_CKBOOL free( Chuck_VM_Shred * shred, t_CKBOOL cascade, 
                    t_CKBOOL dec = TRUE );
     void dump( Chuck_VM_Shred * shred );
     void release_dump();
+    void finish_render();
+    void run_callbacks();
+    void drop_callbacks();
 
 protected:
     t_CKBOOL m_init;
@@ -446,6 +581,12 @@ protected:
 
     // audio
     BBQ * m_bbq;
+    // offline render, and how many samples (-1 until the vm halts)
+    Chuck_Render * m_render;
+    t_CKINT m_render_samps;
+    // dac recording and its file name
+    WvOut * m_record;
+    Chuck_String m_record_name;
 
     // function table
     // Chuck_VM_FTable * m_func_table;
@@ -455,10 +596,15 @@ protected:
     CBufferSimple * m_msg_buffer;
     CBufferSimple * m_reply_buffer;
     CBufferSimple * m_event_buffer;
+    // callbacks from other threads, and those waiting for their time
+    CBufferSimple * m_callback_buffer;
+    std::multimap<t_CKTIME, Chuck_VM_Callback> m_callbacks;
 
 public:
     // running
     t_CKBOOL m_running;
+    // execution engine (CK_VM_ENGINE_*)
+    t_CKUINT m_engine;
 
     // priority
     static t_CKBOOL set_priority( t_CKINT priority, Chuck_VM * vm );
@@ -512,6 +658,10 @@ struct Chuck_Msg
 
     std::vector<std::string> * args;
 
+    // shred waiting (on event) for the result, if compiled asynchronously
+    Chuck_VM_Shred * caller;
+    Chuck_Event * caller_event;
+
     Chuck_Msg() { memset( this, 0, sizeof(*this) ); }
     ~Chuck_Msg() { SAFE_DELETE( args ); }
     
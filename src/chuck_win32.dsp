@@ -95,6 +95,10 @@ SOURCE=.\chuck_bbq.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\chuck_bytecode.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\chuck_compile.cpp
 # End Source File
 # Begin Source File
@@ -147,6 +151,10 @@ SOURCE=.\chuck_parse.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\chuck_render.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\chuck_scan.cpp
 # End Source File
 # Begin Source File
@@ -292,6 +300,10 @@ SOURCE=.\util_string.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\util_fft.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\util_thread.cpp
 # End Source File
 # Begin Source File
@@ -312,6 +324,10 @@ SOURCE=.\chuck_bbq.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\chuck_bytecode.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\chuck_compile.h
 # End Source File
 # Begin Source File
@@ -364,6 +380,10 @@ SOURCE=.\chuck_parse.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\chuck_render.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\chuck_scan.h
 # End Source File
 # Begin Source File
@@ -500,6 +520,10 @@ SOURCE=.\util_raw.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\util_simd.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\util_sndfile.h
 # End Source File
 # Begin Source File
@@ -508,6 +532,10 @@ SOURCE=.\util_string.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\util_fft.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\util_thread.h
 # End Source File
 # Begin Source File
@@ -70,8 +70,8 @@ SAMPLE ** Digitalio::m_write_ptr = NULL;
 SAMPLE ** Digitalio::m_read_ptr = NULL;
 SAMPLE * Digitalio::m_extern_in = NULL;
 SAMPLE * Digitalio::m_extern_out = NULL;
-BOOL__ Digitalio::m_out_ready = FALSE;
-BOOL__ Digitalio::m_in_ready = FALSE;
+volatile BOOL__ Digitalio::m_out_ready = FALSE;
+volatile BOOL__ Digitalio::m_in_ready = FALSE;
 BOOL__ Digitalio::m_use_cb = USE_CB_DEFAULT;
 DWORD__ Digitalio::m_go = 0;
 DWORD__ Digitalio::m_dac_n = 0;
@@ -79,6 +79,13 @@ DWORD__ Digitalio::m_adc_n = 0;
 DWORD__ Digitalio::m_end = 0;
 DWORD__ Digitalio::m_block = TRUE;
 DWORD__ Digitalio::m_xrun = 0;
+DWORD__ Digitalio::m_wait_hist[CK_DIGIO_WAIT_BINS];
+DWORD__ Digitalio::m_underruns = 0;
+
+// blocking handoff wakeups (the flags above carry the state)
+static XSemaphore g_out_ready_sem( 0, 1 ); // vm -> cb: output rendered
+static XSemaphore g_out_done_sem( 0, 1 );  // cb -> vm: output taken
+static XSemaphore g_in_ready_sem( 0, 1 );  // cb -> vm: input copied
 
 
 // sample
@@ -539,6 +546,90 @@ BOOL__ Digitalio::initialize( DWORD__ num_dac_channels,
 
 
 
+//-----------------------------------------------------------------------------
+// name: handoff_clock()
+// desc: seconds, for timing the handoff (local, unlike get_current_time)
+//-----------------------------------------------------------------------------
+static t_CKFLOAT handoff_clock()
+{
+#ifdef __PLATFORM_WIN32__
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &freq );
+    return (t_CKFLOAT)count.QuadPart / (t_CKFLOAT)freq.QuadPart;
+#else
+    struct timeval t;
+    gettimeofday( &t, NULL );
+    return t.tv_sec + (t_CKFLOAT)t.tv_usec / 1000000;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wait_out_ready()
+// desc: wait up to usec for the vm to finish the output buffer; the flag
+//       is checked without blocking first, the semaphore only wakes us
+//-----------------------------------------------------------------------------
+static BOOL__ wait_out_ready( t_CKUINT usec, t_CKBOOL track )
+{
+    // ready already
+    if( ck_load_acquire( &Digitalio::m_out_ready ) )
+    {
+        if( track ) Digitalio::m_wait_hist[0]++;
+        return TRUE;
+    }
+
+    t_CKFLOAT start = handoff_clock();
+    t_CKUINT waited = 0;
+    BOOL__ ready = FALSE;
+    while( !( ready = ck_load_acquire( &Digitalio::m_out_ready ) ) && waited < usec )
+    {
+        g_out_ready_sem.wait_for( usec - waited );
+        waited = (t_CKUINT)( ( handoff_clock() - start ) * 1000000 );
+    }
+
+    // histogram
+    if( track )
+    {
+        t_CKUINT bin = 1, edge = 250;
+        while( bin < CK_DIGIO_WAIT_BINS - 1 && waited >= edge ) { bin++; edge *= 2; }
+        Digitalio::m_wait_hist[bin]++;
+        if( !ready ) Digitalio::m_underruns++;
+    }
+
+    return ready;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: log_wait_stats()
+// desc: ...
+//-----------------------------------------------------------------------------
+void Digitalio::log_wait_stats()
+{
+    static const char * labels[CK_DIGIO_WAIT_BINS] =
+        { "0", "<250us", "<500us", "<1ms", "<2ms", "<4ms", ">=4ms" };
+    DWORD__ total = 0;
+
+    for( t_CKUINT i = 0; i < CK_DIGIO_WAIT_BINS; i++ ) total += m_wait_hist[i];
+    if( !total ) return;
+
+    EM_log( CK_LOG_SYSTEM, "audio callback wait for vm (%lu buffers, %lu underruns):",
+            (unsigned long)total, (unsigned long)m_underruns );
+    EM_pushlog();
+    for( t_CKUINT i = 0; i < CK_DIGIO_WAIT_BINS; i++ )
+        if( m_wait_hist[i] )
+            EM_log( CK_LOG_SYSTEM, "%6s: %lu", labels[i], (unsigned long)m_wait_hist[i] );
+    EM_poplog();
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: cb()
 // desc: ...
@@ -546,7 +637,6 @@ BOOL__ Digitalio::initialize( DWORD__ num_dac_channels,
 int Digitalio::cb( char * buffer, int buffer_size, void * user_data )
 {
     DWORD__ len = buffer_size * sizeof(SAMPLE) * m_num_channels_out;
-    DWORD__ n = 20;
     DWORD__ start = 50;
 
     // copy input to local buffer
@@ -557,13 +647,15 @@ int Digitalio::cb( char * buffer, int buffer_size, void * user_data )
         if( m_extern_in ) memcpy( m_extern_in, buffer, len );
     }
     // flag ready
-    m_in_ready = TRUE;
+    ck_store_release( &m_in_ready, TRUE );
+    g_in_ready_sem.post();
     // out is ready early
     if( m_go < start && m_go > 1 && m_out_ready ) m_go = start;
     // copy output into local buffer
     if( m_go >= start )
     {
-        while( !m_out_ready && n-- ) usleep( 250 );
+        // wait for the vm, up to 5 ms
+        wait_out_ready( 5000, TRUE );
         if( m_out_ready && g_do_watchdog )
             g_watchdog_time = get_current_time( TRUE );
         // copy local buffer to be rendered
@@ -590,7 +682,7 @@ int Digitalio::cb( char * buffer, int buffer_size, void * user_data )
     // 2nd buffer
     if( m_go == start )
     {
-        n = 8; while( !m_out_ready && n-- ) usleep( 250 );
+        wait_out_ready( 2000, FALSE );
         len /= sizeof(SAMPLE); DWORD__ i = 0;
         SAMPLE * s = (SAMPLE *)buffer;
         while( i < len ) *s++ *= (SAMPLE)i++/len;
@@ -603,7 +695,8 @@ int Digitalio::cb( char * buffer, int buffer_size, void * user_data )
     // set pointer to the beginning - if not ready, then too late anyway
     //*m_write_ptr = (SAMPLE *)m_buffer_out;
     //*m_read_ptr = (SAMPLE *)m_buffer_in;
-    m_out_ready = FALSE;
+    ck_store_release( &m_out_ready, FALSE );
+    g_out_done_sem.post();
 
     return 0;
 }
@@ -807,6 +900,9 @@ void Digitalio::shutdown()
 
     m_init = FALSE;
     m_start = FALSE;
+
+    // handoff timing
+    log_wait_stats();
     
     // stop watchdog
     watchdog_stop();
@@ -987,11 +1083,12 @@ DWORD__ DigitalOut::render()
 
     if( Digitalio::m_block )
     {
-        // synchronize
-        Digitalio::m_out_ready = TRUE;
-        // synchronize
-        while( Digitalio::m_out_ready )
-            usleep( 250 );
+        // hand the buffer to the callback
+        ck_store_release( &Digitalio::m_out_ready, TRUE );
+        g_out_ready_sem.post();
+        // wait until it has been taken
+        while( ck_load_acquire( &Digitalio::m_out_ready ) )
+            g_out_done_sem.wait_for( 10000 );
     }
 
     // set pointer to the beginning - if not ready, then too late anyway
@@ -1175,9 +1272,10 @@ DWORD__ DigitalIn::capture( )
 
     if( Digitalio::m_block )
     {
+        // up to 5 ms, woken as soon as the callback has copied
         t_CKUINT n = 20;
-        while( !Digitalio::m_in_ready && n-- )
-            usleep( 250 );
+        while( !ck_load_acquire( &Digitalio::m_in_ready ) && n-- )
+            g_in_ready_sem.wait_for( 250 );
     }
 
     // copy data
@@ -64,6 +64,7 @@
 #define BITS_PER_SAMPLE_DEFAULT      16      // sample size
 #define DEVICE_NUM_OUT_DEFAULT       0
 #define DEVICE_NUM_IN_DEFAULT        0
+#define CK_DIGIO_WAIT_BINS           7
 
 // sample types
 // #define SAMPLE_SHORT         short
@@ -152,8 +153,8 @@ public: // data
     static SAMPLE ** m_read_ptr;
     static SAMPLE * m_extern_in;
     static SAMPLE * m_extern_out;
-    static BOOL__ m_out_ready;
-    static BOOL__ m_in_ready;
+    static volatile BOOL__ m_out_ready;
+    static volatile BOOL__ m_in_ready;
     static BOOL__ m_use_cb;
     static DWORD__ m_go;
     static DWORD__ m_end;
@@ -162,6 +163,13 @@ public: // data
 
     static DWORD__ m_dac_n;
     static DWORD__ m_adc_n;
+
+public: // blocking handoff: how long cb() waited for the vm, binned at
+        // 0, <250us, <500us, <1ms, <2ms, <4ms, and longer; and how many
+        // buffers it gave up on (underruns, played as silence)
+    static DWORD__ m_wait_hist[CK_DIGIO_WAIT_BINS];
+    static DWORD__ m_underruns;
+    static void log_wait_stats();
 };
 
 
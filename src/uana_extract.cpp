@@ -38,6 +38,9 @@
 #include "chuck_errmsg.h"
 #include "util_math.h"
 #include "util_xforms.h"
+#include "util_fft.h"
+#include "util_simd.h"
+#include "chuck_globals.h"
 
 
 
@@ -117,6 +120,40 @@ CK_DLL_SFUN( ZeroX_compute );
 // offset
 static t_CKUINT ZeroX_offset_data = 0;
 
+// MFCC
+CK_DLL_CTOR( MFCC_ctor );
+CK_DLL_DTOR( MFCC_dtor );
+CK_DLL_TICK( MFCC_tick );
+CK_DLL_TOCK( MFCC_tock );
+CK_DLL_PMSG( MFCC_pmsg );
+CK_DLL_MFUN( MFCC_ctrl_numCoeffs );
+CK_DLL_MFUN( MFCC_cget_numCoeffs );
+CK_DLL_MFUN( MFCC_ctrl_numFilters );
+CK_DLL_MFUN( MFCC_cget_numFilters );
+// offset
+static t_CKUINT MFCC_offset_data = 0;
+
+// Chroma
+CK_DLL_CTOR( Chroma_ctor );
+CK_DLL_DTOR( Chroma_dtor );
+CK_DLL_TICK( Chroma_tick );
+CK_DLL_TOCK( Chroma_tock );
+CK_DLL_PMSG( Chroma_pmsg );
+// offset
+static t_CKUINT Chroma_offset_data = 0;
+
+// SFM
+CK_DLL_TICK( SFM_tick );
+CK_DLL_TOCK( SFM_tock );
+CK_DLL_PMSG( SFM_pmsg );
+CK_DLL_SFUN( SFM_compute );
+
+// Crest
+CK_DLL_TICK( Crest_tick );
+CK_DLL_TOCK( Crest_tock );
+CK_DLL_PMSG( Crest_pmsg );
+CK_DLL_SFUN( Crest_compute );
+
 // LPC
 CK_DLL_CTOR( LPC_ctor );
 CK_DLL_DTOR( LPC_dtor );
@@ -336,6 +373,87 @@ DLL_QUERY extract_query( Chuck_DL_Query * QUERY )
     func->add_arg( "float[]", "input" );
     if( !type_engine_import_sfun( env, func ) ) goto error;
 
+    // end import
+    if( !type_engine_import_class_end( env ) )
+        return FALSE;
+
+    //---------------------------------------------------------------------
+    // init as base class: MFCC
+    //---------------------------------------------------------------------
+    if( !type_engine_import_uana_begin( env, "MFCC", "UAna", env->global(), 
+                                        MFCC_ctor, MFCC_dtor,
+                                        MFCC_tick, MFCC_tock, MFCC_pmsg ) )
+        return FALSE;
+
+    // data offset
+    MFCC_offset_data = type_engine_import_mvar( env, "int", "@MFCC_data", FALSE );
+    if( MFCC_offset_data == CK_INVALID_OFFSET ) goto error;
+
+    // numCoeffs
+    func = make_new_mfun( "int", "numCoeffs", MFCC_ctrl_numCoeffs );
+    func->add_arg( "int", "n" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // numCoeffs
+    func = make_new_mfun( "int", "numCoeffs", MFCC_cget_numCoeffs );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // numFilters
+    func = make_new_mfun( "int", "numFilters", MFCC_ctrl_numFilters );
+    func->add_arg( "int", "n" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // numFilters
+    func = make_new_mfun( "int", "numFilters", MFCC_cget_numFilters );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // end the class import
+    type_engine_import_class_end( env );
+
+    //---------------------------------------------------------------------
+    // init as base class: Chroma
+    //---------------------------------------------------------------------
+    if( !type_engine_import_uana_begin( env, "Chroma", "UAna", env->global(), 
+                                        Chroma_ctor, Chroma_dtor,
+                                        Chroma_tick, Chroma_tock, Chroma_pmsg ) )
+        return FALSE;
+
+    // data offset
+    Chroma_offset_data = type_engine_import_mvar( env, "int", "@Chroma_data", FALSE );
+    if( Chroma_offset_data == CK_INVALID_OFFSET ) goto error;
+
+    // end the class import
+    type_engine_import_class_end( env );
+
+    //---------------------------------------------------------------------
+    // init as base class: SFM
+    //---------------------------------------------------------------------
+    if( !type_engine_import_uana_begin( env, "SFM", "UAna", env->global(), 
+                                        NULL, NULL,
+                                        SFM_tick, SFM_tock, SFM_pmsg ) )
+        return FALSE;
+
+    // compute
+    func = make_new_sfun( "float", "compute", SFM_compute );
+    func->add_arg( "float[]", "input" );
+    if( !type_engine_import_sfun( env, func ) ) goto error;
+
+    // end the class import
+    type_engine_import_class_end( env );
+
+    //---------------------------------------------------------------------
+    // init as base class: Crest
+    //---------------------------------------------------------------------
+    if( !type_engine_import_uana_begin( env, "Crest", "UAna", env->global(), 
+                                        NULL, NULL,
+                                        Crest_tick, Crest_tock, Crest_pmsg ) )
+        return FALSE;
+
+    // compute
+    func = make_new_sfun( "float", "compute", Crest_compute );
+    func->add_arg( "float[]", "input" );
+    if( !type_engine_import_sfun( env, func ) ) goto error;
+
     // end import
     if( !type_engine_import_class_end( env ) )
         return FALSE;
@@ -416,24 +534,39 @@ CK_DLL_PMSG( FeatureCollector_pmsg )
     return TRUE;
 }
 
-static t_CKFLOAT compute_centroid( Chuck_Array8 & buffer, t_CKUINT size )
+// copy a float[] into contiguous SAMPLEs, for the compute() functions
+// (the tocks get theirs from the incoming blob); valid until the next call
+static SAMPLE * samples_of( Chuck_Array8 & array, t_CKUINT & size )
 {
-    t_CKFLOAT m0 = 0.0;
-    t_CKFLOAT m1 = 0.0;
-    t_CKFLOAT centroid;
-    t_CKFLOAT v;
-    t_CKUINT i;
+    static SAMPLE * buffer = NULL;
+    static t_CKUINT cap = 0;
 
-    // Compute centroid using moments
-    for( i = 0; i < size; i++ )
+    size = array.size();
+    if( size > cap )
     {
-        buffer.get( i, &v );
-        m1 += (i * v);
-        m0 += v;
+        SAFE_DELETE_ARRAY( buffer );
+        buffer = new SAMPLE[size];
+        cap = size;
     }
+    for( t_CKUINT i = 0; i < size; i++ )
+        buffer[i] = (SAMPLE)array.m_vector[i];
+
+    return buffer;
+}
+
+static t_CKFLOAT compute_centroid( const SAMPLE * buffer, t_CKUINT size )
+{
+    SAMPLE m0, m1;
+    t_CKFLOAT centroid;
+
+    // sanity check
+    if( size == 0 ) return 0.0;
+
+    // Compute centroid using moments
+    vec_moments( buffer, size, m0, m1 );
 
     if( m0 != 0.0 )
-        centroid = m1 / m0;
+        centroid = m1 / (t_CKFLOAT)m0;
     else 
         centroid = size / 2.0; // Perfectly balanced
 
@@ -458,10 +591,11 @@ CK_DLL_TOCK( Centroid_tock )
         Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
         // sanity check
         assert( BLOB_IN != NULL );
-        // get the array
-        Chuck_Array8 & mag = BLOB_IN->fvals();
+        // get the spectrum
+        t_CKUINT size;
+        const SAMPLE * mag = BLOB_IN->mag( size );
         // compute centroid
-        result = compute_centroid( mag, mag.size() );
+        result = compute_centroid( mag, size );
     }
     // otherwise zero out
     else
@@ -500,7 +634,9 @@ CK_DLL_SFUN( Centroid_compute )
     else
     {
         // do it
-        RETURN->v_float = compute_centroid( *array, array->size() );
+        t_CKUINT size;
+        const SAMPLE * buffer = samples_of( *array, size );
+        RETURN->v_float = compute_centroid( buffer, size );
     }
 }
 
@@ -508,53 +644,56 @@ CK_DLL_SFUN( Centroid_compute )
 // Flux state
 struct StateOfFlux
 {
-    Chuck_Array8 prev;
-    Chuck_Array8 norm;
+    SAMPLE * prev;
+    SAMPLE * norm;
+    t_CKUINT size;
     t_CKBOOL initialized;
 
     StateOfFlux()
     {
+        prev = norm = NULL;
+        size = 0;
+        initialized = FALSE;
+    }
+
+    ~StateOfFlux()
+    {
+        SAFE_DELETE_ARRAY( prev );
+        SAFE_DELETE_ARRAY( norm );
+    }
+
+    // resize (forgets the previous frame)
+    void resize( t_CKUINT n )
+    {
+        SAFE_DELETE_ARRAY( prev );
+        SAFE_DELETE_ARRAY( norm );
+        prev = new SAMPLE[n];
+        norm = new SAMPLE[n];
+        size = n;
         initialized = FALSE;
     }
 };
 
 
 // compute norm rms
-static void compute_norm_rms( Chuck_Array8 & curr, Chuck_Array8 & norm )
+static void compute_norm_rms( const SAMPLE * curr, t_CKUINT size, SAMPLE * norm )
 {
     t_CKUINT i;
-    t_CKFLOAT energy = 0.0;
-    t_CKFLOAT v;
-
-    // check size
-    if( norm.size() != curr.size() )
-        norm.set_size( curr.size() );
-
-    // get energy
-    for( i = 0; i < curr.size(); i++ )
-    {
-        curr.get( i, &v );
-        energy += v * v;
-    }
+    t_CKFLOAT energy = vec_dot( curr, curr, size );
 
     // check energy
     if (energy == 0.0) 
     {
         // all zeros
-        norm.zero( 0, norm.size() );
+        memset( norm, 0, size * sizeof(SAMPLE) );
         return;
     }
     else 
         energy = ::sqrt( energy );
     
-    for( i = 0; i < curr.size(); i++ )
-    {
-        curr.get( i, & v );
-        if( v > 0.0) 
-            norm.set( i, v / energy );
-        else
-            norm.set( i, 0.0 );
-    }
+    SAMPLE scale = (SAMPLE)(1.0 / energy);
+    for( i = 0; i < size; i++ )
+        norm[i] = curr[i] > 0 ? curr[i] * scale : 0;
 }
 
 // compute flux
@@ -584,37 +723,24 @@ static t_CKFLOAT compute_flux( Chuck_Array8 & curr, Chuck_Array8 & prev, Chuck_A
 }
 
 // compute flux
-static t_CKFLOAT compute_flux( Chuck_Array8 & curr, StateOfFlux & sof )
+static t_CKFLOAT compute_flux( const SAMPLE * curr, t_CKUINT size, StateOfFlux & sof )
 {
     // flux
     t_CKFLOAT result = 0.0;
-    t_CKFLOAT v;
 
     // verify size
-    if( curr.size() != sof.prev.size() )
-    {
-        sof.initialized = FALSE;
-        // resize prev
-        sof.prev.set_size( curr.size() );
-    }
+    if( size != sof.size )
+        sof.resize( size );
+
+    // compute normalize rms
+    compute_norm_rms( curr, size, sof.norm );
 
     // check initialized
     if( sof.initialized )
-    {
-        // compute normalize rms
-        compute_norm_rms( curr, sof.norm );
-        // do it
-        result = compute_flux( sof.norm, sof.prev, &sof.prev );
-    }
+        result = ::sqrt( vec_dist2( sof.norm, sof.prev, size ) );
 
     // copy curr to prev
-    for( t_CKUINT i = 0; i < curr.size(); i++ )
-    {
-        // get the value
-        sof.norm.get( i, &v );
-        // set it
-        sof.prev.set( i, v );
-    }
+    if( size ) memcpy( sof.prev, sof.norm, size * sizeof(SAMPLE) );
 
     // initialize
     sof.initialized = TRUE;
@@ -661,10 +787,11 @@ CK_DLL_TOCK( Flux_tock )
         Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
         // sanity check
         assert( BLOB_IN != NULL );
-        // get the array
-        Chuck_Array8 & mag = BLOB_IN->fvals();
+        // get the spectrum
+        t_CKUINT size;
+        const SAMPLE * mag = BLOB_IN->mag( size );
         // compute flux
-        result = compute_flux( mag, *state );
+        result = compute_flux( mag, size, *state );
     }
     // otherwise zero out
     else
@@ -760,18 +887,15 @@ CK_DLL_SFUN( Flux_compute2 )
 }
 
 
-static t_CKFLOAT compute_rms( Chuck_Array8 & buffer, t_CKUINT size )
+static t_CKFLOAT compute_rms( const SAMPLE * buffer, t_CKUINT size )
 {
     t_CKFLOAT rms = 0.0;
-    t_CKFLOAT v;
-    t_CKUINT i;
+
+    // sanity check
+    if( size == 0 ) return 0.0;
 
     // get sum of squares
-    for( i = 0; i < size; i++ )
-    {
-        buffer.get( i, &v );
-        rms += (v * v);
-    }
+    rms = vec_dot( buffer, buffer, size );
 
     // go
     rms /= size;
@@ -799,9 +923,10 @@ CK_DLL_TOCK( RMS_tock )
         // sanity check
         assert( BLOB_IN != NULL );
         // get the array
-        Chuck_Array8 & mag = BLOB_IN->fvals();
-        // compute centroid
-        result = compute_rms( mag, mag.size() );
+        t_CKUINT size;
+        const SAMPLE * mag = BLOB_IN->mag( size );
+        // compute rms
+        result = compute_rms( mag, size );
     }
     // otherwise zero out
     else
@@ -840,35 +965,29 @@ CK_DLL_SFUN( RMS_compute )
     else
     {
         // do it
-        RETURN->v_float = compute_rms( *array, array->size() );
+        t_CKUINT size;
+        const SAMPLE * buffer = samples_of( *array, size );
+        RETURN->v_float = compute_rms( buffer, size );
     }
 }
 
 
-static t_CKFLOAT compute_rolloff( Chuck_Array8 & buffer, t_CKUINT size, t_CKFLOAT percent )
+static t_CKFLOAT compute_rolloff( const SAMPLE * buffer, t_CKUINT size, t_CKFLOAT percent )
 {
-    t_CKFLOAT sum = 0.0, v, target;
-    t_CKINT i;
+    t_CKFLOAT sum = 0.0, target;
+    t_CKUINT i;
 
     // sanity check
     assert( percent >= 0 && percent <= 1 );
-
-    // iterate
-    for( i = 0; i < size; i++ )
-    {
-        buffer.get( i, &v );
-        sum += v;
-    }
+    if( size == 0 ) return 0.0;
 
     // the target
-    target = sum * percent;
-    sum = 0.0;
+    target = vec_sum( buffer, size ) * percent;
 
     // iterate
     for( i = 0; i < size; i++ )
     {
-        buffer.get( i, &v );
-        sum += v;
+        sum += buffer[i];
         if( sum >= target ) break;
     }
 
@@ -905,10 +1024,11 @@ CK_DLL_TOCK( RollOff_tock )
         Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
         // sanity check
         assert( BLOB_IN != NULL );
-        // get the array
-        Chuck_Array8 & mag = BLOB_IN->fvals();
+        // get the spectrum
+        t_CKUINT size;
+        const SAMPLE * mag = BLOB_IN->mag( size );
         // compute rolloff
-        result = compute_rolloff( mag, mag.size(), percent );
+        result = compute_rolloff( mag, size, percent );
     }
     // otherwise zero out
     else
@@ -969,7 +1089,9 @@ CK_DLL_SFUN( RollOff_compute )
     else
     {
         // do it
-        RETURN->v_float = compute_rolloff( *array, array->size(), percent );
+        t_CKUINT size;
+        const SAMPLE * buffer = samples_of( *array, size );
+        RETURN->v_float = compute_rolloff( buffer, size, percent );
     }
 }
 
@@ -1340,8 +1462,8 @@ void xcorr_fft( SAMPLE * f, t_CKINT fsize, SAMPLE * g, t_CKINT gsize, SAMPLE * b
     assert( fsize == gsize == size );
 
     // take fft
-    rfft( f, size/2, FFT_FORWARD );
-    rfft( g, size/2, FFT_FORWARD );
+    fft_real( f, size/2, FFT_FORWARD );
+    fft_real( g, size/2, FFT_FORWARD );
 
     // complex
     t_CKCOMPLEX_SAMPLE * F = (t_CKCOMPLEX_SAMPLE *)f;
@@ -1359,7 +1481,7 @@ void xcorr_fft( SAMPLE * f, t_CKINT fsize, SAMPLE * g, t_CKINT gsize, SAMPLE * b
     }
 
     // inverse fft
-    rfft( buffy, size/2, FFT_INVERSE );
+    fft_real( buffy, size/2, FFT_INVERSE );
 }
 
 
@@ -1389,21 +1511,10 @@ void xcorr_normalize( SAMPLE * buffy, t_CKINT size, SAMPLE * f, t_CKINT fs, SAMP
 
 // ZeroX
 #define __SGN(x)  (x >= 0.0f ? 1.0f : -1.0f )
-static t_CKINT compute_zerox( Chuck_Array8 & buffer, t_CKUINT size )
+static t_CKINT compute_zerox( const SAMPLE * buffer, t_CKUINT size )
 {
-    t_CKUINT i, xings = 0;
-    t_CKFLOAT v = 0, p = 0;
-    buffer.get( 0, &p );
-
-    // Compute centroid using moments
-    for( i = 0; i < size; i++ )
-    {
-        buffer.get( i, &v );
-        xings += __SGN(v) != __SGN(p);
-        p = v;
-    }
-
-    return xings;
+    // sign changes between neighbours
+    return vec_crossings( buffer, size );
 }
 
 CK_DLL_CTOR( ZeroX_ctor )
@@ -1438,10 +1549,11 @@ CK_DLL_TOCK( ZeroX_tock )
         Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
         // sanity check
         assert( BLOB_IN != NULL );
-        // get the array
-        Chuck_Array8 & mag = BLOB_IN->fvals();
+        // get the spectrum
+        t_CKUINT size;
+        const SAMPLE * mag = BLOB_IN->mag( size );
         // compute ZeroX
-        result = (t_CKFLOAT)( compute_zerox( mag, mag.size() ) + .5 );
+        result = (t_CKFLOAT)compute_zerox( mag, size );
     }
     // otherwise zero out
     else
@@ -1480,6 +1592,512 @@ CK_DLL_SFUN( ZeroX_compute )
     else
     {
         // do it
-        RETURN->v_float = (t_CKFLOAT)( compute_centroid( *array, array->size() ) + .5 );
+        t_CKUINT size;
+        const SAMPLE * buffer = samples_of( *array, size );
+        RETURN->v_float = (t_CKFLOAT)compute_zerox( buffer, size );
+    }
+}
+
+
+
+
+// spectrum bins of a default (512-point) FFT: what the tables below are
+// first built for, so a default chain never builds them in a tock
+#define FEATURE_DEFAULT_BINS 256
+
+// MFCC state
+struct MFCC_Object
+{
+    // settings
+    t_CKUINT num_coeffs;
+    t_CKUINT num_filters;
+    // filterbank built for this many bins at this rate
+    t_CKUINT bins;
+    t_CKFLOAT srate;
+    // per filter: first bin, number of bins, offset into weights
+    t_CKUINT * start;
+    t_CKUINT * length;
+    t_CKUINT * offset;
+    SAMPLE * weights;
+    // log filter energies, coefficients
+    SAMPLE * energy;
+    SAMPLE * coeffs;
+
+    MFCC_Object( t_CKFLOAT sr )
+    {
+        num_coeffs = 13;
+        num_filters = 26;
+        bins = 0;
+        srate = 0;
+        start = length = offset = NULL;
+        weights = energy = coeffs = NULL;
+        build( FEATURE_DEFAULT_BINS, sr );
+    }
+
+    ~MFCC_Object()
+    {
+        this->reset();
+    }
+
+    // forget the filterbank
+    void reset()
+    {
+        SAFE_DELETE_ARRAY( start );
+        SAFE_DELETE_ARRAY( length );
+        SAFE_DELETE_ARRAY( offset );
+        SAFE_DELETE_ARRAY( weights );
+        SAFE_DELETE_ARRAY( energy );
+        SAFE_DELETE_ARRAY( coeffs );
+        bins = 0;
+    }
+
+    // triangular filters, equally spaced in mel from 0 to nyquist
+    void build( t_CKUINT n, t_CKFLOAT sr )
+    {
+        t_CKUINT i, j, total = 0;
+        t_CKFLOAT mel_max = 2595.0 * ::log10( 1.0 + sr / 2.0 / 700.0 );
+        // bin i is at i * sr / (2n)
+        t_CKFLOAT hz_per_bin = sr / 2.0 / n;
+        t_CKFLOAT * edge = new t_CKFLOAT[num_filters+2];
+
+        this->reset();
+        bins = n;
+        srate = sr;
+        // and the dct of the log energies
+        fft_dct_plan( num_filters );
+        start = new t_CKUINT[num_filters];
+        length = new t_CKUINT[num_filters];
+        offset = new t_CKUINT[num_filters];
+        energy = new SAMPLE[num_filters];
+        coeffs = new SAMPLE[num_filters];
+
+        // band edges, in bins
+        for( i = 0; i < num_filters + 2; i++ )
+        {
+            t_CKFLOAT mel = mel_max * i / (num_filters + 1);
+            edge[i] = 700.0 * ( ::pow( 10.0, mel / 2595.0 ) - 1.0 ) / hz_per_bin;
+        }
+
+        // bins under each triangle
+        for( i = 0; i < num_filters; i++ )
+        {
+            t_CKUINT lo = (t_CKUINT)::ceil( edge[i] );
+            t_CKUINT hi = (t_CKUINT)::floor( edge[i+2] );
+            if( hi >= n ) hi = n - 1;
+            start[i] = lo;
+            length[i] = hi >= lo ? hi - lo + 1 : 0;
+            offset[i] = total;
+            total += length[i];
+        }
+
+        // the weights, packed
+        weights = new SAMPLE[total ? total : 1];
+        for( i = 0; i < num_filters; i++ )
+        {
+            for( j = 0; j < length[i]; j++ )
+            {
+                t_CKFLOAT b = (t_CKFLOAT)(start[i] + j);
+                t_CKFLOAT w = b <= edge[i+1]
+                    ? ( b - edge[i] ) / ( edge[i+1] - edge[i] )
+                    : ( edge[i+2] - b ) / ( edge[i+2] - edge[i+1] );
+                weights[offset[i]+j] = (SAMPLE)( w > 0 ? w : 0 );
+            }
+        }
+
+        SAFE_DELETE_ARRAY( edge );
+    }
+
+    // coefficients of one power spectrum, into coeffs
+    t_CKUINT compute( const SAMPLE * power, t_CKUINT n, t_CKFLOAT sr )
+    {
+        t_CKUINT i;
+
+        if( n == 0 ) return 0;
+        // (only if the spectrum size changed upstream)
+        if( n != bins || sr != srate ) build( n, sr );
+
+        // log mel energies
+        for( i = 0; i < num_filters; i++ )
+            energy[i] = (SAMPLE)::log( vec_dot( power + start[i],
+                weights + offset[i], length[i] ) + 1e-10 );
+
+        // decorrelate
+        t_CKUINT count = ck_min( num_coeffs, num_filters );
+        fft_dct( energy, num_filters, coeffs, count );
+
+        return count;
+    }
+};
+
+
+CK_DLL_CTOR( MFCC_ctor )
+{
+    OBJ_MEMBER_UINT( SELF, MFCC_offset_data ) = (t_CKUINT)new MFCC_Object( g_vm->srate() );
+}
+
+CK_DLL_DTOR( MFCC_dtor )
+{
+    MFCC_Object * mfcc = (MFCC_Object *)OBJ_MEMBER_UINT( SELF, MFCC_offset_data );
+    SAFE_DELETE( mfcc );
+    OBJ_MEMBER_UINT( SELF, MFCC_offset_data ) = 0;
+}
+
+CK_DLL_TICK( MFCC_tick )
+{
+    // do nothing
+    return TRUE;
+}
+
+CK_DLL_TOCK( MFCC_tock )
+{
+    MFCC_Object * mfcc = (MFCC_Object *)OBJ_MEMBER_UINT( SELF, MFCC_offset_data );
+    t_CKUINT count = 0;
+
+    if( UANA->numIncomingUAnae() > 0 )
+    {
+        // get first
+        Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
+        // sanity check
+        assert( BLOB_IN != NULL );
+        // get the power spectrum
+        t_CKUINT size;
+        const SAMPLE * power = BLOB_IN->power( size );
+        // compute mfcc
+        count = mfcc->compute( power, size, g_vm->srate() );
+    }
+
+    // get fvals of output BLOB
+    Chuck_Array8 & fvals = BLOB->fvals();
+    // ensure size == resulting size
+    if( fvals.size() != count )
+        fvals.set_size( count );
+    // copy the result in
+    for( t_CKUINT i = 0; i < count; i++ )
+        fvals.m_vector[i] = mfcc->coeffs[i];
+
+    return TRUE;
+}
+
+CK_DLL_PMSG( MFCC_pmsg )
+{
+    // do nothing
+    return TRUE;
+}
+
+CK_DLL_CTRL( MFCC_ctrl_numCoeffs )
+{
+    MFCC_Object * mfcc = (MFCC_Object *)OBJ_MEMBER_UINT( SELF, MFCC_offset_data );
+    // get it
+    t_CKINT n = GET_NEXT_INT(ARGS);
+    if( n < 1 ) n = 1;
+    // set it (capped by numFilters when computed)
+    mfcc->num_coeffs = n;
+    // return it
+    RETURN->v_int = n;
+}
+
+CK_DLL_CGET( MFCC_cget_numCoeffs )
+{
+    MFCC_Object * mfcc = (MFCC_Object *)OBJ_MEMBER_UINT( SELF, MFCC_offset_data );
+    RETURN->v_int = mfcc->num_coeffs;
+}
+
+CK_DLL_CTRL( MFCC_ctrl_numFilters )
+{
+    MFCC_Object * mfcc = (MFCC_Object *)OBJ_MEMBER_UINT( SELF, MFCC_offset_data );
+    // get it
+    t_CKINT n = GET_NEXT_INT(ARGS);
+    if( n < 1 ) n = 1;
+    // set it; rebuild now, for the current spectrum size
+    if( (t_CKUINT)n != mfcc->num_filters )
+    {
+        mfcc->num_filters = n;
+        mfcc->build( mfcc->bins, mfcc->srate );
+    }
+    // return it
+    RETURN->v_int = n;
+}
+
+CK_DLL_CGET( MFCC_cget_numFilters )
+{
+    MFCC_Object * mfcc = (MFCC_Object *)OBJ_MEMBER_UINT( SELF, MFCC_offset_data );
+    RETURN->v_int = mfcc->num_filters;
+}
+
+
+
+
+// Chroma state
+struct Chroma_Object
+{
+    // map built for this many bins at this rate
+    t_CKUINT bins;
+    t_CKFLOAT srate;
+    // pitch class of each bin, -1 outside the piano range
+    t_CKINT * pclass;
+    SAMPLE chroma[12];
+
+    Chroma_Object( t_CKFLOAT sr )
+    {
+        bins = 0;
+        srate = 0;
+        pclass = NULL;
+        memset( chroma, 0, sizeof(chroma) );
+        build( FEATURE_DEFAULT_BINS, sr );
+    }
+
+    ~Chroma_Object()
+    {
+        SAFE_DELETE_ARRAY( pclass );
+    }
+
+    // nearest pitch class of each bin, A0 to C8
+    void build( t_CKUINT n, t_CKFLOAT sr )
+    {
+        SAFE_DELETE_ARRAY( pclass );
+        pclass = new t_CKINT[n];
+        bins = n;
+        srate = sr;
+
+        for( t_CKUINT i = 0; i < n; i++ )
+        {
+            t_CKFLOAT hz = i * sr / 2.0 / n;
+            if( hz < 27.5 || hz > 4186.0 ) { pclass[i] = -1; continue; }
+            // midi note 0 is a C
+            t_CKINT note = (t_CKINT)::floor( 69.0 + 12.0 * ::log( hz / 440.0 ) / ::log( 2.0 ) + .5 );
+            pclass[i] = note % 12;
+        }
+    }
+
+    // energy per pitch class of one power spectrum, peak at 1
+    void compute( const SAMPLE * power, t_CKUINT n, t_CKFLOAT sr )
+    {
+        t_CKUINT i;
+
+        memset( chroma, 0, sizeof(chroma) );
+        if( n == 0 ) return;
+        // (only if the spectrum size changed upstream)
+        if( n != bins || sr != srate ) build( n, sr );
+
+        for( i = 0; i < n; i++ )
+            if( pclass[i] >= 0 ) chroma[pclass[i]] += power[i];
+
+        SAMPLE peak = vec_max( chroma, 12 );
+        if( peak > 0 )
+            for( i = 0; i < 12; i++ ) chroma[i] /= peak;
+    }
+};
+
+
+CK_DLL_CTOR( Chroma_ctor )
+{
+    OBJ_MEMBER_UINT( SELF, Chroma_offset_data ) = (t_CKUINT)new Chroma_Object( g_vm->srate() );
+}
+
+CK_DLL_DTOR( Chroma_dtor )
+{
+    Chroma_Object * chroma = (Chroma_Object *)OBJ_MEMBER_UINT( SELF, Chroma_offset_data );
+    SAFE_DELETE( chroma );
+    OBJ_MEMBER_UINT( SELF, Chroma_offset_data ) = 0;
+}
+
+CK_DLL_TICK( Chroma_tick )
+{
+    // do nothing
+    return TRUE;
+}
+
+CK_DLL_TOCK( Chroma_tock )
+{
+    Chroma_Object * chroma = (Chroma_Object *)OBJ_MEMBER_UINT( SELF, Chroma_offset_data );
+    t_CKUINT size = 0;
+    const SAMPLE * power = NULL;
+
+    if( UANA->numIncomingUAnae() > 0 )
+    {
+        // get first
+        Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
+        // sanity check
+        assert( BLOB_IN != NULL );
+        // get the power spectrum
+        power = BLOB_IN->power( size );
+    }
+    // compute chroma (zeros without input)
+    chroma->compute( power, size, g_vm->srate() );
+
+    // get fvals of output BLOB
+    Chuck_Array8 & fvals = BLOB->fvals();
+    // ensure size == resulting size
+    if( fvals.size() != 12 )
+        fvals.set_size( 12 );
+    // copy the result in
+    for( t_CKUINT i = 0; i < 12; i++ )
+        fvals.m_vector[i] = chroma->chroma[i];
+
+    return TRUE;
+}
+
+CK_DLL_PMSG( Chroma_pmsg )
+{
+    // do nothing
+    return TRUE;
+}
+
+
+
+
+// spectral flatness: geometric over arithmetic mean of the power
+static t_CKFLOAT compute_sfm( const SAMPLE * power, t_CKUINT size )
+{
+    t_CKFLOAT logs = 0.0;
+    t_CKFLOAT mean;
+
+    // sanity check
+    if( size == 0 ) return 0.0;
+
+    mean = vec_sum( power, size ) / size;
+    if( mean <= 0.0 ) return 0.0;
+
+    for( t_CKUINT i = 0; i < size; i++ )
+        logs += ::log( power[i] + 1e-20 );
+
+    return ::exp( logs / size ) / mean;
+}
+
+
+CK_DLL_TICK( SFM_tick )
+{
+    // do nothing
+    return TRUE;
+}
+
+CK_DLL_TOCK( SFM_tock )
+{
+    t_CKFLOAT result = 0.0;
+
+    if( UANA->numIncomingUAnae() > 0 )
+    {
+        // get first
+        Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
+        // sanity check
+        assert( BLOB_IN != NULL );
+        // get the power spectrum
+        t_CKUINT size;
+        const SAMPLE * power = BLOB_IN->power( size );
+        // compute flatness
+        result = compute_sfm( power, size );
+    }
+
+    // get fvals of output BLOB
+    Chuck_Array8 & fvals = BLOB->fvals();
+    // ensure size == resulting size
+    if( fvals.size() != 1 )
+        fvals.set_size( 1 );
+    // copy the result in
+    fvals.set( 0, result );
+
+    return TRUE;
+}
+
+CK_DLL_PMSG( SFM_pmsg )
+{
+    // do nothing
+    return TRUE;
+}
+
+CK_DLL_SFUN( SFM_compute )
+{
+    // get array (of magnitudes)
+    Chuck_Array8 * array = (Chuck_Array8 *)GET_NEXT_OBJECT(ARGS);
+    // sanity check
+    if( !array )
+    {
+        // no flatness
+        RETURN->v_float = 0.0;
+    }
+    else
+    {
+        // square in place
+        t_CKUINT size;
+        SAMPLE * buffer = samples_of( *array, size );
+        for( t_CKUINT i = 0; i < size; i++ )
+            buffer[i] *= buffer[i];
+        // do it
+        RETURN->v_float = compute_sfm( buffer, size );
+    }
+}
+
+
+
+
+// spectral crest: peak over mean of the magnitude
+static t_CKFLOAT compute_crest( const SAMPLE * mag, t_CKUINT size )
+{
+    // sanity check
+    if( size == 0 ) return 0.0;
+
+    t_CKFLOAT mean = vec_sum( mag, size ) / size;
+    if( mean <= 0.0 ) return 0.0;
+
+    return vec_max( mag, size ) / mean;
+}
+
+
+CK_DLL_TICK( Crest_tick )
+{
+    // do nothing
+    return TRUE;
+}
+
+CK_DLL_TOCK( Crest_tock )
+{
+    t_CKFLOAT result = 0.0;
+
+    if( UANA->numIncomingUAnae() > 0 )
+    {
+        // get first
+        Chuck_UAnaBlobProxy * BLOB_IN = UANA->getIncomingBlob( 0 );
+        // sanity check
+        assert( BLOB_IN != NULL );
+        // get the spectrum
+        t_CKUINT size;
+        const SAMPLE * mag = BLOB_IN->mag( size );
+        // compute crest
+        result = compute_crest( mag, size );
+    }
+
+    // get fvals of output BLOB
+    Chuck_Array8 & fvals = BLOB->fvals();
+    // ensure size == resulting size
+    if( fvals.size() != 1 )
+        fvals.set_size( 1 );
+    // copy the result in
+    fvals.set( 0, result );
+
+    return TRUE;
+}
+
+CK_DLL_PMSG( Crest_pmsg )
+{
+    // do nothing
+    return TRUE;
+}
+
+CK_DLL_SFUN( Crest_compute )
+{
+    // get array
+    Chuck_Array8 * array = (Chuck_Array8 *)GET_NEXT_OBJECT(ARGS);
+    // sanity check
+    if( !array )
+    {
+        // no crest
+        RETURN->v_float = 0.0;
+    }
+    else
+    {
+        // do it
+        t_CKUINT size;
+        const SAMPLE * buffer = samples_of( *array, size );
+        RETURN->v_float = compute_crest( buffer, size );
     }
 }
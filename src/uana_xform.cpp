@@ -37,6 +37,8 @@
 #include "chuck_lang.h"
 #include "util_buffers.h"
 #include "util_xforms.h"
+#include "util_fft.h"
+#include "util_simd.h"
 
 
 // FFT
@@ -548,10 +550,10 @@ t_CKBOOL FFT_object::resize( t_CKINT size )
     // sanity check
     assert( size > 0 );
     
-    // next power of 2
-    t_CKINT x = --size;
-    for( ; size &= size-1; x = size );
-    size = x*2;
+    // even (next power of 2 with classic fft)
+    size = fft_size_for( size );
+    // plan now, rather than on the first transform
+    if( fft_planned() ) fft_plan( size/2 );
 
     // log
     EM_log( CK_LOG_FINE, "FFT resize %d -> %d", m_size, size );
@@ -678,7 +680,7 @@ void FFT_object::transform( )
     // zero pad
     memset( m_buffer + m_window_size, 0, (m_size - m_window_size)*sizeof(SAMPLE) );
     // go for it
-    rfft( m_buffer, m_size/2, FFT_FORWARD );
+    fft_real( m_buffer, m_size/2, FFT_FORWARD );
     // copy into the result
     SAMPLE * ptr = m_buffer;
     for( t_CKINT i = 0; i < m_size/2; i++ )
@@ -845,6 +847,10 @@ CK_DLL_TOCK( FFT_tock )
     for( i = 0; i < fft->m_size/2; i++ )
         cvals.set( i, fft->m_spectrum[i] );
 
+    // magnitude spectrum, once, kept in the blob for downstream UAnae
+    SAMPLE * mag = BLOB->set_mag( fft->m_size/2, UANA->m_uana_time );
+    vec_mag( mag, fft->m_buffer, fft->m_size/2 );
+
     // get fvals of output BLOB; fill with magnitude spectrum
     Chuck_Array8 & fvals = BLOB->fvals();
     // ensure size == resulting size
@@ -852,7 +858,7 @@ CK_DLL_TOCK( FFT_tock )
         fvals.set_size( fft->m_size/2 );
     // copy the result in
     for( i = 0; i < fft->m_size/2; i++ )
-        fvals.set( i, __modulus(fft->m_spectrum[i]) );
+        fvals.m_vector[i] = mag[i];
 
     return TRUE;
 }
@@ -1071,10 +1077,10 @@ t_CKBOOL IFFT_object::resize( t_CKINT size )
     // sanity check
     assert( size > 0 );
 
-    // next power of 2
-    t_CKINT x = --size;
-    for( ; size &= size-1; x = size );
-    size = x*2;
+    // even (next power of 2 with classic fft)
+    size = fft_size_for( size );
+    // plan now, rather than on the first transform
+    if( fft_planned() ) fft_plan( size/2 );
 
     // log
     EM_log( CK_LOG_FINE, "IFFT resize %d -> %d", m_size, size );
@@ -1188,7 +1194,7 @@ void IFFT_object::transform( )
     // sanity
     assert( m_window_size <= m_size );
     // go for it
-    rfft( m_buffer, m_size/2, FFT_INVERSE );
+    fft_real( m_buffer, m_size/2, FFT_INVERSE );
     // copy
     memcpy( m_inverse, m_buffer, m_size * sizeof(SAMPLE) );
     // apply window, if there is one
@@ -1677,28 +1683,6 @@ CK_DLL_SFUN( Windowing_triangle )
 
 
 
-//-----------------------------------------------------------------------------
-// name: delete_matrix()
-// desc: deallocates NxN matrix
-//-----------------------------------------------------------------------------
-static void delete_matrix( SAMPLE ** matrix, t_CKUINT N )
-{
-    t_CKUINT i;
-
-    // check
-    if( !matrix ) return;
-
-    // delete
-    for( i = 0; i < N; i++ )
-        SAFE_DELETE_ARRAY( matrix[i] );
-
-    // delete
-    SAFE_DELETE_ARRAY( matrix );
-}
-
-
-
-
 //-----------------------------------------------------------------------------
 // name: Flip_object
 // desc: standalone object for Flip UAna
@@ -2701,8 +2685,6 @@ public:
     AccumBuffer m_accum;
     // DCT buffer
     SAMPLE * m_buffer;
-    // DCT matrix
-    SAMPLE ** m_matrix;
     // result
     SAMPLE * m_spectrum;
 };
@@ -2721,7 +2703,6 @@ DCT_object::DCT_object()
     m_window = NULL;
     m_window_size = m_size;
     m_buffer = NULL;
-    m_matrix = NULL;
     m_spectrum = NULL;
     // initialize window
     this->window( NULL, m_window_size );
@@ -2741,7 +2722,6 @@ DCT_object::~DCT_object()
     // clean up
     SAFE_DELETE_ARRAY( m_window );
     SAFE_DELETE_ARRAY( m_buffer );
-    delete_matrix( m_matrix, m_size );
     SAFE_DELETE_ARRAY( m_spectrum );
     m_window_size = 0;
     m_size = 0;
@@ -2756,30 +2736,24 @@ DCT_object::~DCT_object()
 //-----------------------------------------------------------------------------
 t_CKBOOL DCT_object::resize( t_CKINT size )
 {
-    t_CKUINT i;
-
     // sanity check
     assert( size > 0 );
 
     // reallocate
     SAFE_DELETE_ARRAY( m_buffer );
-    delete_matrix( m_matrix, m_size );
     SAFE_DELETE_ARRAY( m_spectrum );
     m_size = 0;
     m_buffer = new SAMPLE[size];
     m_spectrum = new SAMPLE[size];
-    m_matrix = new SAMPLE *[size];
-    for( i = 0; i < size; i++ ) m_matrix[i] = new SAMPLE[size];
 
     // check it
-    if( !m_buffer || !m_spectrum || !m_matrix )
+    if( !m_buffer || !m_spectrum )
     {
         // out of memory
         fprintf( stderr, "[chuck]: DCT failed to allocate %ld, %ld buffers...\n",
             size, size/2 );
         // clean
         SAFE_DELETE_ARRAY( m_buffer );
-        delete_matrix( m_matrix, size );
         SAFE_DELETE_ARRAY( m_spectrum );
         // done
         return FALSE;
@@ -2788,8 +2762,8 @@ t_CKBOOL DCT_object::resize( t_CKINT size )
     // zero it
     memset( m_buffer, 0, size * sizeof(SAMPLE) );
     memset( m_spectrum, 0, size * sizeof(SAMPLE) );
-    // compute dct matrix
-    the_dct_matrix( m_matrix, size );
+    // plan now, rather than on the first transform
+    fft_dct_plan( size );
     // set
     m_size = size;
     // if no window specified, then set accum size
@@ -2890,7 +2864,7 @@ void DCT_object::transform( )
     // zero pad
     memset( m_buffer + m_window_size, 0, (m_size - m_window_size)*sizeof(SAMPLE) );
     // go for it
-    the_dct_now( m_buffer, m_matrix, m_size, m_spectrum, m_size );
+    fft_dct( m_buffer, m_size, m_spectrum, m_size );
 }
 
 
@@ -3179,8 +3153,6 @@ public:
     DeccumBuffer m_deccum;
     // IDCT buffer
     SAMPLE * m_buffer;
-    // IDCT matrix
-    SAMPLE ** m_matrix;
     // result
     SAMPLE * m_inverse;
 };
@@ -3199,7 +3171,6 @@ IDCT_object::IDCT_object()
     m_window = NULL;
     m_window_size = m_size;
     m_buffer = NULL;
-    m_matrix = NULL;
     m_inverse = NULL;
     // initialize window
     this->window( NULL, m_window_size );
@@ -3219,7 +3190,6 @@ IDCT_object::~IDCT_object()
     // clean up
     SAFE_DELETE_ARRAY( m_window );
     SAFE_DELETE_ARRAY( m_buffer );
-    delete_matrix( m_matrix, m_size );
     SAFE_DELETE_ARRAY( m_inverse );
     m_window_size = 0;
     m_size = 0;
@@ -3234,29 +3204,23 @@ IDCT_object::~IDCT_object()
 //-----------------------------------------------------------------------------
 t_CKBOOL IDCT_object::resize( t_CKINT size )
 {
-    t_CKUINT i;
-
     // sanity check
     assert( size > 0 );
 
     // reallocate
     SAFE_DELETE_ARRAY( m_buffer );
-    delete_matrix( m_matrix, m_size );
     SAFE_DELETE_ARRAY( m_inverse );
     m_size = 0;
     m_buffer = new SAMPLE[size];
-    m_matrix = new SAMPLE *[size];
-    for( i = 0; i < size; i++ ) m_matrix[i] = new SAMPLE[size];
     m_inverse = new SAMPLE[size];
-    // check it TODO: check individual m_matrix[i]
-    if( !m_buffer || !m_inverse || !m_matrix )
+    // check it
+    if( !m_buffer || !m_inverse )
     {
         // out of memory
-        fprintf( stderr, "[chuck]: IDCT failed to allocate %ld, %ld, %ldx%ld buffers...\n",
-            size, size, size, size );
+        fprintf( stderr, "[chuck]: IDCT failed to allocate %ld, %ld buffers...\n",
+            size, size );
         // clean
         SAFE_DELETE_ARRAY( m_buffer );
-        delete_matrix( m_matrix, size );
         SAFE_DELETE_ARRAY( m_inverse );
         // done
         return FALSE;
@@ -3265,8 +3229,8 @@ t_CKBOOL IDCT_object::resize( t_CKINT size )
     // zero it
     memset( m_buffer, 0, size * sizeof(SAMPLE) );
     memset( m_inverse, 0, size * sizeof(SAMPLE) );
-    // compute IDCT matrix
-    the_inverse_dct_matrix( m_matrix, size );
+    // plan now, rather than on the first transform
+    fft_dct_plan( size );
     // set
     m_size = size;
     // set deccum size
@@ -3354,7 +3318,7 @@ void IDCT_object::transform( )
     // sanity
     assert( m_window_size <= m_size );
     // go for it
-    the_inverse_dct_now( m_buffer, m_matrix, m_size, m_inverse, m_size );
+    fft_idct( m_buffer, m_size, m_inverse );
     // apply window, if there is one
     if( m_window )
         apply_window( m_inverse, m_window, m_window_size );
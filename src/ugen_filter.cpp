@@ -32,6 +32,7 @@
 //-----------------------------------------------------------------------------
 #include "ugen_filter.h"
 #include "chuck_type.h"
+#include "util_simd.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -305,6 +306,8 @@ DLL_QUERY filter_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "BiQuad", "UGen", env->global(), 
                                         biquad_ctor, biquad_dtor, biquad_tick, NULL ) )
         return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, biquad_tickf ) ) goto error;
 
     // member variable
     biquad_offset_data = type_engine_import_mvar ( env, "int", "@biquad_data", FALSE );
@@ -1891,6 +1894,56 @@ CK_DLL_TICK( biquad_tick )
     return TRUE;
 }
 
+
+
+
+//-----------------------------------------------------------------------------
+// name: biquad_tickf()
+// desc: the feed-forward half is vectorized over the block, the feedback
+//       half is a recursion in time and stays scalar
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( biquad_tickf )
+{
+    biquad_data * d = (biquad_data *)OBJ_MEMBER_UINT(SELF, biquad_offset_data );
+    SAMPLE y1 = d->m_output1, y2 = d->m_output2, y;
+    t_CKUINT i;
+
+    // feed-forward, first two frames from the saved input
+    for( i = 0; i < nframes && i < 2; i++ )
+    {
+        d->m_input0 = d->m_a0 * in[i];
+        out[i] = d->m_b0 * d->m_input0 + d->m_b1 * d->m_input1 + d->m_b2 * d->m_input2;
+        d->m_input2 = d->m_input1;
+        d->m_input1 = d->m_input0;
+    }
+    // the rest of the block
+    if( nframes > 2 )
+    {
+        vec_fir3( out + 2, in + 2, d->m_a0, d->m_b0, d->m_b1, d->m_b2, nframes - 2 );
+        d->m_input0 = d->m_a0 * in[nframes-1];
+        d->m_input1 = d->m_input0;
+        d->m_input2 = d->m_a0 * in[nframes-2];
+    }
+
+    // feedback
+    for( i = 0; i < nframes; i++ )
+    {
+        y = out[i] - ( d->m_a2 * y2 + d->m_a1 * y1 );
+        y2 = y1;
+        y1 = y;
+        // be normal
+        CK_DDN(y1);
+        CK_DDN(y2);
+        out[i] = y;
+    }
+
+    if( nframes ) d->m_output0 = out[nframes-1];
+    d->m_output1 = y1;
+    d->m_output2 = y2;
+
+    return TRUE;
+}
+
 void biquad_set_reson( biquad_data * d )
 {
     d->m_a2 = (SAMPLE)(d->prad * d->prad);
@@ -134,6 +134,7 @@ CK_DLL_PMSG( filter_pmsg );
 CK_DLL_CTOR( biquad_ctor );
 CK_DLL_DTOR( biquad_dtor );
 CK_DLL_TICK( biquad_tick );
+CK_DLL_TICKF( biquad_tickf );
 
 CK_DLL_CTRL( biquad_ctrl_pfreq );
 CK_DLL_CGET( biquad_cget_pfreq );
@@ -34,12 +34,18 @@
 #include "ugen_osc.h"
 #include "chuck_type.h"
 #include "chuck_ugen.h"
+#include "util_simd.h"
+#include "chuck_errmsg.h"
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
 
 static t_CKUINT g_srate = 0;
 // for member data offset
 static t_CKUINT osc_offset_data = 0;
+static t_CKUINT oscbank_offset_data = 0;
 
 
 //-----------------------------------------------------------------------------
@@ -70,6 +76,8 @@ DLL_QUERY osc_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Osc", "UGen", env->global(), 
                                         osc_ctor, osc_dtor, osc_tick, osc_pmsg ) )
         return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, osc_tickf ) ) goto error;
 
     // add member variable
     osc_offset_data = type_engine_import_mvar( env, "int", "@osc_data", FALSE );
@@ -118,6 +126,8 @@ DLL_QUERY osc_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Phasor", "Osc", env->global(), 
                                         NULL, NULL, osc_tick, NULL ) )
         return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, osc_tickf ) ) goto error;
 
     // end the class import
     type_engine_import_class_end( env );
@@ -128,6 +138,15 @@ DLL_QUERY osc_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "SinOsc", "Osc", env->global(), 
                                         NULL, NULL, sinosc_tick, NULL ) )
         return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, sinosc_tickf ) ) goto error;
+
+    // add ctrl: wavetable
+    func = make_new_mfun( "int", "wavetable", sinosc_ctrl_wavetable );
+    func->add_arg( "int", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "int", "wavetable", osc_cget_wavetable );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
 
     // end the class import
     type_engine_import_class_end( env );
@@ -147,6 +166,13 @@ DLL_QUERY osc_query( Chuck_DL_Query * QUERY )
     func = make_new_mfun( "float", "width", osc_cget_width );
     if( !type_engine_import_mfun( env, func ) ) goto error;    
 
+    // add ctrl: wavetable
+    func = make_new_mfun( "int", "wavetable", triosc_ctrl_wavetable );
+    func->add_arg( "int", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "int", "wavetable", osc_cget_wavetable );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
     // end the class import
     type_engine_import_class_end( env );
 
@@ -183,6 +209,13 @@ DLL_QUERY osc_query( Chuck_DL_Query * QUERY )
     func = make_new_mfun( "float", "width", osc_cget_width );
     if( !type_engine_import_mfun( env, func ) ) goto error;    
 
+    // add ctrl: wavetable
+    func = make_new_mfun( "int", "wavetable", pulseosc_ctrl_wavetable );
+    func->add_arg( "int", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "int", "wavetable", osc_cget_wavetable );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
     // end the class import
     type_engine_import_class_end( env );
 
@@ -200,6 +233,61 @@ DLL_QUERY osc_query( Chuck_DL_Query * QUERY )
     // end the class import
     type_engine_import_class_end( env );
 
+    //---------------------------------------------------------------------
+    // oscbank - bank of sine partials (additive synthesis)
+    //---------------------------------------------------------------------
+    if( !type_engine_import_ugen_begin( env, "OscBank", "UGen", env->global(), 
+                                        oscbank_ctor, oscbank_dtor, oscbank_tick, NULL ) )
+        return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, oscbank_tickf ) ) goto error;
+
+    // add member variable
+    oscbank_offset_data = type_engine_import_mvar( env, "int", "@oscbank_data", FALSE );
+    if( oscbank_offset_data == CK_INVALID_OFFSET ) goto error;
+
+    // add ctrl: size
+    func = make_new_mfun( "int", "size", oscbank_ctrl_size );
+    func->add_arg( "int", "partials" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "int", "size", oscbank_cget_size );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add ctrl: freqs, amps, phases (all at once)
+    func = make_new_mfun( "float[]", "freqs", oscbank_ctrl_freqs );
+    func->add_arg( "float", "hz[]" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "float[]", "amps", oscbank_ctrl_amps );
+    func->add_arg( "float", "amp[]" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "float[]", "phases", oscbank_ctrl_phases );
+    func->add_arg( "float", "phase[]" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add ctrl: harmonics
+    func = make_new_mfun( "float", "harmonics", oscbank_ctrl_harmonics );
+    func->add_arg( "float", "f0" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // add ctrl: freq, amp (one partial)
+    func = make_new_mfun( "float", "freq", oscbank_ctrl_freq );
+    func->add_arg( "int", "which" );
+    func->add_arg( "float", "hz" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "float", "freq", oscbank_cget_freq );
+    func->add_arg( "int", "which" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "float", "amp", oscbank_ctrl_amp );
+    func->add_arg( "int", "which" );
+    func->add_arg( "float", "amp" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "float", "amp", oscbank_cget_amp );
+    func->add_arg( "int", "which" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    // end the class import
+    type_engine_import_class_end( env );
+
     // include GenX!!!
     if( !genX_query( QUERY ) )
         return FALSE;
@@ -217,6 +305,118 @@ error:
 
 
 
+//-----------------------------------------------------------------------------
+// name: struct Wavetable
+// desc: a lookup table of genX_tableSize points, plus a guard point (a copy
+//       of the first) so interpolation never wraps; tables are cached by
+//       generator and coefficients, and shared by every GenX and table-mode
+//       oscillator that asks for the same one
+//-----------------------------------------------------------------------------
+#define genX_tableSize 4096
+#define genX_MAX_COEFFS 100
+
+struct Wavetable
+{
+    std::string key;
+    t_CKUINT refs;
+    t_CKDOUBLE table[genX_tableSize+1];
+};
+
+// generators (part of the key)
+enum
+{
+    WT_ZERO = 0, WT_SIN, WT_TRI, WT_PULSE, WT_GEN5, WT_GEN7,
+    WT_GEN9, WT_GEN10, WT_GEN17, WT_CURVE, WT_WARP
+};
+
+// the cache (tables are made and released on the VM thread)
+static std::map<std::string, Wavetable *> g_wavetables;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wavetable_get()
+// desc: the table for generator type and coefficients, with a reference
+//       added; fresh is TRUE if it was just made (zeroed), and needs filling
+//       and wavetable_done()
+//-----------------------------------------------------------------------------
+static Wavetable * wavetable_get( t_CKUINT type, const t_CKFLOAT * coeffs,
+                                  t_CKUINT n, t_CKBOOL & fresh )
+{
+    std::string key( 1, (char)type );
+    key.append( (const char *)coeffs, n * sizeof(t_CKFLOAT) );
+
+    std::map<std::string, Wavetable *>::iterator iter = g_wavetables.find( key );
+    if( iter != g_wavetables.end() )
+    {
+        iter->second->refs++;
+        fresh = FALSE;
+        return iter->second;
+    }
+
+    Wavetable * w = new Wavetable;
+    w->key = key;
+    w->refs = 1;
+    memset( w->table, 0, sizeof(w->table) );
+    g_wavetables[key] = w;
+    fresh = TRUE;
+
+    // log
+    EM_log( CK_LOG_FINE, "(wavetable): new table, type %d, %d coefficient(s) (%d cached)",
+            type, n, g_wavetables.size() );
+
+    return w;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wavetable_done()
+// desc: set the guard point, after filling
+//-----------------------------------------------------------------------------
+static void wavetable_done( Wavetable * w )
+{
+    w->table[genX_tableSize] = w->table[0];
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wavetable_release()
+// desc: drop a reference; the last one frees the table
+//-----------------------------------------------------------------------------
+static void wavetable_release( Wavetable * w )
+{
+    if( !w || --w->refs ) return;
+
+    g_wavetables.erase( w->key );
+    delete w;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wavetable_lookup()
+// desc: linear interpolation, phase wrapped to [0,1)
+//-----------------------------------------------------------------------------
+static inline t_CKDOUBLE wavetable_lookup( const Wavetable * w, t_CKFLOAT phase )
+{
+    if( phase >= 1.0 || phase < 0.0 ) phase -= floor( phase );
+    t_CKFLOAT index = phase * genX_tableSize;
+    t_CKUINT i = (t_CKUINT)index;
+    // (rounding, just under 1.0)
+    if( i >= genX_tableSize ) i = genX_tableSize - 1;
+    t_CKFLOAT alpha = index - i;
+    return w->table[i] + alpha * ( w->table[i+1] - w->table[i] );
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: struct Osc_Data
 // desc: ...
@@ -230,6 +430,10 @@ struct Osc_Data
     t_CKFLOAT width;
     
     t_CKFLOAT phase;
+
+    // shared wavetable, if in wavetable mode, and its generator
+    Wavetable * table;
+    t_CKUINT table_type;
     
     Osc_Data()
     {
@@ -239,12 +443,63 @@ struct Osc_Data
         width = 0.5;
         srate = g_srate;
         phase = 0.0;
+        table = NULL;
+        table_type = WT_SIN;
+    }
+
+    ~Osc_Data()
+    {
+        wavetable_release( table );
     }
 };
 
 
 
 
+//-----------------------------------------------------------------------------
+// name: osc_set_table()
+// desc: switch to the shared table of generator type at the current width,
+//       or back to computing the waveform (on == FALSE)
+//-----------------------------------------------------------------------------
+static void osc_set_table( Osc_Data * d, t_CKUINT type, t_CKBOOL on )
+{
+    Wavetable * w = NULL;
+    t_CKBOOL fresh = FALSE;
+    t_CKINT i;
+
+    if( on )
+    {
+        // the sine has no parameters
+        w = wavetable_get( type, &d->width, type == WT_SIN ? 0 : 1, fresh );
+        if( fresh )
+        {
+            for( i = 0; i < genX_tableSize; i++ )
+            {
+                t_CKFLOAT phase = (t_CKFLOAT)i / genX_tableSize;
+                if( type == WT_SIN )
+                    w->table[i] = ::sin( phase * TWO_PI );
+                else if( type == WT_TRI )
+                {
+                    // as triosc_tick
+                    phase += .25; if( phase > 1.0 ) phase -= 1.0;
+                    if( phase < d->width ) w->table[i] = (d->width == 0.0) ? 1.0 : -1.0 + 2.0 * phase / d->width;
+                    else w->table[i] = (d->width == 1.0) ? 0 : 1.0 - 2.0 * (phase - d->width) / (1.0 - d->width);
+                }
+                else
+                    w->table[i] = (phase < d->width) ? 1.0 : -1.0;
+            }
+            wavetable_done( w );
+        }
+    }
+
+    wavetable_release( d->table );
+    d->table = w;
+    d->table_type = type;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: osc_ctor()
 // desc: ...
@@ -413,7 +668,8 @@ CK_DLL_TICK( sinosc_tick )
     }
 
     // set output
-    *out = (SAMPLE) ::sin( d->phase * TWO_PI );
+    if( d->table ) *out = (SAMPLE)wavetable_lookup( d->table, d->phase );
+    else *out = (SAMPLE) ::sin( d->phase * TWO_PI );
 
     if( inc_phase )
     {
@@ -430,6 +686,97 @@ CK_DLL_TICK( sinosc_tick )
 
 
 
+//-----------------------------------------------------------------------------
+// name: osc_tickf()
+// desc: block phasor; with inputs, falls back to osc_tick per frame
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( osc_tickf )
+{
+    // get the data
+    Osc_Data * d = (Osc_Data *)OBJ_MEMBER_UINT(SELF, osc_offset_data );
+    Chuck_UGen * ugen = (Chuck_UGen *)SELF;
+    t_CKUINT i;
+
+    // input drives freq or phase per sample
+    if( ugen->m_num_src )
+    {
+        for( i = 0; i < nframes; i++ )
+            osc_tick( SELF, in[i], &out[i], SHRED );
+        return TRUE;
+    }
+
+    for( i = 0; i < nframes; i++ )
+    {
+        // set output to current phase
+        out[i] = (SAMPLE)d->phase;
+        // step the phase.
+        d->phase += d->num;
+        // keep the phase between 0 and 1
+        if( d->phase > 1.0 ) d->phase -= 1.0;
+        else if( d->phase < 0.0 ) d->phase += 1.0;
+    }
+
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sinosc_tickf()
+// desc: block sine; the phase is accumulated in double precision (as in
+//       sinosc_tick), folded to [-.5,.5], and the sine taken over the block
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( sinosc_tickf )
+{
+    // get the data
+    Osc_Data * d = (Osc_Data *)OBJ_MEMBER_UINT(SELF, osc_offset_data );
+    Chuck_UGen * ugen = (Chuck_UGen *)SELF;
+    t_CKUINT i;
+
+    // input drives freq or phase per sample
+    if( ugen->m_num_src )
+    {
+        for( i = 0; i < nframes; i++ )
+            sinosc_tick( SELF, in[i], &out[i], SHRED );
+        return TRUE;
+    }
+
+    // wavetable
+    if( d->table )
+    {
+        for( i = 0; i < nframes; i++ )
+        {
+            out[i] = (SAMPLE)wavetable_lookup( d->table, d->phase );
+            // next phase
+            d->phase += d->num;
+            // keep the phase between 0 and 1
+            if( d->phase > 1.0 ) d->phase -= 1.0;
+            else if( d->phase < 0.0 ) d->phase += 1.0;
+        }
+        return TRUE;
+    }
+
+    for( i = 0; i < nframes; i++ )
+    {
+        // phase, folded
+        out[i] = (SAMPLE)( d->phase - floor( d->phase + .5 ) );
+        // next phase
+        d->phase += d->num;
+        // keep the phase between 0 and 1
+        if( d->phase > 1.0 ) d->phase -= 1.0;
+        else if( d->phase < 0.0 ) d->phase += 1.0;
+    }
+
+    // the sines
+    vec_sin2pi( out, out, nframes );
+
+    return TRUE;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: triosc_tick()
 // desc: ...
@@ -482,9 +829,13 @@ CK_DLL_TICK( triosc_tick )
     }
 
     // compute
-    t_CKFLOAT phase = d->phase + .25; if( phase > 1.0 ) phase -= 1.0;
-    if( phase < d->width ) *out = (SAMPLE) (d->width == 0.0) ? 1.0 : -1.0 + 2.0 * phase / d->width; 
-    else *out = (SAMPLE) (d->width == 1.0) ? 0 : 1.0 - 2.0 * (phase - d->width) / (1.0 - d->width);
+    if( d->table ) *out = (SAMPLE)wavetable_lookup( d->table, d->phase );
+    else
+    {
+        t_CKFLOAT phase = d->phase + .25; if( phase > 1.0 ) phase -= 1.0;
+        if( phase < d->width ) *out = (SAMPLE) (d->width == 0.0) ? 1.0 : -1.0 + 2.0 * phase / d->width; 
+        else *out = (SAMPLE) (d->width == 1.0) ? 0 : 1.0 - 2.0 * (phase - d->width) / (1.0 - d->width);
+    }
 
     // advance internal phase
     if( inc_phase )
@@ -554,7 +905,8 @@ CK_DLL_TICK( pulseosc_tick )
     }
 
     // compute
-    *out = (SAMPLE) (d->phase < d->width) ? 1.0 : -1.0;
+    if( d->table ) *out = (SAMPLE)wavetable_lookup( d->table, d->phase );
+    else *out = (SAMPLE) (d->phase < d->width) ? 1.0 : -1.0;
 
     // move phase
     if( inc_phase )
@@ -697,6 +1049,8 @@ CK_DLL_CTRL( osc_ctrl_width )
     d->width = GET_CK_FLOAT(ARGS);
     //bound ( this could be set arbitrarily high or low ) 
     d->width = ck_max( 0.0, ck_min( 1.0, d->width ) );
+    // table for the new width
+    if( d->table ) osc_set_table( d, d->table_type, TRUE );
     // return
     RETURN->v_float = (t_CKFLOAT)d->width;
 }
@@ -743,6 +1097,8 @@ CK_DLL_CTRL( sqrosc_ctrl_width )
     Osc_Data * d = (Osc_Data *)OBJ_MEMBER_UINT(SELF, osc_offset_data );
     // force value
     d->width = 0.5; 
+    // table for the new width
+    if( d->table ) osc_set_table( d, d->table_type, TRUE );
     // return
     RETURN->v_float = (t_CKFLOAT)d->width;
 }
@@ -776,6 +1132,8 @@ CK_DLL_CTRL( sawosc_ctrl_width )
     d->width = GET_CK_FLOAT(ARGS);
     // bound ( this could be set arbitrarily high or low ) 
     d->width = ( d->width < 0.5 ) ? 0.0 : 1.0;  //rising or falling
+    // table for the new width
+    if( d->table ) osc_set_table( d, d->table_type, TRUE );
     // return
     RETURN->v_float = (t_CKFLOAT)d->width;
 }
@@ -830,6 +1188,72 @@ CK_DLL_CGET( osc_cget_sync )
 
 
 
+//-----------------------------------------------------------------------------
+// name: sinosc_ctrl_wavetable()
+// desc: look the sine up in a shared table instead of calling sin()
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( sinosc_ctrl_wavetable )
+{
+    // get data
+    Osc_Data * d = (Osc_Data *)OBJ_MEMBER_UINT(SELF, osc_offset_data );
+    // set
+    osc_set_table( d, WT_SIN, GET_CK_INT(ARGS) != 0 );
+    // return
+    RETURN->v_int = d->table != NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: triosc_ctrl_wavetable()
+// desc: look the triangle (or saw) up in a shared table, one per width
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( triosc_ctrl_wavetable )
+{
+    // get data
+    Osc_Data * d = (Osc_Data *)OBJ_MEMBER_UINT(SELF, osc_offset_data );
+    // set
+    osc_set_table( d, WT_TRI, GET_CK_INT(ARGS) != 0 );
+    // return
+    RETURN->v_int = d->table != NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pulseosc_ctrl_wavetable()
+// desc: look the pulse (or square) up in a shared table, one per width
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( pulseosc_ctrl_wavetable )
+{
+    // get data
+    Osc_Data * d = (Osc_Data *)OBJ_MEMBER_UINT(SELF, osc_offset_data );
+    // set
+    osc_set_table( d, WT_PULSE, GET_CK_INT(ARGS) != 0 );
+    // return
+    RETURN->v_int = d->table != NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: osc_cget_wavetable()
+// desc: whether in wavetable mode
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( osc_cget_wavetable )
+{
+    // get data
+    Osc_Data * d = (Osc_Data *)OBJ_MEMBER_UINT(SELF, osc_offset_data );
+    // return
+    RETURN->v_int = d->table != NULL;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: osc_pmsg()
 // desc: ...
@@ -849,6 +1273,308 @@ CK_DLL_PMSG( osc_pmsg )
 
 
 
+//-----------------------------------------------------------------------------
+// name: struct OscBank_Data
+// desc: a bank of sine partials, one array per parameter, so a tick is one
+//       pass of vec_sinbank() over all of them
+//-----------------------------------------------------------------------------
+struct OscBank_Data
+{
+    t_CKUINT size;
+    t_CKUINT srate;
+    // as set (Hz)
+    t_CKFLOAT * freq;
+    // per partial: phase and increment in [-.5, .5), amplitude
+    SAMPLE * phase;
+    SAMPLE * inc;
+    SAMPLE * amp;
+
+    OscBank_Data()
+    {
+        size = 0;
+        srate = g_srate;
+        freq = NULL;
+        phase = inc = amp = NULL;
+    }
+
+    ~OscBank_Data()
+    {
+        release();
+    }
+
+    void release()
+    {
+        SAFE_DELETE_ARRAY( freq );
+        SAFE_DELETE_ARRAY( phase );
+        SAFE_DELETE_ARRAY( inc );
+        SAFE_DELETE_ARRAY( amp );
+    }
+
+    // new partials are silent, at 0 Hz and phase 0
+    void resize( t_CKUINT n )
+    {
+        t_CKFLOAT * f = new t_CKFLOAT[n];
+        SAMPLE * p = new SAMPLE[n];
+        SAMPLE * i = new SAMPLE[n];
+        SAMPLE * a = new SAMPLE[n];
+        t_CKUINT keep = ck_min( n, size );
+        for( t_CKUINT k = 0; k < n; k++ )
+        {
+            f[k] = k < keep ? freq[k] : 0;
+            p[k] = k < keep ? phase[k] : 0;
+            i[k] = k < keep ? inc[k] : 0;
+            a[k] = k < keep ? amp[k] : 0;
+        }
+        release();
+        freq = f; phase = p; inc = i; amp = a;
+        size = n;
+    }
+
+    void set_freq( t_CKUINT k, t_CKFLOAT hz )
+    {
+        freq[k] = hz;
+        t_CKFLOAT num = hz / srate;
+        inc[k] = (SAMPLE)( num - floor( num + .5 ) );
+    }
+
+    void set_phase( t_CKUINT k, t_CKFLOAT p )
+    {
+        phase[k] = (SAMPLE)( p - floor( p + .5 ) );
+    }
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctor()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_CTOR( oscbank_ctor )
+{
+    OBJ_MEMBER_UINT(SELF, oscbank_offset_data) = (t_CKUINT)new OscBank_Data;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_dtor()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_DTOR( oscbank_dtor )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    SAFE_DELETE( d );
+    OBJ_MEMBER_UINT(SELF, oscbank_offset_data) = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_tick()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_TICK( oscbank_tick )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    *out = vec_sinbank( d->phase, d->inc, d->amp, d->size );
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_tickf()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( oscbank_tickf )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    for( t_CKUINT i = 0; i < nframes; i++ )
+        out[i] = vec_sinbank( d->phase, d->inc, d->amp, d->size );
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctrl_size()
+// desc: number of partials
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( oscbank_ctrl_size )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    t_CKINT n = GET_CK_INT(ARGS);
+    if( n < 0 ) n = 0;
+    d->resize( n );
+    RETURN->v_int = (t_CKINT)d->size;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_cget_size()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( oscbank_cget_size )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    RETURN->v_int = (t_CKINT)d->size;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_fill()
+// desc: get v from a float array into the first partials, growing the bank
+//       to fit; which is 0: freq, 1: amp, 2: phase
+//-----------------------------------------------------------------------------
+static void oscbank_fill( OscBank_Data * d, Chuck_Array8 * v, t_CKUINT which )
+{
+    if( !v ) return;
+    t_CKUINT n = v->size();
+    if( n > d->size ) d->resize( n );
+
+    t_CKFLOAT val;
+    for( t_CKUINT i = 0; i < n; i++ )
+    {
+        v->get( i, &val );
+        if( which == 0 ) d->set_freq( i, val );
+        else if( which == 1 ) d->amp[i] = (SAMPLE)val;
+        else d->set_phase( i, val );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctrl_freqs()
+// desc: set all frequencies (Hz) at once
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( oscbank_ctrl_freqs )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    Chuck_Array8 * v = (Chuck_Array8 *)GET_CK_OBJECT(ARGS);
+    oscbank_fill( d, v, 0 );
+    RETURN->v_object = v;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctrl_amps()
+// desc: set all amplitudes at once
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( oscbank_ctrl_amps )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    Chuck_Array8 * v = (Chuck_Array8 *)GET_CK_OBJECT(ARGS);
+    oscbank_fill( d, v, 1 );
+    RETURN->v_object = v;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctrl_phases()
+// desc: set all phases ( 0 - 1 ) at once
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( oscbank_ctrl_phases )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    Chuck_Array8 * v = (Chuck_Array8 *)GET_CK_OBJECT(ARGS);
+    oscbank_fill( d, v, 2 );
+    RETURN->v_object = v;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctrl_harmonics()
+// desc: partial i at ( i + 1 ) * f0 Hz
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( oscbank_ctrl_harmonics )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    t_CKFLOAT f0 = GET_CK_FLOAT(ARGS);
+    for( t_CKUINT i = 0; i < d->size; i++ )
+        d->set_freq( i, f0 * ( i + 1 ) );
+    RETURN->v_float = f0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctrl_freq()
+// desc: set one partial's frequency; (int which, float hz)
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( oscbank_ctrl_freq )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    t_CKINT which = GET_NEXT_INT(ARGS);
+    t_CKFLOAT hz = GET_NEXT_FLOAT(ARGS);
+    if( which >= 0 && (t_CKUINT)which < d->size ) d->set_freq( which, hz );
+    RETURN->v_float = hz;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_cget_freq()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( oscbank_cget_freq )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    t_CKINT which = GET_NEXT_INT(ARGS);
+    RETURN->v_float = which >= 0 && (t_CKUINT)which < d->size ? d->freq[which] : 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_ctrl_amp()
+// desc: set one partial's amplitude; (int which, float amp)
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( oscbank_ctrl_amp )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    t_CKINT which = GET_NEXT_INT(ARGS);
+    t_CKFLOAT amp = GET_NEXT_FLOAT(ARGS);
+    if( which >= 0 && (t_CKUINT)which < d->size ) d->amp[which] = (SAMPLE)amp;
+    RETURN->v_float = amp;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: oscbank_cget_amp()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( oscbank_cget_amp )
+{
+    OscBank_Data * d = (OscBank_Data *)OBJ_MEMBER_UINT(SELF, oscbank_offset_data);
+    t_CKINT which = GET_NEXT_INT(ARGS);
+    RETURN->v_float = which >= 0 && (t_CKUINT)which < d->size ? d->amp[which] : 0;
+}
+
+
+
+
 
 //-----------------------------------------------------------------------------
 // file: ugen_genX.cpp
@@ -1033,18 +1759,15 @@ error:
 // name: struct genX_Data
 // desc: ...
 //-----------------------------------------------------------------------------
-#define genX_tableSize 4096
-#define genX_MAX_COEFFS 100
-
 struct genX_Data
 {    
     t_CKUINT genX_type;
-    t_CKDOUBLE genX_table[genX_tableSize];
+    // shared, see wavetable_get()
+    Wavetable * table;
     // gewang: was int
     t_CKINT sync; 
     t_CKUINT srate;
     t_CKFLOAT xtemp;
-    t_CKDOUBLE coeffs[genX_MAX_COEFFS];
 
     genX_Data()
     {
@@ -1052,15 +1775,37 @@ struct genX_Data
         sync        = 0;
         srate       = g_srate;
 
-        t_CKINT i;
-        for( i=0; i<genX_MAX_COEFFS; i++ ) coeffs[i] = 0.;
-        for( i=0; i<genX_tableSize; i++ ) genX_table[i] = 0.;
+        t_CKBOOL fresh;
+        table = wavetable_get( WT_ZERO, NULL, 0, fresh );
+    }
+
+    ~genX_Data()
+    {
+        wavetable_release( table );
     }
 };
 
 
 
 
+//-----------------------------------------------------------------------------
+// name: genX_use()
+// desc: switch d to the shared table for type and coefficients; TRUE if the
+//       table is new and must be filled (starting from zeros), then finished
+//       with wavetable_done()
+//-----------------------------------------------------------------------------
+static t_CKBOOL genX_use( genX_Data * d, t_CKUINT type, const t_CKFLOAT * coeffs, t_CKUINT n )
+{
+    t_CKBOOL fresh;
+    Wavetable * w = wavetable_get( type, coeffs, n, fresh );
+    wavetable_release( d->table );
+    d->table = w;
+    return fresh;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: genX_ctor()
 // desc: ...
@@ -1136,7 +1881,7 @@ CK_DLL_TICK( genX_tick )
     // outvalue = genX_lookup(in_index);?
     
     // calculate output value with linear interpolation
-    outvalue = d->genX_table[lowIndex]*omAlpha + d->genX_table[hiIndex]*alpha;
+    outvalue = d->table->table[lowIndex]*omAlpha + d->table->table[hiIndex]*alpha;
     
     // set output
     *out = (SAMPLE)outvalue;
@@ -1177,7 +1922,7 @@ CK_DLL_CTRL( genX_lookup )
     while(hiIndex >= genX_tableSize) hiIndex -= genX_tableSize; 
     
     //calculate output value with linear interpolation
-    outvalue = d->genX_table[lowIndex]*omAlpha + d->genX_table[hiIndex]*alpha;
+    outvalue = d->table->table[lowIndex]*omAlpha + d->table->table[hiIndex]*alpha;
     
     RETURN->v_float = (t_CKFLOAT)outvalue;
 
@@ -1209,6 +1954,10 @@ CK_DLL_CTRL( gen5_coeffs )
         coeffs[ii] = v;
     }
 
+    // already made?
+    if( !genX_use( d, WT_GEN5, coeffs, size ) ) { RETURN->v_object = in_args; return; }
+    t_CKDOUBLE * table = d->table->table;
+
     amp2 = coeffs[0];
     if (amp2 <= 0.0) amp2 = 0.000001;
     for(k = 1; k < size; k += 2) {
@@ -1216,23 +1965,24 @@ CK_DLL_CTRL( gen5_coeffs )
         amp2 = coeffs[k+1];
         if (amp2 <= 0.0) amp2 = 0.000001;
         j = i + 1;
-        d->genX_table[i] = amp1;
+        table[i] = amp1;
         c = (t_CKFLOAT) pow((amp2/amp1),(1./(coeffs[k]*genX_tableSize)));
         i = (t_CKINT)((j - 1) + coeffs[k]*genX_tableSize);
         for(l = j; l < i; l++) {
             if(l < genX_tableSize)
-                d->genX_table[l] = d->genX_table[l-1] * c;
+                table[l] = table[l-1] * c;
             }
         }
    
     for(j = 0; j < genX_tableSize; j++) {
-        if ((wmax = fabs(d->genX_table[j])) > xmax) xmax = wmax;
+        if ((wmax = fabs(table[j])) > xmax) xmax = wmax;
         // fprintf( stdout, "table current = %f\n", wmax);
     }
     // fprintf( stdout, "table max = %f\n", xmax);
     for(j = 0; j < genX_tableSize; j++) {
-        d->genX_table[j] /= xmax;
+        table[j] /= xmax;
     }
+    wavetable_done( d->table );
 
     // return
     RETURN->v_object = in_args;
@@ -1263,6 +2013,10 @@ CK_DLL_CTRL( gen7_coeffs )
         // fprintf( stdout, "weight %d = %f...\n", ii, v );
         coeffs[ii] = v;
     }
+
+    // already made?
+    if( !genX_use( d, WT_GEN7, coeffs, size ) ) { RETURN->v_object = in_args; return; }
+    t_CKDOUBLE * table = d->table->table;
     
     amp2 = coeffs[0];
     for (k = 1; k < size; k += 2) {
@@ -1272,19 +2026,20 @@ CK_DLL_CTRL( gen7_coeffs )
       i = (t_CKINT)(j + coeffs[k]*genX_tableSize - 1);
       for (l = j; l <= i; l++) {
          if (l <= genX_tableSize)
-            d->genX_table[l - 1] = amp1 +
+            table[l - 1] = amp1 +
                 (amp2 - amp1) * (double) (l - j) / (i - j + 1);
         }
     }
    
     for(j = 0; j < genX_tableSize; j++) {
-        if ((wmax = fabs(d->genX_table[j])) > xmax) xmax = wmax;
+        if ((wmax = fabs(table[j])) > xmax) xmax = wmax;
         // fprintf( stdout, "table current = %f\n", wmax);
     }
     // fprintf( stdout, "table max = %f\n", xmax);
     for(j = 0; j < genX_tableSize; j++) {
-        d->genX_table[j] /= xmax;
+        table[j] /= xmax;
     }
+    wavetable_done( d->table );
 
     // return
     RETURN->v_object = in_args;
@@ -1317,25 +2072,30 @@ CK_DLL_CTRL( gen9_coeffs )
         // fprintf( stdout, "weight %d = %f...\n", ii, v );
         coeffs[ii] = v;
     }
+
+    // already made?
+    if( !genX_use( d, WT_GEN9, coeffs, size ) ) { RETURN->v_object = weights; return; }
+    t_CKDOUBLE * table = d->table->table;
     
     for(j = size - 1; j > 0; j -= 3) {
         if(coeffs[j - 1] != 0) {
             for(i = 0; i < genX_tableSize; i++) {
                 t_CKDOUBLE val = sin(TWO_PI * ((t_CKDOUBLE) i / ((t_CKDOUBLE) (genX_tableSize)
                                  / coeffs[j - 2]) + coeffs[j] / 360.));
-                d->genX_table[i] += val * coeffs[j - 1];
+                table[i] += val * coeffs[j - 1];
             }
         }
     }
     
     for(j = 0; j < genX_tableSize; j++) {
-        if ((wmax = fabs(d->genX_table[j])) > xmax) xmax = wmax;
+        if ((wmax = fabs(table[j])) > xmax) xmax = wmax;
         // fprintf( stdout, "table current = %f\n", wmax);
     }
     // fprintf( stdout, "table max = %f\n", xmax);
     for(j = 0; j < genX_tableSize; j++) {
-        d->genX_table[j] /= xmax;
+        table[j] /= xmax;
     }
+    wavetable_done( d->table );
 
     // return 
     RETURN->v_object = weights;
@@ -1352,6 +2112,7 @@ CK_DLL_CTRL( gen10_coeffs )
     genX_Data * d = (genX_Data *)OBJ_MEMBER_UINT(SELF, genX_offset_data);
     t_CKINT i, j, size;
     t_CKDOUBLE wmax, xmax=0.0;
+    t_CKFLOAT coeffs[genX_MAX_COEFFS];
     
     Chuck_Array8 * weights = (Chuck_Array8 *)GET_CK_OBJECT(ARGS);
     
@@ -1364,28 +2125,33 @@ CK_DLL_CTRL( gen10_coeffs )
     for(t_CKUINT ii = 0; ii<size; ii++) {
         weights->get(ii, &v);
         // fprintf( stdout, "weight %d = %f...\n", ii, v );
-        d->coeffs[ii] = v;
+        coeffs[ii] = v;
     }
+
+    // already made?
+    if( !genX_use( d, WT_GEN10, coeffs, size ) ) { RETURN->v_object = weights; return; }
+    t_CKDOUBLE * table = d->table->table;
     
-    j = genX_MAX_COEFFS;
+    j = size;
     while (j--) {
-      if (d->coeffs[j] != 0) {
+      if (coeffs[j] != 0) {
          for (i = 0; i < genX_tableSize; i++) {
             t_CKDOUBLE val = (t_CKDOUBLE) (TWO_PI * (t_CKDOUBLE) i / (genX_tableSize / (j + 1)));
-            d->genX_table[i] += sin(val) * d->coeffs[j];
+            table[i] += sin(val) * coeffs[j];
          }
       }
     }
        
     for(j = 0; j < genX_tableSize; j++) {
-        if ((wmax = fabs(d->genX_table[j])) > xmax) xmax = wmax;
+        if ((wmax = fabs(table[j])) > xmax) xmax = wmax;
         // fprintf( stdout, "table current = %f\n", wmax);
     }
 
     // fprintf( stdout, "table max = %f\n", xmax);
     for(j = 0; j < genX_tableSize; j++) {
-        d->genX_table[j] /= xmax;
+        table[j] /= xmax;
     }
+    wavetable_done( d->table );
 
     // return
     RETURN->v_object = weights;
@@ -1419,14 +2185,18 @@ CK_DLL_CTRL( gen17_coeffs )
         // fprintf( stdout, "weight %d = %f...\n", ii, v );
         coeffs[ii] = v;
     }
+
+    // already made?
+    if( !genX_use( d, WT_GEN17, coeffs, size ) ) { RETURN->v_object = weights; return; }
+    t_CKDOUBLE * table = d->table->table;
     
     for (i = 0; i < genX_tableSize; i++) {
         x = (t_CKDOUBLE)(i / dg - 1.);
-        d->genX_table[i] = 0.0;
+        table[i] = 0.0;
         Tn1 = 1.0;
         Tn = x;
         for (j = 0; j < size; j++) {
-            d->genX_table[i] = coeffs[j] * Tn + d->genX_table[i];
+            table[i] = coeffs[j] * Tn + table[i];
             Tn2 = Tn1;
             Tn1 = Tn;
             Tn = 2.0 * x * Tn1 - Tn2;
@@ -1434,14 +2204,15 @@ CK_DLL_CTRL( gen17_coeffs )
     }
    
     for(j = 0; j < genX_tableSize; j++) {
-        if ((wmax = fabs(d->genX_table[j])) > xmax) xmax = wmax;
+        if ((wmax = fabs(table[j])) > xmax) xmax = wmax;
         // fprintf( stdout, "table current = %f\n", wmax);
     }
     // fprintf( stdout, "table max = %f\n", xmax);
     for(j = 0; j < genX_tableSize; j++) {
-        d->genX_table[j] /= xmax;
-        // fprintf( stdout, "table current = %f\n", d->genX_table[j]);
+        table[j] /= xmax;
+        // fprintf( stdout, "table current = %f\n", table[j]);
     }
+    wavetable_done( d->table );
 
     // return
     RETURN->v_object = weights;
@@ -1500,16 +2271,20 @@ CK_DLL_CTRL( curve_coeffs )
             alpha[points] = (t_CKDOUBLE) coeffs[i++];
     }
 
+    // already made?
+    if( !genX_use( d, WT_CURVE, coeffs, nargs ) ) goto done;
+
     factor = (t_CKDOUBLE) (len - 1) / time[points - 1];
     for (i = 0; i < points; i++)
         time[i] *= factor;
 
-    ptr = d->genX_table;
+    ptr = d->table->table;
     for (i = 0; i < points - 1; i++) {
         seglen = (t_CKINT) (floor(time[i + 1] + 0.5) - floor(time[i] + 0.5)) + 1;
         _transition(value[i], alpha[i], value[i + 1], seglen, ptr);
         ptr += seglen - 1;
     }
+    wavetable_done( d->table );
 
 done:
     // return
@@ -1566,6 +2341,7 @@ CK_DLL_CTRL( warp_coeffs )
 
     t_CKFLOAT k_asym = 1.; 
     t_CKFLOAT k_sym  = 1.; 
+    t_CKFLOAT coeffs[2];
 
     // gewang:
     Chuck_Array8 * weights = (Chuck_Array8 *)GET_CK_OBJECT(ARGS);
@@ -1580,20 +2356,25 @@ CK_DLL_CTRL( warp_coeffs )
     weights->get( 0, &k_asym ); // (t_CKDOUBLE) GET_NEXT_FLOAT(ARGS);
     weights->get( 1, &k_sym ); // (t_CKDOUBLE) GET_NEXT_FLOAT(ARGS);
 
+    // already made?
+    coeffs[0] = k_asym; coeffs[1] = k_sym;
+    if( !genX_use( d, WT_WARP, coeffs, 2 ) ) goto done;
+
     for (i = 0; i < genX_tableSize; i++) {
         t_CKDOUBLE inval = (t_CKDOUBLE) i/(genX_tableSize - 1);
         if(k_asym == 1 && k_sym == 1) {
-            d->genX_table[i]    = inval;
+            d->table->table[i]    = inval;
         } else if(k_sym == 1) {
-            d->genX_table[i]    = _asymwarp(inval, k_asym);
+            d->table->table[i]    = _asymwarp(inval, k_asym);
         } else if(k_asym == 1) {
-            d->genX_table[i]    = _symwarp(inval, k_sym);
+            d->table->table[i]    = _symwarp(inval, k_sym);
         } else {
             inval               = _asymwarp(inval, k_asym);
-            d->genX_table[i]    = _symwarp(inval, k_sym);
+            d->table->table[i]    = _symwarp(inval, k_sym);
         }
-        // fprintf(stdout, "table %d = %f\n", i, d->genX_table[i]);
+        // fprintf(stdout, "table %d = %f\n", i, d->table->table[i]);
     }
+    wavetable_done( d->table );
 
 done:
 
@@ -44,6 +44,7 @@ DLL_QUERY osc_query( Chuck_DL_Query * query );
 CK_DLL_CTOR( osc_ctor );
 CK_DLL_DTOR( osc_dtor );
 CK_DLL_TICK( osc_tick );
+CK_DLL_TICKF( osc_tickf );
 CK_DLL_PMSG( osc_pmsg );
 CK_DLL_CTRL( osc_ctrl_freq );
 CK_DLL_CGET( osc_cget_freq );
@@ -55,15 +56,20 @@ CK_DLL_CTRL( osc_ctrl_width );
 CK_DLL_CGET( osc_cget_width );
 CK_DLL_CTRL( osc_ctrl_sync );
 CK_DLL_CGET( osc_cget_sync );
+CK_DLL_CGET( osc_cget_wavetable );
 
 // sinosc
 CK_DLL_TICK( sinosc_tick );
+CK_DLL_TICKF( sinosc_tickf );
+CK_DLL_CTRL( sinosc_ctrl_wavetable );
 
 // pulseosc
 CK_DLL_TICK( pulseosc_tick );
+CK_DLL_CTRL( pulseosc_ctrl_wavetable );
 
 // triosc
 CK_DLL_TICK( triosc_tick );
+CK_DLL_CTRL( triosc_ctrl_wavetable );
 
 // sawosc 
 CK_DLL_CTOR( sawosc_ctor );
@@ -73,6 +79,22 @@ CK_DLL_CTRL( sawosc_ctrl_width );
 CK_DLL_CTOR( sqrosc_ctor );
 CK_DLL_CTRL( sqrosc_ctrl_width );
 
+// oscbank
+CK_DLL_CTOR( oscbank_ctor );
+CK_DLL_DTOR( oscbank_dtor );
+CK_DLL_TICK( oscbank_tick );
+CK_DLL_TICKF( oscbank_tickf );
+CK_DLL_CTRL( oscbank_ctrl_size );
+CK_DLL_CGET( oscbank_cget_size );
+CK_DLL_CTRL( oscbank_ctrl_freqs );
+CK_DLL_CTRL( oscbank_ctrl_amps );
+CK_DLL_CTRL( oscbank_ctrl_phases );
+CK_DLL_CTRL( oscbank_ctrl_harmonics );
+CK_DLL_CTRL( oscbank_ctrl_freq );
+CK_DLL_CGET( oscbank_cget_freq );
+CK_DLL_CTRL( oscbank_ctrl_amp );
+CK_DLL_CGET( oscbank_cget_amp );
+
 
 //-----------------------------------------------------------------------------
 // file: ugen_genX
@@ -231,6 +231,7 @@ CK_DLL_CGET( Echo_cget_mix );
 CK_DLL_CTOR( Envelope_ctor );
 CK_DLL_DTOR( Envelope_dtor );
 CK_DLL_TICK( Envelope_tick );
+CK_DLL_TICKF( Envelope_tickf );
 CK_DLL_PMSG( Envelope_pmsg );
 CK_DLL_CTRL( Envelope_ctrl_rate );
 CK_DLL_CTRL( Envelope_ctrl_target );
@@ -261,6 +262,7 @@ CK_DLL_CGET( FilterStk_cget_coefs );
 CK_DLL_CTOR( OnePole_ctor );
 CK_DLL_DTOR( OnePole_dtor );
 CK_DLL_TICK( OnePole_tick );
+CK_DLL_TICKF( OnePole_tickf );
 CK_DLL_PMSG( OnePole_pmsg );
 CK_DLL_CTRL( OnePole_ctrl_a1 );
 CK_DLL_CTRL( OnePole_ctrl_b0 );
@@ -273,6 +275,7 @@ CK_DLL_CGET( OnePole_cget_pole );
 CK_DLL_CTOR( TwoPole_ctor );
 CK_DLL_DTOR( TwoPole_dtor );
 CK_DLL_TICK( TwoPole_tick );
+CK_DLL_TICKF( TwoPole_tickf );
 CK_DLL_PMSG( TwoPole_pmsg );
 CK_DLL_CTRL( TwoPole_ctrl_a1 );
 CK_DLL_CTRL( TwoPole_ctrl_a2 );
@@ -445,6 +448,11 @@ CK_DLL_CTRL( WvOut_ctrl_autoPrefix );
 CK_DLL_CGET( WvOut_cget_filename );
 CK_DLL_CGET( WvOut_cget_record );
 CK_DLL_CGET( WvOut_cget_autoPrefix );
+CK_DLL_CTRL( WvOut_ctrl_queueDepth );
+CK_DLL_CGET( WvOut_cget_queueDepth );
+CK_DLL_CGET( WvOut_cget_blocksQueued );
+CK_DLL_CGET( WvOut_cget_blocksDropped );
+CK_DLL_CGET( WvOut_cget_writerLatency );
 
 // FM
 CK_DLL_CTOR( FM_ctor );
@@ -1332,6 +1340,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "BlowBotl", "StkInstrument", env->global(), 
                         BlowBotl_ctor, BlowBotl_dtor,
                         BlowBotl_tick, BlowBotl_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // BlowBotl_offset_data = type_engine_import_mvar ( env, "int", "@BlowBotl_data", FALSE );
     // if( BlowBotl_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -1391,6 +1401,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "BlowHole", "StkInstrument", env->global(), 
                         BlowHole_ctor, BlowHole_dtor,
                         BlowHole_tick, BlowHole_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // BlowHole_offset_data = type_engine_import_mvar ( env, "int", "@BlowHole_data", FALSE );
     // if( BlowHole_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -1583,6 +1595,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Clarinet", "StkInstrument", env->global(), 
                         Clarinet_ctor, Clarinet_dtor,
                         Clarinet_tick, Clarinet_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // Clarinet_offset_data = type_engine_import_mvar ( env, "int", "@Clarinet_data", FALSE );
     // if( Clarinet_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -1652,6 +1666,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Flute", "StkInstrument", env->global(), 
                         Flute_ctor, Flute_dtor,
                         Flute_tick, Flute_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // Flute_offset_data = type_engine_import_mvar ( env, "int", "@Flute_data", FALSE );
     // if( Flute_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -1991,6 +2007,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Saxofony", "StkInstrument", env->global(), 
                         Saxofony_ctor, Saxofony_dtor,
                         Saxofony_tick, Saxofony_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // Saxofony_offset_data = type_engine_import_mvar ( env, "int", "@Saxofony_data", FALSE );
     // if( Saxofony_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -2075,6 +2093,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Shakers", "StkInstrument", env->global(), 
                         Shakers_ctor, Shakers_dtor,
                         Shakers_tick, Shakers_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // Shakers_offset_data = type_engine_import_mvar ( env, "int", "@Shakers_data", FALSE );
     // if( Shakers_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -2140,6 +2160,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Sitar", "StkInstrument", env->global(), 
                         Sitar_ctor, Sitar_dtor,
                         Sitar_tick, Sitar_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // Sitar_offset_data = type_engine_import_mvar ( env, "int", "@Sitar_data", FALSE );
     // if( Sitar_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -2164,6 +2186,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "StifKarp", "StkInstrument", env->global(), 
                         StifKarp_ctor, StifKarp_dtor,
                         StifKarp_tick, StifKarp_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // StifKarp_offset_data = type_engine_import_mvar ( env, "int", "@StifKarp_data", FALSE );
     // if( StifKarp_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -2217,6 +2241,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "VoicForm", "StkInstrument", env->global(), 
                         VoicForm_ctor, VoicForm_dtor,
                         VoicForm_tick, VoicForm_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     // member variable
     // VoicForm_offset_data = type_engine_import_mvar ( env, "int", "@VoicForm_data", FALSE );
     // if( VoicForm_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -2602,6 +2628,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Envelope", "UGen", env->global(), 
                         Envelope_ctor, Envelope_dtor,
                         Envelope_tick, Envelope_pmsg ) ) return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, Envelope_tickf ) ) goto error;
     //member variable
     Envelope_offset_data = type_engine_import_mvar ( env, "int", "@Envelope_data", FALSE );
     if( Envelope_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -2862,6 +2890,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "OnePole", "UGen", env->global(), 
                         OnePole_ctor, OnePole_dtor,
                         OnePole_tick, OnePole_pmsg ) ) return FALSE; 
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, OnePole_tickf ) ) goto error;
     // member variable
     OnePole_offset_data = type_engine_import_mvar ( env, "int", "@OnePole_data", FALSE );
     if( OnePole_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -2900,6 +2930,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "TwoPole", "UGen", env->global(), 
                         TwoPole_ctor, TwoPole_dtor,
                         TwoPole_tick, TwoPole_pmsg ) ) return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, TwoPole_tickf ) ) goto error;
     //member variable
     TwoPole_offset_data = type_engine_import_mvar ( env, "int", "@TwoPole_data", FALSE );
     if( TwoPole_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -3210,6 +3242,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Modulate", "UGen", env->global(), 
                         Modulate_ctor, Modulate_dtor,
                         Modulate_tick, Modulate_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     //member variable
     Modulate_offset_data = type_engine_import_mvar ( env, "int", "@Modulate_data", FALSE );
     if( Modulate_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -3282,6 +3316,8 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "SubNoise", "UGen", env->global(), 
                         SubNoise_ctor, SubNoise_dtor,
                         SubNoise_tick, SubNoise_pmsg ) ) return FALSE;
+    // uses rand()
+    if( !type_engine_import_ugen_serial( env ) ) goto error;
     //member variable
     SubNoise_offset_data = type_engine_import_mvar ( env, "int", "@SubNoise_data", FALSE );
     if( SubNoise_offset_data == CK_INVALID_OFFSET ) goto error;
@@ -3415,6 +3451,22 @@ DLL_QUERY stk_query( Chuck_DL_Query * QUERY )
     func = make_new_mfun( "string", "autoPrefix", WvOut_cget_autoPrefix ); //! set/get auto prefix string
     if( !type_engine_import_mfun( env, func ) ) goto error;
 
+    func = make_new_mfun( "int", "queueDepth", WvOut_ctrl_queueDepth ); //! buffers queued for the writer (next file)
+    func->add_arg( "int", "value" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "int", "queueDepth", WvOut_cget_queueDepth ); //! buffers queued for the writer (next file)
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "int", "blocksQueued", WvOut_cget_blocksQueued ); //! buffers handed to the writer
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "int", "blocksDropped", WvOut_cget_blocksDropped ); //! buffers dropped, queue full
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "dur", "writerLatency", WvOut_cget_writerLatency ); //! worst queue-to-disk time
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
     // end the class import
     type_engine_import_class_end( env );
     
@@ -15087,6 +15139,7 @@ WaveLoop :: WaveLoop( const char *fileName, bool raw, bool generate )
   : WvIn( fileName, raw ), phaseOffset(0.0)
 {
   m_freq = 0;
+  looping = true;
   // If at end of file, redo extra sample frame for looping.
   if (chunkPointer+bufferSize == fileSize) {
     for (unsigned int j=0; j<channels; j++)
@@ -15097,7 +15150,7 @@ WaveLoop :: WaveLoop( const char *fileName, bool raw, bool generate )
 
 WaveLoop :: WaveLoop( )
   : WvIn( ), phaseOffset(0.0)
-{ m_freq = 0; } 
+{ m_freq = 0; looping = true; } 
 
 void
 WaveLoop :: openFile( const char * fileName, bool raw, bool norm )
@@ -15121,8 +15174,9 @@ void WaveLoop :: readData( unsigned long index )
 {
   WvIn::readData( index );
 
-  // If at end of file, redo extra sample frame for looping.
-  if (chunkPointer+bufferSize == fileSize) {
+  // If at end of file, redo extra sample frame for looping (streamed
+  // chunks come with it).
+  if (!stream && chunkPointer+bufferSize == fileSize) {
     for (unsigned int j=0; j<channels; j++)
       data[bufferSize*channels+j] = data[j];
   }
@@ -15188,8 +15242,15 @@ const MY_FLOAT *WaveLoop :: tickFrame(void)
 
   if (chunking) {
     // Check the time address vs. our current buffer limits.
-    if ( (tyme < chunkPointer) || (tyme >= chunkPointer+bufferSize) )
+    if ( (tyme < chunkPointer) || (tyme >= chunkPointer+bufferSize) ) {
       this->readData((long) tyme);
+      // Still streaming in: silence until it arrives.
+      if ( (tyme < chunkPointer) || (tyme >= chunkPointer+bufferSize) ) {
+        for (i=0; i<channels; i++) lastOutput[i] = 0.0;
+        time += rate;
+        return lastOutput;
+      }
+    }
     // Adjust index for the current buffer.
     tyme -= chunkPointer;
   }
@@ -15649,6 +15710,238 @@ void Wurley :: controlChange( int which, MY_FLOAT value )
 #include <iostream>
 
 #include "util_raw.h"
+#include "util_thread.h"
+#include "util_buffers.h"
+#include "chuck_errmsg.h"
+#include <vector>
+
+// Read length sample frames starting at frame start into data[], which
+// must hold length*channels MY_FLOATs; converts to MY_FLOAT in place.
+static bool wvin_read_frames( FILE *fd, MY_FLOAT *data, Stk::STK_FORMAT dataType,
+                              bool byteswap, unsigned long dataOffset,
+                              unsigned int channels, long start, long length )
+{
+  long i;
+
+  // Read samples into data[].  Use MY_FLOAT data structure
+  // to store samples.
+  if ( dataType == Stk::STK_SINT16 ) {
+    SINT16 *buf = (SINT16 *)data;
+    if (fseek(fd, dataOffset+(long)(start*channels*2), SEEK_SET) == -1) return false;
+    if (fread(buf, length*channels, 2, fd) != 2 ) return false;
+    if ( byteswap ) {
+      SINT16 *ptr = buf;
+      for (i=length*channels-1; i>=0; i--)
+        Stk::swap16((unsigned char *)(ptr++));
+    }
+    for (i=length*channels-1; i>=0; i--)
+      data[i] = buf[i];
+  }
+  else if ( dataType == Stk::STK_SINT32 ) {
+    SINT32 *buf = (SINT32 *)data;
+    if (fseek(fd, dataOffset+(long)(start*channels*4), SEEK_SET) == -1) return false;
+    if (fread(buf, length*channels, 4, fd) != 4 ) return false;
+    if ( byteswap ) {
+      SINT32 *ptr = buf;
+      for (i=length*channels-1; i>=0; i--)
+        Stk::swap32((unsigned char *)(ptr++));
+    }
+    for (i=length*channels-1; i>=0; i--)
+      data[i] = buf[i];
+  }
+  else if ( dataType == Stk::MY_FLOAT32 ) {
+    FLOAT32 *buf = (FLOAT32 *)data;
+    if (fseek(fd, dataOffset+(long)(start*channels*4), SEEK_SET) == -1) return false;
+    if (fread(buf, length*channels, 4, fd) != 4 ) return false;
+    if ( byteswap ) {
+      FLOAT32 *ptr = buf;
+      for (i=length*channels-1; i>=0; i--)
+        Stk::swap32((unsigned char *)(ptr++));
+    }
+    for (i=length*channels-1; i>=0; i--)
+      data[i] = buf[i];
+  }
+  else if ( dataType == Stk::MY_FLOAT64 ) {
+    FLOAT64 *buf = (FLOAT64 *)data;
+    if (fseek(fd, dataOffset+(long)(start*channels*8), SEEK_SET) == -1) return false;
+    if (fread(buf, length*channels, 8, fd) != 8 ) return false;
+    if ( byteswap ) {
+      FLOAT64 *ptr = buf;
+      for (i=length*channels-1; i>=0; i--)
+        Stk::swap64((unsigned char *)(ptr++));
+    }
+    for (i=length*channels-1; i>=0; i--)
+      data[i] = buf[i];
+  }
+  else if ( dataType == Stk::STK_SINT8 ) {
+    unsigned char *buf = (unsigned char *)data;
+    if (fseek(fd, dataOffset+(long)(start*channels), SEEK_SET) == -1) return false;
+    if (fread(buf, length*channels, 1, fd) != 1 ) return false;
+    for (i=length*channels-1; i>=0; i--)
+      data[i] = buf[i] - 128.0;  // 8-bit WAV data is unsigned!
+  }
+
+  return true;
+}
+
+// Chunk slot states.  The audio thread owns EMPTY and READY slots, the
+// streaming thread owns WANTED ones.
+#define STREAM_EMPTY  0
+#define STREAM_WANTED 1
+#define STREAM_READY  2
+
+// A chunked file being read by the streaming thread.  The WvIn copies
+// READY chunks into its own buffer as playback reaches them, so together
+// with the slots that makes a triple buffer.
+struct WvInStream
+{
+  struct Slot
+  {
+    volatile t_CKUINT state;
+    long start;
+    unsigned long length;
+    // the chunk after the last one is the first (WaveLoop)
+    bool wrap;
+    // (STREAM_CHUNK_SIZE+1)*channels
+    MY_FLOAT *data;
+  };
+
+  FILE *fd;
+  Stk::STK_FORMAT dataType;
+  bool byteswap;
+  unsigned long dataOffset;
+  unsigned int channels;
+  unsigned long fileSize;
+  Slot slots[STREAM_SLOTS];
+  // set by the owner when done; the streaming thread frees it
+  volatile t_CKUINT closed;
+  // chunks that were not there in time, and the one waited on (or -1)
+  unsigned long underruns;
+  long missed;
+  std::string name;
+};
+
+// The streaming thread and the streams it serves.  Created on first use
+// and never destroyed, since the thread may still be running at exit.
+struct WvInStreamer
+{
+  WvInStreamer() : wake( 0, 1 ), started( false ) { }
+
+  XThread thread;
+  XSemaphore wake;
+  XMutex mutex;
+  std::vector<WvInStream *> streams;
+  bool started;
+};
+static WvInStreamer *g_wvin_streamer = 0;
+
+// Read one wanted chunk (streaming thread).
+static void wvin_stream_fill( WvInStream *s, WvInStream::Slot *slot )
+{
+  long length = slot->length;
+  bool endfile = ( slot->start+length == (long)s->fileSize );
+  if ( !endfile ) length += 1;
+
+  bool ok = wvin_read_frames( s->fd, slot->data, s->dataType, s->byteswap, s->dataOffset,
+                              s->channels, slot->start, length );
+  // Interpolation frame past the end of the file: the first frame if
+  // looping, else the last one again.
+  if ( ok && endfile ) {
+    MY_FLOAT *extra = slot->data + slot->length*s->channels;
+    if ( !slot->wrap || !wvin_read_frames( s->fd, extra, s->dataType, s->byteswap,
+                                           s->dataOffset, s->channels, 0, 1 ) )
+      for (unsigned int j=0; j<s->channels; j++)
+        extra[j] = extra[j - s->channels];
+  }
+  // Unreadable chunks play as silence rather than stalling playback.
+  if ( !ok )
+    memset( slot->data, 0, (slot->length+1)*s->channels*sizeof(MY_FLOAT) );
+
+  ck_store_release( &slot->state, STREAM_READY );
+}
+
+static void wvin_stream_free( WvInStream *s )
+{
+  EM_log( CK_LOG_INFO, "(WvIn): done streaming '%s', %lu underrun(s)",
+          s->name.c_str(), s->underruns );
+  if ( s->fd ) fclose( s->fd );
+  for (unsigned int i=0; i<STREAM_SLOTS; i++)
+    delete [] s->slots[i].data;
+  delete s;
+}
+
+// The streaming thread: reads wanted chunks, frees closed streams.
+static THREAD_RETURN THREAD_TYPE wvin_stream_cb( void * data )
+{
+  while ( true ) {
+    g_wvin_streamer->wake.wait();
+
+    g_wvin_streamer->mutex.acquire();
+    for (unsigned long i=0; i<g_wvin_streamer->streams.size(); ) {
+      WvInStream *s = g_wvin_streamer->streams[i];
+      if ( ck_load_acquire( &s->closed ) ) {
+        g_wvin_streamer->streams.erase( g_wvin_streamer->streams.begin() + i );
+        wvin_stream_free( s );
+        continue;
+      }
+      for (unsigned int j=0; j<STREAM_SLOTS; j++)
+        if ( ck_load_acquire( &s->slots[j].state ) == STREAM_WANTED )
+          wvin_stream_fill( s, &s->slots[j] );
+      i++;
+    }
+    g_wvin_streamer->mutex.release();
+  }
+
+  return 0;
+}
+
+// Hand an open chunked file to the streaming thread; NULL if it cannot
+// be started, in which case the file is read in the tick path as before.
+static WvInStream *wvin_stream_open( FILE *fd, const char *name, Stk::STK_FORMAT dataType,
+                                     bool byteswap, unsigned long dataOffset,
+                                     unsigned int channels, unsigned long fileSize )
+{
+  // (only the VM thread opens files)
+  if ( !g_wvin_streamer ) {
+    g_wvin_streamer = new WvInStreamer;
+    g_wvin_streamer->started = g_wvin_streamer->thread.start( wvin_stream_cb, NULL );
+    if ( !g_wvin_streamer->started )
+      EM_log( CK_LOG_WARNING, "(WvIn): cannot start streaming thread, reading in place" );
+  }
+  if ( !g_wvin_streamer->started ) return NULL;
+
+  g_wvin_streamer->mutex.acquire();
+
+  WvInStream *s = new WvInStream;
+  s->fd = fd;
+  s->dataType = dataType;
+  s->byteswap = byteswap;
+  s->dataOffset = dataOffset;
+  s->channels = channels;
+  s->fileSize = fileSize;
+  s->closed = FALSE;
+  s->underruns = 0;
+  s->missed = -1;
+  s->name = name;
+  for (unsigned int i=0; i<STREAM_SLOTS; i++) {
+    s->slots[i].state = STREAM_EMPTY;
+    s->slots[i].start = -1;
+    s->slots[i].length = 0;
+    s->slots[i].wrap = false;
+    s->slots[i].data = new MY_FLOAT[(STREAM_CHUNK_SIZE+1)*channels];
+  }
+  g_wvin_streamer->streams.push_back( s );
+  g_wvin_streamer->mutex.release();
+
+  return s;
+}
+
+// Let go of a stream; the streaming thread closes and frees it.
+static void wvin_stream_close( WvInStream *s )
+{
+  ck_store_release( &s->closed, TRUE );
+  g_wvin_streamer->wake.post();
+}
 
 WvIn :: WvIn()
 {
@@ -15663,6 +15956,9 @@ WvIn :: WvIn( const char *fileName, bool raw, bool doNormalize, bool generate )
 
 WvIn :: ~WvIn()
 {
+    if (stream)
+        wvin_stream_close(stream);
+
     if (fd)
         fclose(fd);
 
@@ -15688,11 +15984,16 @@ void WvIn :: init( void )
     bufferSize = 0;
     channels = 0;
     time = 0.0;
+    stream = 0;
+    looping = false;
 }
 
 void WvIn :: closeFile( void )
 {
+    if ( stream ) wvin_stream_close( stream );
+    stream = 0;
     if ( fd ) fclose( fd );
+    fd = 0;
     finished = true;
     str_filename.str = "";
 }
@@ -15716,6 +16017,8 @@ void WvIn :: openFile( const char *fileName, bool raw, bool doNormalize, bool ge
         }
 
         bool result = false;
+        chunking = false;
+        gain = 1.0;
         if ( raw )
             result = getRawInfo( fileName );
         else {
@@ -15751,9 +16054,14 @@ void WvIn :: openFile( const char *fileName, bool raw, bool doNormalize, bool ge
             sprintf(msg, "[chuck](via WvIn): File (%s) data size is zero!", fileName);
             handleError(msg, StkError::FILE_ERROR);
         }
+
+        // Streamed files are read ahead in bigger chunks.
+        if ( chunking ) bufferSize = STREAM_CHUNK_SIZE;
     }
     else
     {
+        if ( stream ) wvin_stream_close( stream );
+        stream = 0;
         bufferSize = 1024;
         channels = 1;
     }
@@ -15890,7 +16198,19 @@ void WvIn :: openFile( const char *fileName, bool raw, bool doNormalize, bool ge
         }
         data[bufferSize] = data[0];
     }
-    else readData( 0 );  // Load file data.
+    else {
+        readData( 0 );  // Load file data.
+
+        // From here on the streaming thread reads the file.
+        if ( chunking ) {
+            stream = wvin_stream_open( fd, fileName, dataType, byteswap, dataOffset,
+                                       channels, fileSize );
+            if ( stream ) {
+                fd = 0;
+                streamRequest( chunkPointer+bufferSize );
+            }
+        }
+    }
 
     if ( doNormalize ) normalize();
     m_loaded = true;
@@ -16358,6 +16678,11 @@ else
 
 void WvIn :: readData( unsigned long index )
 {
+  if ( stream ) {
+    streamData( index );
+    return;
+  }
+
   while (index < (unsigned long)chunkPointer) {
     // Negative rate.
     chunkPointer -= CHUNK_SIZE;
@@ -16376,67 +16701,12 @@ void WvIn :: readData( unsigned long index )
     }
   }
 
-  long i, length = bufferSize;
+  long length = bufferSize;
   bool endfile = (chunkPointer+bufferSize == fileSize);
   if ( !endfile ) length += 1;
 
-  // Read samples into data[].  Use MY_FLOAT data structure
-  // to store samples.
-  if ( dataType == STK_SINT16 ) {
-    SINT16 *buf = (SINT16 *)data;
-    if (fseek(fd, dataOffset+(long)(chunkPointer*channels*2), SEEK_SET) == -1) goto error;
-    if (fread(buf, length*channels, 2, fd) != 2 ) goto error;
-    if ( byteswap ) {
-      SINT16 *ptr = buf;
-      for (i=length*channels-1; i>=0; i--)
-        swap16((unsigned char *)(ptr++));
-    }
-    for (i=length*channels-1; i>=0; i--)
-      data[i] = buf[i];
-  }
-  else if ( dataType == STK_SINT32 ) {
-    SINT32 *buf = (SINT32 *)data;
-    if (fseek(fd, dataOffset+(long)(chunkPointer*channels*4), SEEK_SET) == -1) goto error;
-    if (fread(buf, length*channels, 4, fd) != 4 ) goto error;
-    if ( byteswap ) {
-      SINT32 *ptr = buf;
-      for (i=length*channels-1; i>=0; i--)
-        swap32((unsigned char *)(ptr++));
-    }
-    for (i=length*channels-1; i>=0; i--)
-      data[i] = buf[i];
-  }
-  else if ( dataType == MY_FLOAT32 ) {
-    FLOAT32 *buf = (FLOAT32 *)data;
-    if (fseek(fd, dataOffset+(long)(chunkPointer*channels*4), SEEK_SET) == -1) goto error;
-    if (fread(buf, length*channels, 4, fd) != 4 ) goto error;
-    if ( byteswap ) {
-      FLOAT32 *ptr = buf;
-      for (i=length*channels-1; i>=0; i--)
-        swap32((unsigned char *)(ptr++));
-    }
-    for (i=length*channels-1; i>=0; i--)
-      data[i] = buf[i];
-  }
-  else if ( dataType == MY_FLOAT64 ) {
-    FLOAT64 *buf = (FLOAT64 *)data;
-    if (fseek(fd, dataOffset+(long)(chunkPointer*channels*8), SEEK_SET) == -1) goto error;
-    if (fread(buf, length*channels, 8, fd) != 8 ) goto error;
-    if ( byteswap ) {
-      FLOAT64 *ptr = buf;
-      for (i=length*channels-1; i>=0; i--)
-        swap64((unsigned char *)(ptr++));
-    }
-    for (i=length*channels-1; i>=0; i--)
-      data[i] = buf[i];
-  }
-  else if ( dataType == STK_SINT8 ) {
-    unsigned char *buf = (unsigned char *)data;
-    if (fseek(fd, dataOffset+(long)(chunkPointer*channels), SEEK_SET) == -1) goto error;
-    if (fread(buf, length*channels, 1, fd) != 1 ) goto error;
-    for (i=length*channels-1; i>=0; i--)
-      data[i] = buf[i] - 128.0;  // 8-bit WAV data is unsigned!
-  }
+  if ( !wvin_read_frames( fd, data, dataType, byteswap, dataOffset, channels,
+                          chunkPointer, length ) ) goto error;
 
   // If at end of file, repeat last sample frame for interpolation.
   if ( endfile ) {
@@ -16456,6 +16726,71 @@ void WvIn :: readData( unsigned long index )
   handleError(msg, StkError::FILE_ERROR);
 }
 
+bool WvIn :: streamData( unsigned long index )
+{
+  long start = (long)(index / STREAM_CHUNK_SIZE) * STREAM_CHUNK_SIZE;
+  WvInStream::Slot *slot = 0;
+  for (unsigned int i=0; i<STREAM_SLOTS; i++) {
+    if ( stream->slots[i].start == start &&
+         ck_load_acquire( &stream->slots[i].state ) == STREAM_READY ) {
+      slot = &stream->slots[i];
+      break;
+    }
+  }
+
+  if ( !slot ) {
+    // Not read yet (a seek, or the disk fell behind): ask for it, and
+    // count it once, however many samples go silent waiting.
+    if ( stream->missed != start ) {
+      stream->underruns++;
+      stream->missed = start;
+    }
+    streamRequest( index );
+    return false;
+  }
+  stream->missed = -1;
+
+  memcpy( data, slot->data, (slot->length+1)*channels*sizeof(MY_FLOAT) );
+  chunkPointer = start;
+  bufferSize = slot->length;
+  ck_store_release( &slot->state, STREAM_EMPTY );
+
+  // Read ahead in the direction of play.
+  long next = ( rate < 0.0 ) ? start - STREAM_CHUNK_SIZE : start + STREAM_CHUNK_SIZE;
+  if ( next >= (long)fileSize )
+    next = looping ? 0 : -1;
+  else if ( next < 0 )
+    next = looping ? (long)((fileSize-1) / STREAM_CHUNK_SIZE) * STREAM_CHUNK_SIZE : -1;
+  if ( next >= 0 ) streamRequest( next );
+
+  return true;
+}
+
+void WvIn :: streamRequest( unsigned long index )
+{
+  if ( index >= fileSize ) return;
+
+  long start = (long)(index / STREAM_CHUNK_SIZE) * STREAM_CHUNK_SIZE;
+  WvInStream::Slot *empty = 0, *stale = 0;
+  for (unsigned int i=0; i<STREAM_SLOTS; i++) {
+    t_CKUINT state = ck_load_acquire( &stream->slots[i].state );
+    // already on its way
+    if ( state != STREAM_EMPTY && stream->slots[i].start == start ) return;
+    if ( state == STREAM_EMPTY && !empty ) empty = &stream->slots[i];
+    else if ( state == STREAM_READY && !stale ) stale = &stream->slots[i];
+  }
+
+  // Both slots busy: try again on the next tick.
+  WvInStream::Slot *slot = empty ? empty : stale;
+  if ( !slot ) return;
+
+  slot->start = start;
+  slot->length = fileSize - start < STREAM_CHUNK_SIZE ? fileSize - start : STREAM_CHUNK_SIZE;
+  slot->wrap = looping;
+  ck_store_release( &slot->state, STREAM_WANTED );
+  g_wvin_streamer->wake.post();
+}
+
 void WvIn :: reset(void)
 {
   time = (MY_FLOAT) 0.0;
@@ -16525,6 +16860,10 @@ void WvIn :: setRate(MY_FLOAT aRate)
   // of sound.
   if ( (rate < 0) && (time == 0.0) ) time += rate + fileSize;
 
+  // Start reading from where we jumped to.
+  if ( stream && ( time < chunkPointer || time >= chunkPointer+bufferSize ) )
+    streamRequest( (unsigned long) time );
+
   if (fmod(rate, 1.0) != 0.0) interpolate = true;
   else interpolate = false;
 }
@@ -16587,8 +16926,16 @@ const MY_FLOAT *WvIn :: tickFrame(void)
   tyme = time;
   if (chunking) {
     // Check the time address vs. our current buffer limits.
-    if ( (tyme < chunkPointer) || (tyme >= chunkPointer+bufferSize) )
+    if ( (tyme < chunkPointer) || (tyme >= chunkPointer+bufferSize) ) {
       this->readData((long) tyme);
+      // Still streaming in: silence until it arrives.
+      if ( (tyme < chunkPointer) || (tyme >= chunkPointer+bufferSize) ) {
+        for (i=0; i<channels; i++) lastOutput[i] = 0.0;
+        time += rate;
+        if ( time < 0.0 || time >= fileSize ) finished = true;
+        return lastOutput;
+      }
+    }
     // Adjust index for the current buffer.
     tyme -= chunkPointer;
   }
@@ -16735,6 +17082,83 @@ struct mathdr {
   // There's more, but it's of variable length
 };
 
+// Where a queued buffer's frame count and time stamp go, after the samples.
+struct WvOutBlockInfo
+{
+  t_CKUINT frames;
+  t_CKUINT stamp;
+};
+#define WVOUT_INFO_FLOATS ((sizeof(WvOutBlockInfo)+sizeof(MY_FLOAT)-1)/sizeof(MY_FLOAT))
+
+#if defined(__OS_WINDOWS__)
+  #include <windows.h>
+#else
+  #include <sys/time.h>
+#endif
+
+// Microseconds, for timing queued buffers.
+static t_CKUINT wvout_clock()
+{
+#if defined(__OS_WINDOWS__)
+  LARGE_INTEGER count, freq;
+  QueryPerformanceCounter( &count );
+  QueryPerformanceFrequency( &freq );
+  return (t_CKUINT)( count.QuadPart * 1000000.0 / freq.QuadPart );
+#else
+  struct timeval t;
+  gettimeofday( &t, NULL );
+  return (t_CKUINT)t.tv_sec * 1000000 + t.tv_usec;
+#endif
+}
+
+// The writer thread and the files it writes.  Created on first use and
+// never destroyed, like the WvIn streaming thread.
+struct WvOutWriter
+{
+  WvOutWriter() : wake( 0, 1 ), started( false ) { }
+
+  XThread thread;
+  XSemaphore wake;
+  XMutex mutex;
+  std::vector<WvOut *> outs;
+  // handed over by closeLater(), and held while closing them
+  std::vector<WvOut *> closing;
+  XMutex closeMutex;
+  bool started;
+};
+static WvOutWriter *g_wvout_writer = 0;
+
+// Write everything queued for w (writer lock held).
+static void wvout_drain( WvOut *w )
+{
+  unsigned long samples = BUFFER_SIZE * w->channels;
+  while ( w->queue->get( w->writerData, 1 ) ) {
+    WvOutBlockInfo info;
+    memcpy( &info, w->writerData + samples, sizeof(info) );
+    if ( !w->writeBlock( w->writerData, info.frames ) )
+      EM_log( CK_LOG_WARNING, "(WvOut): error writing data to '%s'", w->str_filename.str.c_str() );
+    t_CKUINT latency = wvout_clock() - info.stamp;
+    if ( latency > w->maxLatency ) w->maxLatency = latency;
+  }
+}
+
+// The writer thread: drains every file's queue when woken.
+static THREAD_RETURN THREAD_TYPE wvout_writer_cb( void * data )
+{
+  while ( true ) {
+    g_wvout_writer->wake.wait();
+
+    g_wvout_writer->mutex.acquire();
+    for (unsigned long i=0; i<g_wvout_writer->outs.size(); i++)
+      wvout_drain( g_wvout_writer->outs[i] );
+    g_wvout_writer->mutex.release();
+
+    WvOut::finishClosing();
+  }
+
+  return 0;
+}
+
 WvOut :: WvOut()
 {
   init();
@@ -16766,13 +17190,41 @@ void WvOut :: init()
   //m_filename[0] = '\0';
   start = TRUE;
   flush = 0;
+  queue = 0;
+  writerData = 0;
+  queueDepth = WVOUT_QUEUE_DEPTH;
+  framesWritten = 0;
+  blocksQueued = 0;
+  blocksDropped = 0;
+  maxLatency = 0;
 }
 
 void WvOut :: closeFile( void )
 {
   if ( fd ) {
     // If there's an existing file, close it first.
+    if ( queue ) {
+      // Take it back from the writer thread, writing what is still queued.
+      g_wvout_writer->mutex.acquire();
+      for (unsigned long i=0; i<g_wvout_writer->outs.size(); i++) {
+        if ( g_wvout_writer->outs[i] == this ) {
+          g_wvout_writer->outs.erase( g_wvout_writer->outs.begin() + i );
+          break;
+        }
+      }
+      wvout_drain( this );
+      g_wvout_writer->mutex.release();
+
+      EM_log( CK_LOG_INFO, "(WvOut): '%s': %lu buffer(s) queued, %lu dropped, worst latency %.2f ms",
+              str_filename.str.c_str(), blocksQueued, blocksDropped, maxLatency / 1000.0 );
+      delete queue;
+      queue = 0;
+      delete [] writerData;
+      writerData = 0;
+    }
     writeData( counter );
+    // What the header says is what made it to the file.
+    totalCount = framesWritten;
 
     if ( fileType == WVOUT_RAW )
       fclose( fd );
@@ -16795,6 +17247,35 @@ void WvOut :: closeFile( void )
 
 }
 
+void WvOut :: closeLater( void )
+{
+  // No writer thread: it writes in place anyway.
+  if ( !queue ) {
+    delete this;
+    return;
+  }
+
+  g_wvout_writer->mutex.acquire();
+  g_wvout_writer->closing.push_back( this );
+  g_wvout_writer->mutex.release();
+  g_wvout_writer->wake.post();
+}
+
+void WvOut :: finishClosing( void )
+{
+  if ( !g_wvout_writer ) return;
+
+  std::vector<WvOut *> closing;
+  g_wvout_writer->closeMutex.acquire();
+  g_wvout_writer->mutex.acquire();
+  closing.swap( g_wvout_writer->closing );
+  g_wvout_writer->mutex.release();
+  // (the destructor writes what is left and closes the file)
+  for (unsigned long i=0; i<closing.size(); i++)
+    delete closing[i];
+  g_wvout_writer->closeMutex.release();
+}
+
 void WvOut :: openFile( const char *fileName, unsigned int nChannels, WvOut::FILE_TYPE type, Stk::STK_FORMAT format )
 {
   closeFile();
@@ -16844,12 +17325,33 @@ void WvOut :: openFile( const char *fileName, unsigned int nChannels, WvOut::FIL
   if ( result == false )
     handleError(msg, StkError::FILE_ERROR);
 
-  // Allocate new memory if necessary.
+  // Allocate new memory if necessary (with room for the queue info).
   if ( lastChannels < channels ) {
     if ( data ) delete [] data;
-    data = (MY_FLOAT *) new MY_FLOAT[BUFFER_SIZE*channels];
+    data = (MY_FLOAT *) new MY_FLOAT[BUFFER_SIZE*channels + WVOUT_INFO_FLOATS];
   }
   counter = 0;
+  framesWritten = 0;
+  blocksQueued = 0;
+  blocksDropped = 0;
+  maxLatency = 0;
+
+  // Full buffers go to the writer thread from now on.
+  // (only the VM thread opens files)
+  if ( !g_wvout_writer ) {
+    g_wvout_writer = new WvOutWriter;
+    g_wvout_writer->started = g_wvout_writer->thread.start( wvout_writer_cb, NULL );
+    if ( !g_wvout_writer->started )
+      EM_log( CK_LOG_WARNING, "(WvOut): cannot start writer thread, writing in place" );
+  }
+  if ( g_wvout_writer->started ) {
+    queue = new CBufferSimple;
+    queue->initialize( queueDepth, (BUFFER_SIZE*channels + WVOUT_INFO_FLOATS) * sizeof(MY_FLOAT) );
+    writerData = new MY_FLOAT[BUFFER_SIZE*channels + WVOUT_INFO_FLOATS];
+    g_wvout_writer->mutex.acquire();
+    g_wvout_writer->outs.push_back( this );
+    g_wvout_writer->mutex.release();
+  }
 }
 
 bool WvOut :: setRawFile( const char *fileName )
@@ -17309,58 +17811,75 @@ MY_FLOAT WvOut :: getTime( void ) const
 
 void WvOut :: writeData( unsigned long frames )
 {
-  if ( dataType == STK_SINT8 ) {
-    if ( fileType == WVOUT_WAV ) { // 8-bit WAV data is unsigned!
-      unsigned char sample;
-      for ( unsigned long k=0; k<frames*channels; k++ ) {
-        sample = (unsigned char) (data[k] * 127.0 + 128.0);
-        if ( fwrite(&sample, 1, 1, fd) != 1 ) goto error;
+  if ( !writeBlock( data, frames ) ) {
+    sprintf(msg, "[chuck](via WvOut): Error writing data to file.");
+    handleError(msg, StkError::FILE_ERROR);
+  }
+}
+
+bool WvOut :: writeBlock( const MY_FLOAT *buf, unsigned long frames )
+{
+  // Convert a piece at a time, one fwrite per piece.
+  unsigned char bytes[4096];
+  size_t size = 1;
+  if ( dataType == STK_SINT16 ) size = 2;
+  else if ( dataType == STK_SINT32 || dataType == MY_FLOAT32 ) size = 4;
+  else if ( dataType == MY_FLOAT64 ) size = 8;
+
+  unsigned long k = 0, n = frames*channels;
+  while ( k < n ) {
+    unsigned long i, m = n - k;
+    if ( m > sizeof(bytes) / size ) m = sizeof(bytes) / size;
+    const MY_FLOAT *in = buf + k;
+
+    if ( dataType == STK_SINT8 ) {
+      if ( fileType == WVOUT_WAV ) { // 8-bit WAV data is unsigned!
+        for ( i=0; i<m; i++ )
+          bytes[i] = (unsigned char) (in[i] * 127.0 + 128.0);
       }
-    }
-    else {
-      signed char sample;
-      for ( unsigned long k=0; k<frames*channels; k++ ) {
-        sample = (signed char) (data[k] * 127.0 + (data[k] > 0 ? 0.5 : -0.5) );
-        //sample = ((signed char) (( data[k] + 1.0 ) * 127.5 + 0.5)) - 128;
-        if ( fwrite(&sample, 1, 1, fd) != 1 ) goto error;
+      else {
+        for ( i=0; i<m; i++ )
+          bytes[i] = (unsigned char) (signed char) (in[i] * 127.0 + (in[i] > 0 ? 0.5 : -0.5) );
       }
     }
-  }
-  else if ( dataType == STK_SINT16 ) {
-    SINT16 sample;
-    for ( unsigned long k=0; k<frames*channels; k++ ) {
-      sample = (SINT16) (data[k] * 32767.0 + (data[k] > 0 ? 0.5 : -0.5) );
-      //sample = ((SINT16) (( data[k] + 1.0 ) * 32767.5 + 0.5)) - 32768;
-      if ( byteswap ) swap16( (unsigned char *)&sample );
-      if ( fwrite(&sample, 2, 1, fd) != 1 ) goto error;
+    else if ( dataType == STK_SINT16 ) {
+      SINT16 sample;
+      for ( i=0; i<m; i++ ) {
+        sample = (SINT16) (in[i] * 32767.0 + (in[i] > 0 ? 0.5 : -0.5) );
+        if ( byteswap ) swap16( (unsigned char *)&sample );
+        memcpy( bytes + i*2, &sample, 2 );
+      }
     }
-  }
-  else if ( dataType == STK_SINT32 ) {
-    SINT32 sample;
-    for ( unsigned long k=0; k<frames*channels; k++ ) {
-      sample = (SINT32) (data[k] * 2147483647.0 + (data[k] > 0 ? 0.5 : -0.5) );
-      //sample = ((SINT32) (( data[k] + 1.0 ) * 2147483647.5 + 0.5)) - 2147483648;
-      if ( byteswap ) swap32( (unsigned char *)&sample );
-      if ( fwrite(&sample, 4, 1, fd) != 1 ) goto error;
+    else if ( dataType == STK_SINT32 ) {
+      SINT32 sample;
+      for ( i=0; i<m; i++ ) {
+        sample = (SINT32) (in[i] * 2147483647.0 + (in[i] > 0 ? 0.5 : -0.5) );
+        if ( byteswap ) swap32( (unsigned char *)&sample );
+        memcpy( bytes + i*4, &sample, 4 );
+      }
     }
-  }
-  else if ( dataType == MY_FLOAT32 ) {
-    FLOAT32 sample;
-    for ( unsigned long k=0; k<frames*channels; k++ ) {
-      sample = (FLOAT32) (data[k]);
-      if ( byteswap ) swap32( (unsigned char *)&sample );
-      if ( fwrite(&sample, 4, 1, fd) != 1 ) goto error;
+    else if ( dataType == MY_FLOAT32 ) {
+      FLOAT32 sample;
+      for ( i=0; i<m; i++ ) {
+        sample = (FLOAT32) (in[i]);
+        if ( byteswap ) swap32( (unsigned char *)&sample );
+        memcpy( bytes + i*4, &sample, 4 );
+      }
     }
-  }
-  else if ( dataType == MY_FLOAT64 ) {
-    FLOAT64 sample;
-    for ( unsigned long k=0; k<frames*channels; k++ ) {
-      sample = (FLOAT64) (data[k]);
-      if ( byteswap ) swap64( (unsigned char *)&sample );
-      if ( fwrite(&sample, 8, 1, fd) != 1 ) goto error;
+    else if ( dataType == MY_FLOAT64 ) {
+      FLOAT64 sample;
+      for ( i=0; i<m; i++ ) {
+        sample = (FLOAT64) (in[i]);
+        if ( byteswap ) swap64( (unsigned char *)&sample );
+        memcpy( bytes + i*8, &sample, 8 );
+      }
     }
+
+    if ( fwrite( bytes, size, m, fd ) != m ) return false;
+    k += m;
   }
 
+  framesWritten += frames;
   flush += frames;
   if( flush >= 8192 )
   {
@@ -17368,11 +17887,25 @@ void WvOut :: writeData( unsigned long frames )
       fflush( fd );
   }
 
-  return;
+  return true;
+}
 
- error:
-  sprintf(msg, "[chuck](via WvOut): Error writing data to file.");
-  handleError(msg, StkError::FILE_ERROR);
+void WvOut :: queueData( unsigned long frames )
+{
+  if ( !queue ) {
+    writeData( frames );
+    return;
+  }
+
+  WvOutBlockInfo info;
+  info.frames = frames;
+  info.stamp = wvout_clock();
+  memcpy( data + BUFFER_SIZE*channels, &info, sizeof(info) );
+
+  // Never wait for the disk: if the writer is that far behind, drop it.
+  if ( queue->put( data, 1 ) ) blocksQueued++;
+  else blocksDropped++;
+  g_wvout_writer->wake.post();
 }
 
 void WvOut :: tick(const MY_FLOAT sample)
@@ -17386,7 +17919,7 @@ void WvOut :: tick(const MY_FLOAT sample)
   totalCount++;
 
   if ( counter == BUFFER_SIZE ) {
-    writeData( BUFFER_SIZE );
+    queueData( BUFFER_SIZE );
     counter = 0;
   }
 }
@@ -17412,12 +17945,27 @@ void WvOut :: tickFrame(const MY_FLOAT *frameVector, unsigned int frames)
     totalCount++;
 
     if ( counter == BUFFER_SIZE ) {
-      writeData( BUFFER_SIZE );
+      queueData( BUFFER_SIZE );
       counter = 0;
     }
   }
 }
 
+void WvOut :: tickSamples(const SAMPLE *frame)
+{
+  if ( !fd ) return;
+
+  for ( unsigned int j=0; j<channels; j++ )
+    data[counter*channels+j] = frame[j];
+  counter++;
+  totalCount++;
+
+  if ( counter == BUFFER_SIZE ) {
+    queueData( BUFFER_SIZE );
+    counter = 0;
+  }
+}
+
 
 
 // chuck - import
@@ -21007,6 +21555,26 @@ CK_DLL_TICK( Envelope_tick )
 }
 
 
+//-----------------------------------------------------------------------------
+// name: Envelope_tickf()
+// desc: TICKF function ... ramps per frame, then a constant gain once the
+//       envelope reaches its target
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( Envelope_tickf )
+{
+    Envelope * d = (Envelope *)OBJ_MEMBER_UINT(SELF, Envelope_offset_data);
+    t_CKUINT i = 0;
+    // ramp
+    for( ; i < nframes && d->getState(); i++ )
+        out[i] = in[i] * d->tick();
+    // at target
+    MY_FLOAT value = d->value;
+    for( ; i < nframes; i++ )
+        out[i] = in[i] * value;
+    return TRUE;
+}
+
+
 //-----------------------------------------------------------------------------
 // name: Envelope_pmsg()
 // desc: PMSG function ...
@@ -21549,6 +22117,19 @@ CK_DLL_TICK( OnePole_tick )
 }
 
 
+//-----------------------------------------------------------------------------
+// name: OnePole_tickf()
+// desc: TICKF function ...
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( OnePole_tickf )
+{
+    OnePole * m = (OnePole *)OBJ_MEMBER_UINT(SELF, OnePole_offset_data);
+    for( t_CKUINT i = 0; i < nframes; i++ )
+        out[i] = m->tick( in[i] );
+    return TRUE;
+}
+
+
 //-----------------------------------------------------------------------------
 // name: OnePole_pmsg()
 // desc: PMSG function ...
@@ -21668,6 +22249,19 @@ CK_DLL_TICK( TwoPole_tick )
 }
 
 
+//-----------------------------------------------------------------------------
+// name: TwoPole_tickf()
+// desc: TICKF function ...
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( TwoPole_tickf )
+{
+    TwoPole * m = (TwoPole *)OBJ_MEMBER_UINT(SELF, TwoPole_offset_data);
+    for( t_CKUINT i = 0; i < nframes; i++ )
+        out[i] = m->tick( in[i] );
+    return TRUE;
+}
+
+
 //-----------------------------------------------------------------------------
 // name: TwoPole_pmsg()
 // desc: PMSG function ...
@@ -24753,6 +25347,63 @@ CK_DLL_CGET( WvOut_cget_autoPrefix )
 }
 
 
+//-----------------------------------------------------------------------------
+// name: WvOut_ctrl_queueDepth()
+// desc: CTRL function ... (takes effect when the next file is opened)
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( WvOut_ctrl_queueDepth )
+{
+    WvOut * w = (WvOut *)OBJ_MEMBER_UINT(SELF, WvOut_offset_data);
+    t_CKINT depth = GET_NEXT_INT(ARGS);
+    w->queueDepth = depth < 2 ? 2 : depth;
+    RETURN->v_int = (t_CKINT) w->queueDepth;
+}
+
+
+//-----------------------------------------------------------------------------
+// name: WvOut_cget_queueDepth()
+// desc: CGET function ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( WvOut_cget_queueDepth )
+{
+    WvOut * w = (WvOut *)OBJ_MEMBER_UINT(SELF, WvOut_offset_data);
+    RETURN->v_int = (t_CKINT) w->queueDepth;
+}
+
+
+//-----------------------------------------------------------------------------
+// name: WvOut_cget_blocksQueued()
+// desc: CGET function ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( WvOut_cget_blocksQueued )
+{
+    WvOut * w = (WvOut *)OBJ_MEMBER_UINT(SELF, WvOut_offset_data);
+    RETURN->v_int = (t_CKINT) w->blocksQueued;
+}
+
+
+//-----------------------------------------------------------------------------
+// name: WvOut_cget_blocksDropped()
+// desc: CGET function ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( WvOut_cget_blocksDropped )
+{
+    WvOut * w = (WvOut *)OBJ_MEMBER_UINT(SELF, WvOut_offset_data);
+    RETURN->v_int = (t_CKINT) w->blocksDropped;
+}
+
+
+//-----------------------------------------------------------------------------
+// name: WvOut_cget_writerLatency()
+// desc: CGET function ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( WvOut_cget_writerLatency )
+{
+    WvOut * w = (WvOut *)OBJ_MEMBER_UINT(SELF, WvOut_offset_data);
+    RETURN->v_dur = (t_CKDUR)( w->maxLatency * Stk::sampleRate() / 1000000.0 );
+}
+
+
 //-----------------------------------------------------------------------------
 // BLT
 //-----------------------------------------------------------------------------
@@ -1080,9 +1080,11 @@ class BandedWG : public Instrmnt
 
     Small files are completely read into local memory
     during instantiation.  Large files are read
-    incrementally from disk.  The file size threshold
-    and the increment size values are defined in
-    WvIn.h.
+    incrementally from disk, by a background thread
+    that prefetches ahead of the play position, so
+    tick() never touches the file system.  The file
+    size threshold and the increment size values are
+    defined in WvIn.h.
 
     WvIn currently supports WAV, AIFF, SND (AU),
     MAT-file (Matlab), and STK RAW file formats.
@@ -1106,8 +1108,15 @@ class BandedWG : public Instrmnt
 #define CHUNK_THRESHOLD 5000000  // 5 Mb
 #define CHUNK_SIZE 1024          // sample frames
 
+// Chunks read ahead by the streaming thread, when it is running,
+// and the number of them in flight besides the one playing.
+#define STREAM_CHUNK_SIZE 16384  // sample frames
+#define STREAM_SLOTS 2
+
 #include <stdio.h>
 
+struct WvInStream;
+
 class WvIn : public Stk
 {
 public:
@@ -1228,6 +1237,12 @@ public: // SWAP formerly protected
   // Read file data.
   virtual void readData(unsigned long index);
 
+  // Switch to the prefetched chunk holding index, if it is there.
+  bool streamData(unsigned long index);
+
+  // Ask the streaming thread for the chunk holding index.
+  void streamRequest(unsigned long index);
+
   // Get STK RAW file information.
   bool getRawInfo( const char *fileName );
 
@@ -1263,6 +1278,9 @@ public: // SWAP formerly protected
   MY_FLOAT gain;
   MY_FLOAT time;
   MY_FLOAT rate;
+  // background reader for chunked files, or NULL
+  WvInStream *stream;
+  bool looping;
 public:
   bool m_loaded;
 };
@@ -5383,6 +5401,11 @@ public: // SWAP formerly protected
     Currently, WvOut is non-interpolating and the
     output rate is always Stk::sampleRate().
 
+    Full buffers are handed to a background writer
+    thread through a queue of queueDepth buffers, so
+    tick() does not wait on the disk; if the queue is
+    full the buffer is dropped and counted.
+
     by Perry R. Cook and Gary P. Scavone, 1995 - 2002.
 */
 /***************************************************/
@@ -5393,6 +5416,9 @@ public: // SWAP formerly protected
 #include <stdio.h>
 
 #define BUFFER_SIZE 1024  // sample frames
+#define WVOUT_QUEUE_DEPTH 32  // buffers waiting for the writer thread
+
+class CBufferSimple;
 
 class WvOut : public Stk
 {
@@ -5427,6 +5453,12 @@ class WvOut : public Stk
   //! If a file is open, write out samples in the queue and then close it.
   void closeFile( void );
 
+  //! Hand this object to the writer thread, which closes the file and deletes it; don't use it after.
+  void closeLater( void );
+
+  //! Close and delete, on this thread, what closeLater() handed over and the writer thread hasn't got to.
+  static void finishClosing( void );
+
   //! Return the number of sample frames output.
   unsigned long getFrames( void ) const;
 
@@ -5451,6 +5483,9 @@ class WvOut : public Stk
   */
   virtual void tickFrame(const MY_FLOAT *frameVector, unsigned int frames = 1);
 
+  //! Output one sample frame of chuck SAMPLEs, one per channel.
+  void tickSamples(const SAMPLE *frame);
+
  public: // SWAP formerly protected
 
   // Initialize class variables.
@@ -5459,6 +5494,12 @@ class WvOut : public Stk
   // Write data to output file;
   virtual void writeData( unsigned long frames );
 
+  // Write frames from buf to the output file; false on error.
+  bool writeBlock( const MY_FLOAT *buf, unsigned long frames );
+
+  // Hand the buffer to the writer thread (or write it, if there is none).
+  void queueData( unsigned long frames );
+
   // Write STK RAW file header.
   bool setRawFile( const char *fileName );
 
@@ -5501,6 +5542,16 @@ class WvOut : public Stk
   // char autoPrefix[1024];
   Chuck_String autoPrefix;
   t_CKUINT flush;
+  // buffers to the writer thread, or NULL to write in place
+  CBufferSimple *queue;
+  // writer thread's copy of a buffer
+  MY_FLOAT *writerData;
+  unsigned long queueDepth;
+  unsigned long framesWritten;
+  // counters: buffers queued and dropped, worst queue-to-disk time (usec)
+  unsigned long blocksQueued;
+  unsigned long blocksDropped;
+  volatile t_CKUINT maxLatency;
 };
 
 #endif // defined(__WVOUT_H)
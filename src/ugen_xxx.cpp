@@ -50,10 +50,19 @@
 #include "chuck_ugen.h"
 #include "chuck_vm.h"
 #include "chuck_globals.h"
+#include "util_thread.h"
 
 #include <fstream>
+#include <map>
+#include <string>
 using namespace std;
 
+#if !defined(__PLATFORM_WIN32__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 
 // LiSa query
 DLL_QUERY lisa_query( Chuck_DL_Query * query );
@@ -167,6 +176,13 @@ DLL_QUERY xxx_query( Chuck_DL_Query * QUERY )
                                                    NULL, NULL, NULL, NULL, 2, 2 )) )
         return FALSE;
 
+    // add record (writes all channels to a WAV file, "" to stop)
+    func = make_new_mfun( "string", "record", dac_ctrl_record );
+    func->add_arg( "string", "filename" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+    func = make_new_mfun( "string", "record", dac_cget_record );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
     // end import
     if( !type_engine_import_class_end( env ) )
         return FALSE;
@@ -254,6 +270,12 @@ DLL_QUERY xxx_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "Noise", "UGen", env->global(), 
                                         NULL, NULL, noise_tick, NULL ) )
         return FALSE;
+    // block tick
+    if( !type_engine_import_ugen_tickf( env, noise_tickf ) )
+        return FALSE;
+    // rand()
+    if( !type_engine_import_ugen_serial( env ) )
+        return FALSE;
 
     // end import
     if( !type_engine_import_class_end( env ) )
@@ -272,6 +294,9 @@ DLL_QUERY xxx_query( Chuck_DL_Query * QUERY )
     if( !type_engine_import_ugen_begin( env, "CNoise", "UGen", env->global(), 
                                         cnoise_ctor, cnoise_dtor, cnoise_tick, NULL ) )
         return FALSE;
+    // rand()
+    if( !type_engine_import_ugen_serial( env ) )
+        return FALSE;
 
     // add member variable
     cnoise_offset_data = type_engine_import_mvar( env, "int", "@cnoise_data", FALSE );
@@ -1161,6 +1186,33 @@ CK_DLL_TICK( dac_tick )
 
 
 
+//-----------------------------------------------------------------------------
+// name: dac_ctrl_record()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_CTRL( dac_ctrl_record )
+{
+    Chuck_String * filename = GET_CK_STRING(ARGS);
+    if( !g_vm->set_record( filename ? filename->str : "" ) )
+        fprintf( stderr, "[chuck](via dac): %s\n", g_vm->last_error() );
+    RETURN->v_string = g_vm->record_name();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: dac_cget_record()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_CGET( dac_cget_record )
+{
+    RETURN->v_string = g_vm->record_name();
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: bunghole_tick
 // desc: ...
@@ -1184,6 +1236,20 @@ CK_DLL_TICK( noise_tick )
 }
 
 
+
+
+//-----------------------------------------------------------------------------
+// name: noise_tickf()
+// desc: ...
+//-----------------------------------------------------------------------------
+CK_DLL_TICKF( noise_tickf )
+{
+    for( t_CKUINT i = 0; i < nframes; i++ )
+        out[i] = -1.0 + 2.0 * (SAMPLE)rand() / RAND_MAX;
+    return TRUE;
+}
+
+
 enum { NOISE_WHITE=0, NOISE_PINK, NOISE_BROWN, NOISE_FBM, NOISE_FLIP, NOISE_XOR };
 
 class CNoise_Data
@@ -2079,6 +2145,441 @@ protected:
 };
 #endif /* CK_SNDBUF_MEMORY_BUFFER */
 
+//-----------------------------------------------------------------------------
+// name: struct sndbuf_sample
+// desc: decoded sample data, shared read-only by every SndBuf that reads the
+//       same file (path, mtime and size) or the same special: table
+//-----------------------------------------------------------------------------
+struct sndbuf_sample
+{
+    string key;
+    // samples (plus guard), read-only once published
+    SAMPLE * buffer;
+    t_CKUINT size;
+    t_CKUINT num_samples;
+    t_CKUINT num_channels;
+    t_CKUINT num_frames;
+    t_CKUINT samplerate;
+    // references from sndbufs
+    t_CKUINT refs;
+    // for evicting idle entries
+    t_CKUINT last_use;
+    // the mapped cache file, if buffer lives there
+    void * map;
+    size_t map_size;
+};
+
+// cache state
+static map<string, sndbuf_sample *> g_sndbuf_cache;
+static XMutex g_sndbuf_cache_mutex;
+static string g_sndbuf_cache_dir;
+static t_CKUINT g_sndbuf_cache_clock = 0;
+static t_CKUINT g_sndbuf_cache_hits = 0;
+static t_CKUINT g_sndbuf_cache_misses = 0;
+static t_CKUINT g_sndbuf_cache_file_hits = 0;
+static t_CKUINT g_sndbuf_cache_bytes = 0;
+static t_CKUINT g_sndbuf_cache_idle_bytes = 0;
+// unreferenced entries are kept up to this many bytes
+#define SNDBUF_CACHE_IDLE_MAX (32 * 1024 * 1024)
+
+// cache file header, followed by the key and then the samples
+struct sndbuf_cache_header
+{
+    char magic[8];
+    unsigned int sample_bytes;
+    unsigned int num_channels;
+    unsigned int samplerate;
+    unsigned int key_len;
+    unsigned int data_offset;
+    unsigned int reserved;
+    unsigned long long size;
+    unsigned long long num_samples;
+};
+#define SNDBUF_CACHE_MAGIC "CKSMPL01"
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_path()
+// desc: cache file for a key; fnv-1a of the key, in the cache directory
+//-----------------------------------------------------------------------------
+static string sndbuf_cache_path( const string & key )
+{
+    unsigned long long h = 14695981039346656037ULL;
+    for( t_CKUINT i = 0; i < key.length(); i++ )
+    {
+        h ^= (unsigned char)key[i];
+        h *= 1099511628211ULL;
+    }
+
+    char buf[32];
+    sprintf( buf, "%08x%08x.cksmp", (unsigned int)(h >> 32), (unsigned int)h );
+    return g_sndbuf_cache_dir + "/" + buf;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_key()
+// desc: key for a sound file: full path, modification time and size
+//-----------------------------------------------------------------------------
+static string sndbuf_cache_key( const char * filename, const struct stat & st )
+{
+    string path = filename;
+#if defined(__PLATFORM_WIN32__)
+    char full[_MAX_PATH];
+    if( _fullpath( full, filename, _MAX_PATH ) ) path = full;
+#else
+    char full[PATH_MAX];
+    if( realpath( filename, full ) ) path = full;
+#endif
+
+    char buf[64];
+    sprintf( buf, "|%lu|%lu", (unsigned long)st.st_mtime, (unsigned long)st.st_size );
+    return path + buf;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_free()
+// desc: free an entry's samples (cache lock held)
+//-----------------------------------------------------------------------------
+static void sndbuf_cache_free( sndbuf_sample * s )
+{
+    g_sndbuf_cache_bytes -= s->size * sizeof(SAMPLE);
+#if !defined(__PLATFORM_WIN32__)
+    if( s->map ) munmap( s->map, s->map_size );
+    else
+#endif
+    SAFE_DELETE_ARRAY( s->buffer );
+    delete s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_evict()
+// desc: free least recently used idle entries over budget (cache lock held)
+//-----------------------------------------------------------------------------
+static void sndbuf_cache_evict()
+{
+    while( g_sndbuf_cache_idle_bytes > SNDBUF_CACHE_IDLE_MAX )
+    {
+        map<string, sndbuf_sample *>::iterator iter, oldest = g_sndbuf_cache.end();
+        for( iter = g_sndbuf_cache.begin(); iter != g_sndbuf_cache.end(); iter++ )
+        {
+            if( iter->second->refs ) continue;
+            if( oldest == g_sndbuf_cache.end() || iter->second->last_use < oldest->second->last_use )
+                oldest = iter;
+        }
+        if( oldest == g_sndbuf_cache.end() ) break;
+
+        sndbuf_sample * s = oldest->second;
+        g_sndbuf_cache.erase( oldest );
+        g_sndbuf_cache_idle_bytes -= s->size * sizeof(SAMPLE);
+        sndbuf_cache_free( s );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_load()
+// desc: look for the key's cache file; mapped read-only where mmap is there,
+//       otherwise read into memory (cache lock held)
+//-----------------------------------------------------------------------------
+static sndbuf_sample * sndbuf_cache_load( const string & key )
+{
+    string path = sndbuf_cache_path( key );
+    sndbuf_cache_header h;
+    char * base = NULL;
+    size_t len = 0;
+
+#if !defined(__PLATFORM_WIN32__)
+    int fd = open( path.c_str(), O_RDONLY );
+    if( fd < 0 ) return NULL;
+    struct stat st;
+    if( fstat( fd, &st ) || (size_t)st.st_size < sizeof(h) ) { close( fd ); return NULL; }
+    len = (size_t)st.st_size;
+    void * m = mmap( NULL, len, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( m == MAP_FAILED ) return NULL;
+    base = (char *)m;
+    memcpy( &h, base, sizeof(h) );
+#else
+    FILE * file = fopen( path.c_str(), "rb" );
+    if( !file ) return NULL;
+    if( fread( &h, sizeof(h), 1, file ) != 1 ) { fclose( file ); return NULL; }
+#endif
+
+    // check it is ours, for this key and this build
+    t_CKBOOL ok = !memcmp( h.magic, SNDBUF_CACHE_MAGIC, 8 ) &&
+        h.sample_bytes == sizeof(SAMPLE) && h.key_len == key.length() &&
+        h.data_offset >= sizeof(h) + h.key_len && h.size >= h.num_samples;
+#if !defined(__PLATFORM_WIN32__)
+    ok = ok && len >= h.data_offset + h.size * sizeof(SAMPLE) &&
+        !memcmp( base + sizeof(h), key.c_str(), h.key_len );
+    if( !ok ) { munmap( base, len ); return NULL; }
+    SAMPLE * buffer = (SAMPLE *)(base + h.data_offset);
+#else
+    string k( h.key_len, '\0' );
+    ok = ok && fread( &k[0], 1, h.key_len, file ) == h.key_len && k == key;
+    SAMPLE * buffer = ok ? new SAMPLE[(t_CKUINT)h.size] : NULL;
+    ok = ok && !fseek( file, h.data_offset, SEEK_SET ) &&
+        fread( buffer, sizeof(SAMPLE), (size_t)h.size, file ) == h.size;
+    fclose( file );
+    if( !ok ) { SAFE_DELETE_ARRAY( buffer ); return NULL; }
+#endif
+
+    sndbuf_sample * s = new sndbuf_sample;
+    s->key = key;
+    s->buffer = buffer;
+    s->size = (t_CKUINT)h.size;
+    s->num_samples = (t_CKUINT)h.num_samples;
+    s->num_channels = h.num_channels;
+    s->num_frames = h.num_channels ? s->num_samples / h.num_channels : 0;
+    s->samplerate = h.samplerate;
+    s->refs = 0;
+    s->last_use = 0;
+    s->map = base;
+    s->map_size = len;
+
+    return s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_store()
+// desc: write an entry to its cache file at path (via rename, so readers
+//       never see a partial file); without the cache lock, as the entry is
+//       read-only and the caller holds a reference to it
+//-----------------------------------------------------------------------------
+static void sndbuf_cache_store( sndbuf_sample * s, const string & path )
+{
+    string temp = path + ".tmp";
+
+    sndbuf_cache_header h;
+    memset( &h, 0, sizeof(h) );
+    memcpy( h.magic, SNDBUF_CACHE_MAGIC, 8 );
+    h.sample_bytes = sizeof(SAMPLE);
+    h.num_channels = (unsigned int)s->num_channels;
+    h.samplerate = (unsigned int)s->samplerate;
+    h.key_len = (unsigned int)s->key.length();
+    // samples start on a 64 byte boundary
+    h.data_offset = (unsigned int)((sizeof(h) + h.key_len + 63) & ~63);
+    h.size = s->size;
+    h.num_samples = s->num_samples;
+
+    FILE * file = fopen( temp.c_str(), "wb" );
+    if( !file )
+    {
+        EM_log( CK_LOG_WARNING, "(sndbuf): cannot write sample cache file '%s'", temp.c_str() );
+        return;
+    }
+
+    char pad[64];
+    memset( pad, 0, sizeof(pad) );
+    t_CKBOOL ok = fwrite( &h, sizeof(h), 1, file ) == 1 &&
+        fwrite( s->key.c_str(), 1, h.key_len, file ) == h.key_len &&
+        fwrite( pad, 1, h.data_offset - sizeof(h) - h.key_len, file ) == h.data_offset - sizeof(h) - h.key_len &&
+        fwrite( s->buffer, sizeof(SAMPLE), s->size, file ) == s->size;
+    ok = !fclose( file ) && ok;
+
+#if defined(__PLATFORM_WIN32__)
+    remove( path.c_str() );
+#endif
+    if( !ok || rename( temp.c_str(), path.c_str() ) )
+    {
+        EM_log( CK_LOG_WARNING, "(sndbuf): cannot write sample cache file '%s'", path.c_str() );
+        remove( temp.c_str() );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_get()
+// desc: reference the samples for key, from memory or the cache file; NULL
+//       if they have to be decoded
+//-----------------------------------------------------------------------------
+static sndbuf_sample * sndbuf_cache_get( const string & key, t_CKBOOL persist )
+{
+    g_sndbuf_cache_mutex.acquire();
+
+    sndbuf_sample * s = NULL;
+    map<string, sndbuf_sample *>::iterator iter = g_sndbuf_cache.find( key );
+    if( iter != g_sndbuf_cache.end() )
+    {
+        s = iter->second;
+        g_sndbuf_cache_hits++;
+    }
+    else if( persist && g_sndbuf_cache_dir != "" && ( s = sndbuf_cache_load( key ) ) )
+    {
+        g_sndbuf_cache[key] = s;
+        g_sndbuf_cache_bytes += s->size * sizeof(SAMPLE);
+        g_sndbuf_cache_idle_bytes += s->size * sizeof(SAMPLE);
+        g_sndbuf_cache_hits++;
+        g_sndbuf_cache_file_hits++;
+    }
+    else g_sndbuf_cache_misses++;
+
+    if( s )
+    {
+        if( !s->refs++ ) g_sndbuf_cache_idle_bytes -= s->size * sizeof(SAMPLE);
+        s->last_use = ++g_sndbuf_cache_clock;
+    }
+
+    g_sndbuf_cache_mutex.release();
+
+    return s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_put()
+// desc: publish freshly decoded samples (taking the buffer) and reference
+//       them; persist writes the cache file too, if there is a cache dir
+//-----------------------------------------------------------------------------
+static sndbuf_sample * sndbuf_cache_put( const string & key, SAMPLE * buffer, t_CKUINT size,
+                                         t_CKUINT num_samples, t_CKUINT num_channels,
+                                         t_CKUINT samplerate, t_CKBOOL persist )
+{
+    g_sndbuf_cache_mutex.acquire();
+
+    sndbuf_sample * s = NULL;
+    string path;
+    map<string, sndbuf_sample *>::iterator iter = g_sndbuf_cache.find( key );
+    if( iter != g_sndbuf_cache.end() )
+    {
+        // someone got there first
+        s = iter->second;
+        SAFE_DELETE_ARRAY( buffer );
+        if( !s->refs ) g_sndbuf_cache_idle_bytes -= s->size * sizeof(SAMPLE);
+    }
+    else
+    {
+        s = new sndbuf_sample;
+        s->key = key;
+        s->buffer = buffer;
+        s->size = size;
+        s->num_samples = num_samples;
+        s->num_channels = num_channels;
+        s->num_frames = num_samples / num_channels;
+        s->samplerate = samplerate;
+        s->refs = 0;
+        s->map = NULL;
+        s->map_size = 0;
+        g_sndbuf_cache[key] = s;
+        g_sndbuf_cache_bytes += size * sizeof(SAMPLE);
+
+        // written below, after the lock
+        if( persist && g_sndbuf_cache_dir != "" )
+            path = sndbuf_cache_path( key );
+    }
+
+    s->refs++;
+    s->last_use = ++g_sndbuf_cache_clock;
+
+    g_sndbuf_cache_mutex.release();
+
+    // other loads and lookups don't wait for the disk
+    if( path != "" ) sndbuf_cache_store( s, path );
+
+    return s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_release()
+// desc: drop a reference; idle entries stay around until over budget
+//-----------------------------------------------------------------------------
+static void sndbuf_cache_release( sndbuf_sample * s )
+{
+    g_sndbuf_cache_mutex.acquire();
+
+    if( !--s->refs )
+    {
+        g_sndbuf_cache_idle_bytes += s->size * sizeof(SAMPLE);
+        sndbuf_cache_evict();
+    }
+
+    g_sndbuf_cache_mutex.release();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_set_dir()
+// desc: directory for cache files; empty to keep the cache in memory only
+//-----------------------------------------------------------------------------
+void sndbuf_cache_set_dir( const char * dir )
+{
+    g_sndbuf_cache_mutex.acquire();
+    g_sndbuf_cache_dir = dir ? dir : "";
+    // no trailing separator
+    while( g_sndbuf_cache_dir.length() > 1 &&
+           ( g_sndbuf_cache_dir[g_sndbuf_cache_dir.length()-1] == '/' ||
+             g_sndbuf_cache_dir[g_sndbuf_cache_dir.length()-1] == '\\' ) )
+        g_sndbuf_cache_dir.erase( g_sndbuf_cache_dir.length()-1 );
+    g_sndbuf_cache_mutex.release();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_stats()
+// desc: cache counters
+//-----------------------------------------------------------------------------
+void sndbuf_cache_stats( Chuck_SndBuf_Cache_Stats & stats )
+{
+    g_sndbuf_cache_mutex.acquire();
+    stats.hits = g_sndbuf_cache_hits;
+    stats.misses = g_sndbuf_cache_misses;
+    stats.file_hits = g_sndbuf_cache_file_hits;
+    stats.entries = g_sndbuf_cache.size();
+    stats.bytes = g_sndbuf_cache_bytes;
+    g_sndbuf_cache_mutex.release();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: sndbuf_cache_log()
+// desc: log cache counters
+//-----------------------------------------------------------------------------
+void sndbuf_cache_log( t_CKUINT level )
+{
+    Chuck_SndBuf_Cache_Stats stats;
+    sndbuf_cache_stats( stats );
+    if( !stats.hits && !stats.misses ) return;
+
+    EM_log( level, "sndbuf sample cache: %d hit(s) (%d from file), %d miss(es)",
+            stats.hits, stats.file_hits, stats.misses );
+    EM_pushlog();
+    EM_log( level, "%d entr%s, %d bytes resident", stats.entries,
+            stats.entries == 1 ? "y" : "ies", stats.bytes );
+    EM_poplog();
+}
+
+
+
+
 // data for each sndbuf
 struct sndbuf_data
 {
@@ -2118,11 +2619,14 @@ struct sndbuf_data
 #endif /* CK_SNDBUF_MEMORY_BUFFER */
 
     SNDFILE * fd;
+    // shared samples from the cache, or NULL if buffer is ours
+    sndbuf_sample * shared;
 
     // constructor
     sndbuf_data()
     {
         buffer = NULL;
+        shared = NULL;
         interp = SNDBUF_INTERP;
         num_channels = 0;
         num_frames = 0;
@@ -2158,9 +2662,30 @@ struct sndbuf_data
 
     ~sndbuf_data()
     {
-        SAFE_DELETE_ARRAY( buffer );
+        free_buffer();
         SAFE_DELETE_ARRAY( chunk_table );
     }
+
+    // release the samples, private or shared
+    void free_buffer()
+    {
+        if( shared ) { sndbuf_cache_release( shared ); shared = NULL; buffer = NULL; }
+        else SAFE_DELETE_ARRAY( buffer );
+    }
+
+    // play shared samples
+    void attach( sndbuf_sample * s )
+    {
+        shared = s;
+        buffer = s->buffer;
+        num_frames = s->num_frames;
+        num_channels = s->num_channels;
+        samplerate = s->samplerate;
+        num_samples = s->num_samples;
+        chan = 0;
+        // nothing left to load
+        chunks_read = num_frames;
+    }
 };
 
 
@@ -2487,11 +3012,7 @@ CK_DLL_CTRL( sndbuf_ctrl_read )
     sndbuf_data * d = (sndbuf_data *)OBJ_MEMBER_UINT(SELF, sndbuf_offset_data);
     const char * filename = GET_CK_STRING(ARGS)->str.c_str();
     
-    if( d->buffer )
-    {
-        delete [] d->buffer;
-        d->buffer = NULL;
-    }
+    d->free_buffer();
 
     if( d->chunk_table )
     {
@@ -2592,32 +3113,35 @@ CK_DLL_CTRL( sndbuf_ctrl_read )
             rawsize = glot_pop_size; rawdata = glot_pop_data; srate = 44100;
         }
 
-        d->num_frames = rawsize;
-        d->num_channels = 1;
-        d->chan = 0;
-        d->samplerate = srate;
-        d->num_samples = rawsize;
-
-        // no chunking
-        d->chunks_read = d->num_frames;
+        // shared with other sndbufs?
+        string key = strstr(filename, "special:");
+        sndbuf_sample * shared = sndbuf_cache_get( key, FALSE );
 
-        if( rawdata ) {
-            d->buffer = new SAMPLE[rawsize+1];
+        if( shared ) {
+            // already converted
+        }
+        else if( rawdata ) {
+            SAMPLE * buffer = new SAMPLE[rawsize+1];
             for( t_CKUINT j = 0; j < rawsize; j++ ) {
-                d->buffer[j] = (SAMPLE)rawdata[j]/(SAMPLE)SHRT_MAX;
+                buffer[j] = (SAMPLE)rawdata[j]/(SAMPLE)SHRT_MAX;
             }
+            buffer[rawsize] = buffer[0];
+            shared = sndbuf_cache_put( key, buffer, rawsize+1, rawsize, 1, srate, FALSE );
         }
         else if( strstr(filename, "special:sinewave") ) {
-            d->buffer = new SAMPLE[rawsize+1];
+            SAMPLE * buffer = new SAMPLE[rawsize+1];
             for( t_CKUINT j = 0; j < rawsize; j++ )
-                d->buffer[j] = sin(2*ONE_PI*j/rawsize);
+                buffer[j] = sin(2*ONE_PI*j/rawsize);
+            buffer[rawsize] = buffer[0];
+            shared = sndbuf_cache_put( key, buffer, rawsize+1, rawsize, 1, srate, FALSE );
         }
         else {
             fprintf( stderr, "[chuck](via SndBuf): cannot load '%s'\n", filename );
             return;
         }
 
-        d->buffer[rawsize] = d->buffer[0];
+        // no chunking
+        d->attach( shared );
     }
     else // read file
     {
@@ -2629,80 +3153,104 @@ CK_DLL_CTRL( sndbuf_ctrl_read )
             return;
         }
 
-        // open it
-        SF_INFO info;
-        info.format = 0;
-        const char * format = (const char *)strrchr( filename, '.');
-        if( format && strcmp( format, ".raw" ) == 0 )
-        { 
-            fprintf( stderr, "[chuck](via SndBuf) %s :: type is '.raw'...\n    assuming 16 bit signed mono (PCM)\n", filename );
-            info.format = SF_FORMAT_RAW | SF_FORMAT_PCM_16 | SF_ENDIAN_CPU ;
-            info.channels = 1;
-            info.samplerate = 44100;
+        // decoded before? (chunked reads stream into a buffer of their own)
+        string key;
+        sndbuf_sample * shared = NULL;
+        if( !d->chunks )
+        {
+            key = sndbuf_cache_key( filename, s );
+            shared = sndbuf_cache_get( key, TRUE );
         }
 
-        // open the handle
-        d->fd = sf_open( filename, SFM_READ, &info );
-        t_CKINT er = sf_error( d->fd );
-        if( er )
+        if( shared )
         {
-            fprintf( stderr, "[chuck](via SndBuf): sndfile error '%i' opening '%s'...\n", er, filename );
-            fprintf( stderr, "[chuck](via SndBuf): (reason: %s)\n", sf_strerror( d->fd ) );
-            if( d->fd ) sf_close( d->fd );
-            // escape
-            return;
+            // log
+            EM_log( CK_LOG_INFO, "(sndbuf): sharing cached samples for '%s'", filename );
+            d->attach( shared );
         }
-
-        // allocate
-        t_CKINT size = info.channels * info.frames;
-        d->buffer = new SAMPLE[size+info.channels];
-        memset( d->buffer, 0, (size+info.channels)*sizeof(SAMPLE) );
-        d->chan = 0;
-        d->num_frames = info.frames;
-        d->num_channels = info.channels;
-        d->samplerate = info.samplerate;
-        d->num_samples = size;
-
-        // log
-        EM_pushlog();
-        EM_log( CK_LOG_INFO, "channels: %d", d->num_channels );
-        EM_log( CK_LOG_INFO, "frames: %d", d->num_frames );
-        EM_log( CK_LOG_INFO, "srate: %d", d->samplerate );
-        EM_log( CK_LOG_INFO, "chunks: %d", d->chunks );
-        EM_poplog();
-
-        // read
-        sf_seek( d->fd, 0, SEEK_SET );
-        d->chunks_read = 0;
-
-        // no chunk
-        if( !d->chunks )
+        else
         {
-            // read all
-            t_CKUINT f = sndbuf_read( d, 0, d->num_frames );
-            // check
-            if( f != (t_CKUINT)d->num_frames )
+            // open it
+            SF_INFO info;
+            info.format = 0;
+            const char * format = (const char *)strrchr( filename, '.');
+            if( format && strcmp( format, ".raw" ) == 0 )
+            { 
+                fprintf( stderr, "[chuck](via SndBuf) %s :: type is '.raw'...\n    assuming 16 bit signed mono (PCM)\n", filename );
+                info.format = SF_FORMAT_RAW | SF_FORMAT_PCM_16 | SF_ENDIAN_CPU ;
+                info.channels = 1;
+                info.samplerate = 44100;
+            }
+
+            // open the handle
+            d->fd = sf_open( filename, SFM_READ, &info );
+            t_CKINT er = sf_error( d->fd );
+            if( er )
             {
-                fprintf( stderr, "[chuck](via SndBuf): read %d rather than %d frames from %s\n",
-                         f, size, filename );
-                sf_close( d->fd ); d->fd = NULL;
+                fprintf( stderr, "[chuck](via SndBuf): sndfile error '%i' opening '%s'...\n", er, filename );
+                fprintf( stderr, "[chuck](via SndBuf): (reason: %s)\n", sf_strerror( d->fd ) );
+                if( d->fd ) sf_close( d->fd );
+                // escape
                 return;
             }
 
-            assert( d->fd == NULL );
-        }
-        else
-        {
-            // reset
-            d->chunks_size = d->chunks;
-            d->chunks_total = d->num_frames / d->chunks;
-            d->chunks_total += d->num_frames % d->chunks ? 1 : 0;
+            // allocate
+            t_CKINT size = info.channels * info.frames;
+            d->buffer = new SAMPLE[size+info.channels];
+            memset( d->buffer, 0, (size+info.channels)*sizeof(SAMPLE) );
+            d->chan = 0;
+            d->num_frames = info.frames;
+            d->num_channels = info.channels;
+            d->samplerate = info.samplerate;
+            d->num_samples = size;
+
+            // log
+            EM_pushlog();
+            EM_log( CK_LOG_INFO, "channels: %d", d->num_channels );
+            EM_log( CK_LOG_INFO, "frames: %d", d->num_frames );
+            EM_log( CK_LOG_INFO, "srate: %d", d->samplerate );
+            EM_log( CK_LOG_INFO, "chunks: %d", d->chunks );
+            EM_poplog();
+
+            // read
+            sf_seek( d->fd, 0, SEEK_SET );
             d->chunks_read = 0;
-            d->chunk_table = new bool[d->chunks_total];
-            memset( d->chunk_table, 0, d->chunks_total * sizeof(bool) );
 
-            // read chunk
-            // sndbuf_load( d, 0 );
+            // no chunk
+            if( !d->chunks )
+            {
+                // read all
+                t_CKUINT f = sndbuf_read( d, 0, d->num_frames );
+                // check
+                if( f != (t_CKUINT)d->num_frames )
+                {
+                    fprintf( stderr, "[chuck](via SndBuf): read %d rather than %d frames from %s\n",
+                             f, size, filename );
+                    sf_close( d->fd ); d->fd = NULL;
+                    return;
+                }
+
+                assert( d->fd == NULL );
+
+                // hand the samples to the cache
+                shared = sndbuf_cache_put( key, d->buffer, size+info.channels, size,
+                                           d->num_channels, d->samplerate, TRUE );
+                d->buffer = NULL;
+                d->attach( shared );
+            }
+            else
+            {
+                // reset
+                d->chunks_size = d->chunks;
+                d->chunks_total = d->num_frames / d->chunks;
+                d->chunks_total += d->num_frames % d->chunks ? 1 : 0;
+                d->chunks_read = 0;
+                d->chunk_table = new bool[d->chunks_total];
+                memset( d->chunk_table, 0, d->chunks_total * sizeof(bool) );
+
+                // read chunk
+                // sndbuf_load( d, 0 );
+            }
         }
     }
 
@@ -2721,11 +3269,7 @@ CK_DLL_CTRL( sndbuf_ctrl_write )
     sndbuf_data * d = (sndbuf_data *)OBJ_MEMBER_UINT(SELF, sndbuf_offset_data);
     const char * filename = GET_CK_STRING(ARGS)->str.c_str();
     
-    if( d->buffer )
-    {
-        delete [] d->buffer;
-        d->buffer = NULL;
-    }
+    d->free_buffer();
     
     struct stat s;
     if( stat( filename, &s ) )
@@ -56,6 +56,10 @@ CK_DLL_CTRL( multi_ctrl_pan );
 CK_DLL_CGET( multi_cget_pan );
 CK_DLL_CGET( multi_cget_chan );
 
+// dac
+CK_DLL_CTRL( dac_ctrl_record );
+CK_DLL_CGET( dac_cget_record );
+
 // bunghole
 CK_DLL_TICK( bunghole_tick );
 
@@ -73,6 +77,7 @@ CK_DLL_CGET( mix2_cget_value );
 
 // noise
 CK_DLL_TICK( noise_tick );
+CK_DLL_TICKF( noise_tickf );
 
 // cnoise
 CK_DLL_CTOR( cnoise_ctor );
@@ -184,6 +189,19 @@ CK_DLL_CGET( sndbuf_cget_length );
 CK_DLL_CGET( sndbuf_cget_channels );
 CK_DLL_CGET( sndbuf_cget_valueAt );
 
+// sndbuf sample cache, shared by all sndbufs
+struct Chuck_SndBuf_Cache_Stats
+{
+    t_CKUINT hits;
+    t_CKUINT misses;
+    t_CKUINT file_hits;
+    t_CKUINT entries;
+    t_CKUINT bytes;
+};
+void sndbuf_cache_set_dir( const char * dir );
+void sndbuf_cache_stats( Chuck_SndBuf_Cache_Stats & stats );
+void sndbuf_cache_log( t_CKUINT level );
+
 // LiSa (Dan Trueman)
 CK_DLL_CTOR( LiSaMulti_ctor );
 CK_DLL_DTOR( LiSaMulti_dtor );
@@ -141,6 +141,9 @@ CK_DLL_SFUN( machine_add_impl )
 
     msg.type = MSG_ADD;
     strcpy( msg.buffer, v );
+    // compile off the VM thread; this shred waits for the id
+    RETURN->v_int = 0;
+    if( otf_compile_async( &msg, SHRED ) ) return;
     RETURN->v_int = (int)the_func( the_vm, the_compiler, &msg, TRUE, NULL );
 }
 
@@ -165,6 +168,9 @@ CK_DLL_SFUN( machine_replace_impl )
     msg.type = MSG_REPLACE;
     msg.param = v;
     strcpy( msg.buffer, v2 );
+    // compile off the VM thread; this shred waits for the id
+    RETURN->v_int = 0;
+    if( otf_compile_async( &msg, SHRED ) ) return;
     RETURN->v_int = (int)the_func( the_vm, the_compiler, &msg, TRUE, NULL );
 }
 
@@ -188,6 +188,18 @@ DLL_QUERY opensoundcontrol_query ( Chuck_DL_Query * query ) {
     func = make_new_mfun( "OscEvent", "address", osc_recv_new_address_type );
     func->add_arg( "string" , "address" );
     func->add_arg( "string" , "type" );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "int", "received", osc_recv_received );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "int", "dropped", osc_recv_dropped );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "int", "late", osc_recv_late );
+    if( !type_engine_import_mfun( env, func ) ) goto error;
+
+    func = make_new_mfun( "dur", "lateness", osc_recv_lateness );
     if( !type_engine_import_mfun( env, func ) ) goto error;
     
 	type_engine_import_class_end( env );
@@ -533,3 +545,39 @@ CK_DLL_MFUN( osc_recv_new_address_type ) {
 
     RETURN->v_object = new_event_obj;
 }
+
+//----------------------------------------------
+// name : osc_recv_received  
+// desc : packets received so far
+//-----------------------------------------------
+CK_DLL_MFUN( osc_recv_received ) { 
+    OSC_Receiver * recv = (OSC_Receiver *)OBJ_MEMBER_INT(SELF, osc_recv_offset_data);
+    RETURN->v_int = recv->received();
+}
+
+//----------------------------------------------
+// name : osc_recv_dropped  
+// desc : messages dropped so far ( by the system, or on full queues )
+//-----------------------------------------------
+CK_DLL_MFUN( osc_recv_dropped ) { 
+    OSC_Receiver * recv = (OSC_Receiver *)OBJ_MEMBER_INT(SELF, osc_recv_offset_data);
+    RETURN->v_int = recv->dropped();
+}
+
+//----------------------------------------------
+// name : osc_recv_late  
+// desc : bundles that arrived after their timetag
+//-----------------------------------------------
+CK_DLL_MFUN( osc_recv_late ) { 
+    OSC_Receiver * recv = (OSC_Receiver *)OBJ_MEMBER_INT(SELF, osc_recv_offset_data);
+    RETURN->v_int = recv->late();
+}
+
+//----------------------------------------------
+// name : osc_recv_lateness  
+// desc : how late the latest of those was
+//-----------------------------------------------
+CK_DLL_MFUN( osc_recv_lateness ) { 
+    OSC_Receiver * recv = (OSC_Receiver *)OBJ_MEMBER_INT(SELF, osc_recv_offset_data);
+    RETURN->v_dur = recv->lateness() * SHRED->vm_ref->srate();
+}
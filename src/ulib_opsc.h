@@ -74,6 +74,10 @@ CK_DLL_MFUN ( osc_recv_remove_address );
 CK_DLL_MFUN ( osc_recv_listen );
 CK_DLL_MFUN ( osc_recv_listen_port );
 CK_DLL_MFUN ( osc_recv_listen_stop );
+CK_DLL_MFUN ( osc_recv_received );
+CK_DLL_MFUN ( osc_recv_dropped );
+CK_DLL_MFUN ( osc_recv_late );
+CK_DLL_MFUN ( osc_recv_lateness );
 
 #endif
 
@@ -33,6 +33,7 @@
 //       Summer 2005 - updated to allow many readers
 //-----------------------------------------------------------------------------
 #include <stdlib.h>
+#include <string.h>
 #include "util_buffers.h"
 #include "chuck_errmsg.h"
 
@@ -369,7 +370,8 @@ UINT__ CBufferAdvance::get( void * data, UINT__ num_elem, UINT__ read_offset_ind
 CBufferSimple::CBufferSimple()
 {
     m_data = NULL;
-    m_data_width = m_read_offset = m_write_offset = m_max_elem = 0;
+    m_data_width = m_read_offset = m_write_offset = m_max_elem = m_mask = 0;
+    m_multi_writer = FALSE;
 }
 
 
@@ -391,20 +393,26 @@ CBufferSimple::~CBufferSimple()
 // name: initialize()
 // desc: initialize
 //-----------------------------------------------------------------------------
-BOOL__ CBufferSimple::initialize( UINT__ num_elem, UINT__ width )
+BOOL__ CBufferSimple::initialize( UINT__ num_elem, UINT__ width, BOOL__ multi_writer )
 {
     // cleanup
     cleanup();
 
+    // power of two, so offsets can wrap by mask
+    UINT__ size = 1;
+    while( size < num_elem ) size <<= 1;
+
     // allocate
-    m_data = (BYTE__ *)malloc( num_elem * width );
+    m_data = (BYTE__ *)malloc( size * width );
     if( !m_data )
         return false;
 
     m_data_width = width;
     m_read_offset = 0;
     m_write_offset = 0;
-    m_max_elem = num_elem;
+    m_max_elem = size;
+    m_mask = size - 1;
+    m_multi_writer = multi_writer;
 
     return true;
 }
@@ -424,7 +432,41 @@ void CBufferSimple::cleanup()
     free( m_data );
 
     m_data = NULL;
-    m_data_width = m_read_offset = m_write_offset = m_max_elem = 0;
+    m_data_width = m_read_offset = m_write_offset = m_max_elem = m_mask = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: copy_in()
+// desc: copy num_elem into the ring at offset at, wrapping once if needed
+//-----------------------------------------------------------------------------
+void CBufferSimple::copy_in( UINT__ at, const BYTE__ * src, UINT__ num_elem )
+{
+    UINT__ i = at & m_mask;
+    UINT__ first = m_max_elem - i < num_elem ? m_max_elem - i : num_elem;
+
+    memcpy( m_data + i * m_data_width, src, first * m_data_width );
+    if( first < num_elem )
+        memcpy( m_data, src + first * m_data_width, ( num_elem - first ) * m_data_width );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: copy_out()
+// desc: copy num_elem out of the ring at offset at, wrapping once if needed
+//-----------------------------------------------------------------------------
+void CBufferSimple::copy_out( UINT__ at, BYTE__ * dst, UINT__ num_elem )
+{
+    UINT__ i = at & m_mask;
+    UINT__ first = m_max_elem - i < num_elem ? m_max_elem - i : num_elem;
+
+    memcpy( dst, m_data + i * m_data_width, first * m_data_width );
+    if( first < num_elem )
+        memcpy( dst + first * m_data_width, m_data, ( num_elem - first ) * m_data_width );
 }
 
 
@@ -434,26 +476,26 @@ void CBufferSimple::cleanup()
 // name: put()
 // desc: put
 //-----------------------------------------------------------------------------
-void CBufferSimple::put( void * data, UINT__ num_elem )
+UINT__ CBufferSimple::put( void * data, UINT__ num_elem )
 {
-    UINT__ i, j;
-    BYTE__ * d = (BYTE__ *)data;
+    if( m_multi_writer ) m_writer_lock.acquire();
 
-    // copy
-    for( i = 0; i < num_elem; i++ )
+    // our index, and how far the reader has got
+    UINT__ write = m_write_offset;
+    UINT__ read = ck_load_acquire( &m_read_offset );
+    UINT__ space = m_max_elem - ( write - read );
+    if( num_elem > space ) num_elem = space;
+
+    // copy, then publish
+    if( num_elem )
     {
-        for( j = 0; j < m_data_width; j++ )
-        {
-            m_data[m_write_offset*m_data_width+j] = d[i*m_data_width+j];
-        }
+        copy_in( write, (const BYTE__ *)data, num_elem );
+        ck_store_release( &m_write_offset, write + num_elem );
+    }
 
-        // move the write
-        m_write_offset++;
+    if( m_multi_writer ) m_writer_lock.release();
 
-        // wrap
-        if( m_write_offset >= m_max_elem )
-            m_write_offset = 0;
-    }
+    return num_elem;
 }
 
 
@@ -465,38 +507,33 @@ void CBufferSimple::put( void * data, UINT__ num_elem )
 //-----------------------------------------------------------------------------
 UINT__ CBufferSimple::get( void * data, UINT__ num_elem )
 {
-    UINT__ i, j;
-    BYTE__ * d = (BYTE__ *)data;
+    // our index, and how far the writer has got
+    UINT__ read = m_read_offset;
+    UINT__ write = ck_load_acquire( &m_write_offset );
+    UINT__ count = write - read;
+    if( num_elem > count ) num_elem = count;
+
+    // copy, then release the slots
+    if( num_elem )
+    {
+        copy_out( read, (BYTE__ *)data, num_elem );
+        ck_store_release( &m_read_offset, read + num_elem );
+    }
 
-    // read catch up with write
-    if( m_read_offset == m_write_offset )
-        return 0;
+    // return number of elems
+    return num_elem;
+}
 
-    // copy
-    for( i = 0; i < num_elem; i++ )
-    {
-        for( j = 0; j < m_data_width; j++ )
-        {
-            d[i*m_data_width+j] = m_data[m_read_offset*m_data_width+j];
-        }
 
-        // move read
-        m_read_offset++;
-        
-        // catch up
-        if( m_read_offset == m_write_offset )
-        {
-            i++;
-            break;
-        }
 
-        // wrap
-        if( m_read_offset >= m_max_elem )
-            m_read_offset = 0;
-    }
 
-    // return number of elems
-    return 1; // shouldn't it return i?
+//-----------------------------------------------------------------------------
+// name: size()
+// desc: elements waiting to be read
+//-----------------------------------------------------------------------------
+UINT__ CBufferSimple::size()
+{
+    return ck_load_acquire( &m_write_offset ) - ck_load_acquire( &m_read_offset );
 }
 
 
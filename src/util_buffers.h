@@ -101,8 +101,13 @@ protected:
 
 //-----------------------------------------------------------------------------
 // name: class CBufferSimple
-// desc: circular buffer - one reader one writer
+// desc: circular buffer - one reader one writer, lock-free; the indices
+//       only grow and are published with release/acquire ordering, each on
+//       its own cache line; put() from several threads is serialized if
+//       initialized with multi_writer
 //-----------------------------------------------------------------------------
+#define CK_CACHE_LINE_SIZE 64
+
 class CBufferSimple
 {
 public:
@@ -110,19 +115,36 @@ public:
     ~CBufferSimple();
 
 public:
-    BOOL__ initialize( UINT__ num_elem, UINT__ width );
+    // num_elem is rounded up to a power of two
+    BOOL__ initialize( UINT__ num_elem, UINT__ width, BOOL__ multi_writer = FALSE );
     void cleanup();
 
 public:
+    // read up to num_elem; returns number read
     UINT__ get( void * data, UINT__ num_elem );
-    void put( void * data, UINT__ num_elem );
+    // write up to num_elem; returns number written (less if full)
+    UINT__ put( void * data, UINT__ num_elem );
+    // number of elements waiting
+    UINT__ size();
+
+protected:
+    void copy_in( UINT__ at, const BYTE__ * src, UINT__ num_elem );
+    void copy_out( UINT__ at, BYTE__ * dst, UINT__ num_elem );
 
 protected:
     BYTE__ * m_data;
     UINT__   m_data_width;
-    UINT__   m_read_offset;
-    UINT__   m_write_offset;
     UINT__   m_max_elem;
+    UINT__   m_mask;
+    BOOL__   m_multi_writer;
+    XMutex   m_writer_lock;
+
+    // writer's index, then reader's, on separate lines
+    BYTE__   m_pad0[CK_CACHE_LINE_SIZE];
+    volatile t_CKUINT m_write_offset;
+    BYTE__   m_pad1[CK_CACHE_LINE_SIZE - sizeof(t_CKUINT)];
+    volatile t_CKUINT m_read_offset;
+    BYTE__   m_pad2[CK_CACHE_LINE_SIZE - sizeof(t_CKUINT)];
 };
 
 
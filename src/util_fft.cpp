@@ -0,0 +1,707 @@
+/*----------------------------------------------------------------------------
+    ChucK Concurrent, On-the-fly Audio Programming Language
+      Compiler and Virtual Machine
+
+    Copyright (c) 2004 Ge Wang and Perry R. Cook.  All rights reserved.
+      http://chuck.cs.princeton.edu/
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// file: util_fft.cpp
+// desc: planned FFT - per-size twiddle tables and bit reversal, radix-4
+//       butterflies (SSE when SAMPLE is float), and any size through
+//       Bluestein's chirp-z; same layout and scaling as rfft()/cfft()
+//-----------------------------------------------------------------------------
+#include "util_fft.h"
+#include "util_xforms.h"
+#include "util_simd.h"
+#include "chuck_errmsg.h"
+
+#include <math.h>
+#include <string.h>
+#include <map>
+
+
+// plans, by complex size
+static std::map<t_CKUINT, Chuck_FFT_Plan *> g_fft_plans;
+// dct plans, by size
+static std::map<t_CKUINT, Chuck_DCT_Plan *> g_dct_plans;
+// use them?
+static t_CKBOOL g_fft_planned = TRUE;
+
+// coefficients worth computing one basis row at a time, for n <= 2^bits
+// (about 2 log2(n) rows cost what the whole transform does); past 16384
+// points the basis is too big to keep
+#define CK_DCT_DIRECT( n, bits ) ( (n) <= 16384 ? ck_min( (n), (bits) * 2 ) : 0 )
+
+static void fft_pow2( const Chuck_FFT_Plan * p, SAMPLE * x, unsigned int forward );
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: Chuck_FFT_Plan()
+// desc: compute tables for nc complex points
+//-----------------------------------------------------------------------------
+Chuck_FFT_Plan::Chuck_FFT_Plan( t_CKUINT nc )
+{
+    t_CKUINT i, j, L, h, d;
+
+    size = nc;
+    pow2 = nc > 0 && !(nc & (nc-1));
+    bits = 0;
+    swaps = NULL;
+    num_swaps = 0;
+    twiddle[0] = twiddle[1] = NULL;
+    sub = NULL;
+    chirp = kernel = work = NULL;
+
+    // real split: e^(i pi k / nc)
+    split = new SAMPLE[2*(nc/2+1)];
+    for( i = 0; i <= nc/2; i++ )
+    {
+        split[2*i] = (SAMPLE)cos( ONE_PI * i / nc );
+        split[2*i+1] = (SAMPLE)sin( ONE_PI * i / nc );
+    }
+
+    if( pow2 )
+    {
+        while( ((t_CKUINT)1 << bits) < nc ) bits++;
+
+        // bit reversal, as swaps
+        swaps = new unsigned int[nc];
+        for( i = 0; i < nc; i++ )
+        {
+            t_CKUINT r = 0;
+            for( t_CKUINT b = 0; b < bits; b++ )
+                if( i & ((t_CKUINT)1 << b) ) r |= (t_CKUINT)1 << (bits-1-b);
+            if( r > i )
+            {
+                swaps[2*num_swaps] = (unsigned int)i;
+                swaps[2*num_swaps+1] = (unsigned int)r;
+                num_swaps++;
+            }
+        }
+
+        // twiddles, in the order fft_pow2() walks the passes
+        t_CKUINT first = (bits & 1) ? 4 : 2;
+        t_CKUINT total = 0;
+        for( L = first; L < nc; L <<= 2 ) total += 6 * (L/2);
+        for( d = 0; d < 2; d++ )
+        {
+            // forward is e^(+i...), as in cfft()
+            double sgn = d == FFT_FORWARD ? 1 : -1;
+            SAMPLE * tw = twiddle[d] = new SAMPLE[total ? total : 1];
+            for( L = first; L < nc; L <<= 2 )
+            {
+                h = L/2;
+                double theta = sgn * ONE_PI / L;
+                for( j = 0; j < h; j++ )
+                {
+                    tw[2*j] = (SAMPLE)cos( theta * 2*j );
+                    tw[2*j+1] = (SAMPLE)sin( theta * 2*j );
+                    tw[2*(h+j)] = (SAMPLE)cos( theta * j );
+                    tw[2*(h+j)+1] = (SAMPLE)sin( theta * j );
+                    tw[2*(2*h+j)] = (SAMPLE)cos( theta * 3*j );
+                    tw[2*(2*h+j)+1] = (SAMPLE)sin( theta * 3*j );
+                }
+                tw += 6*h;
+            }
+        }
+    }
+    else if( nc > 0 )
+    {
+        // convolve with the chirp on a power of two >= 2nc-1
+        t_CKUINT m = 1;
+        while( m < 2*nc-1 ) m <<= 1;
+        sub = fft_plan( m );
+
+        // c[n] = e^(i pi n^2 / nc), with n^2 taken mod 2nc to keep it exact
+        chirp = new SAMPLE[2*nc];
+        for( i = 0; i < nc; i++ )
+        {
+            double phase = ONE_PI * fmod( (double)i * (double)i, 2.0 * nc ) / nc;
+            chirp[2*i] = (SAMPLE)cos( phase );
+            chirp[2*i+1] = (SAMPLE)sin( phase );
+        }
+
+        // kernel: conj(c[|n|]) around zero, transformed, over m
+        kernel = new SAMPLE[2*m];
+        memset( kernel, 0, 2*m*sizeof(SAMPLE) );
+        for( i = 0; i < nc; i++ )
+        {
+            kernel[2*i] = chirp[2*i];
+            kernel[2*i+1] = -chirp[2*i+1];
+            if( i == 0 ) continue;
+            kernel[2*(m-i)] = chirp[2*i];
+            kernel[2*(m-i)+1] = -chirp[2*i+1];
+        }
+        fft_pow2( sub, kernel, FFT_FORWARD );
+        for( i = 0; i < 2*m; i++ ) kernel[i] /= (SAMPLE)m;
+
+        work = new SAMPLE[2*m];
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~Chuck_FFT_Plan()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_FFT_Plan::~Chuck_FFT_Plan()
+{
+    // sub plans are cached on their own
+    SAFE_DELETE_ARRAY( swaps );
+    SAFE_DELETE_ARRAY( twiddle[0] );
+    SAFE_DELETE_ARRAY( twiddle[1] );
+    SAFE_DELETE_ARRAY( split );
+    SAFE_DELETE_ARRAY( chirp );
+    SAFE_DELETE_ARRAY( kernel );
+    SAFE_DELETE_ARRAY( work );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_plan()
+// desc: get (or make) the plan for nc complex points
+//-----------------------------------------------------------------------------
+Chuck_FFT_Plan * fft_plan( t_CKUINT nc )
+{
+    std::map<t_CKUINT, Chuck_FFT_Plan *>::iterator iter = g_fft_plans.find( nc );
+    if( iter != g_fft_plans.end() ) return (*iter).second;
+
+    EM_log( CK_LOG_FINE, "FFT plan for %ld points...", (long)nc );
+    Chuck_FFT_Plan * plan = new Chuck_FFT_Plan( nc );
+    g_fft_plans[nc] = plan;
+
+    return plan;
+}
+
+
+
+
+#if defined(__CK_SIMD_SSE__)
+//-----------------------------------------------------------------------------
+// name: cmul_ps(), rot_ps()
+// desc: two complex products a*w; a times +i (forward) or -i (inverse)
+//-----------------------------------------------------------------------------
+static inline __m128 cmul_ps( __m128 a, __m128 w )
+{
+    __m128 neg_re = _mm_castsi128_ps( _mm_set_epi32( 0, 0x80000000, 0, 0x80000000 ) );
+    __m128 wr = _mm_shuffle_ps( w, w, _MM_SHUFFLE(2,2,0,0) );
+    __m128 wi = _mm_shuffle_ps( w, w, _MM_SHUFFLE(3,3,1,1) );
+    __m128 as = _mm_shuffle_ps( a, a, _MM_SHUFFLE(2,3,0,1) );
+    return _mm_add_ps( _mm_mul_ps( a, wr ), _mm_xor_ps( _mm_mul_ps( as, wi ), neg_re ) );
+}
+
+static inline __m128 rot_ps( __m128 a, unsigned int forward )
+{
+    __m128 neg = forward ? _mm_castsi128_ps( _mm_set_epi32( 0, 0x80000000, 0, 0x80000000 ) )
+                         : _mm_castsi128_ps( _mm_set_epi32( 0x80000000, 0, 0x80000000, 0 ) );
+    return _mm_xor_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE(2,3,0,1) ), neg );
+}
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: radix4_pass()
+// desc: two radix-2 stages at once, over blocks of 2L: for j < L/2, the
+//       points j, j+L/2, j+L, j+3L/2 with twiddles W^2j, W^j, W^3j
+//-----------------------------------------------------------------------------
+static void radix4_pass( SAMPLE * x, t_CKUINT n, t_CKUINT L, const SAMPLE * tw,
+                         unsigned int forward )
+{
+    t_CKUINT h = L/2, s, j;
+    const SAMPLE * w1 = tw;
+    const SAMPLE * w2 = tw + 2*h;
+    const SAMPLE * w3 = tw + 4*h;
+
+    for( s = 0; s < n; s += 2*L )
+    {
+        SAMPLE * a = x + 2*s;
+        SAMPLE * b = a + 2*h;
+        SAMPLE * c = a + 2*L;
+        SAMPLE * d = c + 2*h;
+        j = 0;
+#if defined(__CK_SIMD_SSE__)
+        for( ; j + 2 <= h; j += 2 )
+        {
+            __m128 va = _mm_loadu_ps( a + 2*j );
+            __m128 t1 = cmul_ps( _mm_loadu_ps( b + 2*j ), _mm_loadu_ps( w1 + 2*j ) );
+            __m128 t2 = cmul_ps( _mm_loadu_ps( c + 2*j ), _mm_loadu_ps( w2 + 2*j ) );
+            __m128 t3 = cmul_ps( _mm_loadu_ps( d + 2*j ), _mm_loadu_ps( w3 + 2*j ) );
+            __m128 a0 = _mm_add_ps( va, t1 );
+            __m128 a1 = _mm_sub_ps( va, t1 );
+            __m128 sum = _mm_add_ps( t2, t3 );
+            __m128 dif = rot_ps( _mm_sub_ps( t2, t3 ), forward );
+            _mm_storeu_ps( a + 2*j, _mm_add_ps( a0, sum ) );
+            _mm_storeu_ps( c + 2*j, _mm_sub_ps( a0, sum ) );
+            _mm_storeu_ps( b + 2*j, _mm_add_ps( a1, dif ) );
+            _mm_storeu_ps( d + 2*j, _mm_sub_ps( a1, dif ) );
+        }
+#endif
+        for( ; j < h; j++ )
+        {
+            SAMPLE * pa = a + 2*j, * pb = b + 2*j, * pc = c + 2*j, * pd = d + 2*j;
+            const SAMPLE * q1 = w1 + 2*j, * q2 = w2 + 2*j, * q3 = w3 + 2*j;
+            SAMPLE t1r = pb[0]*q1[0] - pb[1]*q1[1], t1i = pb[0]*q1[1] + pb[1]*q1[0];
+            SAMPLE t2r = pc[0]*q2[0] - pc[1]*q2[1], t2i = pc[0]*q2[1] + pc[1]*q2[0];
+            SAMPLE t3r = pd[0]*q3[0] - pd[1]*q3[1], t3i = pd[0]*q3[1] + pd[1]*q3[0];
+            SAMPLE a0r = pa[0] + t1r, a0i = pa[1] + t1i;
+            SAMPLE a1r = pa[0] - t1r, a1i = pa[1] - t1i;
+            SAMPLE sr = t2r + t3r, si = t2i + t3i;
+            // (t2 - t3) times +i forward, -i inverse
+            SAMPLE dr = forward ? t3i - t2i : t2i - t3i;
+            SAMPLE di = forward ? t2r - t3r : t3r - t2r;
+            pa[0] = a0r + sr; pa[1] = a0i + si;
+            pc[0] = a0r - sr; pc[1] = a0i - si;
+            pb[0] = a1r + dr; pb[1] = a1i + di;
+            pd[0] = a1r - dr; pd[1] = a1i - di;
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_pow2()
+// desc: unscaled in-place transform, size a power of two
+//-----------------------------------------------------------------------------
+static void fft_pow2( const Chuck_FFT_Plan * p, SAMPLE * x, unsigned int forward )
+{
+    t_CKUINT n = p->size, i, L = 2;
+    SAMPLE t;
+
+    // bit reverse
+    for( i = 0; i < p->num_swaps; i++ )
+    {
+        SAMPLE * u = x + 2*p->swaps[2*i];
+        SAMPLE * v = x + 2*p->swaps[2*i+1];
+        t = u[0]; u[0] = v[0]; v[0] = t;
+        t = u[1]; u[1] = v[1]; v[1] = t;
+    }
+
+    // odd number of stages: one radix-2 stage first
+    if( p->bits & 1 )
+    {
+        for( i = 0; i < 2*n; i += 4 )
+        {
+            SAMPLE ur = x[i], ui = x[i+1];
+            x[i] = ur + x[i+2]; x[i+1] = ui + x[i+3];
+            x[i+2] = ur - x[i+2]; x[i+3] = ui - x[i+3];
+        }
+        L = 4;
+    }
+
+    // then by fours
+    const SAMPLE * tw = p->twiddle[forward ? FFT_FORWARD : FFT_INVERSE];
+    for( ; L < n; L <<= 2 )
+    {
+        radix4_pass( x, n, L, tw, forward );
+        tw += 6 * (L/2);
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_chirp()
+// desc: unscaled in-place transform of any size (Bluestein): with
+//       c[n] = e^(i pi n^2 / N), X = c . ( (x . c) (*) conj(c) ); the
+//       inverse is conj( forward( conj(x) ) )
+//-----------------------------------------------------------------------------
+static void fft_chirp( const Chuck_FFT_Plan * p, SAMPLE * x, unsigned int forward )
+{
+    t_CKUINT n = p->size, m = p->sub->size, i = 0;
+    SAMPLE * w = p->work;
+    const SAMPLE * c = p->chirp;
+    const SAMPLE * k = p->kernel;
+    SAMPLE sgn = forward ? 1 : -1;
+
+    // times the chirp
+    for( i = 0; i < n; i++ )
+    {
+        SAMPLE re = x[2*i], im = sgn * x[2*i+1];
+        w[2*i] = re*c[2*i] - im*c[2*i+1];
+        w[2*i+1] = re*c[2*i+1] + im*c[2*i];
+    }
+    memset( w + 2*n, 0, 2*(m-n)*sizeof(SAMPLE) );
+
+    // convolve
+    fft_pow2( p->sub, w, FFT_FORWARD );
+    i = 0;
+#if defined(__CK_SIMD_SSE__)
+    for( ; i + 2 <= m; i += 2 )
+        _mm_storeu_ps( w + 2*i, cmul_ps( _mm_loadu_ps( w + 2*i ), _mm_loadu_ps( k + 2*i ) ) );
+#endif
+    for( ; i < m; i++ )
+    {
+        SAMPLE re = w[2*i]*k[2*i] - w[2*i+1]*k[2*i+1];
+        w[2*i+1] = w[2*i]*k[2*i+1] + w[2*i+1]*k[2*i];
+        w[2*i] = re;
+    }
+    fft_pow2( p->sub, w, FFT_INVERSE );
+
+    // times the chirp again
+    for( i = 0; i < n; i++ )
+    {
+        x[2*i] = w[2*i]*c[2*i] - w[2*i+1]*c[2*i+1];
+        x[2*i+1] = sgn * ( w[2*i]*c[2*i+1] + w[2*i+1]*c[2*i] );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_unscaled()
+// desc: ...
+//-----------------------------------------------------------------------------
+static void fft_unscaled( const Chuck_FFT_Plan * p, SAMPLE * x, unsigned int forward )
+{
+    if( p->pow2 ) fft_pow2( p, x, forward );
+    else fft_chirp( p, x, forward );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_complex()
+// desc: complex fft on NC values; forward scales by 1/2NC and inverse by 2,
+//       like cfft()
+//-----------------------------------------------------------------------------
+void fft_complex( SAMPLE * x, t_CKUINT NC, unsigned int forward )
+{
+    if( !g_fft_planned ) { cfft( x, (long)NC, forward ); return; }
+    if( NC == 0 ) return;
+
+    fft_unscaled( fft_plan( NC ), x, forward );
+    vec_scale( x, (SAMPLE)( forward ? 1.0 / (2*NC) : 2.0 ), 2*NC );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_real_planned()
+// desc: real fft on 2N values, N = p->size, like rfft(): forward leaves N
+//       complex bins with the nyquist (real) in x[1]; inverse takes that
+//       back.  the complex transform's scaling is folded into the split
+//-----------------------------------------------------------------------------
+static void fft_real_planned( const Chuck_FFT_Plan * p, SAMPLE * x, unsigned int forward )
+{
+    const SAMPLE * w = p->split;
+    t_CKUINT N = p->size;
+    SAMPLE c1, c2, xr, xi, wr, wi, h1r, h1i, h2r, h2i, sgn;
+    t_CKUINT i, i1, i2, i3, i4, N2p1 = (N<<1) + 1;
+
+    if( N == 0 ) return;
+
+    if( forward )
+    {
+        fft_unscaled( p, x, FFT_FORWARD );
+        c1 = (SAMPLE)( .5 / (2*N) );
+        c2 = -c1;
+        sgn = 1;
+        xr = x[0];
+        xi = x[1];
+    }
+    else
+    {
+        c1 = c2 = 1;
+        sgn = -1;
+        xr = x[1];
+        xi = 0;
+        x[1] = 0;
+    }
+
+    for( i = 0; i <= N>>1; i++ )
+    {
+        i1 = i<<1;
+        i2 = i1 + 1;
+        i3 = N2p1 - i2;
+        i4 = i3 + 1;
+        wr = w[i1];
+        wi = sgn * w[i2];
+        if( i == 0 )
+        {
+            h1r =  c1*(x[i1] + xr);
+            h1i =  c1*(x[i2] - xi);
+            h2r = -c2*(x[i2] + xi);
+            h2i =  c2*(x[i1] - xr);
+            x[i1] =  h1r + wr*h2r - wi*h2i;
+            x[i2] =  h1i + wr*h2i + wi*h2r;
+            xr =  h1r - wr*h2r + wi*h2i;
+            xi = -h1i + wr*h2i + wi*h2r;
+        }
+        else
+        {
+            h1r =  c1*(x[i1] + x[i3]);
+            h1i =  c1*(x[i2] - x[i4]);
+            h2r = -c2*(x[i2] + x[i4]);
+            h2i =  c2*(x[i1] - x[i3]);
+            x[i1] =  h1r + wr*h2r - wi*h2i;
+            x[i2] =  h1i + wr*h2i + wi*h2r;
+            x[i3] =  h1r - wr*h2r + wi*h2i;
+            x[i4] = -h1i + wr*h2i + wi*h2r;
+        }
+    }
+
+    if( forward )
+        x[1] = xr;
+    else
+        fft_unscaled( p, x, FFT_INVERSE );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_real()
+// desc: real fft on 2N values (see rfft)
+//-----------------------------------------------------------------------------
+void fft_real( SAMPLE * x, t_CKUINT N, unsigned int forward )
+{
+    if( !g_fft_planned ) { rfft( x, (long)N, forward ); return; }
+    if( N == 0 ) return;
+
+    fft_real_planned( fft_plan( N ), x, forward );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: Chuck_DCT_Plan()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_DCT_Plan::Chuck_DCT_Plan( t_CKUINT n )
+{
+    t_CKUINT k, j, bits = 0;
+
+    size = n;
+    twiddle = new SAMPLE[2*n];
+    for( k = 0; k < n; k++ )
+    {
+        twiddle[2*k] = (SAMPLE)cos( ONE_PI * k / (2.0 * n) );
+        twiddle[2*k+1] = (SAMPLE)sin( ONE_PI * k / (2.0 * n) );
+    }
+    fft = fft_plan( n & 1 ? n : n/2 );
+    work = new SAMPLE[2*n];
+
+    // how many rows are cheaper than the fft
+    while( ((t_CKUINT)1 << bits) < n ) bits++;
+    direct = CK_DCT_DIRECT( n, bits );
+    basis = direct ? new SAMPLE[direct * n] : NULL;
+    for( k = 0; k < direct; k++ )
+        for( j = 0; j < n; j++ )
+            basis[k*n+j] = (SAMPLE)cos( ONE_PI * k * (j + .5) / n );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~Chuck_DCT_Plan()
+// desc: ...
+//-----------------------------------------------------------------------------
+Chuck_DCT_Plan::~Chuck_DCT_Plan()
+{
+    SAFE_DELETE_ARRAY( twiddle );
+    SAFE_DELETE_ARRAY( work );
+    SAFE_DELETE_ARRAY( basis );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_dct_plan()
+// desc: get (or make) the dct plan for n points
+//-----------------------------------------------------------------------------
+Chuck_DCT_Plan * fft_dct_plan( t_CKUINT n )
+{
+    std::map<t_CKUINT, Chuck_DCT_Plan *>::iterator iter = g_dct_plans.find( n );
+    if( iter != g_dct_plans.end() ) return (*iter).second;
+
+    EM_log( CK_LOG_FINE, "DCT plan for %ld points...", (long)n );
+    Chuck_DCT_Plan * plan = new Chuck_DCT_Plan( n );
+    g_dct_plans[n] = plan;
+
+    return plan;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_dct()
+// desc: dct-ii by way of the fft (Makhoul): v = x[0], x[2], ... then the
+//       odd ones backwards; out[k] = Re( e^(-i pi k / 2N) V[k] )
+//-----------------------------------------------------------------------------
+void fft_dct( const SAMPLE * x, t_CKUINT N, SAMPLE * out, t_CKUINT Nout )
+{
+    if( Nout > N ) Nout = N;
+    if( Nout == 0 ) return;
+
+    Chuck_DCT_Plan * p = fft_dct_plan( N );
+    const SAMPLE * tw = p->twiddle;
+    SAMPLE * v = p->work;
+    t_CKUINT k, n, j;
+
+    // the first few, straight from the basis
+    if( Nout <= p->direct )
+    {
+        for( k = 0; k < Nout; k++ )
+            v[k] = vec_dot( x, p->basis + k*N, N );
+        // (out may be x)
+        memcpy( out, v, Nout * sizeof(SAMPLE) );
+        return;
+    }
+
+    if( !(N & 1) )
+    {
+        // reorder
+        for( n = 0; n < N/2; n++ )
+        {
+            v[n] = x[2*n];
+            v[N-1-n] = x[2*n+1];
+        }
+        // half-size real fft; its bins are conj(V[k]) / N
+        fft_real_planned( p->fft, v, FFT_FORWARD );
+        SAMPLE s = (SAMPLE)N;
+        out[0] = s * v[0];
+        for( k = 1; k < Nout; k++ )
+        {
+            if( k < N/2 )
+                out[k] = s * ( tw[2*k] * v[2*k] - tw[2*k+1] * v[2*k+1] );
+            else if( k == N/2 )
+                out[k] = s * tw[2*k] * v[1];
+            else
+            {
+                // V[N-j] = conj(V[j])
+                j = N - k;
+                out[k] = s * ( tw[2*k] * v[2*j] + tw[2*k+1] * v[2*j+1] );
+            }
+        }
+    }
+    else
+    {
+        // reorder, as complex
+        for( n = 0; n < N; n++ )
+        {
+            j = n < (N+1)/2 ? 2*n : 2*(N-1-n) + 1;
+            v[2*n] = x[j];
+            v[2*n+1] = 0;
+        }
+        // e^(-i...) is our inverse
+        fft_unscaled( p->fft, v, FFT_INVERSE );
+        for( k = 0; k < Nout; k++ )
+            out[k] = tw[2*k] * v[2*k] + tw[2*k+1] * v[2*k+1];
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_idct()
+// desc: the inverse of fft_dct(): V[k] = e^(i pi k / 2N) ( X[k] - i X[N-k] ),
+//       v = ifft(V), and v unshuffled back into even and odd samples
+//-----------------------------------------------------------------------------
+void fft_idct( const SAMPLE * X, t_CKUINT N, SAMPLE * out )
+{
+    if( N == 0 ) return;
+
+    Chuck_DCT_Plan * p = fft_dct_plan( N );
+    const SAMPLE * tw = p->twiddle;
+    SAMPLE * v = p->work;
+    SAMPLE s = (SAMPLE)( 1.0 / N );
+    SAMPLE a, b;
+    t_CKUINT k, n;
+
+    if( !(N & 1) )
+    {
+        // packed for the real inverse: conj(V[k]) / N, nyquist in v[1]
+        v[0] = s * X[0];
+        v[1] = s * ( tw[N] + tw[N+1] ) * X[N/2];
+        for( k = 1; k < N/2; k++ )
+        {
+            a = X[k]; b = X[N-k];
+            v[2*k] = s * ( tw[2*k] * a + tw[2*k+1] * b );
+            v[2*k+1] = -s * ( tw[2*k+1] * a - tw[2*k] * b );
+        }
+        fft_real_planned( p->fft, v, FFT_INVERSE );
+        // unshuffle
+        for( n = 0; n < N/2; n++ )
+        {
+            out[2*n] = v[n];
+            out[2*n+1] = v[N-1-n];
+        }
+    }
+    else
+    {
+        for( k = 0; k < N; k++ )
+        {
+            a = X[k]; b = k ? X[N-k] : 0;
+            v[2*k] = s * ( tw[2*k] * a + tw[2*k+1] * b );
+            v[2*k+1] = s * ( tw[2*k+1] * a - tw[2*k] * b );
+        }
+        // e^(+i...) is our forward
+        fft_unscaled( p->fft, v, FFT_FORWARD );
+        for( n = 0; n < N; n++ )
+            out[n < (N+1)/2 ? 2*n : 2*(N-1-n) + 1] = v[2*n];
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_set_planned(), fft_planned()
+// desc: ...
+//-----------------------------------------------------------------------------
+void fft_set_planned( t_CKBOOL planned ) { g_fft_planned = planned; }
+t_CKBOOL fft_planned( ) { return g_fft_planned; }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fft_size_for()
+// desc: any even size with plans; the next power of two without
+//-----------------------------------------------------------------------------
+t_CKUINT fft_size_for( t_CKUINT n )
+{
+    if( n < 2 ) return 2;
+    if( g_fft_planned ) return n + (n & 1);
+
+    t_CKUINT x = 1;
+    while( x < n ) x <<= 1;
+    return x;
+}
@@ -0,0 +1,126 @@
+/*----------------------------------------------------------------------------
+    ChucK Concurrent, On-the-fly Audio Programming Language
+      Compiler and Virtual Machine
+
+    Copyright (c) 2004 Ge Wang and Perry R. Cook.  All rights reserved.
+      http://chuck.cs.princeton.edu/
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// file: util_fft.h
+// desc: planned FFT - per-size twiddle tables and bit reversal, radix-4
+//       butterflies (SSE when SAMPLE is float), and any size through
+//       Bluestein's chirp-z; same layout and scaling as rfft()/cfft().
+//       and the DCT-II/III on top of it
+//-----------------------------------------------------------------------------
+#ifndef __UTIL_FFT_H__
+#define __UTIL_FFT_H__
+
+#include "chuck_def.h"
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_FFT_Plan
+// desc: everything an NC-point complex transform needs, computed once
+//-----------------------------------------------------------------------------
+struct Chuck_FFT_Plan
+{
+    // complex points
+    t_CKUINT size;
+    // is size a power of two, and which
+    t_CKBOOL pow2;
+    t_CKUINT bits;
+
+    // power of two: bit reversal swaps (index pairs), and for each radix-4
+    // pass, twiddles W^2j, W^j, W^3j (forward, then inverse)
+    unsigned int * swaps;
+    t_CKUINT num_swaps;
+    SAMPLE * twiddle[2];
+    // real transform split: e^(i pi k / size), k = 0..size/2
+    SAMPLE * split;
+
+    // otherwise: chirp, and the transformed chirp kernel, on a power of two
+    Chuck_FFT_Plan * sub;
+    SAMPLE * chirp;
+    SAMPLE * kernel;
+    SAMPLE * work;
+
+    Chuck_FFT_Plan( t_CKUINT nc );
+    ~Chuck_FFT_Plan();
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct Chuck_DCT_Plan
+// desc: an N-point DCT as an N/2-point real fft (N odd: N-point complex),
+//       plus a few rows of the basis for when only the first ones are wanted
+//-----------------------------------------------------------------------------
+struct Chuck_DCT_Plan
+{
+    // points
+    t_CKUINT size;
+    // e^(i pi k / 2N)
+    SAMPLE * twiddle;
+    // the fft underneath, and its scratch
+    Chuck_FFT_Plan * fft;
+    SAMPLE * work;
+    // up to this many coefficients are cheaper straight from the basis
+    t_CKUINT direct;
+    // cos( pi k (n+.5) / N ), direct x N
+    SAMPLE * basis;
+
+    Chuck_DCT_Plan( t_CKUINT n );
+    ~Chuck_DCT_Plan();
+};
+
+
+
+
+// the (cached) plan for NC complex points; plans live until exit, and
+// share scratch, so transforms are for one thread (the vm)
+Chuck_FFT_Plan * fft_plan( t_CKUINT nc );
+
+// real fft on 2*N values, any N >= 1 (see rfft)
+void fft_real( SAMPLE * x, t_CKUINT N, unsigned int forward );
+// complex fft on NC values, any NC >= 1 (see cfft)
+void fft_complex( SAMPLE * x, t_CKUINT NC, unsigned int forward );
+
+// the (cached) dct plan for N points; make it before the first transform
+// (e.g. on resize) to keep the allocation off the audio thread
+Chuck_DCT_Plan * fft_dct_plan( t_CKUINT N );
+// dct-ii: out[k] = sum x[n] cos( pi k (n+.5) / N ), for k < Nout
+void fft_dct( const SAMPLE * x, t_CKUINT N, SAMPLE * out, t_CKUINT Nout );
+// its inverse, a dct-iii times 2/N:
+// out[n] = 2/N ( X[0]/2 + sum X[k] cos( pi k (n+.5) / N ) )
+void fft_idct( const SAMPLE * X, t_CKUINT N, SAMPLE * out );
+
+// use plans (default), or the classic power-of-two rfft/cfft
+void fft_set_planned( t_CKBOOL planned );
+t_CKBOOL fft_planned( );
+// smallest transform size >= n that fft_real() accepts
+t_CKUINT fft_size_for( t_CKUINT n );
+
+
+
+
+#endif
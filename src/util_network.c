@@ -34,9 +34,14 @@
 //         Ge Wang (gewang@cs.princeton.edu)
 // date: Winter 2003
 //-----------------------------------------------------------------------------
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // for recvmmsg()
+#endif
+
 #include "util_network.h"
 #include "chuck_utils.h"
 #include <stdio.h>
+#include <string.h>
 
 #if defined(__PLATFORM_WIN32__)
 #include <winsock.h>
@@ -105,6 +110,14 @@ ck_socket ck_udp_create( )
     sock->sock = socket( AF_INET, SOCK_DGRAM, 0 );  
     sock->prot = SOCK_DGRAM;
 
+#ifdef SO_RXQ_OVFL
+    // have recvmsg report datagrams dropped on a full receive queue
+    {
+        int one = 1;
+        setsockopt( sock->sock, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one) );
+    }
+#endif
+
     return sock;
 }
 
@@ -341,6 +354,68 @@ int ck_recvfrom( ck_socket sock, char * buffer, int len,
 
 
 
+//-----------------------------------------------------------------------------
+// name: ck_recvmany()
+// desc: recv up to num datagrams into consecutive width-byte buffers, waiting
+//       only for the first; their sizes go in lens.  where the system keeps
+//       it, drops gets the count of datagrams dropped on this socket so far.
+//       returns the number of datagrams received.
+//-----------------------------------------------------------------------------
+int ck_recvmany( ck_socket sock, char * buffers, int width, int * lens,
+                 int num, unsigned long * drops )
+{
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+    struct mmsghdr msgs[CK_RECVMANY_MAX];
+    struct iovec iovs[CK_RECVMANY_MAX];
+    // (control buffers aligned for cmsghdr)
+    long ctrl[CK_RECVMANY_MAX][( CMSG_SPACE(sizeof(unsigned int)) + sizeof(long) - 1 ) / sizeof(long)];
+    struct cmsghdr * cmsg;
+    int i, n;
+
+    if( sock->prot == SOCK_STREAM ) return 0;
+    if( num > CK_RECVMANY_MAX ) num = CK_RECVMANY_MAX;
+
+    memset( msgs, 0, num * sizeof(msgs[0]) );
+    for( i = 0; i < num; i++ )
+    {
+        iovs[i].iov_base = buffers + i * width;
+        iovs[i].iov_len = width;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = ctrl[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+    }
+
+    n = recvmmsg( sock->sock, msgs, num, MSG_WAITFORONE, NULL );
+    if( n <= 0 ) return 0;
+
+    for( i = 0; i < n; i++ )
+    {
+        lens[i] = msgs[i].msg_len;
+#ifdef SO_RXQ_OVFL
+        for( cmsg = CMSG_FIRSTHDR( &msgs[i].msg_hdr ); cmsg;
+             cmsg = CMSG_NXTHDR( &msgs[i].msg_hdr, cmsg ) )
+            if( drops && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL )
+                *drops = *(unsigned int *)CMSG_DATA( cmsg );
+#endif
+    }
+
+    return n;
+#else
+    int len;
+
+    if( sock->prot == SOCK_STREAM || num < 1 ) return 0;
+    len = recvfrom( sock->sock, buffers, width, 0, NULL, NULL );
+    if( len <= 0 ) return 0;
+
+    lens[0] = len;
+    return 1;
+#endif
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: ck_recv()
 // desc: recv a datagram
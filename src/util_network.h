@@ -55,6 +55,9 @@
 // our socket type
 typedef struct ck_socket_ * ck_socket;
 
+// most datagrams ck_recvmany() takes at once
+#define CK_RECVMANY_MAX 64
+
 // create a UDP socket
 ck_socket ck_udp_create( );
 // create a TCP socket
@@ -86,6 +89,9 @@ int ck_recv2( ck_socket sock, char * buffer, int len );
 // recv a datagram
 int ck_recvfrom( ck_socket sock, char * buffer, int len,
                  struct sockaddr * from, int * fromlen );
+// recv up to num datagrams (at most CK_RECVMANY_MAX) in one go
+int ck_recvmany( ck_socket sock, char * buffers, int width, int * lens,
+                 int num, unsigned long * drops );
 
 // send timeout
 int ck_send_timeout( ck_socket sock, long sec, long usec );
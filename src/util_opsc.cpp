@@ -39,6 +39,7 @@
 
 #include "chuck_errmsg.h"
 #include "chuck_vm.h"
+#include "chuck_globals.h"
 
 #include <algorithm>
 using namespace std;
@@ -983,6 +984,9 @@ public:
         int& port() { return _port; }
 };
 
+// most datagrams taken from the socket at once
+#define OSC_RECV_BATCH 32
+
 class UDP_Port_Listener { 
 private:
     UDP_Receiver*  m_in;
@@ -991,8 +995,12 @@ private:
     XThread*       m_thread;
     XMutex*        m_mutex;
 
-    char           m_inbuf[OSCINBUFSIZE];
+    // packet buffers for one batch from the socket, parsed in place
+    char *         m_ring;
+    int            m_lens[OSC_RECV_BATCH];
     int            m_inbufsize;
+    // datagrams the system has dropped on the socket so far
+    unsigned long  m_drops;
 
     vector < UDP_Subscriber * > m_subscribers;
     queue < UDP_Subscriber * > m_free;
@@ -1052,6 +1060,7 @@ public:
     void init();
     bool bind_to_port(int port);
     int recv_next(char *buffer, int size);   
+    int recv_many(char *buffers, int width, int *lens, int num, unsigned long *drops);
     void close_sock();
     udp_stat status();    
 };
@@ -1135,7 +1144,9 @@ UDP_Port_Manager::unsubscribe( UDP_Subscriber * sub ) {
 }
 
 UDP_Port_Listener::UDP_Port_Listener( int port ) : 
+    m_ring( NULL ),
     m_inbufsize( OSCINBUFSIZE ),
+    m_drops( 0 ),
         listening( false )  
     { 
     init();
@@ -1150,11 +1161,12 @@ UDP_Port_Listener::~UDP_Port_Listener() {
     delete m_in;
     delete m_mutex;
     delete m_thread;
+    free( m_ring );
 }
 
 void
 UDP_Port_Listener::init() { 
-    memset( (void*)m_inbuf, '\0', m_inbufsize * sizeof(char) );
+    m_ring = (char *)calloc( OSC_RECV_BATCH, m_inbufsize );
     m_thread = new XThread();
     m_mutex  = new XMutex();
     m_in = new UDP_Receiver();
@@ -1212,9 +1224,9 @@ THREAD_RETURN ( THREAD_TYPE udp_port_listener_thread ) ( void * data )
 
     EM_log( CK_LOG_INFO, "UDP_Port_Listener:: starting receive loop\n" );
     int mLen;
+    // (the socket blocks until there is something to read)
     do {
         mLen = upl->recv_mesg();
-        usleep( 10 );
     } while( mLen != 0 );
 
     EM_log( CK_LOG_INFO, "UDP_Port_Listener:: receive loop terminated\n" );
@@ -1249,23 +1261,33 @@ UDP_Port_Listener::close() {
     }
 }
 
+// takes whatever datagrams are waiting (at least one) in a single call,
+// and hands each to the subscribers in place.  returns the number taken.
 int
 UDP_Port_Listener::recv_mesg() { 
-    int mLen = m_in->recv_next( m_inbuf, m_inbufsize );
+    unsigned long drops = m_drops;
+    int n = m_in->recv_many( m_ring, m_inbufsize, m_lens, OSC_RECV_BATCH, &drops );
     
-    if( mLen == 0 ) { 
+    if( n == 0 ) { 
         EM_log( CK_LOG_INFO, "recvLen 0 on socket, returning 0" );
         return 0;
     }
 
     m_mutex->acquire();
     vector<UDP_Subscriber *>::size_type i;
-    for( i = 0 ; i < m_subscribers.size(); i++ ) {
-        m_subscribers[i]->onReceive( m_inbuf, mLen );
+    if( drops != m_drops ) { 
+        for( i = 0 ; i < m_subscribers.size(); i++ )
+            m_subscribers[i]->onDrop( drops - m_drops );
+        m_drops = drops;
+    }
+    for( int j = 0 ; j < n ; j++ ) { 
+        for( i = 0 ; i < m_subscribers.size(); i++ ) {
+            m_subscribers[i]->onReceive( m_ring + j * m_inbufsize, m_lens[j] );
+        }
     }
     m_mutex->release();
 
-    return mLen;
+    return n;
 }
 
 
@@ -1344,6 +1366,18 @@ UDP_Receiver::recv_next(char * buffer, int bsize)
 }
 
 
+int
+UDP_Receiver::recv_many(char * buffers, int width, int * lens, int num, unsigned long * drops)
+{ 
+   if( _status != UDP_BOUND ) 
+   {
+      EM_log( CK_LOG_SYSTEM, "(via OSC): recv -> socket not bound!"); return 0; 
+   }
+
+   return ck_recvmany( _sock, buffers, width, lens, num, drops );
+}
+
+
 void
 UDP_Receiver::close_sock() {
     ck_close ( _sock );
@@ -1596,6 +1630,70 @@ OSC_Transmitter::kickMessage() {
 
 // OSC_RECEIVER
 
+// characters that make an incoming address a pattern
+#define OSC_PATTERN_CHARS "*?[]{}\\"
+// starting number of address index buckets (a power of 2)
+#define OSC_INDEX_MIN 16
+
+// fnv-1a hash of an address
+static unsigned long osc_address_hash( const char * address )
+{
+    unsigned long h = 2166136261UL;
+    while( *address ) { h ^= (unsigned char)*address++; h *= 16777619UL; }
+    return h;
+}
+
+// seconds from 1900 (osc timetags) to 1970 (unix time)
+#define OSC_SECONDS_1900_TO_1970 2208988800.0
+
+// wall clock time, in seconds since 1900
+static double osc_wallclock()
+{
+#if defined(__PLATFORM_WIN32__)
+    // 100ns ticks since 1601
+    FILETIME ft;
+    GetSystemTimeAsFileTime( &ft );
+    double t = ( (double)ft.dwHighDateTime * 4294967296.0 + ft.dwLowDateTime ) / 1e7;
+    return t - 11644473600.0 + OSC_SECONDS_1900_TO_1970;
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + OSC_SECONDS_1900_TO_1970 + tv.tv_usec / 1e6;
+#endif
+}
+
+// big-endian 4 byte unsigned int
+static unsigned long osc_read_uint( const char * p )
+{
+    const unsigned char * u = (const unsigned char *)p;
+    return ( (unsigned long)u[0] << 24 ) | ( u[1] << 16 ) | ( u[2] << 8 ) | u[3];
+}
+
+// a timetag in seconds since 1900; 0 for "immediately"
+static double osc_timetag( const char * p )
+{
+    unsigned long secs = osc_read_uint( p );
+    unsigned long frac = osc_read_uint( p + 4 );
+    if( secs == 0 ) return 0;
+    return secs + frac / 4294967296.0;
+}
+
+// vm callback for a scheduled bundle
+static void osc_deliver_packet( void * data )
+{
+    OSCPacket * p = (OSCPacket *)data;
+    if( p->recv ) p->recv->deliver( p );
+    else delete p;
+}
+
+// vm callback for a bundle that will never be delivered
+static void osc_drop_packet( void * data )
+{
+    OSCPacket * p = (OSCPacket *)data;
+    if( p->recv ) p->recv->recycle( p );
+    else delete p;
+}
+
 OSC_Receiver::OSC_Receiver():
 //    _listening(false),
 //    _inbufsize(OSCINBUFSIZE),
@@ -1606,13 +1704,19 @@ OSC_Receiver::OSC_Receiver():
     _in_write(1),
     _address_space (NULL),
     _address_size ( 2 ),
-    _address_num ( 0 )
+    _address_num ( 0 ),
+    _received ( 0 ),
+    _dropped ( 0 ),
+    _late ( 0 ),
+    _lateness ( 0 )
 { 
 
     _inbox = (OSCMesg*) malloc (sizeof(OSCMesg) * _inbox_size);
     for( int i = 0; i < _inbox_size; i++ ) _inbox[i].payload = NULL;
 
     _address_space = (OSC_Address_Space **) realloc ( _address_space, _address_size * sizeof ( OSC_Address_Space * ) );
+    _address_index.resize( OSC_INDEX_MIN );
+    _address_mutex = new XMutex();
 
     _io_mutex = new XMutex();
 //    _io_thread = new XThread();
@@ -1626,6 +1730,16 @@ OSC_Receiver::OSC_Receiver():
 OSC_Receiver::OSC_Receiver(UDP_Receiver* in) {
 //    _in   = in;
     _port = -1;
+    _address_space = NULL;
+    _address_size = 0;
+    _address_num = 0;
+    _address_index.resize( OSC_INDEX_MIN );
+    _address_mutex = new XMutex();
+    _io_mutex = new XMutex();
+    _inbox = NULL;
+    _inbox_size = 0;
+    _received = _dropped = _late = 0;
+    _lateness = 0;
 }
 
 void 
@@ -1642,8 +1756,16 @@ OSC_Receiver::~OSC_Receiver()
             free ( _inbox[i].payload );
             _inbox[i].payload = NULL;
         }
-        free ( _inbox );
     }
+    free ( _inbox );
+
+    // bundles still waiting are freed by the vm when due
+    _io_mutex->acquire();
+    for( size_t i = 0 ; i < _scheduled.size() ; i++ ) _scheduled[i]->recv = NULL;
+    for( size_t i = 0 ; i < _packet_pool.size() ; i++ ) delete _packet_pool[i];
+    _scheduled.clear();
+    _packet_pool.clear();
+    _io_mutex->release();
 
     //delete _in;
 }
@@ -1670,7 +1792,13 @@ OSC_Receiver::port() { return _port; }
 
 void 
 OSC_Receiver::onReceive( char * mesg, int mesgLen ) { 
-    handle_mesg( mesg, mesgLen );
+    ck_atomic_add( &_received, 1 );
+    if( mesgLen >= 4 ) handle_mesg( mesg, mesgLen );
+}
+
+void 
+OSC_Receiver::onDrop( unsigned long n ) { 
+    ck_atomic_add( &_dropped, n );
 }
 
 void
@@ -1913,49 +2041,126 @@ OSC_Receiver::handle_mesg( char * buf, int len )
    // this is called sequentially by the receiving thread. 
    if( buf[0] == '#' ) { handle_bundle( buf, len ); return; }
   
-   OSCMesg * mrp = write();
+   // parse in place: the buffer is the listener's (or a scheduled
+   // bundle's), and stays put until distribution is done
+   OSCMesg m;
+   m.payload = NULL;
+   set_mesg( &m, buf, len ); // set pointers for the message into the buffer
+   m.recvtime = 0.000; // GetTime(); // set message time
 
-   if( mrp->payload == NULL ) {
-      mrp->payload = (char *)malloc( OSCINBUFSIZE * sizeof(char) );
-      // fprintf(stderr, "oscrecv:mallocing %d bytes\n", OSCINBUFSIZE);
-   }
+   distribute_message( &m );  // copy message to any & all matching address spaces
+
+   // the distribute message will copy any necessary data into the addr object's private queue.
+   // so we don't need to buffer here.
+}
+
+/*
+  A bundle whose timetag is in the future is copied aside and handed to
+  the vm, which unpacks it once 'now' reaches the sample matching the
+  timetag (taking the wall clock and 'now' to move together).  A bundle
+  that is due (or nested in one, with no later timetag) is unpacked right
+  away; one already past its timetag counts as late.
+*/
 
-   memcpy( (void*)mrp->payload, (const void*)buf, len ); // copy data from buffer to message payload
-   set_mesg( mrp, mrp->payload, len ); // set pointers for the message to its own payload
-   mrp->recvtime = 0.000; // GetTime(); // set message time
+void
+OSC_Receiver::handle_bundle(char*b, int len, double parent) { 
 
-   distribute_message( mrp );  // copy message to any & all matching address spaces
+   if( len < 16 ) return; // "#bundle\0timetags"
 
-   // the distribute message will copy any necessary data into the addr object's private queue.
-   // so we don't need to buffer here.. ( totally wasting the kick-ass expanding buffer i have in this class...drat )  
+   double when = osc_timetag( b + 8 );
 
-   // next_write();
+   if( when <= parent || g_vm == NULL ) { 
+      unpack_bundle( b, len, parent );
+      return;
+   }
+
+   double delay = when - osc_wallclock();
+   if( delay > 0 ) { 
+      schedule_bundle( b, len, when, delay );
+      return;
+   }
+
+   ck_atomic_add( &_late, 1 );
+   _address_mutex->acquire();
+   if( -delay > _lateness ) _lateness = -delay;
+   _address_mutex->release();
+   unpack_bundle( b, len, when );
 }
 
 void
-OSC_Receiver::handle_bundle(char*b, int len) { 
-
-   //no scheduling for now
-   //just immediately unpack everything
+OSC_Receiver::unpack_bundle(char*b, int len, double when) { 
 
-   //fprintf(stderr, "bundle (length %d)\n", len);
-   
    int off = 16; //skip "#bundle\0timetags"
 
-   while ( off < len ) 
+   while ( off + 4 <= len ) 
    { 
       char * z = b+off;
-      unsigned long size = ntohl(*((unsigned long*)z));
+      unsigned long size = osc_read_uint( z );
+      if( size > (unsigned long)( len - off - 4 ) ) break; // truncated
 
       char * m = z+4;
 
-      if( m[0] == '#' ) handle_bundle(m,size);
-      else handle_mesg(m,size);
+      if( size >= 4 ) { 
+         if( m[0] == '#' ) handle_bundle(m,size,when);
+         else handle_mesg(m,size);
+      }
 
       off += size+4; //beginning of next message
    }
 }
 
+void
+OSC_Receiver::schedule_bundle(char*b, int len, double when, double delay) { 
+
+   OSCPacket * p = NULL;
+
+   _io_mutex->acquire();
+   if( _packet_pool.size() ) { 
+      p = _packet_pool.back();
+      _packet_pool.pop_back();
+   }
+   _io_mutex->release();
+
+   if( !p ) p = new OSCPacket;
+   memcpy( p->buf, b, len );
+   p->len  = len;
+   p->when = when;
+   p->recv = this;
+
+   _io_mutex->acquire();
+   _scheduled.push_back( p );
+   _io_mutex->release();
+
+   t_CKTIME at = g_vm->shreduler()->now_system + delay * g_vm->srate();
+   if( !g_vm->queue_callback( at, osc_deliver_packet, p, osc_drop_packet ) ) { 
+      EM_log( CK_LOG_INFO, "OSC_Receiver: cannot schedule bundle...(dropping)" );
+      ck_atomic_add( &_dropped, 1 );
+      _io_mutex->acquire();
+      _scheduled.erase( std::remove( _scheduled.begin(), _scheduled.end(), p ), _scheduled.end() );
+      _packet_pool.push_back( p );
+      _io_mutex->release();
+   }
+}
+
+// (vm thread) unpack a scheduled bundle, then recycle its buffer
+void
+OSC_Receiver::deliver( OSCPacket * p ) { 
+
+   unpack_bundle( p->buf, p->len, p->when );
+   recycle( p );
+}
+
+// (vm thread) take a bundle off the schedule, keep its buffer for reuse
+void
+OSC_Receiver::recycle( OSCPacket * p ) { 
+
+   _io_mutex->acquire();
+   _scheduled.erase( std::remove( _scheduled.begin(), _scheduled.end(), p ), _scheduled.end() );
+   if( _packet_pool.size() < OSC_PACKET_POOL ) _packet_pool.push_back( p );
+   else delete p;
+   _io_mutex->release();
+}
+
 OSC_Address_Space * 
 OSC_Receiver::new_event ( char * spec) { 
     OSC_Address_Space * event = new OSC_Address_Space ( spec );
@@ -1973,21 +2178,41 @@ OSC_Receiver::new_event ( char * addr, char * type) {
 
 void
 OSC_Receiver::add_address ( OSC_Address_Space * src ) { 
+    _address_mutex->acquire();
     if( _address_num == _address_size ) { 
-        _address_size *= 2;
+        _address_size = _address_size ? _address_size * 2 : 2;
         _address_space = (OSC_Address_Space **) realloc ( _address_space, _address_size * sizeof( OSC_Address_Space **));
     }
     _address_space[_address_num++] = src;
+
+    // keep about one address per bucket
+    if( _address_num > (int)_address_index.size() ) { 
+        _address_index.clear();
+        _address_index.resize( _address_size );
+        for( int i = 0 ; i < _address_num ; i++ ) index_address( _address_space[i] );
+    }
+    else index_address( src );
+    _address_mutex->release();
+
     src->setReceiver(this);
 }
 
+void
+OSC_Receiver::index_address ( OSC_Address_Space * src ) { 
+    _address_index[ src->hash() & ( _address_index.size() - 1 ) ].push_back( src );
+}
+
 void
 OSC_Receiver::remove_address ( OSC_Address_Space *odd ) { 
+    _address_mutex->acquire();
     for( int i = 0 ; i < _address_num ; i++ ) { 
-        while ( _address_space[i] == odd ) { 
+        while ( i < _address_num && _address_space[i] == odd ) { 
             _address_space[i] = _address_space[--_address_num];
         }
     }
+    std::vector<OSC_Address_Space *> & bucket = _address_index[ odd->hash() & ( _address_index.size() - 1 ) ];
+    bucket.erase( std::remove( bucket.begin(), bucket.end(), odd ), bucket.end() );
+    _address_mutex->release();
 }
 
 /*
@@ -1995,17 +2220,39 @@ OSC_Receiver::remove_address ( OSC_Address_Space *odd ) {
   chuck shred.  There are some issues with this.
   bundle simultaneity might be solved via mutex?
   
+  A plain address goes straight to its bucket in the address index, and
+  matches on a string compare of address and type tags.  An address with
+  pattern characters is matched against every address space, as before.
 */
 
 void 
 OSC_Receiver::distribute_message( OSCMesg * msg ) { 
-    for( int i = 0 ; i < _address_num ; i++ ) { 
-        if( _address_space[i]->try_queue_mesg( msg ) ) {
-            // fprintf ( stderr, "broadcasting %x from %x\n", (uint)_address_space[i]->SELF, (uint)_address_space[i] );
-            // if the event has any shreds queued, fire them off..
-            ( (Chuck_Event *) _address_space[i]->SELF )->queue_broadcast();
+    _address_mutex->acquire();
+
+    if( strpbrk( msg->address, OSC_PATTERN_CHARS ) ) { 
+        for( int i = 0 ; i < _address_num ; i++ ) { 
+            if( _address_space[i]->message_matches( msg ) ) {
+                if( !_address_space[i]->queue_mesg( msg ) ) ck_atomic_add( &_dropped, 1 );
+                // fprintf ( stderr, "broadcasting %x from %x\n", (uint)_address_space[i]->SELF, (uint)_address_space[i] );
+                // if the event has any shreds queued, fire them off..
+                ( (Chuck_Event *) _address_space[i]->SELF )->queue_broadcast();
+            }
+        }
+    }
+    else if( msg->types ) { 
+        unsigned long h = osc_address_hash( msg->address );
+        const char * types = msg->types + 1;
+        int type_len = strlen( types );
+        std::vector<OSC_Address_Space *> & bucket = _address_index[ h & ( _address_index.size() - 1 ) ];
+        for( size_t i = 0 ; i < bucket.size() ; i++ ) { 
+            if( bucket[i]->hash() == h && bucket[i]->exact_matches( msg->address, types, type_len ) ) { 
+                if( !bucket[i]->queue_mesg( msg ) ) ck_atomic_add( &_dropped, 1 );
+                ( (Chuck_Event *) bucket[i]->SELF )->queue_broadcast();
+            }
         }
     }
+
+    _address_mutex->release();
 }
 
 
@@ -2060,10 +2307,14 @@ OSC_Address_Space::init() {
 	_cur_value = 0;
     _current_data = NULL;
     _buffer_mutex = new XMutex();
+    _hash = 0;
+    _type_len = 0;
+    _tags = NULL;
 }
 
 OSC_Address_Space::~OSC_Address_Space() { 
     if( _queue ) free ( _queue ); 
+    if( _tags ) free ( _tags );
 }
 
 void
@@ -2073,20 +2324,28 @@ OSC_Address_Space::setReceiver(OSC_Receiver * recv) {
 
 void
 OSC_Address_Space::setSpec( const char *addr, const char * types ) { 
+    // the receiver indexes by address: take it out while it changes
+    OSC_Receiver * recv = _receiver;
+    if( recv ) recv->remove_address( this );
     strncpy ( _spec, addr, 512 );
     strncat ( _spec, "," , 512);
     strncat ( _spec, types, 512 );
     scanSpec();
     _needparse = true; 
     parseSpec(); 
+    if( recv ) recv->add_address( this );
 }
 
 void   
 OSC_Address_Space::setSpec( const char *c ) { 
+    // the receiver indexes by address: take it out while it changes
+    OSC_Receiver * recv = _receiver;
+    if( recv ) recv->remove_address( this );
     strncpy ( _spec, c, 512); 
     scanSpec();
     _needparse = true; 
     parseSpec(); 
+    if( recv ) recv->add_address( this );
 }
  
 void
@@ -2138,6 +2397,20 @@ OSC_Address_Space::parseSpec() {
 
    int n = strlen ( type );
    _noArgs = ( n == 0 );
+
+   // pre-parse for matching and queue_mesg
+   _hash = osc_address_hash( _address );
+   _type_len = n;
+   _tags = (osc_datatype *) realloc ( _tags, ( n + 1 ) * sizeof( osc_datatype ) );
+   for( int i = 0; i < n; i++ ) { 
+       switch( type[i] ) { 
+       case 'i': _tags[i] = OSC_INT; break;
+       case 'f': _tags[i] = OSC_FLOAT; break;
+       case 's': _tags[i] = OSC_STRING; break;
+       case 'b': _tags[i] = OSC_BLOB; break;
+       default: _tags[i] = OSC_UNTYPED; break;
+       }
+   }
    resizeData( ( n < 1 ) ? 1 : n );
    _qread = 0;
    _qwrite = 1;
@@ -2246,6 +2519,13 @@ OSC_Address_Space::message_matches( OSCMesg * m ) {
 }
 
 
+bool
+OSC_Address_Space::exact_matches( const char * address, const char * types, int type_len ) {
+    return type_len == _type_len && strcmp( address, _address ) == 0 
+        && memcmp( types, _type, type_len ) == 0;
+}
+
+
 bool
 OSC_Address_Space::try_queue_mesg( OSCMesg * m ) 
 { 
@@ -2334,10 +2614,11 @@ OSC_Address_Space::next_blob() {
     return ( vcheck(OSC_BLOB) )   ?  _cur_mesg[_cur_value++].s : NULL ;
 }
 
-void
+bool
 OSC_Address_Space::queue_mesg( OSCMesg * m ) 
 {
     // in the server thread. 
+    bool kept = true;
     int nqw = ( _qwrite + 1 ) % _queueSize;
     EM_log( CK_LOG_FINE, "OSC address(%s): read: %d write: %d size: %d", _address, _qread, _qwrite, _queueSize );
 
@@ -2351,6 +2632,7 @@ OSC_Address_Space::queue_mesg( OSCMesg * m )
             EM_log( CK_LOG_INFO, "...(dropping oldest message %d)", _qread );
 
             // bump!
+            kept = false;
             _buffer_mutex->acquire();
             _qread = ( _qread + 1 ) % _queueSize; 
             _buffer_mutex->release();
@@ -2363,7 +2645,7 @@ OSC_Address_Space::queue_mesg( OSCMesg * m )
         _vals[0].t = OSC_NOARGS;
     }
     else { 
-        char * type = m->types+1;
+        // (the message's type tags are ours, pre-parsed)
         char * data = m->data;
         
         unsigned int endy;
@@ -2372,23 +2654,23 @@ OSC_Address_Space::queue_mesg( OSCMesg * m )
         float *fp;
         int   *ip;
         int   clen;
-        while ( *type != '\0' ) { 
-            switch ( *type ) { 
-            case 'f':
+        for( i = 0; i < _type_len; i++ ) { 
+            switch ( _tags[i] ) { 
+            case OSC_FLOAT:
                 endy = ntohl(*((unsigned long*)data));
                 fp = (float*)(&endy);
                 _vals[i].t = OSC_FLOAT;
                 _vals[i].f = *fp; 
                 data += 4;
                 break;
-            case 'i':
+            case OSC_INT:
                 endy = ntohl(*((unsigned long*)data));
                 ip = (int4byte*)(&endy);
                 _vals[i].t = OSC_INT;
                 _vals[i].i = *ip; 
                 data += 4;
                 break;
-            case 's':
+            case OSC_STRING:
                 // string
                 clen = strlen(data) + 1; // terminating!
                 _vals[i].t = OSC_STRING;
@@ -2398,7 +2680,7 @@ OSC_Address_Space::queue_mesg( OSCMesg * m )
                 data += (((clen-1) >> 2) + 1) << 2;
                 // data += clen + 4 - clen % 4;
             break;
-            case 'b':
+            case OSC_BLOB:
                 // blobs
                 endy = ntohl(*((unsigned long*)data));
                 clen = *((int*)(&endy));
@@ -2407,9 +2689,9 @@ OSC_Address_Space::queue_mesg( OSCMesg * m )
                 memcpy ( _vals[i].s, data, clen );
                 data += clen + 4 - clen % 4;
                 break;
+            default:
+                break;
             }
-            i++;
-            type++;
         }
     }
     
@@ -2422,4 +2704,6 @@ OSC_Address_Space::queue_mesg( OSCMesg * m )
       }
       fprintf(stderr, "\n");
     */
+
+    return kept;
 }
@@ -387,6 +387,7 @@ int OSC_effectiveStringLength(char *string);
 // from veldt:platform.h - UDP Transmitter / Receiver Pair
 
 #include "chuck_oo.h"
+#include <vector>
 
 class OSC_Address_Space;
 class UDP_Transmitter;
@@ -447,6 +448,17 @@ struct OSCMesg {
 struct XMutex;
 struct XThread;
 
+// most bundles held for later that keep their buffers for reuse
+#define OSC_PACKET_POOL 64
+
+// a bundle held until its timetag, in its own buffer
+struct OSCPacket {
+    class OSC_Receiver * recv; // NULL once the receiver is gone
+    double when;               // timetag, in seconds since 1900
+    int len;
+    char buf[OSCINBUFSIZE];
+};
+
 class UDP_Subscriber
 {
 public:
@@ -455,6 +467,8 @@ public:
 public:
     virtual int& port() = 0; // get/set the value of the subscriber's current port. 
     virtual void onReceive( char * mesg, int mesgLen ) = 0;
+    // datagrams the system dropped on the port since the last call
+    virtual void onDrop( unsigned long n ) { }
 
 protected: 
     virtual bool subscribe( int port );
@@ -474,6 +488,7 @@ protected:
 	int			   _port;
 	int			   _tmp_port;
 	void		   onReceive( char * mesg, int mesgLen);
+	void		   onDrop( unsigned long n );
 	int &		   port();
 
     XMutex*        _io_mutex;
@@ -488,6 +503,25 @@ protected:
     OSC_Address_Space **      _address_space;
     int            _address_size;
     int            _address_num;
+    // the same address spaces, hashed by address (see distribute_message)
+    std::vector< std::vector<OSC_Address_Space *> > _address_index;
+    XMutex*        _address_mutex;
+    void index_address( OSC_Address_Space * o );
+
+    // bundles waiting on the vm for their time, and spare packet buffers
+    // (both under _io_mutex)
+    std::vector<OSCPacket *> _scheduled;
+    std::vector<OSCPacket *> _packet_pool;
+    void schedule_bundle( char * b, int len, double when, double delay );
+    void unpack_bundle( char * b, int len, double when );
+
+    // counters: packets in, messages dropped, bundles past their timetag
+    // (counted atomically, by the listener and the VM thread), and the
+    // latest of those in seconds (under _address_mutex)
+    volatile t_CKUINT _received;
+    volatile t_CKUINT _dropped;
+    volatile t_CKUINT _late;
+    double         _lateness;
 
 public:
     
@@ -508,7 +542,9 @@ public:
 
     void parse(char *, int len);
     void handle_mesg(char *, int len);
-    void handle_bundle(char *, int len);
+    void handle_bundle(char *, int len, double parent = 0);
+    void deliver( OSCPacket * p );
+    void recycle( OSCPacket * p );
     void set_mesg(OSCMesg *m, char * buf, int len );
     
     OSCMesg *write()  { return _inbox + _in_write;}
@@ -526,6 +562,12 @@ public:
     OSC_Address_Space * new_event ( char * spec );
     OSC_Address_Space * new_event ( char * addr, char * type );
     void distribute_message( OSCMesg * msg);
+
+    t_CKUINT received() const { return _received; }
+    t_CKUINT dropped() const { return _dropped; }
+    t_CKUINT late() const { return _late; }
+    double lateness() const
+    { _address_mutex->acquire(); double l = _lateness; _address_mutex->release(); return l; }
 };
 
 enum osc_datatype { OSC_UNTYPED, OSC_NOARGS, OSC_INT, OSC_FLOAT, OSC_STRING, OSC_BLOB, OSC_NTYPE };
@@ -568,6 +610,10 @@ protected:
     bool  _needparse;
     char  _address[512];
     char  _type[512];
+    // pre-parsed: hash of _address, length of _type, and its tags
+    unsigned long _hash;
+    int   _type_len;
+    osc_datatype * _tags;
     opsc_data * _queue;
     opsc_data * _current_data;
     int   _qread;
@@ -600,7 +646,9 @@ public:
     // distribution
     bool   try_queue_mesg ( OSCMesg * o );
     bool   message_matches ( OSCMesg * o );
-    void   queue_mesg ( OSCMesg * o );
+    bool   exact_matches ( const char * address, const char * types, int type_len );
+    unsigned long hash() const { return _hash; }
+    bool   queue_mesg ( OSCMesg * o ); // false if the oldest was dropped
 
     // loop functions
     bool   has_mesg();
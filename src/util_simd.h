@@ -0,0 +1,457 @@
+/*----------------------------------------------------------------------------
+    ChucK Concurrent, On-the-fly Audio Programming Language
+      Compiler and Virtual Machine
+
+    Copyright (c) 2004 Ge Wang and Perry R. Cook.  All rights reserved.
+      http://chuck.cs.princeton.edu/
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// file: util_simd.h
+// desc: vector kernels on SAMPLE buffers, for block ugen processing; uses
+//       SSE2 when SAMPLE is float and the compiler targets it, plain loops
+//       otherwise
+//-----------------------------------------------------------------------------
+#ifndef __UTIL_SIMD_H__
+#define __UTIL_SIMD_H__
+
+#include "chuck_def.h"
+#include <math.h>
+#include <string.h>
+
+#if !defined(CK_S_DOUBLE) && !defined(__CK_NO_SIMD__) && \
+    ( defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) )
+  #define __CK_SIMD_SSE__
+  #include <emmintrin.h>
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_add(), vec_sub(), vec_mul(), vec_div()
+// desc: dst[i] op= src[i]
+//-----------------------------------------------------------------------------
+#if defined(__CK_SIMD_SSE__)
+#define VEC_BINARY( name, op, sse ) \
+inline void name( SAMPLE * dst, const SAMPLE * src, t_CKUINT n ) \
+{ \
+    t_CKUINT i = 0; \
+    for( ; i + 4 <= n; i += 4 ) \
+        _mm_storeu_ps( dst+i, sse( _mm_loadu_ps( dst+i ), _mm_loadu_ps( src+i ) ) ); \
+    for( ; i < n; i++ ) dst[i] op src[i]; \
+}
+#else
+#define VEC_BINARY( name, op, sse ) \
+inline void name( SAMPLE * dst, const SAMPLE * src, t_CKUINT n ) \
+{ for( t_CKUINT i = 0; i < n; i++ ) dst[i] op src[i]; }
+#endif
+
+VEC_BINARY( vec_add, +=, _mm_add_ps )
+VEC_BINARY( vec_sub, -=, _mm_sub_ps )
+VEC_BINARY( vec_mul, *=, _mm_mul_ps )
+VEC_BINARY( vec_div, /=, _mm_div_ps )
+#undef VEC_BINARY
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_madd()
+// desc: dst[i] += src[i] * g
+//-----------------------------------------------------------------------------
+inline void vec_madd( SAMPLE * dst, const SAMPLE * src, SAMPLE g, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 vg = _mm_set1_ps( g );
+    for( ; i + 4 <= n; i += 4 )
+        _mm_storeu_ps( dst+i, _mm_add_ps( _mm_loadu_ps( dst+i ),
+                       _mm_mul_ps( _mm_loadu_ps( src+i ), vg ) ) );
+#endif
+    for( ; i < n; i++ ) dst[i] += src[i] * g;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_scale()
+// desc: dst[i] *= g
+//-----------------------------------------------------------------------------
+inline void vec_scale( SAMPLE * dst, SAMPLE g, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 vg = _mm_set1_ps( g );
+    for( ; i + 4 <= n; i += 4 )
+        _mm_storeu_ps( dst+i, _mm_mul_ps( _mm_loadu_ps( dst+i ), vg ) );
+#endif
+    for( ; i < n; i++ ) dst[i] *= g;
+}
+
+
+
+
+#if defined(__CK_SIMD_SSE__)
+//-----------------------------------------------------------------------------
+// name: vec_hsum_ps()
+// desc: sum of the four lanes
+//-----------------------------------------------------------------------------
+inline SAMPLE vec_hsum_ps( __m128 v )
+{
+    t_CKSINGLE part[4];
+    _mm_storeu_ps( part, v );
+    return ( part[0] + part[1] ) + ( part[2] + part[3] );
+}
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_dot()
+// desc: sum of a[i] * b[i]
+//-----------------------------------------------------------------------------
+inline SAMPLE vec_dot( const SAMPLE * a, const SAMPLE * b, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+    SAMPLE sum = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for( ; i + 8 <= n; i += 8 )
+    {
+        acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( a+i ), _mm_loadu_ps( b+i ) ) );
+        acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_loadu_ps( a+i+4 ), _mm_loadu_ps( b+i+4 ) ) );
+    }
+    sum = vec_hsum_ps( _mm_add_ps( acc0, acc1 ) );
+#endif
+    for( ; i < n; i++ ) sum += a[i] * b[i];
+    return sum;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_sum()
+// desc: sum of x[i]
+//-----------------------------------------------------------------------------
+inline SAMPLE vec_sum( const SAMPLE * x, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+    SAMPLE sum = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 acc = _mm_setzero_ps();
+    for( ; i + 4 <= n; i += 4 )
+        acc = _mm_add_ps( acc, _mm_loadu_ps( x+i ) );
+    sum = vec_hsum_ps( acc );
+#endif
+    for( ; i < n; i++ ) sum += x[i];
+    return sum;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_max()
+// desc: largest x[i] (0 if n is 0)
+//-----------------------------------------------------------------------------
+inline SAMPLE vec_max( const SAMPLE * x, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+    if( n == 0 ) return 0;
+    SAMPLE m = x[0];
+#if defined(__CK_SIMD_SSE__)
+    if( n >= 4 )
+    {
+        t_CKSINGLE part[4];
+        __m128 acc = _mm_loadu_ps( x );
+        for( i = 4; i + 4 <= n; i += 4 )
+            acc = _mm_max_ps( acc, _mm_loadu_ps( x+i ) );
+        _mm_storeu_ps( part, acc );
+        m = ck_max( ck_max( part[0], part[1] ), ck_max( part[2], part[3] ) );
+    }
+#endif
+    for( ; i < n; i++ ) if( x[i] > m ) m = x[i];
+    return m;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_moments()
+// desc: m0 = sum of x[i], m1 = sum of i * x[i]
+//-----------------------------------------------------------------------------
+inline void vec_moments( const SAMPLE * x, t_CKUINT n, SAMPLE & m0, SAMPLE & m1 )
+{
+    t_CKUINT i = 0;
+    m0 = m1 = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 a0 = _mm_setzero_ps();
+    __m128 a1 = _mm_setzero_ps();
+    __m128 idx = _mm_set_ps( 3, 2, 1, 0 );
+    __m128 four = _mm_set1_ps( 4 );
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 v = _mm_loadu_ps( x+i );
+        a0 = _mm_add_ps( a0, v );
+        a1 = _mm_add_ps( a1, _mm_mul_ps( v, idx ) );
+        idx = _mm_add_ps( idx, four );
+    }
+    m0 = vec_hsum_ps( a0 );
+    m1 = vec_hsum_ps( a1 );
+#endif
+    for( ; i < n; i++ ) { m0 += x[i]; m1 += i * x[i]; }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_dist2()
+// desc: sum of ( a[i] - b[i] )^2
+//-----------------------------------------------------------------------------
+inline SAMPLE vec_dist2( const SAMPLE * a, const SAMPLE * b, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+    SAMPLE sum = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 acc = _mm_setzero_ps();
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 d = _mm_sub_ps( _mm_loadu_ps( a+i ), _mm_loadu_ps( b+i ) );
+        acc = _mm_add_ps( acc, _mm_mul_ps( d, d ) );
+    }
+    sum = vec_hsum_ps( acc );
+#endif
+    for( ; i < n; i++ ) sum += ( a[i] - b[i] ) * ( a[i] - b[i] );
+    return sum;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_mag()
+// desc: dst[i] = |c[i]|, c interleaved re, im
+//-----------------------------------------------------------------------------
+inline void vec_mag( SAMPLE * dst, const SAMPLE * c, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+#if defined(__CK_SIMD_SSE__)
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 lo = _mm_loadu_ps( c + 2*i );
+        __m128 hi = _mm_loadu_ps( c + 2*i + 4 );
+        lo = _mm_mul_ps( lo, lo );
+        hi = _mm_mul_ps( hi, hi );
+        __m128 re = _mm_shuffle_ps( lo, hi, _MM_SHUFFLE(2,0,2,0) );
+        __m128 im = _mm_shuffle_ps( lo, hi, _MM_SHUFFLE(3,1,3,1) );
+        _mm_storeu_ps( dst+i, _mm_sqrt_ps( _mm_add_ps( re, im ) ) );
+    }
+#endif
+    for( ; i < n; i++ )
+        dst[i] = (SAMPLE)::sqrt( c[2*i] * c[2*i] + c[2*i+1] * c[2*i+1] );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_crossings()
+// desc: how many i have x[i] >= 0 differing from x[i-1] >= 0
+//-----------------------------------------------------------------------------
+inline t_CKUINT vec_crossings( const SAMPLE * x, t_CKUINT n )
+{
+    t_CKUINT i = 1, count = 0;
+    if( n < 2 ) return 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 zero = _mm_setzero_ps();
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 now = _mm_cmpge_ps( _mm_loadu_ps( x+i ), zero );
+        __m128 then = _mm_cmpge_ps( _mm_loadu_ps( x+i-1 ), zero );
+        int bits = _mm_movemask_ps( _mm_xor_ps( now, then ) );
+        count += ( bits & 1 ) + ( (bits >> 1) & 1 ) + ( (bits >> 2) & 1 ) + ( (bits >> 3) & 1 );
+    }
+#endif
+    for( ; i < n; i++ ) count += ( x[i] >= 0 ) != ( x[i-1] >= 0 );
+    return count;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_fir3()
+// desc: dst[i] = b0*(g*src[i]) + b1*(g*src[i-1]) + b2*(g*src[i-2]), summed
+//       in that order; src[-1] and src[-2] must be readable
+//-----------------------------------------------------------------------------
+inline void vec_fir3( SAMPLE * dst, const SAMPLE * src, SAMPLE g,
+                      SAMPLE b0, SAMPLE b1, SAMPLE b2, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 vg = _mm_set1_ps( g );
+    __m128 v0 = _mm_set1_ps( b0 );
+    __m128 v1 = _mm_set1_ps( b1 );
+    __m128 v2 = _mm_set1_ps( b2 );
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 x0 = _mm_mul_ps( vg, _mm_loadu_ps( src+i ) );
+        __m128 x1 = _mm_mul_ps( vg, _mm_loadu_ps( src+i-1 ) );
+        __m128 x2 = _mm_mul_ps( vg, _mm_loadu_ps( src+i-2 ) );
+        _mm_storeu_ps( dst+i, _mm_add_ps( _mm_add_ps( _mm_mul_ps( v0, x0 ),
+                       _mm_mul_ps( v1, x1 ) ), _mm_mul_ps( v2, x2 ) ) );
+    }
+#endif
+    for( ; i < n; i++ )
+        dst[i] = b0 * (g * src[i]) + b1 * (g * src[i-1]) + b2 * (g * src[i-2]);
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_ddn()
+// desc: CK_DDN on every element (zero if |x| <= 1e-15, |x| >= 1e15, or nan)
+//-----------------------------------------------------------------------------
+inline void vec_ddn( SAMPLE * dst, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 lo = _mm_set1_ps( (t_CKSINGLE)1e-15 );
+    __m128 hi = _mm_set1_ps( (t_CKSINGLE)1e15 );
+    __m128 abs_mask = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ) );
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 v = _mm_loadu_ps( dst+i );
+        __m128 a = _mm_and_ps( v, abs_mask );
+        // ordered compares are false for nan
+        __m128 keep = _mm_and_ps( _mm_cmpgt_ps( a, lo ), _mm_cmplt_ps( a, hi ) );
+        _mm_storeu_ps( dst+i, _mm_and_ps( v, keep ) );
+    }
+#endif
+    for( ; i < n; i++ ) CK_DDN( dst[i] );
+}
+
+
+
+
+#if defined(__CK_SIMD_SSE__)
+//-----------------------------------------------------------------------------
+// name: vec_sin2pi_ps()
+// desc: sin( 2pi * v ), v in [-.5, .5]; a polynomial good to about 1e-7,
+//       which is below float resolution of the scalar path
+//-----------------------------------------------------------------------------
+inline __m128 vec_sin2pi_ps( __m128 v )
+{
+    __m128 half = _mm_set1_ps( .5f );
+    __m128 quarter = _mm_set1_ps( .25f );
+    __m128 sign_mask = _mm_castsi128_ps( _mm_set1_epi32( 0x80000000 ) );
+    __m128 twopi = _mm_set1_ps( (t_CKSINGLE)TWO_PI );
+    // taylor coefficients, y in [-pi/2, pi/2]
+    __m128 c3 = _mm_set1_ps( -1.0f / 6.0f );
+    __m128 c5 = _mm_set1_ps( 1.0f / 120.0f );
+    __m128 c7 = _mm_set1_ps( -1.0f / 5040.0f );
+    __m128 c9 = _mm_set1_ps( 1.0f / 362880.0f );
+    __m128 c11 = _mm_set1_ps( -1.0f / 39916800.0f );
+    // fold |x| > .25 onto [-.25, .25]: sin(2pi x) = sin(2pi (+-.5 - x))
+    __m128 s = _mm_and_ps( v, sign_mask );
+    __m128 a = _mm_andnot_ps( sign_mask, v );
+    __m128 fold = _mm_cmpgt_ps( a, quarter );
+    a = _mm_or_ps( _mm_and_ps( fold, _mm_sub_ps( half, a ) ), _mm_andnot_ps( fold, a ) );
+    __m128 y = _mm_mul_ps( _mm_or_ps( a, s ), twopi );
+    __m128 y2 = _mm_mul_ps( y, y );
+    __m128 p = _mm_add_ps( c9, _mm_mul_ps( y2, c11 ) );
+    p = _mm_add_ps( c7, _mm_mul_ps( y2, p ) );
+    p = _mm_add_ps( c5, _mm_mul_ps( y2, p ) );
+    p = _mm_add_ps( c3, _mm_mul_ps( y2, p ) );
+    p = _mm_mul_ps( _mm_mul_ps( y2, p ), y );
+    return _mm_add_ps( y, p );
+}
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_sin2pi()
+// desc: dst[i] = sin( 2pi * x[i] ), x[i] in [-.5, .5]
+//-----------------------------------------------------------------------------
+inline void vec_sin2pi( SAMPLE * dst, const SAMPLE * x, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+#if defined(__CK_SIMD_SSE__)
+    for( ; i + 4 <= n; i += 4 )
+        _mm_storeu_ps( dst+i, vec_sin2pi_ps( _mm_loadu_ps( x+i ) ) );
+#endif
+    for( ; i < n; i++ ) dst[i] = (SAMPLE)::sin( x[i] * TWO_PI );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: vec_sinbank()
+// desc: one sample of a bank of sines: returns the sum of
+//       amp[i] * sin( 2pi * phase[i] ), then steps phase[i] by inc[i]; phases
+//       and increments are kept in [-.5, .5)
+//-----------------------------------------------------------------------------
+inline SAMPLE vec_sinbank( SAMPLE * phase, const SAMPLE * inc, const SAMPLE * amp, t_CKUINT n )
+{
+    t_CKUINT i = 0;
+    SAMPLE sum = 0;
+#if defined(__CK_SIMD_SSE__)
+    __m128 half = _mm_set1_ps( .5f );
+    __m128 mhalf = _mm_set1_ps( -.5f );
+    __m128 one = _mm_set1_ps( 1.0f );
+    __m128 acc = _mm_setzero_ps();
+    t_CKSINGLE part[4];
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 p = _mm_loadu_ps( phase+i );
+        acc = _mm_add_ps( acc, _mm_mul_ps( _mm_loadu_ps( amp+i ), vec_sin2pi_ps( p ) ) );
+        // step and wrap
+        p = _mm_add_ps( p, _mm_loadu_ps( inc+i ) );
+        p = _mm_sub_ps( p, _mm_and_ps( _mm_cmpge_ps( p, half ), one ) );
+        p = _mm_add_ps( p, _mm_and_ps( _mm_cmplt_ps( p, mhalf ), one ) );
+        _mm_storeu_ps( phase+i, p );
+    }
+    _mm_storeu_ps( part, acc );
+    sum = ( part[0] + part[1] ) + ( part[2] + part[3] );
+#endif
+    for( ; i < n; i++ )
+    {
+        sum += amp[i] * (SAMPLE)::sin( phase[i] * TWO_PI );
+        phase[i] += inc[i];
+        if( phase[i] >= .5 ) phase[i] -= 1;
+        else if( phase[i] < -.5 ) phase[i] += 1;
+    }
+    return sum;
+}
+
+
+
+
+#endif
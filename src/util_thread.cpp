@@ -34,6 +34,11 @@
 //-----------------------------------------------------------------------------
 #include "util_thread.h"
 
+#if !defined(__PLATFORM_WIN32__) || defined(__WINDOWS_PTHREAD__)
+  #include <sys/time.h>
+  #include <errno.h>
+#endif
+
 
 
 
@@ -194,3 +199,377 @@ void XMutex::release( )
     LeaveCriticalSection(&mutex);
 #endif 
 }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: XSemaphore()
+// desc: ...
+//-----------------------------------------------------------------------------
+XSemaphore::XSemaphore( t_CKUINT count, t_CKUINT max )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_mutex_init( &m_mutex, NULL );
+    pthread_cond_init( &m_cond, NULL );
+    m_count = count;
+    m_max = max;
+#elif defined(__PLATFORM_WIN32__)
+    m_sem = CreateSemaphore( NULL, (LONG)count, (LONG)max, NULL );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~XSemaphore()
+// desc: ...
+//-----------------------------------------------------------------------------
+XSemaphore::~XSemaphore( )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_cond_destroy( &m_cond );
+    pthread_mutex_destroy( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    CloseHandle( m_sem );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: post()
+// desc: ...
+//-----------------------------------------------------------------------------
+void XSemaphore::post( )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_mutex_lock( &m_mutex );
+    if( m_count < m_max ) m_count++;
+    pthread_cond_signal( &m_cond );
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    ReleaseSemaphore( m_sem, 1, NULL );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wait()
+// desc: ...
+//-----------------------------------------------------------------------------
+void XSemaphore::wait( )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_mutex_lock( &m_mutex );
+    while( !m_count )
+        pthread_cond_wait( &m_cond, &m_mutex );
+    m_count--;
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    WaitForSingleObject( m_sem, INFINITE );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wait_for()
+// desc: ...
+//-----------------------------------------------------------------------------
+t_CKBOOL XSemaphore::wait_for( t_CKUINT usec )
+{
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    struct timeval now;
+    struct timespec until;
+    t_CKBOOL got = FALSE;
+
+    // absolute deadline
+    gettimeofday( &now, NULL );
+    until.tv_sec = now.tv_sec + usec / 1000000;
+    until.tv_nsec = ( now.tv_usec + usec % 1000000 ) * 1000;
+    if( until.tv_nsec >= 1000000000 )
+    { until.tv_sec++; until.tv_nsec -= 1000000000; }
+
+    pthread_mutex_lock( &m_mutex );
+    while( !m_count )
+        if( pthread_cond_timedwait( &m_cond, &m_mutex, &until ) == ETIMEDOUT )
+            break;
+    if( m_count ) { m_count--; got = TRUE; }
+    pthread_mutex_unlock( &m_mutex );
+
+    return got;
+#elif defined(__PLATFORM_WIN32__)
+    return WaitForSingleObject( m_sem, (DWORD)( ( usec + 999 ) / 1000 ) ) == WAIT_OBJECT_0;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: XWorkPool()
+// desc: ...
+//-----------------------------------------------------------------------------
+XWorkPool::XWorkPool( )
+{
+    m_workers = NULL;
+    m_num_workers = 0;
+    m_func = NULL;
+    m_data = NULL;
+    m_num_tasks = 0;
+    m_next = 0;
+    m_pending = 0;
+    m_generation = 0;
+    m_quit = FALSE;
+
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_mutex_init( &m_mutex, NULL );
+    pthread_cond_init( &m_go, NULL );
+    pthread_cond_init( &m_done, NULL );
+#elif defined(__PLATFORM_WIN32__)
+    InitializeCriticalSection( &m_mutex );
+    m_go = CreateSemaphore( NULL, 0, 0x7fffffff, NULL );
+    m_done = CreateEvent( NULL, FALSE, FALSE, NULL );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~XWorkPool()
+// desc: ...
+//-----------------------------------------------------------------------------
+XWorkPool::~XWorkPool( )
+{
+    this->stop();
+
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_cond_destroy( &m_done );
+    pthread_cond_destroy( &m_go );
+    pthread_mutex_destroy( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    CloseHandle( m_done );
+    CloseHandle( m_go );
+    DeleteCriticalSection( &m_mutex );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: start()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool XWorkPool::start( t_CKUINT num_workers )
+{
+    // already started
+    if( m_workers ) return false;
+
+    m_quit = FALSE;
+    m_workers = new THREAD_HANDLE[num_workers];
+    for( m_num_workers = 0; m_num_workers < num_workers; m_num_workers++ )
+    {
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+        if( pthread_create( &m_workers[m_num_workers], NULL, worker_cb, this ) != 0 )
+            break;
+#elif defined(__PLATFORM_WIN32__)
+        unsigned thread_id;
+        m_workers[m_num_workers] = _beginthreadex( NULL, 0, worker_cb, this, 0, &thread_id );
+        if( !m_workers[m_num_workers] ) break;
+#endif
+    }
+
+    return m_num_workers == num_workers;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stop()
+// desc: ...
+//-----------------------------------------------------------------------------
+void XWorkPool::stop( )
+{
+    if( !m_workers ) return;
+
+    // tell the workers
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_mutex_lock( &m_mutex );
+    m_quit = TRUE;
+    pthread_cond_broadcast( &m_go );
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    EnterCriticalSection( &m_mutex );
+    m_quit = TRUE;
+    ReleaseSemaphore( m_go, (LONG)m_num_workers, NULL );
+    LeaveCriticalSection( &m_mutex );
+#endif
+
+    // join them
+    for( t_CKUINT i = 0; i < m_num_workers; i++ )
+    {
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+        pthread_join( m_workers[i], NULL );
+#elif defined(__PLATFORM_WIN32__)
+        WaitForSingleObject( (HANDLE)m_workers[i], INFINITE );
+        CloseHandle( (HANDLE)m_workers[i] );
+#endif
+    }
+
+    delete [] m_workers;
+    m_workers = NULL;
+    m_num_workers = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: ...
+//-----------------------------------------------------------------------------
+void XWorkPool::run( XWORK_FUNCTION func, void * data, t_CKUINT num_tasks )
+{
+    // nothing to share
+    if( !m_num_workers || num_tasks < 2 )
+    {
+        for( t_CKUINT i = 0; i < num_tasks; i++ )
+            func( data, i );
+        return;
+    }
+
+    // post the job
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_mutex_lock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    EnterCriticalSection( &m_mutex );
+#endif
+    m_func = func;
+    m_data = data;
+    m_num_tasks = num_tasks;
+    m_next = 0;
+    m_pending = num_tasks;
+    m_generation++;
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_cond_broadcast( &m_go );
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    ReleaseSemaphore( m_go, (LONG)m_num_workers, NULL );
+    LeaveCriticalSection( &m_mutex );
+#endif
+
+    // help out
+    this->work();
+
+    // wait for the stragglers
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    pthread_mutex_lock( &m_mutex );
+    while( m_pending )
+        pthread_cond_wait( &m_done, &m_mutex );
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    EnterCriticalSection( &m_mutex );
+    while( m_pending )
+    {
+        LeaveCriticalSection( &m_mutex );
+        WaitForSingleObject( m_done, INFINITE );
+        EnterCriticalSection( &m_mutex );
+    }
+    LeaveCriticalSection( &m_mutex );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: work()
+// desc: take tasks from the current job until there are none left
+//-----------------------------------------------------------------------------
+void XWorkPool::work( )
+{
+    XWORK_FUNCTION func;
+    void * data;
+    t_CKUINT task;
+
+    while( true )
+    {
+        // take the next task
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+        pthread_mutex_lock( &m_mutex );
+        if( m_next >= m_num_tasks ) { pthread_mutex_unlock( &m_mutex ); break; }
+        task = m_next++; func = m_func; data = m_data;
+        pthread_mutex_unlock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+        EnterCriticalSection( &m_mutex );
+        if( m_next >= m_num_tasks ) { LeaveCriticalSection( &m_mutex ); break; }
+        task = m_next++; func = m_func; data = m_data;
+        LeaveCriticalSection( &m_mutex );
+#endif
+
+        // do it
+        func( data, task );
+
+        // done
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+        pthread_mutex_lock( &m_mutex );
+        if( --m_pending == 0 ) pthread_cond_signal( &m_done );
+        pthread_mutex_unlock( &m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+        EnterCriticalSection( &m_mutex );
+        if( --m_pending == 0 ) SetEvent( m_done );
+        LeaveCriticalSection( &m_mutex );
+#endif
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: worker_cb()
+// desc: worker thread
+//-----------------------------------------------------------------------------
+THREAD_RETURN THREAD_TYPE XWorkPool::worker_cb( void * data )
+{
+    XWorkPool * pool = (XWorkPool *)data;
+
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    t_CKUINT seen = 0;
+    pthread_mutex_lock( &pool->m_mutex );
+    seen = pool->m_generation;
+    while( true )
+    {
+        // wait for a new job
+        while( !pool->m_quit && seen == pool->m_generation )
+            pthread_cond_wait( &pool->m_go, &pool->m_mutex );
+        if( pool->m_quit ) break;
+        seen = pool->m_generation;
+        pthread_mutex_unlock( &pool->m_mutex );
+
+        pool->work();
+
+        pthread_mutex_lock( &pool->m_mutex );
+    }
+    pthread_mutex_unlock( &pool->m_mutex );
+#elif defined(__PLATFORM_WIN32__)
+    while( true )
+    {
+        // wait for a job (or a share of one)
+        WaitForSingleObject( pool->m_go, INFINITE );
+        if( pool->m_quit ) break;
+        pool->work();
+    }
+#endif
+
+    return 0;
+}
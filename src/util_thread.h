@@ -46,6 +46,7 @@
   typedef void * THREAD_RETURN;
   typedef void * (*THREAD_FUNCTION)(void *);
   typedef pthread_mutex_t MUTEX;
+  typedef pthread_cond_t CONDITION;
   #define CHUCK_THREAD pthread_t
 #elif defined(__PLATFORM_WIN32__)
   #include <windows.h>
@@ -55,12 +56,56 @@
   typedef unsigned THREAD_RETURN;
   typedef unsigned (__stdcall *THREAD_FUNCTION)(void *);
   typedef CRITICAL_SECTION MUTEX;
+  typedef HANDLE CONDITION;
   #define CHUCK_THREAD HANDLE
 #endif
 
 
 
 
+//-----------------------------------------------------------------------------
+// name: ck_cas_ptr(), ck_atomic_add()
+// desc: lock-free primitives (full barrier); cas returns TRUE if *dst was
+//       expected and is now desired, add returns the new value
+//-----------------------------------------------------------------------------
+#if defined(_MSC_VER)
+inline t_CKBOOL ck_cas_ptr( void * volatile * dst, void * expected, void * desired )
+{ return InterlockedCompareExchangePointer( dst, desired, expected ) == expected; }
+inline t_CKUINT ck_atomic_add( volatile t_CKUINT * dst, t_CKUINT v )
+{ return (t_CKUINT)InterlockedExchangeAdd( (volatile LONG *)dst, (LONG)v ) + v; }
+#else
+inline t_CKBOOL ck_cas_ptr( void * volatile * dst, void * expected, void * desired )
+{ return __sync_bool_compare_and_swap( dst, expected, desired ); }
+inline t_CKUINT ck_atomic_add( volatile t_CKUINT * dst, t_CKUINT v )
+{ return __sync_add_and_fetch( dst, v ); }
+#endif
+
+
+//-----------------------------------------------------------------------------
+// name: ck_load_acquire(), ck_store_release()
+// desc: ordered access to an index or flag shared by two threads
+//-----------------------------------------------------------------------------
+#if defined(_MSC_VER)
+#include <intrin.h>
+inline t_CKUINT ck_load_acquire( volatile t_CKUINT * src )
+{ t_CKUINT v = *src; _ReadWriteBarrier(); return v; }
+inline void ck_store_release( volatile t_CKUINT * dst, t_CKUINT v )
+{ _ReadWriteBarrier(); *dst = v; }
+#elif defined(__ATOMIC_ACQUIRE)
+inline t_CKUINT ck_load_acquire( volatile t_CKUINT * src )
+{ return __atomic_load_n( src, __ATOMIC_ACQUIRE ); }
+inline void ck_store_release( volatile t_CKUINT * dst, t_CKUINT v )
+{ __atomic_store_n( dst, v, __ATOMIC_RELEASE ); }
+#else
+inline t_CKUINT ck_load_acquire( volatile t_CKUINT * src )
+{ t_CKUINT v = *src; __sync_synchronize(); return v; }
+inline void ck_store_release( volatile t_CKUINT * dst, t_CKUINT v )
+{ __sync_synchronize(); *dst = v; }
+#endif
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: struct XThread
 // desc: ...
@@ -114,4 +159,88 @@ protected:
 
 
 
+//-----------------------------------------------------------------------------
+// name: struct XSemaphore
+// desc: counting semaphore, for handing buffers between threads; with
+//       max 1 it is a wakeup signal that extra posts cannot pile up on
+//-----------------------------------------------------------------------------
+struct XSemaphore
+{
+public:
+    XSemaphore( t_CKUINT count = 0, t_CKUINT max = 0x7fffffff );
+    ~XSemaphore();
+
+public:
+    // increment, waking a waiter
+    void post();
+    // wait until positive, then decrement
+    void wait();
+    // as wait(), giving up after usec microseconds; TRUE if decremented
+    t_CKBOOL wait_for( t_CKUINT usec );
+
+protected:
+#if ( defined(__PLATFORM_MACOSX__) || defined(__PLATFORM_LINUX__) || defined(__WINDOWS_PTHREAD__) )
+    MUTEX m_mutex;
+    CONDITION m_cond;
+    t_CKUINT m_count;
+    t_CKUINT m_max;
+#else
+    HANDLE m_sem;
+#endif
+};
+
+
+
+
+// work function, called with the pool data and a task index
+typedef void (*XWORK_FUNCTION)( void * data, t_CKUINT task );
+
+//-----------------------------------------------------------------------------
+// name: struct XWorkPool
+// desc: a fixed set of worker threads; run() hands out task indices to
+//       the workers and the calling thread, whichever is free next, and
+//       returns once every task has finished
+//-----------------------------------------------------------------------------
+struct XWorkPool
+{
+public:
+    XWorkPool();
+    ~XWorkPool();
+
+public:
+    // start num_workers threads (in addition to the caller)
+    bool start( t_CKUINT num_workers );
+    // stop and join the workers
+    void stop();
+    // call func( data, i ) for i in [0,num_tasks), in parallel
+    void run( XWORK_FUNCTION func, void * data, t_CKUINT num_tasks );
+    // number of workers
+    t_CKUINT size() const { return m_num_workers; }
+
+protected:
+    static THREAD_RETURN THREAD_TYPE worker_cb( void * data );
+    void work();
+
+protected:
+    THREAD_HANDLE * m_workers;
+    t_CKUINT m_num_workers;
+    // current job
+    XWORK_FUNCTION m_func;
+    void * m_data;
+    t_CKUINT m_num_tasks;
+    t_CKUINT m_next;
+    t_CKUINT m_pending;
+    // bumped per job, workers wait for a change
+    t_CKUINT m_generation;
+    t_CKBOOL m_quit;
+    // guards the job
+    MUTEX m_mutex;
+    // job posted / job done
+    CONDITION m_go;
+    CONDITION m_done;
+};
+
+
+
+
 #endif